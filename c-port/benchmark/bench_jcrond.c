@@ -0,0 +1,1824 @@
+/**
+ * JCRON Daemon Benchmarks
+ *
+ * Exercises the daemon modules in examples/jcrond/ directly (no crontab,
+ * no syslog output): job launch and reaping, admission control, crontab
+ * reload, load spreading, missed-run catch-up, run-state journal,
+ * scheduler and launch threads, launch helper, output capture, metrics,
+ * direct exec against the shell, cached user credentials, asynchronous
+ * logging, schedule simulation, multi-node ownership, control socket.
+ */
+
+#include "jcrond.h"
+
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <fcntl.h>
+#include <pwd.h>
+#include <sys/ptrace.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/* ========================================================================
+ * Helpers
+ * ======================================================================== */
+
+static int compare_i64(const void* a, const void* b) {
+    int64_t x = *(const int64_t*)a, y = *(const int64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void print_latencies(const char* label, int64_t* ns, int n) {
+    qsort(ns, (size_t)n, sizeof(int64_t), compare_i64);
+    double sum = 0;
+    for (int i = 0; i < n; i++) sum += (double)ns[i];
+    printf("  %-36s mean %7.1f us  p50 %7.1f us  p99 %7.1f us  max %8.1f us\n", label,
+           sum / n / 1e3, ns[n / 2] / 1e3, ns[n * 99 / 100] / 1e3, ns[n - 1] / 1e3);
+}
+
+static cron_job_t* make_jobs(int n, const char* command) {
+    cron_job_t* jobs = calloc((size_t)n, sizeof(cron_job_t));
+    for (int i = 0; jobs && i < n; i++) {
+        jobs[i].command = (char*)command;
+    }
+    return jobs;
+}
+
+// Give synthetic jobs slots in job_table holding their patterns
+static int place_jobs(cron_job_t* jobs, int n, const char* const* schedules, int count) {
+    if (jcron_table_init(&job_table, (uint32_t)n, 0) != JCRON_OK) return -1;
+    for (int i = 0; i < n; i++) {
+        jcron_pattern_t pattern;
+        if (jcron_parse(schedules[i % count], &pattern) != JCRON_OK ||
+            jcron_table_insert(&job_table, &pattern, jobs[i].key, &jobs[i], &jobs[i].slot) != JCRON_OK) {
+            jcron_table_free(&job_table);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Reap until every launched run has exited (SIGCHLD is blocked by main)
+static void reap_all(void) {
+    sigset_t chld;
+    sigemptyset(&chld);
+    sigaddset(&chld, SIGCHLD);
+
+    struct timespec timeout = {0, 10 * 1000000};
+    while (exec_running() > 0) {
+        sigtimedwait(&chld, NULL, &timeout);
+        exec_complete();
+        exec_reap();
+        job_dispatch();
+        exec_enforce_timeouts();
+    }
+}
+
+// The pre-epoll jcrond: fork, exec and wait for each job in turn
+static pid_t launch_blocking(const cron_job_t* job) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl("/bin/sh", "sh", "-c", job->command, (char*)NULL);
+        _exit(127);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    return pid;
+}
+
+/* ========================================================================
+ * Launch Benchmarks
+ * ======================================================================== */
+
+/**
+ * 1000 jobs due in the same second: time between successive launches
+ */
+static void benchmark_simultaneous_launch(void) {
+    printf("\n=== Launch: 1000 simultaneous jobs (sh -c true) ===\n");
+
+    enum { N = 1000 };
+    cron_job_t* jobs = make_jobs(N, "true");
+    int64_t* gaps = malloc(N * sizeof(int64_t));
+    if (!jobs || !gaps) return;
+
+    // Non-blocking: vfork + exec, reaped afterwards
+    int64_t start = monotonic_ns(), prev = start;
+    for (int i = 0; i < N; i++) {
+        exec_launch(&jobs[i], 0);
+        int64_t t = monotonic_ns();
+        gaps[i] = t - prev;
+        prev = t;
+    }
+    int64_t launched = monotonic_ns();
+    reap_all();
+    int64_t done = monotonic_ns();
+
+    print_latencies("vfork, launch-to-launch", gaps, N);
+    printf("  %-36s %7.1f ms to launch all, %7.1f ms until all reaped\n", "",
+           (launched - start) / 1e6, (done - start) / 1e6);
+
+    // Blocking: what jcrond did before (fork + waitpid per job)
+    start = prev = monotonic_ns();
+    for (int i = 0; i < N; i++) {
+        launch_blocking(&jobs[i]);
+        int64_t t = monotonic_ns();
+        gaps[i] = t - prev;
+        prev = t;
+    }
+    done = monotonic_ns();
+
+    print_latencies("fork+waitpid, launch-to-launch", gaps, N);
+    printf("  %-36s %7.1f ms for all\n", "", (done - start) / 1e6);
+
+    free(gaps);
+    free(jobs);
+}
+
+/**
+ * One slow job ahead of 99 quick ones: when does the last one start?
+ */
+static void benchmark_head_of_line(void) {
+    printf("\n=== Launch: 1 slow job (sleep 1) ahead of 99 quick ones ===\n");
+
+    enum { N = 100 };
+    cron_job_t* jobs = make_jobs(N, "true");
+    if (!jobs) return;
+    jobs[0].command = "sleep 1";
+
+    int64_t start = monotonic_ns();
+    for (int i = 0; i < N; i++) exec_launch(&jobs[i], 0);
+    int64_t last_async = monotonic_ns() - start;
+    reap_all();
+
+    start = monotonic_ns();
+    for (int i = 0; i < N; i++) launch_blocking(&jobs[i]);
+    int64_t last_blocking = monotonic_ns() - start;
+
+    printf("  %-36s %9.1f ms\n", "vfork, 100th job started after", last_async / 1e6);
+    printf("  %-36s %9.1f ms\n", "fork+waitpid, 100th job done after", last_blocking / 1e6);
+
+    free(jobs);
+}
+
+/* ========================================================================
+ * Direct Exec Benchmarks
+ * ======================================================================== */
+
+// Syscalls of one launch, counted with ptrace: the daemon side
+// (exec_launch() until reaped) and every process of the run
+typedef struct {
+    long daemon;
+    long job;
+    long execs;
+} launch_syscalls_t;
+
+static int count_launch_syscalls(cron_job_t* job, launch_syscalls_t* counts) {
+    memset(counts, 0, sizeof(*counts));
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (ptrace(PTRACE_TRACEME, 0, NULL, NULL) != 0) _exit(1);
+        raise(SIGSTOP);
+        exec_launch(job, 0);
+        reap_all();
+        _exit(0);
+    }
+    int status;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFSTOPPED(status)) {
+        if (pid > 0) waitpid(pid, NULL, 0);
+        return -1;
+    }
+    ptrace(PTRACE_SETOPTIONS, pid, NULL,
+           (void*)(long)(PTRACE_O_TRACESYSGOOD | PTRACE_O_TRACEFORK | PTRACE_O_TRACEVFORK |
+                         PTRACE_O_TRACECLONE | PTRACE_O_EXITKILL));
+    ptrace(PTRACE_SYSCALL, pid, NULL, NULL);
+
+    pid_t traced;
+    while ((traced = waitpid(-1, &status, __WALL)) > 0) {
+        if (!WIFSTOPPED(status)) continue;
+        int sig = WSTOPSIG(status);
+        if (sig == (SIGTRAP | 0x80)) {
+            struct __ptrace_syscall_info info;
+            if (ptrace(PTRACE_GET_SYSCALL_INFO, traced, (void*)sizeof(info), &info) > 0 &&
+                info.op == PTRACE_SYSCALL_INFO_ENTRY) {
+                if (traced == pid) counts->daemon++;
+                else counts->job++;
+                if (info.entry.nr == SYS_execve) counts->execs++;
+            }
+            sig = 0;
+        } else if (sig == SIGSTOP || sig == SIGTRAP) {
+            sig = 0;  // New tracees start stopped; events stop with SIGTRAP
+        }
+        ptrace(PTRACE_SYSCALL, traced, NULL, (void*)(long)sig);
+    }
+    return counts->daemon > 0 ? 0 : -1;
+}
+
+/**
+ * Simple commands exec'd directly against the same through /bin/sh -c:
+ * launch-to-exit time of /bin/true (one at a time) and syscalls per fire
+ */
+static void benchmark_direct_exec(void) {
+    printf("\n=== Launch: /bin/true direct against sh -c (1000 fires each) ===\n");
+
+    enum { N = 1000 };
+    int64_t* ns = malloc(N * sizeof(int64_t));
+    cron_job_t* job = make_jobs(1, "/bin/true -q");
+    if (!ns || !job) {
+        free(ns);
+        free(job);
+        return;
+    }
+    static char* words[] = {"/bin/true", "-q", NULL};
+    static char* bare_words[] = {"true", "-q", NULL};
+    static const struct {
+        const char* label;
+        char** argv;
+    } modes[] = {
+        {"sh -c", NULL},
+        {"direct", words},
+        {"direct, PATH search", bare_words},
+    };
+
+    for (int m = 0; m < 3; m++) {
+        job->argv = modes[m].argv;
+        for (int i = 0; i < N; i++) {
+            int64_t start = monotonic_ns();
+            exec_launch(job, 0);
+            reap_all();
+            ns[i] = monotonic_ns() - start;
+        }
+        char label[64];
+        snprintf(label, sizeof(label), "%s, launch to exit", modes[m].label);
+        print_latencies(label, ns, N);
+    }
+
+    for (int m = 0; m < 3; m++) {
+        job->argv = modes[m].argv;
+        launch_syscalls_t counts;
+        if (count_launch_syscalls(job, &counts) != 0) {
+            printf("  syscalls: ptrace unavailable\n");
+            break;
+        }
+        printf("  %-36s syscalls per fire: daemon %3ld, job %4ld (%ld execve)\n", modes[m].label,
+               counts.daemon, counts.job, counts.execs);
+    }
+
+    free(job);
+    free(ns);
+}
+
+/**
+ * 1000 jobs across 50 users: time from exec_launch() to the child's exec
+ * (vfork returns then) with the users looked up on every fire, as before
+ * the credential cache, and from the cache
+ */
+static void benchmark_credentials(void) {
+    enum { N = 1000, USERS = 50 };
+    char* names[USERS];
+    int user_count = 0;
+    struct passwd* pwd;
+    setpwent();
+    while (user_count < USERS && (pwd = getpwent())) {
+        if ((names[user_count] = strdup(pwd->pw_name))) user_count++;
+    }
+    endpwent();
+    printf("\n=== Launch: %d jobs across %d users, exec_launch() to exec ===\n", N, user_count);
+
+    static char* words[] = {"/bin/true", "-q", NULL};
+    int64_t* ns = malloc(N * sizeof(int64_t));
+    cron_job_t* jobs = make_jobs(N, "/bin/true -q");
+    if (!ns || !jobs || user_count == 0) {
+        for (int i = 0; i < user_count; i++) free(names[i]);
+        free(jobs);
+        free(ns);
+        return;
+    }
+    for (int i = 0; i < N; i++) {
+        jobs[i].argv = words;
+        jobs[i].user = names[i % user_count];
+        jobs[i].creds = creds_user(jobs[i].user);
+    }
+
+    for (int cached = 0; cached < 2; cached++) {
+        for (int i = 0; i < N; i++) {
+            if (!cached) creds_invalidate();
+            int64_t start = monotonic_ns();
+            exec_launch(&jobs[i], 0);
+            ns[i] = monotonic_ns() - start;
+        }
+        reap_all();
+        print_latencies(cached ? "cached credentials" : "getpwnam + getgrouplist per fire",
+                        ns, N);
+    }
+
+    for (int cached = 0; cached < 2; cached++) {
+        if (cached) {
+            creds_check();  // Not due again during the count
+            creds_release(creds_get(jobs[1].creds));
+        } else {
+            creds_invalidate();
+        }
+        launch_syscalls_t counts;
+        if (count_launch_syscalls(&jobs[1], &counts) != 0) {
+            printf("  syscalls: ptrace unavailable\n");
+            break;
+        }
+        printf("  %-36s syscalls per fire: daemon %3ld, job %4ld\n",
+               cached ? "cached credentials" : "lookup per fire", counts.daemon, counts.job);
+    }
+
+    for (int i = 0; i < user_count; i++) free(names[i]);
+    free(jobs);
+    free(ns);
+}
+
+/* ========================================================================
+ * Admission Control Benchmarks
+ * ======================================================================== */
+
+/**
+ * 1000 simultaneous jobs through job_submit() with a global limit
+ */
+static void benchmark_admission(int max_running) {
+    enum { N = 1000 };
+    cron_job_t* jobs = make_jobs(N, "true");
+    if (!jobs) return;
+
+    memset(&counters, 0, sizeof(counters));
+    limits.max_running = max_running;
+
+    int64_t start = monotonic_ns();
+    for (int i = 0; i < N; i++) {
+        jobs[i].options.priority = i % 4;
+        job_submit(&jobs[i], 0);
+    }
+    int64_t submitted = monotonic_ns();
+    reap_all();
+    int64_t done = monotonic_ns();
+
+    printf("  -j %-4d submit %6.1f ms, all done %7.1f ms, peak queue %4u, "
+           "mean wait %6.1f ms, max wait %5llu ms\n",
+           max_running, (submitted - start) / 1e6, (done - start) / 1e6,
+           counters.queue_depth_max,
+           counters.queued ? (double)counters.queue_wait_ms / counters.queued : 0.0,
+           (unsigned long long)counters.queue_wait_max_ms);
+
+    free(jobs);
+}
+
+/**
+ * Timeout enforcement: a 1 s limit on "sleep 30"
+ */
+static void benchmark_timeout(void) {
+    cron_job_t* job = make_jobs(1, "sleep 30");
+    if (!job) return;
+    job->options.timeout_sec = 1;
+
+    memset(&counters, 0, sizeof(counters));
+    int64_t start = monotonic_ns();
+    job_submit(job, 0);
+    reap_all();
+
+    printf("  timeout 1 s on sleep 30: reaped after %.1f ms (%llu timeout)\n",
+           (monotonic_ns() - start) / 1e6, (unsigned long long)counters.timeouts);
+    free(job);
+}
+
+// Pump launches and exits for `ms` milliseconds
+static void pump_runs(int ms) {
+    sigset_t chld;
+    sigemptyset(&chld);
+    sigaddset(&chld, SIGCHLD);
+
+    struct timespec timeout = {0, 10 * 1000000};
+    for (int64_t end = monotonic_ns() + (int64_t)ms * 1000000; monotonic_ns() < end; ) {
+        sigtimedwait(&chld, NULL, &timeout);
+        exec_complete();
+        exec_reap();
+        job_dispatch();
+        exec_enforce_timeouts();
+    }
+}
+
+static int count_lines(const char* path) {
+    FILE* f = fopen(path, "r");
+    int lines = 0;
+    for (int c; f && (c = fgetc(f)) != EOF; ) lines += c == '\n';
+    if (f) fclose(f);
+    return lines;
+}
+
+/**
+ * OVERLAP_KILL: a run superseded by the next fire gets SIGTERM (its trap
+ * writes a line) and exits well within the SIGKILL grace period
+ */
+static void benchmark_overlap_kill(void) {
+    char marker[] = "/tmp/jcrond-bench-term-XXXXXX";
+    int fd = mkstemp(marker);
+    if (fd < 0) return;
+    close(fd);
+    char command[256];
+    snprintf(command, sizeof(command),
+             "trap 'echo term >> %s; exit 0' TERM; sleep 30 & wait", marker);
+    cron_job_t* job = make_jobs(1, command);
+    if (!job) return;
+    job->options.overlap = OVERLAP_KILL;
+
+    memset(&counters, 0, sizeof(counters));
+    job_submit(job, 0);
+    pump_runs(200);  // Launched, trap installed
+
+    int64_t start = monotonic_ns();
+    job_submit(job, 60);
+    while (exec_running() > 1 && monotonic_ns() - start < 10000000000LL) pump_runs(1);
+    double superseded_ms = (monotonic_ns() - start) / 1e6;
+    int terms = count_lines(marker);
+
+    exec_terminate_job(job);
+    reap_all();
+    printf("  overlap kill: old run got SIGTERM %s, exited after %.1f ms "
+           "(%llu killed, %d of 2 runs trapped SIGTERM)\n", terms == 1 ? "yes" : "NO",
+           superseded_ms, (unsigned long long)counters.overlap_killed, count_lines(marker));
+    unlink(marker);
+    free(job);
+}
+
+/* ========================================================================
+ * Reload Benchmarks
+ * ======================================================================== */
+
+// Replace a cron.d file the way editors do: write a temp file, rename it
+static void write_crontab(const char* dir, int file_no, int version) {
+    char tmp[512], path[512];
+    snprintf(tmp, sizeof(tmp), "%s/.tmp", dir);
+    snprintf(path, sizeof(path), "%s/job-%05d", dir, file_no);
+
+    FILE* f = fopen(tmp, "w");
+    if (!f) return;
+    fprintf(f, "JCRON_OVERLAP=skip\n");
+    for (int line = 0; line < 5; line++) {
+        fprintf(f, "%d * * * * root /bin/true %d.%d v%d\n", (file_no + line) % 60,
+                file_no, line, line == 0 ? version : 0);
+    }
+    fclose(f);
+    rename(tmp, path);
+}
+
+/**
+ * 10k cron.d files (50k jobs): reload cost against the number changed
+ */
+static void benchmark_reload(void) {
+    printf("\n=== Reload: 10000 cron.d files x 5 jobs ===\n");
+
+    enum { FILES = 10000 };
+    char root[] = "/tmp/jcrond-bench-XXXXXX";
+    if (!mkdtemp(root)) return;
+
+    char crontab[512], cron_d[512], spool[512];
+    snprintf(crontab, sizeof(crontab), "%s/crontab", root);
+    snprintf(cron_d, sizeof(cron_d), "%s/cron.d", root);
+    snprintf(spool, sizeof(spool), "%s/spool", root);
+    mkdir(cron_d, 0755);
+    crontab_paths = (jcrond_paths_t){crontab, cron_d, spool};
+
+    for (int i = 0; i < FILES; i++) write_crontab(cron_d, i, 0);
+
+    crontab_init(JCRON_SCHED_HEAP);
+    int64_t start = monotonic_ns();
+    crontab_load_all(0);
+    printf("  initial load: %d jobs in %.1f ms\n", crontab_job_count(),
+           (monotonic_ns() - start) / 1e6);
+
+    // State that an incremental reload must keep (slot 0 stays the same job)
+    crontab_job(0)->last_run = 42;
+
+    int version = 1;
+    int has_watch = crontab_watch() >= 0;
+    const int changed[] = {1, 10, 100, 1000};
+    for (int c = 0; c < 4; c++) {
+        int k = changed[c];
+
+        // Spread changes over the tree, skipping the probe's file
+        for (int i = 0; i < k; i++) write_crontab(cron_d, 1 + i * (FILES / k - 1), version);
+        version++;
+        start = monotonic_ns();
+        int inotify_files = has_watch ? crontab_watch_handle() : 0;
+        int64_t inotify_ns = monotonic_ns() - start;
+
+        for (int i = 0; i < k; i++) write_crontab(cron_d, 1 + i * (FILES / k - 1), version);
+        version++;
+        start = monotonic_ns();
+        int rescan_files = crontab_load_all(0);
+        int64_t rescan_ns = monotonic_ns() - start;
+        if (has_watch) crontab_watch_handle();  // Drain the rescan's events
+
+        start = monotonic_ns();
+        crontab_load_all(1);
+        int64_t full_ns = monotonic_ns() - start;
+
+        printf("  %4d changed: inotify %8.2f ms (%4d files), stat rescan %7.1f ms (%4d files), "
+               "re-read all %7.1f ms\n", k, inotify_ns / 1e6, inotify_files,
+               rescan_ns / 1e6, rescan_files, full_ns / 1e6);
+    }
+    printf("  jobs %d, unchanged job state kept: %s\n", crontab_job_count(),
+           crontab_job(0) && crontab_job(0)->last_run == 42 ? "yes" : "NO");
+
+    crontab_free();
+    char command[600];
+    snprintf(command, sizeof(command), "rm -rf %s", root);
+    if (system(command) != 0) fprintf(stderr, "Cannot remove %s\n", root);
+}
+
+// Resident set size in KiB
+static long rss_kib(void) {
+    long pages = 0, resident = 0;
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (f) {
+        if (fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+        fclose(f);
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+/**
+ * One 100k-line crontab: load time and RSS growth (in a fresh child, so
+ * earlier benchmarks' heap does not hide it), unchanged re-read, free
+ */
+static void benchmark_load(void) {
+    enum { N = 100000 };
+    printf("\n=== Crontab load: one file of %d lines ===\n", N);
+
+    char root[] = "/tmp/jcrond-bench-XXXXXX";
+    if (!mkdtemp(root)) return;
+    char crontab[512], cron_d[512], spool[512];
+    snprintf(crontab, sizeof(crontab), "%s/crontab", root);
+    snprintf(cron_d, sizeof(cron_d), "%s/cron.d", root);
+    snprintf(spool, sizeof(spool), "%s/spool", root);
+    crontab_paths = (jcrond_paths_t){crontab, cron_d, spool};
+
+    FILE* f = fopen(crontab, "w");
+    if (!f) return;
+    for (int i = 0; i < N; i++) {
+        fprintf(f, "%d %d * * %d root /usr/local/bin/report --id %d --out /var/tmp/r%d.csv\n",
+                i % 60, i % 24, i % 7, i, i);
+    }
+    fclose(f);
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        crontab_init(JCRON_SCHED_HEAP);
+        long before = rss_kib();
+        int64_t start = monotonic_ns();
+        crontab_load_all(0);
+        int64_t loaded = monotonic_ns();
+        long grown = rss_kib() - before;
+        crontab_load_all(1);
+        int64_t reloaded = monotonic_ns();
+        int jobs = crontab_job_count();
+        crontab_free();
+        printf("  load %6.1f ms (%d jobs), RSS +%ld KiB (%ld B/job), "
+               "re-read unchanged %6.1f ms, free %5.1f ms\n", (loaded - start) / 1e6, jobs,
+               grown, grown * 1024 / (jobs ? jobs : 1), (reloaded - loaded) / 1e6,
+               (monotonic_ns() - reloaded) / 1e6);
+        fflush(stdout);
+        _exit(0);
+    }
+    waitpid(pid, NULL, 0);
+
+    char command[600];
+    snprintf(command, sizeof(command), "rm -rf %s", root);
+    if (system(command) != 0) fprintf(stderr, "Cannot remove %s\n", root);
+}
+
+/* ========================================================================
+ * Load Spreading Benchmarks
+ * ======================================================================== */
+
+/**
+ * One crontab of 100k jobs sharing `schedule`, loaded with a -W window:
+ * fires per minute and per second over the next hour
+ */
+static void benchmark_spread(const char* schedule, int window) {
+    enum { N = 100000, HOUR = 3600 };
+    char root[] = "/tmp/jcrond-bench-XXXXXX";
+    if (!mkdtemp(root)) return;
+
+    char crontab[512], cron_d[512], spool[512];
+    snprintf(crontab, sizeof(crontab), "%s/crontab", root);
+    snprintf(cron_d, sizeof(cron_d), "%s/cron.d", root);
+    snprintf(spool, sizeof(spool), "%s/spool", root);
+    mkdir(cron_d, 0755);
+    crontab_paths = (jcrond_paths_t){crontab, cron_d, spool};
+
+    FILE* f = fopen(crontab, "w");
+    if (!f) return;
+    for (int i = 0; i < N; i++) fprintf(f, "%s root /usr/bin/job %d\n", schedule, i);
+    fclose(f);
+
+    spread_window = window;
+    crontab_init(JCRON_SCHED_HEAP);
+    int64_t start = monotonic_ns();
+    crontab_load_all(0);
+    int64_t load_ns = monotonic_ns() - start;
+
+    // Every fire in the hour from the first scheduled minute
+    static int per_second[HOUR];
+    int per_minute[HOUR / 60] = {0};
+    memset(per_second, 0, sizeof(per_second));
+    int64_t from = (now_ms() / 60000 + 1) * 60;
+    int64_t when;
+    for (int slot; (slot = jcron_sched_pop(&job_sched, from + HOUR - 1, &when)) >= 0; ) {
+        cron_job_t* job = crontab_job((uint32_t)slot);
+        per_second[when - from]++;
+        per_minute[(when - from) / 60]++;
+        sched_set_next(&job_sched, (uint32_t)slot, &job_table.patterns[slot], job->spread,
+                       when + 60);
+    }
+
+    int peak = 0, low = N, peak_second = 0, fires = 0;
+    for (int m = 0; m < HOUR / 60; m++) {
+        if (per_minute[m] > peak) peak = per_minute[m];
+        if (per_minute[m] < low) low = per_minute[m];
+        fires += per_minute[m];
+    }
+    for (int i = 0; i < HOUR; i++) {
+        if (per_second[i] > peak_second) peak_second = per_second[i];
+    }
+    printf("  %-13s -W %2d: load %4.0f ms, %6d fires/h, per minute peak %6d min %6d "
+           "(peak/mean %5.2f), busiest second %6d\n", schedule, window, load_ns / 1e6, fires,
+           peak, low, peak / (fires / 60.0), peak_second);
+
+    crontab_free();
+    spread_window = 0;
+    char command[600];
+    snprintf(command, sizeof(command), "rm -rf %s", root);
+    if (system(command) != 0) fprintf(stderr, "Cannot remove %s\n", root);
+}
+
+/* ========================================================================
+ * Catch-up Benchmarks
+ * ======================================================================== */
+
+/**
+ * 10k jobs back from a week of downtime: cost of deciding what to replay
+ */
+static void benchmark_catchup(void) {
+    printf("\n=== Catch-up: 10000 jobs after 7 days down ===\n");
+
+    enum { N = 10000 };
+    static const char* schedules[] = {
+        "0 * * * * *", "0 */15 * * * *", "0 0 * * * *", "0 30 2 * * *", "0 0 4 * * 1", "0 0 0 1 * *"
+    };
+    cron_job_t* jobs = make_jobs(N, "true");
+    if (!jobs) return;
+    for (int i = 0; i < N; i++) jobs[i].schedule = (char*)schedules[i % 6];
+    if (place_jobs(jobs, N, schedules, 6) != 0) {
+        free(jobs);
+        return;
+    }
+
+    int64_t until = now_ms() / 60000 * 60;
+    int64_t first = until - 7 * 86400;
+    static const struct { catchup_policy_t policy; int max; const char* label; } policies[] = {
+        {CATCHUP_SKIP, 0, "skip"}, {CATCHUP_ONCE, 0, "once"},
+        {CATCHUP_ALL, 10, "all:10"}, {CATCHUP_ALL, 1000, "all:1000"}
+    };
+
+    for (int p = 0; p < 4; p++) {
+        memset(&counters, 0, sizeof(counters));
+        int64_t elapsed = 0;
+        for (int i = 0; i < N; i++) {
+            jobs[i].options.catchup = policies[p].policy;
+            jobs[i].options.catchup_max = policies[p].max;
+            int64_t start = monotonic_ns();
+            catchup_missed(&jobs[i], first, until);
+            elapsed += monotonic_ns() - start;
+            catchup_forget(&jobs[i]);  // Keep the queue from growing across rounds
+        }
+        printf("  %-8s %7.1f ms (%5.2f us/job), missed %8llu, queued %7llu\n",
+               policies[p].label, elapsed / 1e6, elapsed / 1e3 / N,
+               (unsigned long long)counters.catchup_missed,
+               (unsigned long long)counters.catchup_queued);
+    }
+
+    jcron_table_free(&job_table);
+    free(jobs);
+}
+
+/* ========================================================================
+ * Run State Benchmarks
+ * ======================================================================== */
+
+/**
+ * 100k jobs firing once a minute: group commit cost on the fire path,
+ * against an fdatasync() per fire, and recovery after a crash
+ */
+static void benchmark_state(void) {
+    printf("\n=== Run state: 100000 jobs firing per minute ===\n");
+
+    enum { N = 100000, SECONDS = 60, NAIVE = 1000 };
+    char root[] = "/tmp/jcrond-state-XXXXXX";
+    if (!mkdtemp(root)) return;
+    char path[512];
+    snprintf(path, sizeof(path), "%s/state", root);
+    state_path = path;
+
+    cron_job_t* jobs = make_jobs(N, "true");
+    if (!jobs) return;
+    for (int i = 0; i < N; i++) jobs[i].key = 0x9E3779B97F4A7C15ull * (uint64_t)(i + 1);
+
+    memset(&counters, 0, sizeof(counters));
+    state_load();
+
+    // Spread over a minute: one loop iteration (and commit) per second
+    int64_t record_ns = 0, commit_ns = 0, commit_max = 0;
+    for (int second = 0; second < SECONDS; second++) {
+        int64_t start = monotonic_ns();
+        for (int i = second; i < N; i += SECONDS) {
+            jobs[i].last_run = 1700000000 + second;
+            state_record_fire(&jobs[i]);
+        }
+        int64_t recorded = monotonic_ns();
+        state_commit();
+        int64_t committed = monotonic_ns();
+        record_ns += recorded - start;
+        commit_ns += committed - recorded;
+        if (committed - recorded > commit_max) commit_max = committed - recorded;
+    }
+    printf("  spread, 1 commit/s: record %5.0f ns/fire, commit mean %6.2f ms max %6.2f ms, "
+           "%llu fsyncs/min\n", (double)record_ns / N, commit_ns / 1e6 / SECONDS,
+           commit_max / 1e6, (unsigned long long)counters.state_syncs);
+
+    // All due in the same second: one group
+    int64_t start = monotonic_ns();
+    for (int i = 0; i < N; i++) {
+        jobs[i].last_run = 1700000060;
+        state_record_fire(&jobs[i]);
+    }
+    int64_t recorded = monotonic_ns();
+    state_commit();
+    int64_t committed = monotonic_ns();
+    printf("  burst, 1 commit:    record %5.0f ns/fire, commit %6.2f ms for %d fires\n",
+           (double)(recorded - start) / N, (committed - recorded) / 1e6, N);
+
+    // Exits ride along without a sync of their own
+    start = monotonic_ns();
+    for (int i = 0; i < N; i++) {
+        jobs[i].last_status = 0;
+        jobs[i].last_duration_ms = i % 1000;
+        state_record_exit(&jobs[i]);
+    }
+    state_commit();
+    printf("  exits, no sync:     %5.0f ns/exit including the write\n",
+           (double)(monotonic_ns() - start) / N);
+
+    // Without group commit: one journal write + fdatasync per fire
+    char naive_path[512];
+    snprintf(naive_path, sizeof(naive_path), "%s/naive", root);
+    int fd = open(naive_path, O_WRONLY | O_CREAT | O_APPEND, 0600);
+    start = monotonic_ns();
+    for (int i = 0; fd >= 0 && i < NAIVE; i++) {
+        char entry[32] = {0};
+        if (write(fd, entry, sizeof(entry)) != (ssize_t)sizeof(entry)) break;
+        fdatasync(fd);
+    }
+    int64_t naive_ns = monotonic_ns() - start;
+    if (fd >= 0) close(fd);
+    printf("  fsync per fire:     %6.1f us/fire, %5.0f fsyncs/s max -> %.1f s for %d fires\n",
+           naive_ns / 1e3 / NAIVE, NAIVE * 1e9 / naive_ns, (double)naive_ns / NAIVE * N / 1e9, N);
+
+    uint64_t checkpoints = counters.state_checkpoints;
+    state_close();
+
+    // Crash after the last commit: recovery maps the snapshot and replays
+    // the journal
+    pid_t pid = fork();
+    if (pid == 0) {
+        state_load();
+        for (int i = 0; i < N; i++) {
+            jobs[i].last_run = 1700000120;
+            state_record_fire(&jobs[i]);
+        }
+        state_commit();
+        _exit(0);
+    }
+    waitpid(pid, NULL, 0);
+
+    start = monotonic_ns();
+    state_load();
+    int64_t load_ns = monotonic_ns() - start;
+    state_close();
+    printf("  recovery:           %6.1f ms to map %d records and replay the journal "
+           "(%llu checkpoints while running)\n", load_ns / 1e6, N,
+           (unsigned long long)checkpoints);
+
+    free(jobs);
+    state_path = NULL;
+    char command[600];
+    snprintf(command, sizeof(command), "rm -rf %s", root);
+    if (system(command) != 0) fprintf(stderr, "Cannot remove %s\n", root);
+}
+
+/* ========================================================================
+ * Thread Scaling Benchmarks
+ * ======================================================================== */
+
+/**
+ * 200k jobs due in the same second: schedule on T shard threads (0 = in
+ * job_sched on the main thread), collect every fire on the main thread
+ */
+static void benchmark_shards(int threads) {
+    enum { N = 200000 };
+    cron_job_t* jobs = make_jobs(N, "true");
+    if (!jobs) return;
+    static const char* every_minute[] = {"0 * * * * *"};
+    for (int i = 0; i < N; i++) jobs[i].key = (uint64_t)i + 1;
+    if (place_jobs(jobs, N, every_minute, 1) != 0) {
+        free(jobs);
+        return;
+    }
+
+    if (threads == 0) jcron_sched_init(&job_sched, N);
+    if (shards_start(threads, JCRON_SCHED_HEAP) != 0) {
+        jcron_table_free(&job_table);
+        free(jobs);
+        return;
+    }
+    int64_t current_minute = now_ms() / 60000 * 60;
+    int64_t start = monotonic_ns();
+    for (int i = 0; i < N; i++) shard_schedule(&jobs[i], current_minute);
+    int64_t sent = monotonic_ns();
+
+    int received = 0;
+    struct pollfd pfd = {shard_fire_fd(), POLLIN, 0};
+    shard_fire_t fire;
+    int64_t when;
+    while (threads == 0 && received < N) {
+        int slot = jcron_sched_pop(&job_sched, now_ms() / 1000, &when);
+        if (slot < 0) break;
+        jcron_sched_set_next(&job_sched, (uint32_t)slot, &job_table.patterns[slot], when + 60);
+        received++;
+    }
+    while (received < N) {
+        if (shard_pop_fire(&fire) == 0) {
+            received++;
+        } else if (poll(&pfd, 1, 1) > 0) {
+            uint64_t count;
+            ssize_t ignored = read(pfd.fd, &count, sizeof(count));
+            (void)ignored;
+        }
+    }
+    int64_t done = monotonic_ns();
+    shards_stop();
+    if (threads == 0) jcron_sched_free(&job_sched);
+
+    printf("  %2d shard threads: %6.1f ms (%5.1f ms sending), %6.2f M fires/s\n", threads,
+           (done - start) / 1e6, (sent - start) / 1e6, N / ((done - start) / 1e9) / 1e6);
+    jcron_table_free(&job_table);
+    free(jobs);
+}
+
+/**
+ * 1000 launches of "true" on T launch threads (0 = on the main thread)
+ */
+static void benchmark_launch_pool(int threads) {
+    enum { N = 1000 };
+    cron_job_t* jobs = make_jobs(N, "true");
+    if (!jobs) return;
+    if (threads > 0 && exec_pool_start(threads) != 0) {
+        free(jobs);
+        return;
+    }
+
+    memset(&counters, 0, sizeof(counters));
+    int64_t start = monotonic_ns();
+    for (int i = 0; i < N; i++) exec_launch(&jobs[i], 0);
+    int64_t queued = monotonic_ns();
+    while (counters.launched + counters.launch_failed < N) {
+        struct pollfd pfd = {exec_complete_fd(), POLLIN, 0};
+        if (poll(&pfd, 1, 1) > 0) {
+            uint64_t count;
+            ssize_t ignored = read(pfd.fd, &count, sizeof(count));
+            (void)ignored;
+        }
+        exec_complete();
+    }
+    int64_t launched = monotonic_ns();
+    reap_all();
+    exec_pool_stop();
+
+    printf("  %2d launch threads: main thread busy %6.1f ms, all started %7.1f ms, "
+           "%6.0f launches/s\n", threads, (queued - start) / 1e6, (launched - start) / 1e6,
+           N / ((launched - start) / 1e9));
+    free(jobs);
+}
+
+/**
+ * Spawn latency against daemon size: fork() (what jcrond did before
+ * vfork), vfork() from the daemon, and the launch helper. `ballast_mb` of
+ * touched heap stands in for a large job table.
+ */
+static void benchmark_launch_helper(int ballast_mb) {
+    enum { N = 200 };
+    size_t ballast_size = (size_t)ballast_mb << 20;
+    char* ballast = ballast_size ? malloc(ballast_size) : NULL;
+    if (ballast) memset(ballast, 1, ballast_size);
+
+    long size_pages, rss_pages = 0;
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm) {
+        if (fscanf(statm, "%ld %ld", &size_pages, &rss_pages) != 2) rss_pages = 0;
+        fclose(statm);
+    }
+    printf("  Daemon RSS %ld MB:\n", rss_pages * sysconf(_SC_PAGESIZE) >> 20);
+
+    cron_job_t* jobs = make_jobs(N, "true");
+    int64_t* ns = malloc(N * sizeof(int64_t));
+    if (!jobs || !ns) goto done;
+
+    for (int i = 0; i < N; i++) {
+        int64_t start = monotonic_ns();
+        pid_t pid = fork();
+        if (pid == 0) {
+            execl("/bin/true", "true", (char*)NULL);
+            _exit(127);
+        }
+        ns[i] = monotonic_ns() - start;
+        waitpid(pid, NULL, 0);
+    }
+    print_latencies("fork()", ns, N);
+
+    for (int i = 0; i < N; i++) {
+        int64_t start = monotonic_ns();
+        exec_launch(&jobs[i], 0);
+        ns[i] = monotonic_ns() - start;
+        reap_all();
+    }
+    print_latencies("vfork() in the daemon", ns, N);
+
+    // Request to reported pid, as the main loop sees it. The helper is a
+    // fresh exec, so starting it now does not make it any bigger.
+    zygote_start();
+    for (int i = 0; i < N && zygote_running(); i++) {
+        uint64_t launched = counters.launched + counters.launch_failed;
+        int64_t start = monotonic_ns();
+        exec_launch(&jobs[i], 0);
+        while (counters.launched + counters.launch_failed == launched) {
+            struct pollfd pfd = {zygote_fd(), POLLIN, 0};
+            poll(&pfd, 1, 10);
+            exec_complete();
+        }
+        ns[i] = monotonic_ns() - start;
+        reap_all();
+    }
+    if (zygote_running()) print_latencies("launch helper", ns, N);
+    zygote_stop();
+
+done:
+    free(ns);
+    free(jobs);
+    free(ballast);
+}
+
+/* ========================================================================
+ * Output Capture Benchmarks
+ * ======================================================================== */
+
+static double cpu_seconds(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+static void print_capture(const char* label, uint64_t bytes, int64_t ns, double cpu) {
+    double mb = bytes / 1048576.0;
+    // Daemon CPU share for a job writing 100 MB per minute
+    double per_100mb = cpu / mb * 100;
+    printf("  %-34s %6.0f MB/s, daemon CPU %6.1f ms per 100 MB (%.2f%% at 100 MB/min)\n",
+           label, mb / (ns / 1e9), per_100mb * 1e3, per_100mb / 60 * 100);
+}
+
+/**
+ * Chatty jobs: `jobs` runs writing `mb` MB each through capture pipes into
+ * 1 MiB ring logs
+ */
+static void benchmark_output_splice(const char* root, int jobs, int mb) {
+    char command[64];
+    snprintf(command, sizeof(command), "head -c %dM /dev/zero", mb);
+    cron_job_t* list = make_jobs(jobs, command);
+    if (!list) return;
+    for (int i = 0; i < jobs; i++) list[i].key = (uint64_t)i + 1;
+
+    output_dir = root;
+    memset(&counters, 0, sizeof(counters));
+    double cpu = cpu_seconds();
+    int64_t start = monotonic_ns();
+    for (int i = 0; i < jobs; i++) exec_launch(&list[i], 0);
+    while (exec_running() > 0 || output_open_count() > 0) {
+        struct pollfd pfd = {output_fd(), POLLIN, 0};
+        poll(&pfd, 1, 10);
+        output_drain();
+        exec_reap();
+    }
+    int64_t ns = monotonic_ns() - start;
+    cpu = cpu_seconds() - cpu;
+    output_dir = NULL;
+
+    char label[64];
+    snprintf(label, sizeof(label), "splice(), %d job%s x %d MB", jobs, jobs > 1 ? "s" : "", mb);
+    print_capture(label, counters.output_bytes, ns, cpu);
+    free(list);
+}
+
+/**
+ * The same through a userspace buffer: read() from the pipe, pwrite() into
+ * the ring
+ */
+static void benchmark_output_copy(const char* root, int mb) {
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0) return;
+    char path[512];
+    snprintf(path, sizeof(path), "%s/copy.log", root);
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+
+    char command[64];
+    snprintf(command, sizeof(command), "head -c %dM /dev/zero", mb);
+    double cpu = cpu_seconds();
+    int64_t start = monotonic_ns();
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(pipe_fds[1], STDOUT_FILENO);
+        execl("/bin/sh", "sh", "-c", command, (char*)NULL);
+        _exit(127);
+    }
+    close(pipe_fds[1]);
+
+    static char buf[65536];
+    const uint64_t capacity = 1 << 20;
+    uint64_t written = 0;
+    ssize_t n;
+    while ((n = read(pipe_fds[0], buf, sizeof(buf))) > 0) {
+        for (ssize_t done = 0; done < n; ) {
+            uint64_t at = written % capacity;
+            size_t len = (size_t)(n - done);
+            if (len > capacity - at) len = (size_t)(capacity - at);
+            ssize_t put = pwrite(fd, buf + done, len, (off_t)(4096 + at));
+            if (put <= 0) break;
+            done += put;
+            written += (uint64_t)put;
+        }
+    }
+    waitpid(pid, NULL, 0);
+    int64_t ns = monotonic_ns() - start;
+    cpu = cpu_seconds() - cpu;
+    close(pipe_fds[0]);
+    close(fd);
+
+    char label[64];
+    snprintf(label, sizeof(label), "read()+pwrite(), 1 job x %d MB", mb);
+    print_capture(label, written, ns, cpu);
+}
+
+static void benchmark_output(void) {
+    printf("\n=== Output capture: chatty jobs into 1 MiB ring logs ===\n");
+    char root[] = "/tmp/jcrond-output-XXXXXX";
+    if (!mkdtemp(root)) return;
+
+    benchmark_output_copy(root, 100);
+    benchmark_output_splice(root, 1, 100);
+    benchmark_output_splice(root, 10, 10);
+
+    char command[512];
+    snprintf(command, sizeof(command), "rm -rf %s", root);
+    if (system(command) != 0) fprintf(stderr, "Cannot remove %s\n", root);
+}
+
+/* ========================================================================
+ * Metrics Benchmarks
+ * ======================================================================== */
+
+enum { METRIC_OPS = 5000000 };
+static uint64_t shared_counter;
+
+static void* record_shared(void* arg) {
+    (void)arg;
+    for (int i = 0; i < METRIC_OPS; i++) __atomic_fetch_add(&shared_counter, 1, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+static void* record_per_cpu(void* arg) {
+    (void)arg;
+    for (int i = 0; i < METRIC_OPS; i++) metric_add(METRIC_FIRES, 1);
+    return NULL;
+}
+
+static void* observe_per_cpu(void* arg) {
+    (void)arg;
+    for (int i = 0; i < METRIC_OPS; i++) metric_observe(HIST_SPAWN, i & 0xFFFF);
+    return NULL;
+}
+
+// ns per operation with `threads` threads recording at once
+static double time_recording(void* (*fn)(void*), int threads) {
+    pthread_t ids[16];
+    int64_t start = monotonic_ns();
+    for (int t = 0; t < threads; t++) pthread_create(&ids[t], NULL, fn, NULL);
+    for (int t = 0; t < threads; t++) pthread_join(ids[t], NULL);
+    return (double)(monotonic_ns() - start) / ((double)METRIC_OPS * threads);
+}
+
+static void benchmark_metrics(void) {
+    printf("\n=== Metrics: recording cost (%ld CPUs) ===\n", sysconf(_SC_NPROCESSORS_ONLN));
+    const int thread_counts[] = {1, 2, 4, 8};
+    for (int i = 0; i < 4; i++) {
+        int threads = thread_counts[i];
+        printf("  %d thread%s: shared atomic %5.1f ns, per-CPU counter %5.1f ns, "
+               "per-CPU histogram %5.1f ns\n", threads, threads > 1 ? "s" : " ",
+               time_recording(record_shared, threads), time_recording(record_per_cpu, threads),
+               time_recording(observe_per_cpu, threads));
+    }
+
+    enum { SCRAPES = 100 };
+    int64_t start = monotonic_ns();
+    size_t len = 0;
+    for (int i = 0; i < SCRAPES; i++) {
+        char* text = NULL;
+        metrics_render(&text, &len);
+        free(text);
+    }
+    printf("  Scrape: %zu bytes rendered in %.1f us\n", len,
+           (monotonic_ns() - start) / 1e3 / SCRAPES);
+}
+
+/* ========================================================================
+ * Logging Benchmarks
+ * ======================================================================== */
+
+// A syslogd stand-in: a datagram socket drained by a thread
+typedef struct {
+    int fd;
+    char path[108];
+    long received;
+    pthread_t thread;
+} log_sink_t;
+
+static void* log_sink_main(void* arg) {
+    log_sink_t* sink = arg;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = recv(sink->fd, buffer, sizeof(buffer), 0)) > 0) {
+        if (n == 1 && buffer[0] == 0) break;  // Stop marker
+        sink->received++;
+    }
+    return NULL;
+}
+
+static int log_sink_start(log_sink_t* sink, const char* root) {
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    snprintf(sink->path, sizeof(sink->path), "%s/log.sock", root);
+    memcpy(addr.sun_path, sink->path, sizeof(sink->path));
+    sink->received = 0;
+    sink->fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (sink->fd < 0 || bind(sink->fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        pthread_create(&sink->thread, NULL, log_sink_main, sink) != 0) {
+        if (sink->fd >= 0) close(sink->fd);
+        return -1;
+    }
+    return 0;
+}
+
+static void log_sink_stop(log_sink_t* sink) {
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, sink->path, sizeof(sink->path));
+    int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    sendto(fd, "", 1, 0, (struct sockaddr*)&addr, sizeof(addr));
+    close(fd);
+    pthread_join(sink->thread, NULL);
+    close(sink->fd);
+    unlink(sink->path);
+}
+
+// What vsyslog() does per call: format, then one send on the caller's thread
+static void log_sync(int fd, const char* command, int pid) {
+    char line[1024];
+    time_t now = time(NULL);
+    struct tm tm;
+    localtime_r(&now, &tm);
+    int len = snprintf(line, sizeof(line), "<%d>", LOG_CRON | LOG_INFO);
+    len += (int)strftime(line + len, sizeof(line) - (size_t)len, "%b %e %H:%M:%S ", &tm);
+    len += snprintf(line + len, sizeof(line) - (size_t)len,
+                    "jcrond[%d]: Started job: %s (pid %d, user %s, late %lld ms)",
+                    (int)getpid(), command, pid, "root", 3LL);
+    send(fd, line, (size_t)len, MSG_NOSIGNAL);
+}
+
+/**
+ * A burst of 10000 "Started job" messages from the main thread: time per
+ * call, synchronous send against the ring and its writer thread
+ */
+static void benchmark_logging(void) {
+    printf("\n=== Logging: burst of 10000 messages ===\n");
+
+    enum { N = 10000 };
+    const char* command = "/usr/local/bin/backup --incremental /srv/data";
+    char root[] = "/tmp/jcrond_log_XXXXXX";
+    int64_t* ns = malloc(N * sizeof(int64_t));
+    if (!ns || !mkdtemp(root)) {
+        free(ns);
+        return;
+    }
+    int mask = setlogmask(LOG_UPTO(LOG_INFO));
+    log_sink_t sink;
+
+    // Synchronous: every call waits for its datagram to be queued
+    if (log_sink_start(&sink, root) == 0) {
+        struct sockaddr_un addr = {0};
+        addr.sun_family = AF_UNIX;
+        memcpy(addr.sun_path, sink.path, sizeof(sink.path));
+        int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        connect(fd, (struct sockaddr*)&addr, sizeof(addr));
+        int64_t start = monotonic_ns();
+        for (int i = 0; i < N; i++) {
+            int64_t t = monotonic_ns();
+            log_sync(fd, command, i);
+            ns[i] = monotonic_ns() - t;
+        }
+        int64_t done = monotonic_ns();
+        close(fd);
+        print_latencies("send per message (as vsyslog)", ns, N);
+        printf("  %-36s %7.1f ms for all\n", "", (done - start) / 1e6);
+        log_sink_stop(&sink);
+    }
+
+    // Ring: the caller only formats and copies a record
+    for (int json = 0; json < 2; json++) {
+        char json_path[64];
+        snprintf(json_path, sizeof(json_path), "%s/log.json", root);
+        if (json) {
+            log_json_path = json_path;
+        } else {
+            if (log_sink_start(&sink, root) != 0) continue;
+            log_syslog_path = sink.path;
+        }
+        uint64_t dropped = metric_value(METRIC_LOG_DROPPED);
+        if (log_start() != 0) break;
+
+        int64_t start = monotonic_ns();
+        for (int i = 0; i < N; i++) {
+            int64_t t = monotonic_ns();
+            log_message(LOG_INFO, "Started job: %s (pid %d, user %s, late %lld ms)",
+                        command, i, "root", 3LL);
+            ns[i] = monotonic_ns() - t;
+        }
+        int64_t queued = monotonic_ns();
+        log_stop();
+        int64_t written = monotonic_ns();
+
+        print_latencies(json ? "ring, writer to JSON lines" : "ring, writer to syslog socket",
+                        ns, N);
+        printf("  %-36s %7.1f ms for all, written after %.1f ms, %llu dropped\n", "",
+               (queued - start) / 1e6, (written - start) / 1e6,
+               (unsigned long long)(metric_value(METRIC_LOG_DROPPED) - dropped));
+        if (json) {
+            unlink(json_path);
+            log_json_path = NULL;
+        } else {
+            log_sink_stop(&sink);
+            log_syslog_path = "/dev/log";
+        }
+    }
+
+    setlogmask(mask);
+    rmdir(root);
+    free(ns);
+}
+
+/* ========================================================================
+ * Main
+ * ======================================================================== */
+
+/* ========================================================================
+ * Simulation Benchmarks
+ * ======================================================================== */
+
+// FNV-1a over everything written to a FILE, which is otherwise discarded
+static ssize_t hash_write(void* cookie, const char* data, size_t size) {
+    uint64_t* hash = cookie;
+    for (size_t i = 0; i < size; i++) *hash = (*hash ^ (unsigned char)data[i]) * 1099511628211ull;
+    return (ssize_t)size;
+}
+
+static void time_simulation(const char* label, jcron_sched_backend_t backend, int64_t from,
+                            int64_t to, int summary, uint64_t* hash) {
+    *hash = 14695981039346656037ull;
+    FILE* out = fopencookie(hash, "w", (cookie_io_functions_t){NULL, hash_write, NULL, NULL});
+    if (!out) return;
+    setvbuf(out, NULL, _IOFBF, 1 << 16);
+    int64_t start = monotonic_ns();
+    int64_t fires = simulate_run(backend, from, to, summary, out);
+    fclose(out);
+    double seconds = (monotonic_ns() - start) / 1e9;
+    printf("  %-36s %5.2f s  %9lld fires  %6.1f M fires/s  output %016llx\n", label, seconds,
+           (long long)fires, fires / seconds / 1e6, (unsigned long long)*hash);
+}
+
+/**
+ * --simulate over a year of 100k jobs (90% weekly, 10% daily): wall time
+ * with and without per-fire output, and whether repeated runs agree
+ */
+static void benchmark_simulate(void) {
+    enum { N = 100000 };
+    printf("\n=== Simulation: %d jobs over one year ===\n", N);
+
+    char root[] = "/tmp/jcrond-bench-XXXXXX";
+    if (!mkdtemp(root)) return;
+    char crontab[512], cron_d[512], spool[512];
+    snprintf(crontab, sizeof(crontab), "%s/crontab", root);
+    snprintf(cron_d, sizeof(cron_d), "%s/cron.d", root);
+    snprintf(spool, sizeof(spool), "%s/spool", root);
+    crontab_paths = (jcrond_paths_t){crontab, cron_d, spool};
+
+    FILE* f = fopen(crontab, "w");
+    if (!f) return;
+    for (int i = 0; i < N; i++) {
+        if (i % 10 == 0) {
+            fprintf(f, "%d %d * * * root /usr/local/bin/rollup --id %d\n", i % 60, i % 24, i);
+        } else {
+            fprintf(f, "%d %d * * %d root /usr/local/bin/report --id %d\n", i % 60, i % 24,
+                    i % 7, i);
+        }
+    }
+    fclose(f);
+
+    int64_t from = simulate_parse_time("2027-01-01");
+    int64_t to = simulate_parse_time("2027-12-31T23:59");
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        uint64_t first, again, heap_summary, wheel_summary;
+        crontab_init(JCRON_SCHED_HEAP);
+        crontab_load_all(0);
+        time_simulation("heap, every fire printed", JCRON_SCHED_HEAP, from, to, 0, &first);
+        time_simulation("heap, every fire printed (again)", JCRON_SCHED_HEAP, from, to, 0,
+                        &again);
+        time_simulation("heap, --summary", JCRON_SCHED_HEAP, from, to, 1, &heap_summary);
+        time_simulation("wheel, --summary", JCRON_SCHED_WHEEL, from, to, 1, &wheel_summary);
+        printf("  repeated runs identical: %s, heap and wheel summaries identical: %s\n",
+               first == again ? "yes" : "no", heap_summary == wheel_summary ? "yes" : "no");
+        crontab_free();
+        fflush(stdout);
+        _exit(0);
+    }
+    waitpid(pid, NULL, 0);
+
+    char command[600];
+    snprintf(command, sizeof(command), "rm -rf %s", root);
+    if (system(command) != 0) fprintf(stderr, "Cannot remove %s\n", root);
+}
+
+/* ========================================================================
+ * Cluster Benchmarks
+ * ======================================================================== */
+
+// What a node process reports to the benchmark
+typedef struct {
+    int kind;                // 0: placed, 1: fired, 2: took shards over
+    int node;
+    int shards;              // Owned (placed), or taken (took)
+    int jobs;                // Jobs scheduled (placed), or moved (took)
+    int64_t fires;
+    int64_t ns;              // Check CPU time, or CLOCK_MONOTONIC at the takeover
+    double cpu;
+} node_report_t;
+
+static int owned_jobs(void) {
+    int count = 0;
+    for (uint32_t slot = 0; slot < job_table.high; slot++) {
+        if (job_table.data[slot] && cluster_owns(job_table.keys[slot])) count++;
+    }
+    return count;
+}
+
+// One node: place at `go`, simulate a month of its share, then keep
+// checking (taking over dead nodes' shards) until `control` closes
+static void cluster_node_main(int node, int nodes, int control, int reports) {
+    cluster_interval_ms = 100;
+    if (cluster_start(node, nodes) != 0) _exit(1);
+    crontab_init(JCRON_SCHED_HEAP);
+    crontab_load_all(0);
+    char go;
+    if (read(control, &go, 1) != 1) _exit(1);
+
+    double check = cpu_seconds();
+    cluster_check(now_ms());
+    check = cpu_seconds() - check;
+    node_report_t report = {0, node, cluster_owned(), owned_jobs(), 0, (int64_t)(check * 1e9),
+                            0};
+    if (write(reports, &report, sizeof(report)) != (ssize_t)sizeof(report)) _exit(1);
+
+    FILE* out = fopen("/dev/null", "w");
+    int64_t from = simulate_parse_time("2027-01-01");
+    double cpu = cpu_seconds();
+    report.fires = simulate_run(JCRON_SCHED_HEAP, from, from + 30 * 86400 - 1, 1, out);
+    report.cpu = cpu_seconds() - cpu;
+    report.kind = 1;
+    fclose(out);
+    if (write(reports, &report, sizeof(report)) != (ssize_t)sizeof(report)) _exit(1);
+
+    struct pollfd wait = {control, POLLIN, 0};
+    while (poll(&wait, 1, 2) == 0) {
+        int owned = cluster_owned(), jobs = owned_jobs();
+        int64_t check = monotonic_ns();
+        if (cluster_check(now_ms()) > 0) {
+            report = (node_report_t){2, node, cluster_owned() - owned, owned_jobs() - jobs, 0,
+                                     check, 0};
+            if (write(reports, &report, sizeof(report)) != (ssize_t)sizeof(report)) _exit(1);
+        }
+    }
+    cluster_stop(now_ms());
+    _exit(0);
+}
+
+/**
+ * 100k jobs (90% weekly, 10% daily) split across `nodes` local node
+ * processes sharing a lock directory: initial placement, a simulated
+ * month of each node's fires, and takeover after node 0 is killed
+ */
+static void benchmark_cluster(int nodes) {
+    enum { N = 100000 };
+    if (nodes < 1 || nodes > CLUSTER_MAX_NODES) return;
+    char root[] = "/tmp/jcrond-bench-XXXXXX";
+    if (!mkdtemp(root)) return;
+    char crontab[512], cron_d[512], spool[512], locks[512];
+    snprintf(crontab, sizeof(crontab), "%s/crontab", root);
+    snprintf(cron_d, sizeof(cron_d), "%s/cron.d", root);
+    snprintf(spool, sizeof(spool), "%s/spool", root);
+    snprintf(locks, sizeof(locks), "%s/cluster", root);
+    crontab_paths = (jcrond_paths_t){crontab, cron_d, spool};
+    cluster_dir = locks;
+    mkdir(locks, 0755);
+
+    FILE* f = fopen(crontab, "w");
+    if (!f) return;
+    for (int i = 0; i < N; i++) {
+        if (i % 10 == 0) {
+            fprintf(f, "%d %d * * * root /usr/local/bin/rollup --id %d\n", i % 60, i % 24, i);
+        } else {
+            fprintf(f, "%d %d * * %d root /usr/local/bin/report --id %d\n", i % 60, i % 24,
+                    i % 7, i);
+        }
+    }
+    fclose(f);
+
+    int control[2], reports[2];
+    if (pipe(control) != 0 || pipe(reports) != 0) return;
+    pid_t pids[CLUSTER_MAX_NODES];
+    fflush(stdout);
+    for (int i = 0; i < nodes; i++) {
+        pids[i] = fork();
+        if (pids[i] == 0) {
+            close(control[1]);
+            close(reports[0]);
+            cluster_node_main(i, nodes, control[0], reports[1]);
+        }
+    }
+    close(control[0]);
+    close(reports[1]);
+
+    // Every node has loaded and joined: place at once
+    usleep(200000 + 150000 * (useconds_t)nodes);
+    char go[CLUSTER_MAX_NODES] = {0};
+    if (write(control[1], go, (size_t)nodes) != nodes) return;
+
+    int placed_shards = 0, placed_jobs = 0, fired = 0, node0_shards = 0, node0_jobs = 0;
+    int64_t slowest_check = 0, fires = 0;
+    double slowest_cpu = 0;
+    node_report_t report;
+    while (fired < nodes && read(reports[0], &report, sizeof(report)) == sizeof(report)) {
+        if (report.kind == 0) {
+            placed_shards += report.shards;
+            placed_jobs += report.jobs;
+            if (report.ns > slowest_check) slowest_check = report.ns;
+            if (report.node == 0) {
+                node0_shards = report.shards;
+                node0_jobs = report.jobs;
+            }
+        } else if (report.kind == 1) {
+            fired++;
+            fires += report.fires;
+            if (report.cpu > slowest_cpu) slowest_cpu = report.cpu;
+        }
+    }
+    printf("  %d node%s  placed %3d shards, %6d jobs (%6d per node), slowest check %5.1f ms CPU; "
+           "month %7lld fires, slowest node %5.2f s CPU = %5.2f M fires/s\n", nodes,
+           nodes > 1 ? "s" : " ", placed_shards, placed_jobs, placed_jobs / nodes,
+           slowest_check / 1e6, (long long)fires, slowest_cpu, fires / slowest_cpu / 1e6);
+
+    if (nodes > 1) {
+        int64_t killed = monotonic_ns();
+        kill(pids[0], SIGKILL);
+        waitpid(pids[0], NULL, 0);
+        int taken = 0, moved = 0;
+        int64_t last = killed;
+        while (taken < node0_shards &&
+               read(reports[0], &report, sizeof(report)) == sizeof(report)) {
+            if (report.kind != 2) continue;
+            taken += report.shards;
+            moved += report.jobs;
+            if (report.ns > last) last = report.ns;
+        }
+        printf("          node 0 killed: %3d of its %3d shards, %6d of its %6d jobs taken over "
+               "after %5.1f ms (check interval 100 ms)\n", taken, node0_shards, moved,
+               node0_jobs, (last - killed) / 1e6);
+    }
+
+    close(control[1]);
+    for (int i = nodes > 1 ? 1 : 0; i < nodes; i++) waitpid(pids[i], NULL, 0);
+    close(reports[0]);
+    cluster_dir = NULL;
+
+    char command[600];
+    snprintf(command, sizeof(command), "rm -rf %s", root);
+    if (system(command) != 0) fprintf(stderr, "Cannot remove %s\n", root);
+}
+
+/* ========================================================================
+ * Control Socket Benchmarks
+ * ======================================================================== */
+
+// A control client: `ops` requests on its own jobs, `batch` in flight
+typedef struct {
+    int index;
+    int ops;
+    int batch;
+    int preload;             // Only add jobs 0..ops-1 (no churn)
+    int errors;
+    int64_t* batch_ns;       // Round trip of each batch
+    int batches;
+} control_client_args_t;
+
+static int clients_done;
+
+static size_t control_frame(char* out, uint8_t op, uint32_t tag, const char* name,
+                            const char* schedule, const char* command) {
+    control_request_t request = {0};
+    size_t lens[4] = {strlen(name), strlen(schedule), 0, strlen(command)};
+    request.length = (uint32_t)(sizeof(request) + lens[0] + lens[1] + lens[3]);
+    request.tag = tag;
+    request.op = op;
+    request.name_len = (uint16_t)lens[0];
+    request.schedule_len = (uint16_t)lens[1];
+    request.command_len = (uint32_t)lens[3];
+    memcpy(out, &request, sizeof(request));
+    char* p = out + sizeof(request);
+    memcpy(p, name, lens[0]);
+    memcpy(p + lens[0], schedule, lens[1]);
+    memcpy(p + lens[0] + lens[1], command, lens[3]);
+    return request.length;
+}
+
+static void* control_client_main(void* arg) {
+    control_client_args_t* args = arg;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", control_path);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        args->errors = args->ops;
+        __atomic_add_fetch(&clients_done, 1, __ATOMIC_RELEASE);
+        return NULL;
+    }
+
+    // Churn cycles each job through add, update, pause, resume, remove
+    static const uint8_t cycle[] = {CONTROL_ADD, CONTROL_UPDATE, CONTROL_PAUSE, CONTROL_RESUME,
+                                    CONTROL_REMOVE};
+    char* frames = malloc((size_t)args->batch * 256);
+    control_reply_t* replies = malloc((size_t)args->batch * sizeof(control_reply_t));
+    for (int done = 0; done < args->ops; ) {
+        int count = args->ops - done < args->batch ? args->ops - done : args->batch;
+        size_t len = 0;
+        for (int i = 0; i < count; i++) {
+            int op = done + i;
+            char name[64], schedule[32], command[96];
+            int job = args->preload ? op : op / 5;
+            uint8_t kind = args->preload ? CONTROL_ADD : cycle[op % 5];
+            snprintf(name, sizeof(name), "client%d-job%d", args->index, job);
+            snprintf(schedule, sizeof(schedule), "%d %d * * %d", job % 60, job % 24,
+                     kind == CONTROL_UPDATE ? (job + 1) % 7 : job % 7);
+            snprintf(command, sizeof(command), "/usr/local/bin/sync --tenant %d --job %d",
+                     args->index, job);
+            len += control_frame(frames + len, kind, (uint32_t)op, name, schedule, command);
+        }
+
+        int64_t start = monotonic_ns();
+        for (size_t sent = 0; sent < len; ) {
+            ssize_t n = write(fd, frames + sent, len - sent);
+            if (n <= 0) break;
+            sent += (size_t)n;
+        }
+        size_t want = (size_t)count * sizeof(control_reply_t);
+        for (size_t got = 0; got < want; ) {
+            ssize_t n = read(fd, (char*)replies + got, want - got);
+            if (n <= 0) {
+                args->errors += count;
+                break;
+            }
+            got += (size_t)n;
+        }
+        args->batch_ns[args->batches++] = monotonic_ns() - start;
+        for (int i = 0; i < count; i++) {
+            if (replies[i].status != CONTROL_OK || replies[i].tag != (uint32_t)(done + i)) {
+                args->errors++;
+            }
+        }
+        done += count;
+    }
+    free(frames);
+    free(replies);
+    close(fd);
+    __atomic_add_fetch(&clients_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+// Serve the control socket until `clients` clients are done
+static double control_serve(control_client_args_t* args, int clients) {
+    pthread_t threads[64];
+    clients_done = 0;
+    int64_t start = monotonic_ns();
+    for (int i = 0; i < clients; i++) {
+        pthread_create(&threads[i], NULL, control_client_main, &args[i]);
+    }
+    struct pollfd ready = {control_fd(), POLLIN, 0};
+    while (__atomic_load_n(&clients_done, __ATOMIC_ACQUIRE) < clients) {
+        if (poll(&ready, 1, 1) > 0) control_handle();
+    }
+    double seconds = (monotonic_ns() - start) / 1e9;
+    for (int i = 0; i < clients; i++) pthread_join(threads[i], NULL);
+    return seconds;
+}
+
+/**
+ * `clients` concurrent connections churning jobs (add, update, pause,
+ * resume, remove; 64 requests in flight each) over a table of `preload`
+ * control jobs
+ */
+static void benchmark_control(int preload, int clients) {
+    enum { OPS = 50000, BATCH = 64 };
+    char root[] = "/tmp/jcrond-bench-XXXXXX";
+    if (!mkdtemp(root)) return;
+    char crontab[512], cron_d[512], spool[512], socket_path[512];
+    snprintf(crontab, sizeof(crontab), "%s/crontab", root);
+    snprintf(cron_d, sizeof(cron_d), "%s/cron.d", root);
+    snprintf(spool, sizeof(spool), "%s/spool", root);
+    snprintf(socket_path, sizeof(socket_path), "%s/control", root);
+    crontab_paths = (jcrond_paths_t){crontab, cron_d, spool};
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        control_path = socket_path;
+        crontab_init(JCRON_SCHED_HEAP);
+        crontab_load_all(0);
+        if (control_start() != 0) _exit(1);
+
+        control_client_args_t args[64];
+        memset(args, 0, sizeof(args));
+        args[0] = (control_client_args_t){63, preload, BATCH, 1, 0,
+                                          malloc(((size_t)preload / BATCH + 1) *
+                                                 sizeof(int64_t)), 0};
+        double load_seconds = preload ? control_serve(args, 1) : 0;
+        int preload_errors = args[0].errors;
+        free(args[0].batch_ns);
+
+        for (int i = 0; i < clients; i++) {
+            int ops = OPS / clients / 5 * 5;
+            args[i] = (control_client_args_t){i, ops, BATCH, 0, 0,
+                                              malloc(((size_t)ops / BATCH + 1) *
+                                                     sizeof(int64_t)), 0};
+        }
+        double seconds = control_serve(args, clients);
+
+        int total = 0, errors = preload_errors, batches = 0;
+        for (int i = 0; i < clients; i++) {
+            total += args[i].ops;
+            errors += args[i].errors;
+            batches += args[i].batches;
+        }
+        int64_t* all = malloc((size_t)batches * sizeof(int64_t));
+        int n = 0;
+        for (int i = 0; i < clients; i++) {
+            memcpy(all + n, args[i].batch_ns, (size_t)args[i].batches * sizeof(int64_t));
+            n += args[i].batches;
+            free(args[i].batch_ns);
+        }
+        qsort(all, (size_t)n, sizeof(int64_t), compare_i64);
+        printf("  %7d jobs, %2d client%s  %7.0f ops/s  batch of %d: p50 %6.0f us  "
+               "p99 %6.0f us  (%d errors; preload %7.0f adds/s)\n", preload, clients,
+               clients > 1 ? "s" : " ", total / seconds, BATCH, all[n / 2] / 1e3,
+               all[n * 99 / 100] / 1e3, errors, preload ? preload / load_seconds : 0.0);
+        free(all);
+        control_stop();
+        fflush(stdout);
+        _exit(0);
+    }
+    waitpid(pid, NULL, 0);
+
+    char command[600];
+    snprintf(command, sizeof(command), "rm -rf %s", root);
+    if (system(command) != 0) fprintf(stderr, "Cannot remove %s\n", root);
+}
+
+int main(int argc, char* argv[]) {
+    int helper_status = zygote_main(argc, argv);
+    if (helper_status >= 0) return helper_status;
+
+    printf("JCRON Daemon Benchmarks\n");
+    printf("=======================\n");
+
+    // Only errors reach syslog; per-run INFO lines would dominate timings
+    setlogmask(LOG_UPTO(LOG_ERR));
+    output_dir = NULL;  // Jobs keep our stdio unless a benchmark captures it
+    metrics_init();
+
+    sigset_t chld;
+    sigemptyset(&chld);
+    sigaddset(&chld, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &chld, NULL);
+
+    benchmark_simultaneous_launch();
+    benchmark_head_of_line();
+    benchmark_direct_exec();
+    benchmark_credentials();
+
+    printf("\n=== Admission: 1000 simultaneous jobs, 4 priorities ===\n");
+    benchmark_admission(0);
+    benchmark_admission(256);
+    benchmark_admission(32);
+    benchmark_admission(4);
+    benchmark_timeout();
+    benchmark_overlap_kill();
+
+    benchmark_reload();
+    benchmark_load();
+
+    printf("\n=== Load spreading: 100000 jobs on one schedule, next hour ===\n");
+    benchmark_spread("0 * * * *", 0);
+    benchmark_spread("0 * * * *", 60);
+    benchmark_spread("H * * * *", 0);
+    benchmark_spread("H * * * *", 60);
+    benchmark_spread("*/15 * * * *", 0);
+    benchmark_spread("H/15 * * * *", 0);
+    benchmark_spread("H/15 * * * *", 60);
+
+    benchmark_catchup();
+    benchmark_state();
+
+    printf("\n=== Threads: 200000 fires through shards (%ld CPUs) ===\n",
+           sysconf(_SC_NPROCESSORS_ONLN));
+    const int thread_counts[] = {1, 2, 4, 8, 16, 32};
+    benchmark_shards(0);
+    for (int i = 0; i < 6; i++) benchmark_shards(thread_counts[i]);
+
+    printf("\n=== Threads: 1000 launches through the launch pool ===\n");
+    benchmark_launch_pool(0);
+    for (int i = 0; i < 6; i++) benchmark_launch_pool(thread_counts[i]);
+
+    printf("\n=== Launch helper: spawn latency against daemon size ===\n");
+    benchmark_launch_helper(0);
+    benchmark_launch_helper(256);
+    benchmark_launch_helper(1024);
+
+    benchmark_output();
+    benchmark_metrics();
+    benchmark_logging();
+    benchmark_simulate();
+
+    printf("\n=== Cluster: 100000 jobs across local nodes (%ld CPUs) ===\n",
+           sysconf(_SC_NPROCESSORS_ONLN));
+    const int node_counts[] = {1, 2, 4, 8};
+    for (int i = 0; i < 4; i++) benchmark_cluster(node_counts[i]);
+
+    printf("\n=== Control socket: 50000 operations (add, update, pause, resume, remove) "
+           "===\n");
+    const int client_counts[] = {1, 4, 16};
+    for (int i = 0; i < 3; i++) benchmark_control(1000, client_counts[i]);
+    for (int i = 0; i < 3; i++) benchmark_control(100000, client_counts[i]);
+
+    printf("\n");
+    return 0;
+}
@@ -5,7 +5,11 @@
  * - Pattern parsing performance
  * - jcron_next() performance
  * - jcron_prev() performance
+ * - jcron_count() / jcron_range() performance
  * - jcron_matches() performance
+ * - jcron_matches_ts_batch() throughput (GB/s of timestamps)
+ * - 64-bit vs legacy 32-bit SIMD field kernels
+ * - Job table scans vs a pointer-chased job list at 1M jobs
  * 
  * Targets (from PostgreSQL/Node.js ports):
  * - Parsing: >1M ops/sec
@@ -13,11 +17,23 @@
  * - matches(): >1M ops/sec
  */
 
+#define _GNU_SOURCE  /* syscall(), for perf_event_open */
+
 #include "../include/jcron.h"
+#include "../include/jcron_simd.h"
+#include "../include/jcron_index.h"
+#include "../include/jcron_sched.h"
+#include "../include/jcron_table.h"
 #include <stdio.h>
 #include <time.h>
 #include <sys/time.h>
 #include <string.h>
+#include <stdlib.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 /* ========================================================================
  * Timing Utilities
@@ -89,6 +105,14 @@ void benchmark_parsing(void) {
     BENCHMARK_TIME("Parse: 0-30 8-17 1-15 * 1-5 *", 1000, {
         jcron_parse("0-30 8-17 1-15 * 1-5 *", &pattern);
     });
+
+    // Pre-split crontab fields, as jcrond hands them over
+    const jcron_span_t fields[5] = {
+        {"0-30", 4}, {"8-17", 4}, {"1-15", 4}, {"*", 1}, {"1-5", 3}
+    };
+    BENCHMARK_TIME("Parse fields: 0-30 8-17 1-15 * 1-5", 1000, {
+        jcron_parse_fields(fields, JCRON_FIELDS_5, 0, &pattern);
+    });
 }
 
 void benchmark_next(void) {
@@ -153,6 +177,33 @@ void benchmark_prev(void) {
     BENCHMARK_TIME("prev: 0 0 12 * * * (daily noon)", 1000, {
         jcron_prev(from, &pattern, &result);
     });
+    
+    // Monthly (more than a week back)
+    jcron_parse("0 0 3 15 * *", &pattern);
+    BENCHMARK_TIME("prev: 0 0 3 15 * * (monthly)", 1000, {
+        jcron_prev(from, &pattern, &result);
+    });
+}
+
+void benchmark_range(void) {
+    printf("\n=== jcron_count() / jcron_range() Benchmarks ===\n");
+    
+    jcron_pattern_t pattern;
+    int64_t count;
+    int64_t times[64];
+    int n;
+    int64_t from = 1729728000;
+    
+    jcron_parse("0 */5 * * * *", &pattern);
+    BENCHMARK_TIME("count: every 5 min over 1 week", 1000, {
+        jcron_count(from, from + 7 * 86400, &pattern, &count);
+    });
+    BENCHMARK_TIME("count: every 5 min over 1 year", 1000, {
+        jcron_count(from, from + 365 * 86400, &pattern, &count);
+    });
+    BENCHMARK_TIME("range(64): every 5 min over 1 week", 1000, {
+        jcron_range(from, from + 7 * 86400, &pattern, times, 64, &n);
+    });
 }
 
 void benchmark_matches(void) {
@@ -180,6 +231,430 @@ void benchmark_matches(void) {
     });
 }
 
+void benchmark_matches_batch(void) {
+    printf("\n=== jcron_matches_ts_batch() Benchmarks ===\n");
+    
+    enum { N = 1 << 20, REPS = 50 };
+    int64_t* ts = malloc(N * sizeof(int64_t));
+    uint8_t* out = malloc(N);
+    if (!ts || !out) {
+        free(ts);
+        free(out);
+        return;
+    }
+    
+    // One event every 37 seconds starting 2024-10-24 (~1.2 years of log)
+    for (int i = 0; i < N; i++) {
+        ts[i] = 1729728000LL + (int64_t)i * 37;
+    }
+    
+    jcron_pattern_t pattern;
+    jcron_parse("* 0-30 2-4 * * 0,6", &pattern);  // weekend maintenance window
+    
+    double start = get_time_ms();
+    for (int r = 0; r < REPS; r++) {
+        jcron_matches_ts_batch(&pattern, ts, N, out);
+    }
+    double batch_ms = get_time_ms() - start;
+    
+    volatile int sink = 0;
+    start = get_time_ms();
+    for (int r = 0; r < REPS / 10; r++) {
+        for (int i = 0; i < N; i++) {
+            sink += jcron_matches(ts[i], &pattern);
+        }
+    }
+    double single_ms = (get_time_ms() - start) * 10;
+    (void)sink;
+    
+    double bytes = (double)N * REPS * sizeof(int64_t);
+    printf("  %-40s %10.0f ts/sec  %6.2f GB/s\n", "batch (1M timestamps)",
+           N * (double)REPS / batch_ms * 1000.0, bytes / batch_ms / 1e6);
+    printf("  %-40s %10.0f ts/sec  %6.2f GB/s\n", "per-element jcron_matches()",
+           N * (double)REPS / single_ms * 1000.0, bytes / single_ms / 1e6);
+    printf("  %-40s %9.1fx\n", "speedup", single_ms / batch_ms);
+    
+    free(ts);
+    free(out);
+}
+
+void benchmark_index(void) {
+    printf("\n=== jcron_index Benchmarks (one tick = all jobs due in a minute) ===\n");
+    
+    static const int sizes[] = {10000, 100000, 1000000};
+    enum { TICKS = 1440 };  // one simulated day
+    
+    for (int s = 0; s < 3; s++) {
+        int n = sizes[s];
+        jcron_pattern_t* jobs = malloc((size_t)n * sizeof(jcron_pattern_t));
+        jcron_index_t index;
+        if (!jobs || jcron_index_init(&index, (uint32_t)n) != JCRON_OK) {
+            free(jobs);
+            return;
+        }
+        
+        // Daily jobs at random minutes, as a large crontab typically looks
+        uint64_t state = 12345;
+        for (int i = 0; i < n; i++) {
+            char expr[32];
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            snprintf(expr, sizeof(expr), "0 %d %d * * *",
+                     (int)((state >> 33) % 60), (int)((state >> 45) % 24));
+            jcron_parse(expr, &jobs[i]);
+            jcron_index_add(&index, (uint32_t)i, &jobs[i]);
+        }
+        
+        int64_t base = 1729728000LL;  // 2024-10-24 00:00 UTC
+        long matched = 0;
+        double start = get_time_ms();
+        for (int t = 0; t < TICKS; t++) {
+            jcron_index_iter_t it;
+            jcron_index_match(&index, base + t * 60, &it);
+            while (jcron_index_next(&it) >= 0) {
+                matched++;
+            }
+        }
+        double index_ms = get_time_ms() - start;
+        
+        char label[64];
+        snprintf(label, sizeof(label), "index, %d jobs", n);
+        printf("  %-40s %10.2f us/tick  %8.1f matches/tick\n", label,
+               index_ms * 1000.0 / TICKS, (double)matched / TICKS);
+        
+        // Linear scan baseline; 1M x 1440 would take minutes, sample fewer ticks
+        int scan_ticks = n >= 1000000 ? TICKS / 24 : TICKS;
+        volatile long sink = 0;
+        start = get_time_ms();
+        for (int t = 0; t < scan_ticks; t++) {
+            for (int i = 0; i < n; i++) {
+                sink += jcron_matches(base + t * 60, &jobs[i]);
+            }
+        }
+        double scan_ms = get_time_ms() - start;
+        (void)sink;
+        
+        snprintf(label, sizeof(label), "linear scan, %d jobs", n);
+        printf("  %-40s %10.2f us/tick  %7.1fx slower\n", label,
+               scan_ms * 1000.0 / scan_ticks,
+               (scan_ms / scan_ticks) / (index_ms / TICKS));
+        
+        jcron_index_free(&index);
+        free(jobs);
+    }
+}
+
+/* ========================================================================
+ * Cache Miss Counter (Linux perf events; unavailable in most VMs)
+ * ======================================================================== */
+
+static int cache_counter_open(void) {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+    return -1;
+#endif
+}
+
+static long long cache_counter_read(int fd) {
+#ifdef __linux__
+    long long value;
+    if (fd >= 0 && read(fd, &value, sizeof(value)) == (ssize_t)sizeof(value)) return value;
+#endif
+    (void)fd;
+    return -1;
+}
+
+/* ========================================================================
+ * Job Table vs Job List
+ * ======================================================================== */
+
+// A job as the PG worker kept it: one node per job, strings allocated
+// alongside, linked in load order
+typedef struct list_job {
+    char* schedule;
+    char* command;
+    char* user;
+    jcron_pattern_t pattern;
+    int64_t next_fire;
+    struct list_job* next;
+} list_job_t;
+
+static void print_tick(const char* label, double ms, int ticks, long long misses,
+                       double bytes_per_tick) {
+    char miss_text[32];
+    if (misses >= 0) snprintf(miss_text, sizeof(miss_text), "%10.0f", (double)misses / ticks);
+    else snprintf(miss_text, sizeof(miss_text), "%10s", "n/a");
+    printf("  %-40s %10.2f us/tick  misses/tick %s  %7.1f MB read/tick\n", label,
+           ms * 1000.0 / ticks, miss_text, bytes_per_tick / 1e6);
+}
+
+void benchmark_table(void) {
+    printf("\n=== jcron_table Benchmarks (1M jobs, one tick = one minute) ===\n");
+
+    enum { N = 1000000, TICKS = 60 };
+    jcron_table_t table;
+    if (jcron_table_init(&table, N, 2) != JCRON_OK) return;
+
+    // Daily jobs at random minutes (as in the index benchmark)
+    list_job_t* head = NULL;
+    list_job_t** tail = &head;
+    int64_t base = 1729728000LL;  // 2024-10-24 00:00 UTC
+    uint64_t state = 12345;
+    for (int i = 0; i < N; i++) {
+        char expr[32], command[64];
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        snprintf(expr, sizeof(expr), "0 %d %d * * *",
+                 (int)((state >> 33) % 60), (int)((state >> 45) % 24));
+        snprintf(command, sizeof(command), "/usr/local/bin/report --shard %d", i % 1000);
+
+        list_job_t* job = malloc(sizeof(list_job_t));
+        if (!job) break;
+        job->schedule = strdup(expr);
+        job->command = strdup(command);
+        job->user = strdup("postgres");
+        jcron_parse(expr, &job->pattern);
+        jcron_result_t result;
+        job->next_fire = jcron_next(base, &job->pattern, &result) == JCRON_OK
+                       ? result.next_time : INT64_MAX;
+        job->next = NULL;
+        *tail = job;
+        tail = &job->next;
+
+        uint32_t slot;
+        if (jcron_table_insert(&table, &job->pattern, (uint64_t)i, NULL, &slot) != JCRON_OK) break;
+        jcron_table_set_string(&table, slot, 0, command, strlen(command));
+        jcron_table_set_string(&table, slot, 1, "postgres", 8);
+        jcron_table_advance(&table, slot, base);
+    }
+
+    int counter = cache_counter_open();
+    long long misses;
+    long fired = 0;
+    volatile long sink = 0;
+
+    // List, matching every pattern (the PG worker before its index)
+    misses = cache_counter_read(counter);
+    double start = get_time_ms();
+    for (int t = 0; t < TICKS; t++) {
+        for (list_job_t* job = head; job; job = job->next) {
+            sink += jcron_matches(base + t * 60, &job->pattern);
+        }
+    }
+    double ms = get_time_ms() - start;
+    if (misses >= 0) misses = cache_counter_read(counter) - misses;
+    // The masks and the next link are on different cache lines of a node
+    print_tick("list walk + jcron_matches()", ms, TICKS, misses, (double)N * 128);
+
+    // List, checking each node's next fire
+    misses = cache_counter_read(counter);
+    start = get_time_ms();
+    for (int t = 0; t < TICKS; t++) {
+        int64_t now = base + t * 60;
+        for (list_job_t* job = head; job; job = job->next) {
+            if (job->next_fire > now) continue;
+            jcron_result_t result;
+            job->next_fire = jcron_next(now + 60, &job->pattern, &result) == JCRON_OK
+                           ? result.next_time : INT64_MAX;
+            fired++;
+        }
+    }
+    ms = get_time_ms() - start;
+    if (misses >= 0) misses = cache_counter_read(counter) - misses;
+    print_tick("list walk, next_fire <= now", ms, TICKS, misses, (double)N * 64);
+
+    // Table, masks
+    uint32_t out[1024];
+    misses = cache_counter_read(counter);
+    start = get_time_ms();
+    for (int t = 0; t < TICKS; t++) {
+        uint32_t cursor = 0;
+        while (cursor < table.high) {
+            sink += jcron_table_match(&table, base + t * 60, &cursor, out, 1024);
+        }
+    }
+    ms = get_time_ms() - start;
+    if (misses >= 0) misses = cache_counter_read(counter) - misses;
+    print_tick("table, jcron_table_match()", ms, TICKS, misses, (double)N * 19);
+
+    // Table, next_fire
+    long table_fired = 0;
+    misses = cache_counter_read(counter);
+    start = get_time_ms();
+    for (int t = 0; t < TICKS; t++) {
+        int64_t now = base + t * 60;
+        uint32_t cursor = 0;
+        while (cursor < table.high) {
+            uint32_t n = jcron_table_due(&table, now, &cursor, out, 1024);
+            for (uint32_t k = 0; k < n; k++) jcron_table_advance(&table, out[k], now + 60);
+            table_fired += n;
+        }
+    }
+    ms = get_time_ms() - start;
+    if (misses >= 0) misses = cache_counter_read(counter) - misses;
+    print_tick("table, jcron_table_due() + advance", ms, TICKS, misses, (double)N * 8);
+    (void)sink;
+
+    printf("  %ld fires from the list, %ld from the table; %u string bytes for %d jobs\n",
+           fired, table_fired, table.pool.used, N);
+    if (counter < 0) printf("  (hardware cache counters unavailable here)\n");
+#ifdef __linux__
+    if (counter >= 0) close(counter);
+#endif
+
+    while (head) {
+        list_job_t* next = head->next;
+        free(head->schedule);
+        free(head->command);
+        free(head->user);
+        free(head);
+        head = next;
+    }
+    jcron_table_free(&table);
+}
+
+void benchmark_sched(void) {
+    printf("\n=== jcron_sched Benchmarks (pop + jcron_next reschedule) ===\n");
+    
+    enum { N = 100000, HOURS = 6 };
+    jcron_pattern_t* jobs = malloc(N * sizeof(jcron_pattern_t));
+    jcron_sched_t sched;
+    if (!jobs || jcron_sched_init(&sched, N) != JCRON_OK) {
+        free(jobs);
+        return;
+    }
+    
+    // Mix of */5, hourly and daily jobs
+    int64_t base = 1729728000LL;  // 2024-10-24 00:00 UTC
+    uint64_t state = 777;
+    for (int i = 0; i < N; i++) {
+        char expr[32];
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        int m = (int)((state >> 33) % 60);
+        switch ((state >> 50) % 3) {
+            case 0:  snprintf(expr, sizeof(expr), "0 */5 * * * *"); break;
+            case 1:  snprintf(expr, sizeof(expr), "0 %d * * * *", m); break;
+            default: snprintf(expr, sizeof(expr), "0 %d %d * * *", m, (int)((state >> 40) % 24)); break;
+        }
+        jcron_parse(expr, &jobs[i]);
+    }
+    
+    double start = get_time_ms();
+    for (int i = 0; i < N; i++) {
+        jcron_sched_set_next(&sched, (uint32_t)i, &jobs[i], base);
+    }
+    double load_ms = get_time_ms() - start;
+    
+    long fires = 0;
+    int64_t when;
+    start = get_time_ms();
+    for (int64_t now = base; now < base + HOURS * 3600; now += 60) {
+        for (int slot; (slot = jcron_sched_pop(&sched, now, &when)) >= 0; ) {
+            jcron_sched_set_next(&sched, (uint32_t)slot, &jobs[slot], when + 60);
+            fires++;
+        }
+    }
+    double run_ms = get_time_ms() - start;
+    
+    printf("  %-40s %10.0f jobs/sec\n", "initial schedule (100k jobs)", N / load_ms * 1000.0);
+    printf("  %-40s %10.0f fires/sec  (%ld fires)\n", "pop + reschedule (6 hours)",
+           fires / run_ms * 1000.0, fires);
+    
+    jcron_sched_free(&sched);
+    free(jobs);
+}
+
+/**
+ * Run one scheduler backend over precomputed fire offsets
+ *
+ * Every job fires `period` seconds after its previous fire; the clock
+ * advances one second per tick, like a daemon woken at each due time.
+ */
+static void bench_sched_backend(const char* label, jcron_sched_backend_t backend,
+                                const int64_t* offsets, int n, int64_t period, int64_t span) {
+    jcron_sched_t sched;
+    int64_t base = 1729728000LL;
+    int ret = backend == JCRON_SCHED_WHEEL ? jcron_sched_init_wheel(&sched, (uint32_t)n, base)
+                                           : jcron_sched_init(&sched, (uint32_t)n);
+    if (ret != JCRON_OK) return;
+    
+    double start = get_time_ms();
+    for (int i = 0; i < n; i++) {
+        jcron_sched_set(&sched, (uint32_t)i, base + offsets[i]);
+    }
+    double insert_ms = get_time_ms() - start;
+    
+    long fires = 0;
+    int64_t when;
+    start = get_time_ms();
+    for (int64_t now = base; now < base + span; now++) {
+        for (int slot; (slot = jcron_sched_pop(&sched, now, &when)) >= 0; ) {
+            jcron_sched_set(&sched, (uint32_t)slot, when + period);
+            fires++;
+        }
+    }
+    double run_ms = get_time_ms() - start;
+    
+    printf("  %-40s %8.1f ns/insert  %8.1f ns/fire  (%ld fires)\n", label,
+           insert_ms * 1e6 / n, run_ms * 1e6 / (fires ? fires : 1), fires);
+    jcron_sched_free(&sched);
+}
+
+void benchmark_sched_backends(void) {
+    printf("\n=== Scheduler Backends: heap vs timing wheel (1M jobs) ===\n");
+    
+    enum { N = 1000000 };
+    int64_t* offsets = malloc(N * sizeof(int64_t));
+    if (!offsets) return;
+    
+    // Burst: every job hourly at minute 0 (top-of-hour thundering herd)
+    for (int i = 0; i < N; i++) offsets[i] = 3600;
+    bench_sched_backend("burst, heap", JCRON_SCHED_HEAP, offsets, N, 3600, 3 * 3600 + 1);
+    bench_sched_backend("burst, wheel", JCRON_SCHED_WHEEL, offsets, N, 3600, 3 * 3600 + 1);
+    
+    // Spread: hourly jobs at uniformly random minutes
+    uint64_t state = 4242;
+    for (int i = 0; i < N; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        offsets[i] = 60 * (int64_t)(1 + (state >> 33) % 60);
+    }
+    bench_sched_backend("spread, heap", JCRON_SCHED_HEAP, offsets, N, 3600, 3 * 3600 + 1);
+    bench_sched_backend("spread, wheel", JCRON_SCHED_WHEEL, offsets, N, 3600, 3 * 3600 + 1);
+    
+    free(offsets);
+}
+
+void benchmark_simd_kernels(void) {
+    printf("\n=== SIMD Field Kernel Benchmarks ===\n");
+    
+    // Values < 32 so the legacy kernel sees the same inputs
+    const uint32_t masks32[5] = {0x7FFFFFFF, 0x00FFFFFF, 0xFFFFFFFE, 0x1FFE, 0x7F};
+    const uint32_t values32[5] = {17, 9, 24, 10, 4};
+    const uint64_t masks64[5] = {0x0FFFFFFFFFFFFFFFULL, 0x00FFFFFF, 0xFFFFFFFE, 0x1FFE, 0x7F};
+    const uint64_t values64[5] = {17, 9, 24, 10, 4};
+    const uint64_t values64_high[5] = {45, 9, 24, 10, 4};
+    volatile int sink = 0;
+    
+    BENCHMARK_TIME("legacy 32-bit lanes (5 fields)", 1000, {
+        sink += jcron_simd_bitmask_match(masks32, values32, 5);
+    });
+    
+    BENCHMARK_TIME("64-bit lanes (5 fields)", 1000, {
+        sink += jcron_simd_bitmask_match64(masks64, values64, 5);
+    });
+    
+    BENCHMARK_TIME("64-bit lanes (minute 45)", 1000, {
+        sink += jcron_simd_bitmask_match64(masks64, values64_high, 5);
+    });
+    (void)sink;
+}
+
 void benchmark_next_n(void) {
     printf("\n=== jcron_next_n() Benchmarks ===\n");
     
@@ -223,7 +698,14 @@ int main(void) {
     benchmark_parsing();
     benchmark_next();
     benchmark_prev();
+    benchmark_range();
     benchmark_matches();
+    benchmark_matches_batch();
+    benchmark_simd_kernels();
+    benchmark_index();
+    benchmark_table();
+    benchmark_sched();
+    benchmark_sched_backends();
     benchmark_next_n();
     
     printf("\n");
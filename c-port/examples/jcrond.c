@@ -9,8 +9,48 @@
  * - Security: drops privileges when executing user jobs
  * - Logging via syslog
  * - Systemd integration
+ * - Event driven: sleeps until the earliest next-fire time
+ *   (min-heap, or timing wheel with -s wheel for very large job counts)
+ * - Non-blocking launches; one epoll loop waits on a timerfd (next fire)
+ *   and a signalfd (SIGCHLD reaping, SIGHUP reload, SIGTERM/SIGINT)
+ * - Admission control: global/per-user/per-file run limits with a bounded
+ *   priority queue, per-job overlap policy and hard timeout set by
+ *   JCRON_OVERLAP= / JCRON_PRIORITY= / JCRON_TIMEOUT= crontab lines,
+ *   counters logged on SIGUSR1
+ * - inotify-driven incremental reload: only changed crontab files are
+ *   re-read, and unchanged lines keep their job state and next fire
+ * - Missed-run catch-up after downtime, suspend or clock jumps, per-job
+ *   JCRON_CATCHUP= policy, rate-limited
+ * - Crash-safe run state: an mmap'd record per job plus a journal that is
+ *   group-committed before due fires launch
+ * - Optional threads (-t N): N scheduler shards and N launch threads,
+ *   connected to the main loop by lock-free rings
+ * - Job stdout/stderr spliced into per-job, size-capped ring logs; the
+ *   last runs' output is printed by jcrond -o
+ * - Prometheus metrics on a Unix socket (-M): per-CPU counters and HDR
+ *   histograms of fire lateness and spawn latency
+ * - Load spreading: "H" schedule fields hashed from each job's line, and
+ *   a per-job start offset within a -W window
+ * - Crontab NAME=value lines set the environment of the jobs below them;
+ *   commands without shell syntax are exec'd directly, not via /bin/sh -c
+ * - Users (uid, gid, supplementary groups, home) resolved once at load and
+ *   cached until /etc/passwd or /etc/group changes; children only make
+ *   the setgroups/setgid/setuid syscalls
+ * - Asynchronous logging: messages are queued on a lock-free ring and a
+ *   writer thread sends them in batches to syslog or a JSON-lines file (-J)
+ * - --simulate --from T1 --to T2: every fire of the loaded crontabs over
+ *   a time range, on a virtual clock, without running anything
+ * - Several nodes (-N node/nodes -D lock-dir) split the jobs by rendezvous
+ *   hashing, with flock leases in a shared directory; a dead node's jobs
+ *   are taken over within a second
+ * - Control socket (-C): a binary protocol to add, update, remove, pause,
+ *   resume, run and list jobs at run time, each in O(log n), no reload
+ *
+ * Daemon modules live in examples/jcrond/ (see jcrond/jcrond.h).
  */
 
+#include "jcrond/jcrond.h"
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -19,295 +59,181 @@
 #include <syslog.h>
 #include <sys/types.h>
 #include <sys/stat.h>
-#include <sys/wait.h>
 #include <fcntl.h>
-#include <dirent.h>
-#include <pwd.h>
-#include <grp.h>
 #include <time.h>
 #include <errno.h>
-#include <stdarg.h>
-#include <limits.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
 
 #include "jcron.h"
+#include "jcron_sched.h"
 
 // Configuration
-#define CRONTAB_FILE "/etc/crontab"
-#define CRON_D_DIR "/etc/cron.d"
-#define USER_CRONTABS_DIR "/var/spool/cron/crontabs"
 #define PID_FILE "/var/run/jcrond.pid"
 
-// Job structure
-typedef struct cron_job {
-    char* schedule;      // Original cron schedule string
-    char* command;       // Command to execute
-    char* user;          // User to run as (NULL for root)
-    jcron_pattern_t pattern; // Parsed pattern
-    time_t last_run;     // Last execution time
-    struct cron_job* next;
-} cron_job_t;
+// Backward clock steps beyond this reschedule every job from the new time;
+// smaller ones just wait (fires already run are not repeated)
+#define CLOCK_BACKWARD_RESCHEDULE (3 * 3600)
 
 // Global variables
-static cron_job_t* job_list = NULL;
-static volatile int running = 1;
-static volatile int reload_config = 0;
-
-// Signal handlers
-void signal_handler(int sig) {
-    switch (sig) {
-        case SIGTERM:
-        case SIGINT:
-            running = 0;
-            break;
-        case SIGHUP:
-            reload_config = 1;
-            break;
-    }
-}
-
-// Logging
-void log_message(int priority, const char* format, ...) {
-    va_list args;
-    va_start(args, format);
-    vsyslog(priority, format, args);
-    va_end(args);
-}
-
-// Parse a crontab line
-int parse_crontab_line(const char* line, cron_job_t* job) {
-    char* line_copy = strdup(line);
-    if (!line_copy) return -1;
-
-    char* saveptr;
-    char* token;
-
-    // Skip comments and empty lines
-    if (line[0] == '#' || line[0] == '\0' || line[0] == '\n') {
-        free(line_copy);
-        return 0;
-    }
-
-    // Parse schedule (5 fields: min hour day month weekday)
-    char schedule[256] = {0};
-    char command[1024] = {0};
-    char user[64] = {0};
-
-    // For system crontab: min hour day month weekday user command
-    // For user crontab: min hour day month weekday command
-
-    token = strtok_r(line_copy, " \t", &saveptr);
-    if (!token) goto error;
-
-    strcpy(schedule, token); // minute
-
-    token = strtok_r(NULL, " \t", &saveptr);
-    if (!token) goto error;
-    strcat(schedule, " ");
-    strcat(schedule, token); // hour
-
-    token = strtok_r(NULL, " \t", &saveptr);
-    if (!token) goto error;
-    strcat(schedule, " ");
-    strcat(schedule, token); // day
-
-    token = strtok_r(NULL, " \t", &saveptr);
-    if (!token) goto error;
-    strcat(schedule, " ");
-    strcat(schedule, token); // month
-
-    token = strtok_r(NULL, " \t", &saveptr);
-    if (!token) goto error;
-    strcat(schedule, " ");
-    strcat(schedule, token); // weekday
-
-    // Check if next token is a username (system crontab) or command (user crontab)
-    token = strtok_r(NULL, " \t", &saveptr);
-    if (!token) goto error;
-
-    // If token contains only letters (potential username), check next token
-    char* remaining = strtok_r(NULL, "", &saveptr);
-    if (remaining && remaining[0] != '\0') {
-        // System crontab format: user command
-        strcpy(user, token);
-        strcpy(command, remaining);
-    } else {
-        // User crontab format: command only
-        strcpy(command, token);
-        // user remains empty (current user)
+static jcron_sched_backend_t sched_backend = JCRON_SCHED_HEAP;
+static int threads = 0;
+
+// Fires popped in one pass, launched once they are committed
+typedef struct {
+    cron_job_t* job;
+    int64_t when;
+} due_fire_t;
+
+static due_fire_t* due = NULL;
+static int due_count = 0;
+static int due_capacity = 0;
+static int running = 1;
+static int reload_config = 0;
+
+// Queue a due fire for launch, or hand a missed one to catch-up
+static void take_fire(cron_job_t* job, int64_t when, int64_t now) {
+    int64_t current_minute = now / 60000 * 60;
+    if (now / 1000 - when >= CATCHUP_GRACE) {
+        // Down, suspended or the clock jumped: the job's policy decides
+        // which of the fires up to the current minute still run
+        catchup_missed(job, when, current_minute);
+        return;
     }
 
-    // Parse the schedule
-    if (jcron_parse(schedule, &job->pattern) != JCRON_OK) {
-        log_message(LOG_ERR, "Failed to parse cron schedule: %s", schedule);
-        goto error;
+    if (due_count == due_capacity) {
+        int capacity = due_capacity ? due_capacity * 2 : 256;
+        due_fire_t* grown = realloc(due, (size_t)capacity * sizeof(due_fire_t));
+        if (!grown) {
+            log_message(LOG_ERR, "Out of memory, dropped fire: %s", job->command);
+            return;
+        }
+        due = grown;
+        due_capacity = capacity;
     }
-
-    job->schedule = strdup(schedule);
-    job->command = strdup(command);
-    job->user = user[0] ? strdup(user) : NULL;
-    job->last_run = 0;
-
-    free(line_copy);
-    return 1;
-
-error:
-    free(line_copy);
-    return -1;
+    due[due_count++] = (due_fire_t){job, when};
+    job->last_run = (time_t)when;
+    state_record_fire(job);
 }
 
-// Load crontab file
-int load_crontab_file(const char* filename, const char* default_user) {
-    FILE* file = fopen(filename, "r");
-    if (!file) {
-        log_message(LOG_WARNING, "Cannot open crontab file: %s", filename);
-        return -1;
+// Submit every job whose fire time has passed and queue its next fire;
+// returns the time fires were taken up to
+int64_t run_due_jobs(void) {
+    int64_t now = now_ms();
+    int64_t when;
+    due_count = 0;
+
+    if (shards_running()) {
+        // Shard threads popped these and already queued the next fires.
+        // A fire pushed before its shard was let go (or the job paused)
+        // may still be here: the new owner runs it, not this node.
+        shard_fire_t fire;
+        while (shard_pop_fire(&fire) == 0) {
+            cron_job_t* job = crontab_job(fire.slot);
+            if (!job || job->key != fire.key || job->paused) continue;
+            if (!job->control && !cluster_owns_fire(job->key, fire.when)) continue;
+            take_fire(job, fire.when, now);
+        }
     }
 
-    char line[2048];
-    int job_count = 0;
-
-    while (fgets(line, sizeof(line), file)) {
-        // Remove trailing newline
-        size_t len = strlen(line);
-        if (len > 0 && line[len-1] == '\n') line[len-1] = '\0';
-
-        cron_job_t* job = calloc(1, sizeof(cron_job_t));
+    for (int slot; (slot = jcron_sched_pop(&job_sched, now / 1000, &when)) >= 0; ) {
+        cron_job_t* job = crontab_job((uint32_t)slot);
         if (!job) continue;
+        take_fire(job, when, now);
 
-        int result = parse_crontab_line(line, job);
-        if (result == 1) {
-            // Set default user if not specified
-            if (!job->user && default_user) {
-                job->user = strdup(default_user);
-            }
+        // Resume at the current minute rather than replaying every
+        // minute that was missed
+        int64_t from = when + 60;
+        int64_t current_minute = now / 60000 * 60;
+        if (from < current_minute) from = current_minute;
 
-            job->next = job_list;
-            job_list = job;
-            job_count++;
-        } else if (result == -1) {
-            free(job);
-        }
+        sched_set_next(&job_sched, (uint32_t)slot, &job_table.patterns[slot], job->spread, from);
     }
 
-    fclose(file);
-    return job_count;
+    // Write ahead: a fire is on disk before it starts, so a crash cannot
+    // make the restarted daemon run it again
+    state_commit();
+    for (int i = 0; i < due_count; i++) job_submit(due[i].job, due[i].when);
+    return now;
 }
 
-// Load all crontabs
-void load_all_crontabs(void) {
-    // Free existing jobs
-    cron_job_t* job = job_list;
-    while (job) {
-        cron_job_t* next = job->next;
-        free(job->schedule);
-        free(job->command);
-        free(job->user);
-        free(job);
-        job = next;
-    }
-    job_list = NULL;
-
-    int total_jobs = 0;
-
-    // Load system crontab
-    total_jobs += load_crontab_file(CRONTAB_FILE, "root");
-
-    // Load /etc/cron.d/* files
-    DIR* dir = opendir(CRON_D_DIR);
-    if (dir) {
-        struct dirent* entry;
-        while ((entry = readdir(dir)) != NULL) {
-            if (entry->d_name[0] == '.') continue;
-
-            char filepath[PATH_MAX];
-            snprintf(filepath, sizeof(filepath), "%s/%s", CRON_D_DIR, entry->d_name);
-            total_jobs += load_crontab_file(filepath, "root");
-        }
-        closedir(dir);
-    }
-
-    // Load user crontabs
-    dir = opendir(USER_CRONTABS_DIR);
-    if (dir) {
-        struct dirent* entry;
-        while ((entry = readdir(dir)) != NULL) {
-            if (entry->d_name[0] == '.') continue;
+// Arm the timerfd for the next time the scheduler may have due work
+void arm_next_fire(int timer_fd) {
+    struct itimerspec spec = {0};
+    int64_t when;
 
-            char filepath[PATH_MAX];
-            snprintf(filepath, sizeof(filepath), "%s/%s", USER_CRONTABS_DIR, entry->d_name);
-            total_jobs += load_crontab_file(filepath, entry->d_name);
-        }
-        closedir(dir);
+    // With nothing scheduled here (or scheduling on shard threads) wake
+    // hourly anyway: only an armed timer reports clock changes
+    if (jcron_sched_next_wakeup(&job_sched, &when) != JCRON_OK) {
+        when = now_ms() / 1000 + 3600;
     }
-
-    log_message(LOG_INFO, "Loaded %d cron jobs", total_jobs);
+    spec.it_value.tv_sec = (time_t)when;
+    if (when <= 0) spec.it_value.tv_nsec = 1;  // Zero would disarm
+    // Reads fail with ECANCELED when the clock is set
+    timerfd_settime(timer_fd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &spec, NULL);
 }
 
-// Execute a cron job
-void execute_job(cron_job_t* job) {
-    pid_t pid = fork();
-    if (pid < 0) {
-        log_message(LOG_ERR, "Failed to fork for job execution");
-        return;
+// Arm the CLOCK_MONOTONIC timerfd for the earliest run deadline,
+// catch-up token or cluster check
+void arm_monotonic_timer(int deadline_fd) {
+    struct itimerspec spec = {0};
+    int64_t deadline = exec_next_deadline();
+    int64_t catchup = catchup_next_ns();
+    if (catchup >= 0 && (deadline < 0 || catchup < deadline)) deadline = catchup;
+    int64_t check = cluster_next_ns();
+    if (check >= 0 && (deadline < 0 || check < deadline)) deadline = check;
+
+    if (deadline >= 0) {
+        spec.it_value.tv_sec = (time_t)(deadline / 1000000000);
+        spec.it_value.tv_nsec = (long)(deadline % 1000000000);
+        if (deadline == 0) spec.it_value.tv_nsec = 1;
     }
+    timerfd_settime(deadline_fd, TFD_TIMER_ABSTIME, &spec, NULL);
+}
 
-    if (pid == 0) {
-        // Child process
-        log_message(LOG_INFO, "Executing job: %s (user: %s)",
-                   job->command, job->user ? job->user : "root");
-
-        // Set environment variables
-        setenv("PATH", "/usr/local/sbin:/usr/local/bin:/sbin:/bin:/usr/sbin:/usr/bin", 1);
-
-        // Change to user's home directory if specified
-        if (job->user) {
-            struct passwd* pwd = getpwnam(job->user);
-            if (pwd) {
-                if (chdir(pwd->pw_dir) != 0) {
-                    chdir("/tmp");
-                }
-                // Drop privileges
-                if (setgid(pwd->pw_gid) != 0 || setuid(pwd->pw_uid) != 0) {
-                    log_message(LOG_ERR, "Failed to drop privileges to user %s", job->user);
-                    exit(1);
-                }
-            }
-        }
-
-        // Execute command
-        execl("/bin/sh", "sh", "-c", job->command, NULL);
-        log_message(LOG_ERR, "Failed to execute command: %s", strerror(errno));
-        exit(1);
-    } else {
-        // Parent process - wait for child to avoid zombies
-        int status;
-        waitpid(pid, &status, 0);
-
-        if (WIFEXITED(status)) {
-            log_message(LOG_INFO, "Job completed with exit code %d", WEXITSTATUS(status));
-        } else if (WIFSIGNALED(status)) {
-            log_message(LOG_WARNING, "Job terminated by signal %d", WTERMSIG(status));
+// The wall clock was set: log the step and recover from large backward ones
+void handle_clock_change(int64_t wall_ms, int64_t mono_ns) {
+    int64_t step = (now_ms() - wall_ms) - (monotonic_ns() - mono_ns) / 1000000;
+    log_message(LOG_NOTICE, "System clock changed by %+lld s", (long long)(step / 1000));
+
+    // Forward steps need nothing here: overdue fires pop and go through
+    // catch-up. Far backward steps would leave every job asleep until the
+    // old time comes around again.
+    if (step < -CLOCK_BACKWARD_RESCHEDULE * 1000LL) {
+        int64_t next_minute = (now_ms() / 60000 + 1) * 60;
+        for (uint32_t slot = 0; slot < crontab_slot_limit(); slot++) {
+            cron_job_t* job = crontab_job(slot);
+            if (job) crontab_schedule_from(job, next_minute);
         }
+        log_message(LOG_NOTICE, "Rescheduled %d jobs from the new time", crontab_job_count());
     }
 }
 
-// Check and execute due jobs
-void check_jobs(void) {
-    time_t now = time(NULL);
-    struct tm tm_now;
-    localtime_r(&now, &tm_now);
-
-    cron_job_t* job = job_list;
-    while (job) {
-        // Check if job should run now
-        if (jcron_matches(now, &job->pattern)) {
-            // Avoid running the same job multiple times in the same minute
-            if (job->last_run == 0 || difftime(now, job->last_run) >= 60) {
-                execute_job(job);
-                job->last_run = now;
-            }
+// Drain the signalfd and act on each signal
+void handle_signals(int signal_fd) {
+    struct signalfd_siginfo info;
+
+    while (read(signal_fd, &info, sizeof(info)) == (ssize_t)sizeof(info)) {
+        switch (info.ssi_signo) {
+            case SIGTERM:
+            case SIGINT:
+                running = 0;
+                break;
+            case SIGHUP:
+                reload_config = 1;
+                creds_invalidate();
+                log_reopen();
+                break;
+            case SIGUSR1:
+                counters_log();
+                break;
+            case SIGCHLD:
+                // Freed slots go to the queue before new fires
+                exec_reap();
+                job_dispatch();
+                break;
         }
-        job = job->next;
     }
 }
 
@@ -340,22 +266,165 @@ void daemonize(void) {
 
 // Main function
 int main(int argc, char* argv[]) {
+    // Re-exec'd as the launch helper?
+    int helper_status = zygote_main(argc, argv);
+    if (helper_status >= 0) return helper_status;
+
     // Parse command line arguments
     int daemon_mode = 1;
-    if (argc > 1 && strcmp(argv[1], "-f") == 0) {
-        daemon_mode = 0; // Foreground mode for debugging
+    int launch_helper = 0;
+    const char* print_pattern = NULL;
+    int print_runs = 5;
+    int simulate = 0, summary = 0;
+    int cluster_node = -1, cluster_nodes = 0;
+    int64_t simulate_from = (now_ms() / 60000 + 1) * 60;
+    int64_t simulate_to = -1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-f") == 0) {
+            daemon_mode = 0; // Foreground mode for debugging
+        } else if (strcmp(argv[i], "-z") == 0) {
+            launch_helper = 1;
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            const char* backend = argv[++i];
+            if (strcmp(backend, "wheel") == 0) {
+                sched_backend = JCRON_SCHED_WHEEL;
+            } else if (strcmp(backend, "heap") == 0) {
+                sched_backend = JCRON_SCHED_HEAP;
+            } else {
+                fprintf(stderr, "Unknown scheduler backend: %s (use heap or wheel)\n", backend);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-S") == 0 && i + 1 < argc) {
+            state_path = strcmp(argv[i + 1], "none") == 0 ? NULL : argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "-O") == 0 && i + 1 < argc) {
+            output_dir = strcmp(argv[i + 1], "none") == 0 ? NULL : argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "-M") == 0 && i + 1 < argc) {
+            metrics_path = strcmp(argv[i + 1], "none") == 0 ? NULL : argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "-C") == 0 && i + 1 < argc) {
+            control_path = strcmp(argv[i + 1], "none") == 0 ? NULL : argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "--simulate") == 0) {
+            simulate = 1;
+        } else if (strcmp(argv[i], "--summary") == 0) {
+            summary = 1;
+        } else if ((strcmp(argv[i], "--from") == 0 || strcmp(argv[i], "--to") == 0) &&
+                   i + 1 < argc) {
+            int64_t t = simulate_parse_time(argv[i + 1]);
+            if (t < 0) {
+                fprintf(stderr, "Invalid time: %s (use a Unix timestamp or "
+                        "YYYY-MM-DDTHH:MM, UTC)\n", argv[i + 1]);
+                return 1;
+            }
+            if (argv[i][2] == 'f') simulate_from = t;
+            else simulate_to = t;
+            i++;
+        } else if (strcmp(argv[i], "-N") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%d/%d", &cluster_node, &cluster_nodes) != 2 ||
+                cluster_nodes < 1 || cluster_nodes > CLUSTER_MAX_NODES ||
+                cluster_node < 0 || cluster_node >= cluster_nodes) {
+                fprintf(stderr, "Invalid cluster node: %s (use node/nodes, node from 0, "
+                        "at most %d nodes)\n", argv[i], CLUSTER_MAX_NODES);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-D") == 0 && i + 1 < argc) {
+            cluster_dir = argv[++i];
+        } else if (strcmp(argv[i], "-J") == 0 && i + 1 < argc) {
+            log_json_path = argv[++i];
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            print_pattern = argv[++i];
+        } else if (i + 1 < argc && (strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "-U") == 0 ||
+                                    strcmp(argv[i], "-F") == 0 || strcmp(argv[i], "-q") == 0 ||
+                                    strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "-t") == 0 ||
+                                    strcmp(argv[i], "-L") == 0 || strcmp(argv[i], "-n") == 0 ||
+                                    strcmp(argv[i], "-W") == 0)) {
+            int value = atoi(argv[i + 1]);
+            if (value < 0) value = 0;
+            switch (argv[i++][1]) {
+                case 'j': limits.max_running = value; break;
+                case 'U': limits.max_per_user = value; break;
+                case 'F': limits.max_per_file = value; break;
+                case 'q': limits.queue_capacity = value; break;
+                case 'r': catchup_rate = value; break;
+                case 't': threads = value; break;
+                case 'L': output_capacity = (uint64_t)(value ? value : 1) << 10; break;
+                case 'n': print_runs = value; break;
+                case 'W': spread_window = value > 3600 ? 3600 : value; break;
+            }
+        } else {
+            fprintf(stderr, "Usage: %s [-f] [-z] [-s heap|wheel] [-t threads] [-j max-jobs] "
+                    "[-U max-per-user] [-F max-per-file] [-q queue-size] [-r catch-up-rate] "
+                    "[-S state-file|none] [-O output-dir|none] [-L output-log-KiB] "
+                    "[-M metrics-socket|none] [-C control-socket|none] [-W spread-seconds] "
+                    "[-J json-log-file] "
+                    "[-N node/nodes] [-D lock-dir]\n"
+                    "       %s -o command-substring [-n runs]\n"
+                    "       %s --simulate [--from time] [--to time] [--summary] [-s heap|wheel] "
+                    "[-W spread-seconds]\n"
+                    "  Limits of 0 mean unlimited (defaults: -j %d -U %d -F %d -q %d -r %d/s)\n"
+                    "  -t N schedules on N shard threads and launches on N more (default 0)\n"
+                    "  -z launches jobs from a separate launch helper process\n"
+                    "  -o prints the captured output of the last runs (default -n 5)\n"
+                    "  --simulate prints every fire from --from (default: next minute) to\n"
+                    "    --to (default: a day later) without running jobs; --summary prints\n"
+                    "    fires per day instead\n"
+                    "  -W delays each job's fires by a fixed per-job 0..N-1 s (default 0)\n"
+                    "  -J logs JSON lines to a file instead of syslog (reopened on SIGHUP)\n"
+                    "  -N runs this node's share of the jobs (e.g. 0/3); nodes share -D\n"
+                    "    (default %s) and need the same crontabs\n"
+                    "  State file default: %s, output logs: %s (%llu KiB per job), "
+                    "metrics: %s, control: %s\n",
+                    argv[0], argv[0], argv[0], limits.max_running, limits.max_per_user, limits.max_per_file,
+                    limits.queue_capacity, catchup_rate, cluster_dir, state_path, output_dir,
+                    (unsigned long long)(output_capacity >> 10), metrics_path, control_path);
+            return 1;
+        }
+    }
+
+    if (print_pattern) {
+        if (output_print(print_pattern, print_runs) > 0) return 0;
+        fprintf(stderr, "No captured output for jobs matching: %s\n", print_pattern);
+        return 1;
+    }
+
+    if (simulate) {
+        if (simulate_to < 0) simulate_to = simulate_from + 86400;
+        openlog("jcrond", LOG_PERROR, LOG_CRON);  // Crontab warnings to stderr
+        setlogmask(LOG_UPTO(LOG_WARNING));
+        if (crontab_init(sched_backend) != JCRON_OK) return 1;
+        crontab_load_all(0);
+        static char buffer[1 << 16];
+        setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+        int64_t fires = simulate_run(sched_backend, simulate_from, simulate_to, summary, stdout);
+        fflush(stdout);
+        return fires < 0 ? 1 : 0;
     }
 
     // Initialize syslog
     openlog("jcrond", LOG_PID | LOG_CONS, LOG_CRON);
+    metrics_init();
+
+    // Signals are read from a signalfd in the main loop, never delivered
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGHUP);
+    sigaddset(&signals, SIGUSR1);
+    sigaddset(&signals, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &signals, NULL);
 
-    // Setup signal handlers
-    signal(SIGTERM, signal_handler);
-    signal(SIGINT, signal_handler);
-    signal(SIGHUP, signal_handler);
+    // Before the crontabs: jobs are scheduled only once their shard is ours
+    if (cluster_nodes > 0 && cluster_start(cluster_node, cluster_nodes) != 0) return 1;
 
     // Load initial configuration
-    load_all_crontabs();
+    if (crontab_init(sched_backend) != JCRON_OK) return 1;
+    crontab_load_all(0);
+    int restored = state_load();
+    log_message(LOG_INFO, "Loaded %d cron jobs (%d with saved state)", crontab_job_count(),
+                restored > 0 ? restored : 0);
 
     if (daemon_mode) {
         log_message(LOG_INFO, "Starting JCRON daemon");
@@ -364,24 +433,146 @@ int main(int argc, char* argv[]) {
         printf("JCRON daemon starting in foreground mode\n");
     }
 
+    // The log writer is a thread: fork() in daemonize() would lose it
+    log_start();
+
+    // The helper must be our child, so it starts after daemonize() too
+    if (launch_helper) zygote_start();
+    metrics_start();
+    control_start();
+
+    // Threads only now: fork() in daemonize() keeps just the calling one.
+    // The helper does the launching if it runs.
+    if (threads > 0) {
+        shards_start(threads, sched_backend);
+        if (!zygote_running()) exec_pool_start(threads);
+    }
+
+    int signal_fd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    int timer_fd = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+    int deadline_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    int watch_fd = crontab_watch();
+    if (signal_fd < 0 || timer_fd < 0 || deadline_fd < 0 || epoll_fd < 0) {
+        log_message(LOG_ERR, "Cannot set up event loop: %s", strerror(errno));
+        return 1;
+    }
+
+    struct epoll_event event = { .events = EPOLLIN };
+    event.data.fd = signal_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, signal_fd, &event);
+    event.data.fd = timer_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &event);
+    event.data.fd = deadline_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, deadline_fd, &event);
+    int fire_fd = shard_fire_fd();
+    int complete_fd = exec_complete_fd();
+    int helper_fd = zygote_fd();
+    int capture_fd = output_fd();
+    int scrape_fd = metrics_fd();
+    int command_fd = control_fd();
+    int extra_fds[] = {watch_fd, fire_fd, complete_fd, helper_fd, capture_fd, scrape_fd,
+                       command_fd};
+    for (int i = 0; i < 7; i++) {
+        if (extra_fds[i] < 0) continue;
+        event.data.fd = extra_fds[i];
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, extra_fds[i], &event);
+    }
+
+    // Clocks at the last wake-up, to size wall clock steps
+    int64_t handled_ms = now_ms();
+    int64_t wall_ms = now_ms();
+    int64_t mono_ns = monotonic_ns();
+
     // Main loop
     while (running) {
         // Check for configuration reload
         if (reload_config) {
-            log_message(LOG_INFO, "Reloading configuration");
-            load_all_crontabs();
+            int64_t start_ns = monotonic_ns();
+            crontab_watch();
+            int changed = crontab_load_all(0);
+            log_message(LOG_INFO, "Reloaded configuration: %d files changed, %d jobs (%lld us)",
+                        changed, crontab_job_count(),
+                        (long long)((monotonic_ns() - start_ns) / 1000));
             reload_config = 0;
         }
 
-        // Check and execute jobs
-        check_jobs();
+        // Launch due jobs, then wait for the next fire or a signal
+        handled_ms = run_due_jobs();
+        if (cluster_check(handled_ms) > 0) continue;  // Taken jobs may be due
+        catchup_drain();
+        state_commit();
+        arm_next_fire(timer_fd);
+        arm_monotonic_timer(deadline_fd);
+
+        struct epoll_event events[10];
+        int n = epoll_wait(epoll_fd, events, 10, -1);
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            if (fd == signal_fd) {
+                handle_signals(signal_fd);
+                continue;
+            }
+            if (fd == watch_fd) {
+                int64_t start_ns = monotonic_ns();
+                int changed = crontab_watch_handle();
+                if (changed) {
+                    log_message(LOG_INFO, "Crontabs changed: %d files, %d jobs (%lld us)",
+                                changed, crontab_job_count(),
+                                (long long)((monotonic_ns() - start_ns) / 1000));
+                }
+                continue;
+            }
+            if (fd == helper_fd) {
+                exec_complete();  // Reads the replies itself
+                job_dispatch();
+                continue;
+            }
+            if (fd == capture_fd) {
+                output_drain();
+                continue;
+            }
+            if (fd == scrape_fd) {
+                metrics_handle();
+                continue;
+            }
+            if (fd == command_fd) {
+                control_handle();
+                continue;
+            }
 
-        // Sleep for 30 seconds (cron traditionally checks every minute)
-        sleep(30);
+            // Consume the expiration or event count; due jobs (including
+            // fires from shards) run at the loop top
+            uint64_t expirations;
+            ssize_t got = read(fd, &expirations, sizeof(expirations));
+            if (fd == deadline_fd) {
+                exec_enforce_timeouts();
+            } else if (fd == complete_fd) {
+                exec_complete();
+                job_dispatch();
+            } else if (fd == timer_fd && got < 0 && errno == ECANCELED) {
+                handle_clock_change(wall_ms, mono_ns);
+                shards_wake();
+            }
+        }
+        if (!zygote_running()) helper_fd = -1;  // Closed, so out of the epoll set
+        wall_ms = now_ms();
+        mono_ns = monotonic_ns();
     }
 
     // Cleanup
-    log_message(LOG_INFO, "JCRON daemon shutting down");
+    log_message(LOG_INFO, "JCRON daemon shutting down (%d jobs still running)",
+                exec_running());
+    exec_pool_stop();
+    zygote_stop();
+    shards_stop();
+    cluster_stop(handled_ms);
+    output_drain();
+    metrics_stop();
+    control_stop();
+    state_close();
+    counters_log();
+    log_stop();
 
     // Remove PID file
     unlink(PID_FILE);
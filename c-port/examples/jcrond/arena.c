@@ -0,0 +1,78 @@
+/**
+ * JCRON Daemon - Arenas
+ *
+ * Bump allocation from a chain of blocks that are only ever freed all at
+ * once. Each loaded crontab file keeps its job records and their strings
+ * in one arena, so loading a file costs a few mallocs instead of several
+ * per line, and replacing it frees everything in one pass.
+ *
+ * Blocks double from ARENA_FIRST_BLOCK up to ARENA_MAX_BLOCK, so a 5-line
+ * cron.d file takes one small block and a 100k-line crontab a few dozen.
+ * An arena that holds one known small thing (a control-socket job) sets
+ * first_block to fit it.
+ */
+
+#include "jcrond.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_FIRST_BLOCK 2048
+#define ARENA_MAX_BLOCK (1 << 20)
+#define ARENA_ALIGN 16
+
+struct arena_block {
+    struct arena_block* next;
+    size_t size;
+    size_t used;
+    // Data follows, aligned
+};
+
+#define BLOCK_HEADER ((sizeof(arena_block_t) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+// Uninitialized, aligned memory
+static void* arena_take(arena_t* arena, size_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    arena_block_t* block = arena->blocks;
+    if (!block || block->size - block->used < size) {
+        size_t block_size = block ? block->size * 2
+                          : arena->first_block ? arena->first_block : ARENA_FIRST_BLOCK;
+        if (block_size > ARENA_MAX_BLOCK) block_size = ARENA_MAX_BLOCK;
+        if (block_size < size) block_size = size;
+
+        arena_block_t* grown = malloc(BLOCK_HEADER + block_size);
+        if (!grown) return NULL;
+        grown->next = block;
+        grown->size = block_size;
+        grown->used = 0;
+        arena->blocks = block = grown;
+        arena->reserved += BLOCK_HEADER + block_size;
+    }
+    void* ptr = (char*)block + BLOCK_HEADER + block->used;
+    block->used += size;
+    return ptr;
+}
+
+void* arena_alloc(arena_t* arena, size_t size) {
+    void* ptr = arena_take(arena, size);
+    if (ptr) memset(ptr, 0, size);
+    return ptr;
+}
+
+char* arena_strndup(arena_t* arena, const char* s, size_t len) {
+    char* copy = arena_take(arena, len + 1);
+    if (!copy) return NULL;
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+void arena_free(arena_t* arena) {
+    for (arena_block_t* block = arena->blocks; block; ) {
+        arena_block_t* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->blocks = NULL;
+    arena->reserved = 0;
+}
@@ -0,0 +1,172 @@
+/**
+ * JCRON Daemon - Missed-Run Catch-up
+ *
+ * A fire popped more than CATCHUP_GRACE seconds after its time was missed:
+ * the daemon was down (state_load() reschedules jobs from their persisted
+ * last run), the host was suspended, or the clock jumped forward. The
+ * missed fires are counted with jcron_count() and chosen with
+ * jcron_range() / jcron_prev(), so a week of downtime costs a few field
+ * jumps per job rather than a scan of every minute. Patterns with an
+ * SOD/EOD modifier are not caught up: jcron_count() and jcron_range()
+ * reject them.
+ *
+ * Fire times include the job's spread offset: the pattern is evaluated
+ * over [first, until) moved back by the offset, and the offset is added
+ * back to each fire found.
+ *
+ * Chosen fires go through a FIFO drained by a token bucket, so a host
+ * resumed after a week does not submit thousands of jobs at once. Each
+ * drained fire then goes through job_submit() like any other.
+ */
+
+#include "jcrond.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+
+int catchup_rate = 10;  // 0 = unlimited
+
+// One fire waiting for a token
+typedef struct {
+    cron_job_t* job;
+    int64_t scheduled;
+} catchup_fire_t;
+
+// Ring buffer, oldest first
+static catchup_fire_t* fires = NULL;
+static int fire_head = 0;
+static int fire_count = 0;
+static int fire_capacity = 0;
+
+// Token bucket
+static double tokens = 0;
+static int64_t refilled_ns = 0;
+
+static int push_fire(cron_job_t* job, int64_t scheduled) {
+    if (fire_count == fire_capacity) {
+        int capacity = fire_capacity ? fire_capacity * 2 : 256;
+        catchup_fire_t* grown = malloc((size_t)capacity * sizeof(catchup_fire_t));
+        if (!grown) return -1;
+        for (int i = 0; i < fire_count; i++) {
+            grown[i] = fires[(fire_head + i) % fire_capacity];
+        }
+        free(fires);
+        fires = grown;
+        fire_head = 0;
+        fire_capacity = capacity;
+    }
+    fires[(fire_head + fire_count) % fire_capacity] = (catchup_fire_t){job, scheduled};
+    fire_count++;
+    job->catchup_queued++;
+    return 0;
+}
+
+void catchup_missed(cron_job_t* job, int64_t first, int64_t until) {
+    const jcron_pattern_t* pattern = &job_table.patterns[job->slot];
+    int64_t spread = job->spread;
+    first -= spread;
+    until -= spread;
+
+    int64_t missed = 0;
+    jcron_count(first, until, pattern, &missed);
+    if (missed <= 0) return;
+
+    jcron_result_t last;
+    if (jcron_prev(until, pattern, &last) != JCRON_OK) return;
+    job->last_run = (time_t)(last.prev_time + spread);
+    state_record_fire(job);
+    counters.catchup_missed += (uint64_t)missed;
+
+    // Chosen fires, oldest first
+    int64_t chosen[1000];
+    int n = 0;
+
+    switch (job->options.catchup) {
+        case CATCHUP_SKIP:
+            break;
+        case CATCHUP_ONCE:
+            chosen[n++] = last.prev_time;
+            break;
+        case CATCHUP_ALL: {
+            int max = job->options.catchup_max;
+            if (missed <= max) {
+                jcron_range(first, until, pattern, chosen, max, &n);
+            } else {
+                // Most recent `max`, walking back from the last one
+                n = max;
+                chosen[n - 1] = last.prev_time;
+                for (int i = n - 2; i >= 0; i--) {
+                    jcron_result_t prev;
+                    if (jcron_prev(chosen[i + 1], pattern, &prev) != JCRON_OK) {
+                        memmove(chosen, chosen + i + 1, (size_t)(n - i - 1) * sizeof(int64_t));
+                        n -= i + 1;
+                        break;
+                    }
+                    chosen[i] = prev.prev_time;
+                }
+            }
+            break;
+        }
+    }
+
+    int queued = 0;
+    for (int i = 0; i < n; i++) {
+        if (push_fire(job, chosen[i] + spread) == 0) queued++;
+    }
+    counters.catchup_queued += (uint64_t)queued;
+    counters.catchup_skipped += (uint64_t)(missed - queued);
+
+    log_message(LOG_INFO, "Missed %lld runs of %s (%s), catching up %d",
+                (long long)missed, job->command, job->schedule, queued);
+}
+
+static void refill(int64_t now) {
+    if (refilled_ns == 0) {
+        tokens = catchup_rate;
+    } else {
+        tokens += (double)(now - refilled_ns) * catchup_rate / 1e9;
+        if (tokens > catchup_rate) tokens = catchup_rate;
+    }
+    refilled_ns = now;
+}
+
+void catchup_drain(void) {
+    if (fire_count == 0) return;
+
+    refill(monotonic_ns());
+    while (fire_count > 0 && (catchup_rate <= 0 || tokens >= 1)) {
+        catchup_fire_t fire = fires[fire_head];
+        fire_head = (fire_head + 1) % fire_capacity;
+        fire_count--;
+        tokens -= 1;
+        fire.job->catchup_queued--;
+        job_submit(fire.job, fire.scheduled);
+    }
+}
+
+int64_t catchup_next_ns(void) {
+    if (fire_count == 0) return -1;
+    if (tokens >= 1 || catchup_rate <= 0) return refilled_ns;
+    return refilled_ns + (int64_t)((1 - tokens) * 1e9 / catchup_rate) + 1;
+}
+
+void catchup_move(const cron_job_t* from, cron_job_t* to) {
+    if (from->catchup_queued == 0) return;
+    for (int i = 0; i < fire_count; i++) {
+        catchup_fire_t* fire = &fires[(fire_head + i) % fire_capacity];
+        if (fire->job == from) fire->job = to;
+    }
+}
+
+void catchup_forget(cron_job_t* job) {
+    if (job->catchup_queued == 0) return;
+
+    int kept = 0;
+    for (int i = 0; i < fire_count; i++) {
+        catchup_fire_t fire = fires[(fire_head + i) % fire_capacity];
+        if (fire.job != job) fires[(fire_head + kept++) % fire_capacity] = fire;
+    }
+    fire_count = kept;
+    job->catchup_queued = 0;
+}
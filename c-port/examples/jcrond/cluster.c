@@ -0,0 +1,304 @@
+/**
+ * JCRON Daemon - Multi-node Ownership
+ *
+ * jcrond -N node/nodes -D lock-dir splits the jobs of identical crontabs
+ * across several daemons without firing any job twice. Jobs fall into
+ * CLUSTER_SHARDS shards by their key (file path and line, the same on
+ * every node), and each shard goes to the highest-ranked live node by
+ * rendezvous hashing: a node joining or leaving moves only the shards it
+ * gains or loses, about 1/nodes of them.
+ *
+ * Ownership is kept in the lock directory with flock(), which the kernel
+ * (or the NFS lock manager) releases when a process dies:
+ *
+ *   node-NNN    held by node NNN while it runs; others probe it to tell
+ *               which nodes are live. Holds the time the node has fired up
+ *               to (its heartbeat).
+ *   shard-NNN   held by the shard's owner; only its jobs are scheduled.
+ *               Holds the last owner, and the time it fired up to if it
+ *               let go cleanly.
+ *
+ * Every cluster_interval_ms a node probes the others, lets go of the
+ * shards a better live node should have, and takes the ones that are now
+ * its own and free. A new owner schedules the shard's jobs from where the
+ * last one stopped, so a handover neither repeats nor drops fires; after
+ * a crash, fires since the dead node's last heartbeat go through catch-up.
+ * A dead node's shards are taken within one interval; shards handed over
+ * by a live node within about two.
+ */
+
+#include "jcrond.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <syslog.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+const char* cluster_dir = "/var/lib/jcrond/cluster";
+int cluster_interval_ms = 1000;
+
+// Record at the start of a node file
+typedef struct {
+    int64_t fired_through;   // Fires due up to here were taken (heartbeat)
+} node_record_t;
+
+// Record at the start of a shard file
+typedef struct {
+    int64_t released_through; // Fired up to here, then let go (0: held or crashed)
+    int32_t owner;           // Last owner (-1: never owned)
+    int32_t reserved;
+} shard_record_t;
+
+static int started = 0;
+static int self = -1;
+static int node_count = 0;
+static int node_fds[CLUSTER_MAX_NODES];
+static int shard_fds[CLUSTER_SHARDS];
+static unsigned char owned[CLUSTER_SHARDS];
+static int64_t released_through[CLUSTER_SHARDS];  // As written when let go
+static int owned_count = 0;
+static int64_t next_check_ns = 0;
+
+/* ========================================================================
+ * Placement
+ * ======================================================================== */
+
+uint32_t cluster_shard(uint64_t key) {
+    // Fibonacci hashing: the key's high bits are spread over every shard
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 56) % CLUSTER_SHARDS;
+}
+
+// Rendezvous weight of a node for a shard (splitmix64 finalizer)
+static uint64_t weight(uint32_t shard, int node) {
+    uint64_t x = ((uint64_t)shard << 32 | (uint32_t)node) + 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Highest-weight live node for a shard
+static int preferred(uint32_t shard, const unsigned char* live) {
+    int best = -1;
+    uint64_t best_weight = 0;
+    for (int node = 0; node < node_count; node++) {
+        if (!live[node]) continue;
+        uint64_t w = weight(shard, node);
+        if (best < 0 || w > best_weight) {
+            best = node;
+            best_weight = w;
+        }
+    }
+    return best;
+}
+
+/* ========================================================================
+ * Lock Files
+ * ======================================================================== */
+
+static int open_lock(const char* kind, int index) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s-%03d", cluster_dir, kind, index);
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) log_message(LOG_ERR, "Cannot open %s: %s", path, strerror(errno));
+    return fd;
+}
+
+// A node is live while it holds its file; the probe's own lock is let go
+// at once
+static int node_live(int node) {
+    if (node == self) return 1;
+    if (flock(node_fds[node], LOCK_EX | LOCK_NB) == 0) {
+        flock(node_fds[node], LOCK_UN);
+        return 0;
+    }
+    return errno == EWOULDBLOCK;
+}
+
+// Where a newly taken shard's jobs are scheduled from
+static int64_t resume_time(uint32_t shard, int64_t handled) {
+    shard_record_t record = {0, -1, 0};
+    if (pread(shard_fds[shard], &record, sizeof(record), 0) != (ssize_t)sizeof(record)) {
+        return handled + 1;  // Never owned
+    }
+    if (record.released_through > 0) return record.released_through + 1;
+
+    // The last owner died holding it: resume after its last heartbeat
+    node_record_t node = {0};
+    if (record.owner >= 0 && record.owner < node_count &&
+        pread(node_fds[record.owner], &node, sizeof(node), 0) == (ssize_t)sizeof(node) &&
+        node.fired_through > 0 && node.fired_through <= handled) {
+        return node.fired_through + 1;
+    }
+    return handled + 1;
+}
+
+static void shard_write(uint32_t shard, int64_t released_through) {
+    shard_record_t record = {released_through, self, 0};
+    if (pwrite(shard_fds[shard], &record, sizeof(record), 0) != (ssize_t)sizeof(record)) {
+        log_message(LOG_WARNING, "Cannot write shard %u record: %s", shard, strerror(errno));
+    }
+}
+
+/* ========================================================================
+ * Interface
+ * ======================================================================== */
+
+int cluster_start(int node, int nodes) {
+    if (nodes < 1 || nodes > CLUSTER_MAX_NODES || node < 0 || node >= nodes) {
+        log_message(LOG_ERR, "Invalid cluster node %d/%d (at most %d nodes)", node, nodes,
+                    CLUSTER_MAX_NODES);
+        return -1;
+    }
+    self = node;
+    node_count = nodes;
+    for (int i = 0; i < nodes; i++) node_fds[i] = -1;
+    for (int i = 0; i < CLUSTER_SHARDS; i++) shard_fds[i] = -1;
+
+    for (int i = 0; i < nodes; i++) {
+        if ((node_fds[i] = open_lock("node", i)) < 0) goto fail;
+    }
+    for (int i = 0; i < CLUSTER_SHARDS; i++) {
+        if ((shard_fds[i] = open_lock("shard", i)) < 0) goto fail;
+    }
+
+    // Other nodes' probes hold it for a moment; another live node with
+    // this id holds it for good
+    int tries = 0;
+    while (flock(node_fds[self], LOCK_EX | LOCK_NB) != 0) {
+        if (errno != EWOULDBLOCK) {
+            log_message(LOG_ERR, "Cannot lock cluster node %d in %s: %s", self, cluster_dir,
+                        strerror(errno));
+            goto fail;
+        }
+        if (++tries == 100) {
+            log_message(LOG_ERR, "Cluster node %d is already running (%s)", self, cluster_dir);
+            goto fail;
+        }
+        usleep(10000);
+    }
+
+    memset(owned, 0, sizeof(owned));
+    memset(released_through, 0, sizeof(released_through));
+    owned_count = 0;
+    next_check_ns = 0;
+    started = 1;
+    log_message(LOG_INFO, "Cluster node %d of %d, lock directory %s", self, nodes, cluster_dir);
+    return 0;
+
+fail:
+    for (int i = 0; i < nodes; i++) {
+        if (node_fds[i] >= 0) close(node_fds[i]);
+    }
+    for (int i = 0; i < CLUSTER_SHARDS; i++) {
+        if (shard_fds[i] >= 0) close(shard_fds[i]);
+    }
+    return -1;
+}
+
+int cluster_owns(uint64_t key) {
+    return !started || owned[cluster_shard(key)];
+}
+
+int cluster_owns_fire(uint64_t key, int64_t when) {
+    if (!started) return 1;
+    uint32_t shard = cluster_shard(key);
+    return owned[shard] || when <= released_through[shard];
+}
+
+int cluster_owned(void) {
+    return started ? owned_count : CLUSTER_SHARDS;
+}
+
+int cluster_check(int64_t handled_ms) {
+    if (!started) return 0;
+    int64_t start_ns = monotonic_ns();
+    if (start_ns < next_check_ns) return 0;
+    next_check_ns = start_ns + (int64_t)cluster_interval_ms * 1000000;
+    int64_t handled = handled_ms / 1000;
+
+    unsigned char live[CLUSTER_MAX_NODES];
+    for (int node = 0; node < node_count; node++) live[node] = (unsigned char)node_live(node);
+
+    // Shards changing hands here, and where taken ones resume
+    static unsigned char change[CLUSTER_SHARDS];
+    static int64_t resume[CLUSTER_SHARDS];
+    int taken = 0, released = 0, waiting = 0;
+    for (uint32_t shard = 0; shard < CLUSTER_SHARDS; shard++) {
+        change[shard] = 0;
+        int mine = preferred(shard, live) == self;
+        if (mine && !owned[shard]) {
+            // Still held by the last owner until its own check lets go
+            if (flock(shard_fds[shard], LOCK_EX | LOCK_NB) != 0) {
+                waiting++;
+                continue;
+            }
+            resume[shard] = resume_time(shard, handled);
+            shard_write(shard, 0);
+            owned[shard] = 1;
+            change[shard] = 1;
+            taken++;
+        } else if (!mine && owned[shard]) {
+            owned[shard] = 0;
+            change[shard] = 1;
+            released++;
+        }
+    }
+
+    // One pass over the jobs: schedule the taken shards', drop the others
+    int moved = 0;
+    if (taken || released) {
+        for (uint32_t slot = 0; slot < job_table.high; slot++) {
+            cron_job_t* job = job_table.data[slot];
+            uint32_t shard = cluster_shard(job_table.keys[slot]);
+            if (!job || job->control || !change[shard]) continue;  // Control jobs stay put
+            if (owned[shard]) shard_schedule(job, resume[shard]);
+            else shard_unschedule(job);
+            moved++;
+        }
+    }
+
+    // Unscheduled first, then handed over with the time fired up to
+    for (uint32_t shard = 0; shard < CLUSTER_SHARDS; shard++) {
+        if (change[shard] && !owned[shard]) {
+            released_through[shard] = handled;
+            shard_write(shard, handled);
+            flock(shard_fds[shard], LOCK_UN);
+        }
+    }
+    owned_count += taken - released;
+
+    node_record_t heartbeat = {handled};
+    if (pwrite(node_fds[self], &heartbeat, sizeof(heartbeat), 0) != (ssize_t)sizeof(heartbeat)) {
+        log_message(LOG_WARNING, "Cannot write cluster heartbeat: %s", strerror(errno));
+    }
+
+    // A shard the last owner has yet to let go is tried again soon
+    if (waiting) next_check_ns = start_ns + (int64_t)cluster_interval_ms * 100000;
+
+    if (taken || released) {
+        log_message(LOG_INFO, "Cluster: took %d shards, released %d, own %d of %d "
+                    "(%d jobs moved, %lld us)", taken, released, owned_count, CLUSTER_SHARDS,
+                    moved, (long long)((monotonic_ns() - start_ns) / 1000));
+    }
+    return taken + released;
+}
+
+int64_t cluster_next_ns(void) {
+    return started ? next_check_ns : -1;
+}
+
+void cluster_stop(int64_t handled_ms) {
+    if (!started) return;
+    for (uint32_t shard = 0; shard < CLUSTER_SHARDS; shard++) {
+        if (owned[shard]) shard_write(shard, handled_ms / 1000);
+        close(shard_fds[shard]);  // Lets go of the lock
+    }
+    for (int node = 0; node < node_count; node++) close(node_fds[node]);
+    memset(owned, 0, sizeof(owned));
+    owned_count = 0;
+    started = 0;
+}
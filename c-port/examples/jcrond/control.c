@@ -0,0 +1,449 @@
+/**
+ * JCRON Daemon - Control Socket
+ *
+ * Jobs can be added, redefined, removed, paused, resumed, fired and
+ * listed at run time over a Unix socket (-C), without writing crontab
+ * files or reloading them: each operation changes one job's slot and its
+ * scheduler entry, O(log n) in the number of jobs, and leaves every other
+ * job alone.
+ *
+ * The protocol is binary and pipelined: a client writes request frames
+ * (control_request_t and the strings it announces) back to back and reads
+ * one reply per request, in order, each carrying the request's tag. A
+ * malformed frame closes the connection. Only root and the daemon's own
+ * user may connect, since a job runs as whatever user it names.
+ *
+ * Control jobs are indexed by name here; their records live in crontab.c,
+ * each in a version of its own. They are not saved: a client that wants
+ * them back after a restart adds them again.
+ *
+ * Like the metrics endpoint, the listening socket and its clients sit in
+ * an epoll set of their own; the main loop watches only control_fd().
+ */
+
+#include "jcrond.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define MAX_CLIENTS 64
+#define READ_CHUNK 65536
+
+// A client with this much unsent is not read until it catches up
+#define OUTPUT_HIGH (1 << 20)
+
+const char* control_path = "/run/jcrond.control";
+
+// A control job, by name
+typedef struct control_entry {
+    char* name;
+    uint64_t hash;
+    cron_job_t* job;
+    struct control_entry* next;  // Same bucket
+} control_entry_t;
+
+// One connection: requests read so far, replies not yet sent
+typedef struct {
+    int fd;
+    char* in;
+    size_t in_len, in_capacity;
+    char* out;
+    size_t out_len, out_sent, out_capacity;
+    uint32_t events;         // What epoll waits for
+} control_client_t;
+
+static control_entry_t** buckets = NULL;
+static uint32_t bucket_count = 0;
+static uint32_t entry_count = 0;
+
+static int listen_fd = -1;
+static int epoll_fd = -1;
+static int client_count = 0;
+
+/* ========================================================================
+ * Names
+ * ======================================================================== */
+
+static uint64_t name_hash(const char* name) {
+    uint64_t hash = 0xcbf29ce484222325ULL;  // FNV-1a
+    for (const char* p = name; *p; p++) {
+        hash = (hash ^ (unsigned char)*p) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Link to the entry for `name`, or to the NULL at the end of its bucket
+static control_entry_t** entry_link(const char* name, uint64_t hash) {
+    control_entry_t** link = &buckets[hash & (bucket_count - 1)];
+    while (*link && ((*link)->hash != hash || strcmp((*link)->name, name) != 0)) {
+        link = &(*link)->next;
+    }
+    return link;
+}
+
+static int buckets_grow(void) {
+    uint32_t count = bucket_count ? bucket_count * 2 : 1024;
+    control_entry_t** grown = calloc(count, sizeof(control_entry_t*));
+    if (!grown) return -1;
+    for (uint32_t b = 0; b < bucket_count; b++) {
+        for (control_entry_t* entry = buckets[b]; entry; ) {
+            control_entry_t* next = entry->next;
+            entry->next = grown[entry->hash & (count - 1)];
+            grown[entry->hash & (count - 1)] = entry;
+            entry = next;
+        }
+    }
+    free(buckets);
+    buckets = grown;
+    bucket_count = count;
+    return 0;
+}
+
+/* ========================================================================
+ * Requests
+ * ======================================================================== */
+
+static int reply_append(control_client_t* client, const void* data, size_t len) {
+    if (client->out_len + len > client->out_capacity) {
+        size_t capacity = client->out_capacity ? client->out_capacity : 4096;
+        while (capacity < client->out_len + len) capacity *= 2;
+        char* grown = realloc(client->out, capacity);
+        if (!grown) return -1;
+        client->out = grown;
+        client->out_capacity = capacity;
+    }
+    memcpy(client->out + client->out_len, data, len);
+    client->out_len += len;
+    return 0;
+}
+
+// One CONTROL_ENTRY reply
+static int reply_entry(control_client_t* client, const control_request_t* request,
+                       const control_entry_t* entry) {
+    const cron_job_t* job = entry->job;
+    const char* strings[4] = {entry->name, job->schedule, job->user ? job->user : "",
+                              job->command};
+    size_t lens[4];
+    size_t total = sizeof(control_reply_t);
+    for (int i = 0; i < 4; i++) total += lens[i] = strlen(strings[i]);
+
+    control_reply_t reply = {0};
+    reply.length = (uint32_t)total;
+    reply.tag = request->tag;
+    reply.op = request->op;
+    reply.status = CONTROL_ENTRY;
+    reply.paused = (uint8_t)job->paused;
+    reply.name_len = (uint16_t)lens[0];
+    reply.schedule_len = (uint16_t)lens[1];
+    reply.user_len = (uint16_t)lens[2];
+    reply.command_len = (uint32_t)lens[3];
+    reply.last_run = job->last_run;
+    // As sched_set_next() finds it
+    jcron_result_t next;
+    int64_t first = (now_ms() / 1000 - job->spread + 59) / 60 * 60;
+    if (!job->paused && jcron_next(first, &job_table.patterns[job->slot], &next) == JCRON_OK) {
+        reply.next_fire = next.next_time + job->spread;
+    }
+
+    if (reply_append(client, &reply, sizeof(reply)) != 0) return -1;
+    for (int i = 0; i < 4; i++) {
+        if (reply_append(client, strings[i], lens[i]) != 0) return -1;
+    }
+    return 0;
+}
+
+static control_status_t apply(control_client_t* client, const control_request_t* request,
+                              const char* name, const char* schedule, const char* user,
+                              const char* command) {
+    uint64_t hash = name_hash(name);
+    control_entry_t** link = bucket_count ? entry_link(name, hash) : NULL;
+    control_entry_t* entry = link ? *link : NULL;
+
+    switch (request->op) {
+        case CONTROL_ADD: {
+            if (entry) return CONTROL_ERR_EXISTS;
+            if (entry_count >= bucket_count) {
+                if (buckets_grow() != 0) return CONTROL_ERR_NO_MEMORY;
+            }
+            entry = calloc(1, sizeof(control_entry_t));
+            if (!entry || !(entry->name = strdup(name))) {
+                free(entry);
+                return CONTROL_ERR_NO_MEMORY;
+            }
+            int ret = crontab_job_define(name, schedule, *user ? user : NULL, command, NULL,
+                                         &entry->job);
+            if (ret != JCRON_OK) {
+                free(entry->name);
+                free(entry);
+                return ret == JCRON_ERR_NO_MEMORY ? CONTROL_ERR_NO_MEMORY : CONTROL_ERR_INVALID;
+            }
+            entry->hash = hash;
+            link = &buckets[hash & (bucket_count - 1)];
+            entry->next = *link;
+            *link = entry;
+            entry_count++;
+            return CONTROL_OK;
+        }
+        case CONTROL_LIST:
+            for (uint32_t b = 0; b < bucket_count; b++) {
+                for (control_entry_t* e = buckets[b]; e; e = e->next) {
+                    if (reply_entry(client, request, e) != 0) return CONTROL_ERR_NO_MEMORY;
+                }
+            }
+            return CONTROL_OK;
+    }
+
+    if (!entry) return CONTROL_ERR_NOT_FOUND;
+    cron_job_t* job = entry->job;
+    switch (request->op) {
+        case CONTROL_UPDATE: {
+            int ret = crontab_job_define(name, schedule, *user ? user : NULL, command, job,
+                                         &entry->job);
+            if (ret == JCRON_OK) return CONTROL_OK;
+            return ret == JCRON_ERR_NO_MEMORY ? CONTROL_ERR_NO_MEMORY : CONTROL_ERR_INVALID;
+        }
+        case CONTROL_REMOVE:
+            crontab_job_remove(job);
+            *link = entry->next;
+            free(entry->name);
+            free(entry);
+            entry_count--;
+            return CONTROL_OK;
+        case CONTROL_PAUSE:
+            job->paused = 1;
+            shard_unschedule(job);
+            return CONTROL_OK;
+        case CONTROL_RESUME:
+            if (job->paused) {
+                job->paused = 0;
+                shard_schedule(job, (now_ms() / 60000 + 1) * 60);
+            }
+            return CONTROL_OK;
+        case CONTROL_RUN:
+            job_submit(job, now_ms() / 1000);
+            return CONTROL_OK;
+    }
+    return CONTROL_ERR_INVALID;
+}
+
+// Answer one complete frame; -1 if it is malformed (or out of memory)
+static int handle_frame(control_client_t* client, const char* frame) {
+    control_request_t request;
+    memcpy(&request, frame, sizeof(request));
+    const char* strings = frame + sizeof(request);
+    size_t lens[4] = {request.name_len, request.schedule_len, request.user_len,
+                      request.command_len};
+    if ((size_t)request.length != sizeof(request) + lens[0] + lens[1] + lens[2] + lens[3] ||
+        request.op < CONTROL_ADD || request.op > CONTROL_LIST ||
+        lens[1] > CONTROL_NAME_MAX || lens[2] > CONTROL_NAME_MAX ||
+        memchr(strings, '\0', request.length - sizeof(request))) {
+        return -1;
+    }
+    int defines = request.op == CONTROL_ADD || request.op == CONTROL_UPDATE;
+
+    control_reply_t reply = {0};
+    reply.length = sizeof(reply);
+    reply.tag = request.tag;
+    reply.op = request.op;
+    if ((request.op != CONTROL_LIST && (lens[0] == 0 || lens[0] > CONTROL_NAME_MAX)) ||
+        (defines && (lens[1] == 0 || lens[3] == 0))) {
+        reply.status = CONTROL_ERR_INVALID;
+    } else {
+        // NUL-terminated copies; the frame is at most CONTROL_FRAME_MAX
+        static char buffer[CONTROL_FRAME_MAX + 4];
+        char* fields[4];
+        char* p = buffer;
+        for (int i = 0; i < 4; i++) {
+            fields[i] = p;
+            memcpy(p, strings, lens[i]);
+            p[lens[i]] = '\0';
+            p += lens[i] + 1;
+            strings += lens[i];
+        }
+        reply.status = (uint8_t)apply(client, &request, fields[0], fields[1], fields[2],
+                                      fields[3]);
+    }
+    return reply_append(client, &reply, sizeof(reply));
+}
+
+/* ========================================================================
+ * Connections
+ * ======================================================================== */
+
+static void client_close(control_client_t* client) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+    free(client->in);
+    free(client->out);
+    free(client);
+    client_count--;
+}
+
+static void client_wait_for(control_client_t* client, uint32_t events) {
+    if (client->events == events) return;
+    struct epoll_event event = {.events = events};
+    event.data.ptr = client;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, client->fd, &event);
+    client->events = events;
+}
+
+// Send what is pending; -1 if the client is gone
+static int client_flush(control_client_t* client) {
+    while (client->out_sent < client->out_len) {
+        ssize_t n = send(client->fd, client->out + client->out_sent,
+                         client->out_len - client->out_sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) return 0;
+        if (n <= 0) return -1;
+        client->out_sent += (size_t)n;
+    }
+    client->out_len = client->out_sent = 0;
+    return 0;
+}
+
+// Answer the complete frames read so far; -1 on a malformed one
+static int client_process(control_client_t* client) {
+    size_t done = 0;
+    while (client->in_len - done >= sizeof(control_request_t) &&
+           client->out_len - client->out_sent < OUTPUT_HIGH) {
+        uint32_t length;
+        memcpy(&length, client->in + done, sizeof(length));
+        if (length < sizeof(control_request_t) || length > CONTROL_FRAME_MAX) return -1;
+        if (client->in_len - done < length) break;
+        if (handle_frame(client, client->in + done) != 0) return -1;
+        done += length;
+    }
+    memmove(client->in, client->in + done, client->in_len - done);
+    client->in_len -= done;
+    return 0;
+}
+
+static void client_service(control_client_t* client) {
+    for (;;) {
+        if (client_process(client) != 0 || client_flush(client) != 0) {
+            client_close(client);
+            return;
+        }
+        // Replies first: read more once the client takes them
+        if (client->out_len - client->out_sent >= OUTPUT_HIGH) {
+            client_wait_for(client, EPOLLOUT);
+            return;
+        }
+
+        if (client->in_capacity - client->in_len < READ_CHUNK) {
+            size_t capacity = client->in_len + READ_CHUNK;
+            char* grown = realloc(client->in, capacity);
+            if (!grown) {
+                client_close(client);
+                return;
+            }
+            client->in = grown;
+            client->in_capacity = capacity;
+        }
+        ssize_t n = read(client->fd, client->in + client->in_len,
+                         client->in_capacity - client->in_len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) {
+            client_wait_for(client, client->out_sent < client->out_len ? EPOLLIN | EPOLLOUT
+                                                                      : EPOLLIN);
+            return;
+        }
+        if (n <= 0) {
+            client_close(client);  // Replies to a closed client are dropped
+            return;
+        }
+        client->in_len += (size_t)n;
+    }
+}
+
+static void client_accept(void) {
+    int fd;
+    while ((fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        struct ucred peer = {0, (uid_t)-1, (gid_t)-1};
+        socklen_t len = sizeof(peer);
+        if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &peer, &len) != 0 ||
+            (peer.uid != 0 && peer.uid != geteuid())) {
+            log_message(LOG_WARNING, "Control connection refused for uid %d", (int)peer.uid);
+            close(fd);
+            continue;
+        }
+        control_client_t* client = client_count < MAX_CLIENTS
+                                 ? calloc(1, sizeof(control_client_t)) : NULL;
+        if (!client) {
+            close(fd);
+            continue;
+        }
+        client->fd = fd;
+        client->events = EPOLLIN;
+        client_count++;
+        struct epoll_event event = {.events = EPOLLIN};
+        event.data.ptr = client;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    }
+}
+
+/* ========================================================================
+ * Interface
+ * ======================================================================== */
+
+int control_start(void) {
+    if (!control_path || listen_fd >= 0) return 0;
+
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    if (strlen(control_path) >= sizeof(addr.sun_path)) {
+        log_message(LOG_ERR, "Control socket path too long: %s", control_path);
+        return -1;
+    }
+    strcpy(addr.sun_path, control_path);
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    unlink(control_path);
+    if (listen_fd < 0 || epoll_fd < 0 ||
+        bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        chmod(control_path, 0600) != 0 || listen(listen_fd, MAX_CLIENTS) != 0) {
+        log_message(LOG_ERR, "Cannot serve control socket on %s: %s", control_path,
+                    strerror(errno));
+        control_stop();
+        return -1;
+    }
+
+    struct epoll_event event = {.events = EPOLLIN};
+    event.data.ptr = NULL;  // The listening socket
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event);
+    return 0;
+}
+
+void control_handle(void) {
+    if (epoll_fd < 0) return;
+    struct epoll_event events[MAX_CLIENTS + 1];
+    int n = epoll_wait(epoll_fd, events, MAX_CLIENTS + 1, 0);
+    for (int i = 0; i < n; i++) {
+        control_client_t* client = events[i].data.ptr;
+        if (client) client_service(client);
+        else client_accept();
+    }
+}
+
+int control_fd(void) {
+    return epoll_fd;
+}
+
+void control_stop(void) {
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        unlink(control_path);
+    }
+    if (epoll_fd >= 0) close(epoll_fd);  // Clients still open are dropped with it
+    listen_fd = -1;
+    epoll_fd = -1;
+}
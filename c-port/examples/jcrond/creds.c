@@ -0,0 +1,184 @@
+/**
+ * JCRON Daemon - Credential Cache
+ *
+ * A job's user is looked up when its crontab is loaded, not when it fires:
+ * getpwnam() and getgrouplist() may go through NSS to nscd, LDAP or
+ * systemd, which is too slow (and too fallible) for every fire. Each user
+ * is resolved once into a record holding uid, gid, supplementary groups
+ * and the HOME, USER and LOGNAME strings of the job environment, so a
+ * launch only copies pointers and the child only makes the setgroups,
+ * setgid and setuid syscalls.
+ *
+ * Users are interned by name, like limit groups, and never freed: jobs
+ * point at their user for good. The record behind a user is replaced when
+ * /etc/passwd or /etc/group changes (checked at most once a second) and
+ * on SIGHUP; records are reference-counted, so a run still being launched
+ * keeps the one it started with.
+ */
+
+#include "jcrond.h"
+
+#include <grp.h>
+#include <limits.h>
+#include <pwd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Interned by name; chained hash table of fixed size
+#define USER_BUCKETS 1024
+
+// How often launches look at the account files
+#define CHECK_INTERVAL_NS 1000000000LL
+
+// Upper bound on supplementary groups (Linux NGROUPS_MAX)
+#define MAX_GROUPS 65536
+
+static const char* const account_files[] = {"/etc/passwd", "/etc/group"};
+
+// Identity of an account file as last seen
+typedef struct {
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+} file_stamp_t;
+
+static cred_user_t* users[USER_BUCKETS];
+static file_stamp_t stamps[2];
+static uint32_t generation = 1;      // Bumped when an account file changes
+static int64_t next_check_ns = 0;
+
+/* ========================================================================
+ * Records
+ * ======================================================================== */
+
+// Look the user up through NSS; NULL if unknown (or out of memory)
+static creds_t* creds_resolve(const char* name) {
+    struct passwd* pwd = getpwnam(name);
+    if (!pwd) return NULL;
+    uid_t uid = pwd->pw_uid;
+    gid_t gid = pwd->pw_gid;
+
+    // getpwnam's buffer is reused by the group lookup's NSS modules
+    char home[PATH_MAX];
+    snprintf(home, sizeof(home), "%s", pwd->pw_dir && *pwd->pw_dir ? pwd->pw_dir : "/");
+
+    // Only root can set groups: otherwise jobs keep the daemon's
+    gid_t stack_groups[64];
+    gid_t* groups = stack_groups;
+    int group_count = -1;
+    if (geteuid() == 0) {
+        int n = 64;
+        while (getgrouplist(name, gid, groups, &n) < 0 && n <= MAX_GROUPS) {
+            gid_t* grown = realloc(groups == stack_groups ? NULL : groups,
+                                   (size_t)n * sizeof(gid_t));
+            if (!grown) {
+                n = -1;
+                break;
+            }
+            groups = grown;
+        }
+        group_count = n < 0 || n > MAX_GROUPS ? 1 : n;
+        if (n < 0 || n > MAX_GROUPS) groups[0] = gid;  // Primary group alone
+    }
+
+    // The record, its groups and its strings in one block
+    size_t name_len = strlen(name);
+    size_t home_len = strlen(home);
+    size_t group_bytes = group_count > 0 ? (size_t)group_count * sizeof(gid_t) : 0;
+    creds_t* creds = malloc(sizeof(creds_t) + group_bytes + home_len + 6 +
+                            2 * (name_len + 9));
+    if (creds) {
+        creds->uid = uid;
+        creds->gid = gid;
+        creds->groups = (gid_t*)(creds + 1);
+        creds->group_count = group_count;
+        if (group_bytes) memcpy(creds->groups, groups, group_bytes);
+        char* strings = (char*)creds->groups + group_bytes;
+        creds->env_home = strings;
+        strings += sprintf(strings, "HOME=%s", home) + 1;
+        creds->env_user = strings;
+        strings += sprintf(strings, "USER=%s", name) + 1;
+        creds->env_logname = strings;
+        sprintf(strings, "LOGNAME=%s", name);
+        creds->refs = 1;
+    }
+    if (groups != stack_groups) free(groups);
+    return creds;
+}
+
+void creds_release(creds_t* creds) {
+    if (creds && --creds->refs == 0) free(creds);
+}
+
+/* ========================================================================
+ * Users
+ * ======================================================================== */
+
+// Bring a user's record up to the current generation
+static void user_refresh(cred_user_t* user) {
+    creds_release(user->creds);
+    user->creds = creds_resolve(user->name);
+    user->generation = generation;
+    if (!user->creds) log_message(LOG_WARNING, "Unknown user: %s", user->name);
+}
+
+cred_user_t* creds_user(const char* name) {
+    uint32_t hash = 2166136261u;  // FNV-1a
+    for (const char* p = name; *p; p++) {
+        hash = (hash ^ (unsigned char)*p) * 16777619u;
+    }
+    cred_user_t** list = &users[hash % USER_BUCKETS];
+
+    for (cred_user_t* user = *list; user; user = user->next) {
+        if (strcmp(user->name, name) == 0) return user;
+    }
+
+    if (next_check_ns == 0) creds_check();  // First user: take the files' stamps
+    cred_user_t* user = calloc(1, sizeof(cred_user_t));
+    if (!user || !(user->name = strdup(name))) {
+        free(user);
+        return NULL;
+    }
+    user_refresh(user);
+    user->next = *list;
+    *list = user;
+    return user;
+}
+
+creds_t* creds_get(cred_user_t* user) {
+    if (monotonic_ns() >= next_check_ns) creds_check();
+    if (user->generation != generation) user_refresh(user);
+    if (user->creds) user->creds->refs++;
+    return user->creds;
+}
+
+int creds_check(void) {
+    next_check_ns = monotonic_ns() + CHECK_INTERVAL_NS;
+
+    int changed = 0;
+    for (int i = 0; i < 2; i++) {
+        struct stat st;
+        file_stamp_t stamp = {0, 0, -1, {0, 0}};
+        if (stat(account_files[i], &st) == 0) {
+            stamp = (file_stamp_t){st.st_dev, st.st_ino, st.st_size, st.st_mtim};
+        }
+        if (stamp.dev != stamps[i].dev || stamp.ino != stamps[i].ino ||
+            stamp.size != stamps[i].size || stamp.mtime.tv_sec != stamps[i].mtime.tv_sec ||
+            stamp.mtime.tv_nsec != stamps[i].mtime.tv_nsec) {
+            stamps[i] = stamp;
+            changed = 1;
+        }
+    }
+    // Users are looked up again at their next launch
+    if (changed) generation++;
+    return changed;
+}
+
+void creds_invalidate(void) {
+    generation++;
+}
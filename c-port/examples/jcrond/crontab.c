@@ -0,0 +1,1018 @@
+/**
+ * JCRON Daemon - Crontab Loading and Incremental Reload
+ *
+ * Jobs are grouped by the file they came from. Reloading a file parses it
+ * again and diffs the result against the live jobs by line key: unchanged
+ * lines keep their job (run state, counters, scheduler slot and pending
+ * fire), new lines get a slot and a first fire, and vanished lines are
+ * unscheduled. inotify reports which files changed, so a reload costs
+ * O(changed files) instead of O(all crontabs).
+ *
+ * A file is mmap'd and tokenized in place. Its job records and strings
+ * are allocated from one arena per version of the file: a reload parses
+ * into a new arena, moves the state of unchanged jobs into their new
+ * records, and frees the old arena whole once no run still uses it.
+ *
+ * Launches are prepared here too: NAME=value lines are compiled into one
+ * environment shared by the jobs below them, and a command without shell
+ * syntax is split into argv, so it is exec'd directly instead of through
+ * /bin/sh -c. Users are resolved here too, through the credential cache
+ * (creds.c). A fire only copies pointers.
+ *
+ * Patterns live in job_table, a structure-of-arrays table indexed by the
+ * job's slot (which is also its scheduler slot). A line gets a slot when
+ * it is parsed; an unchanged line hands it back and keeps its live one.
+ *
+ * Jobs added over the control socket (control.c) live here too, each in a
+ * version of its own that belongs to no file.
+ */
+
+#include "jcrond.h"
+
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+jcrond_paths_t crontab_paths = {
+    "/etc/crontab",
+    "/etc/cron.d",
+    "/var/spool/cron/crontabs"
+};
+
+jcron_sched_t job_sched;
+jcron_table_t job_table;
+int spread_window = 0;
+
+// One loaded crontab file
+typedef struct crontab_file {
+    char* path;
+    char* owner;         // Spool owner; NULL for system files (user column)
+    cron_job_t* jobs;    // In file order
+    int job_count;
+    crontab_version_t* version;  // Holds jobs and their strings
+    dev_t dev;           // Identity of the version that was read
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+    int seen;            // Mark for crontab_load_all() sweeps
+    uint64_t hash;
+    struct crontab_file* hash_next;
+    struct crontab_file* prev;
+    struct crontab_file* next;
+} crontab_file_t;
+
+static crontab_file_t* files = NULL;
+static crontab_file_t** file_buckets = NULL;
+static uint32_t file_bucket_count = 0;
+static uint32_t file_count = 0;
+
+static int job_count = 0;            // Attached jobs (job_table also holds parsed ones)
+
+/* ========================================================================
+ * Keys
+ * ======================================================================== */
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME  0x100000001b3ULL
+
+static uint64_t fnv1a(uint64_t hash, const char* s) {
+    while (*s) {
+        hash ^= (unsigned char)*s++;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static uint64_t fnv1a_span(uint64_t hash, const char* s, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)s[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/* ========================================================================
+ * Parsing
+ * ======================================================================== */
+
+// Next whitespace-separated word of [*p, end), or NULL at the end
+static const char* next_word(const char** p, const char* end, size_t* len) {
+    const char* s = *p;
+    while (s < end && (*s == ' ' || *s == '\t')) s++;
+    if (s == end) return NULL;
+    const char* e = s;
+    while (e < end && *e != ' ' && *e != '\t') e++;
+    *p = e;
+    *len = (size_t)(e - s);
+    return s;
+}
+
+// How split_command() sees each byte: part of a word, a separator, or
+// shell syntax (CR too, from a DOS line end)
+enum { CHAR_WORD = 0, CHAR_BLANK, CHAR_SHELL };
+static const unsigned char char_class[256] = {
+    [' '] = CHAR_BLANK, ['\t'] = CHAR_BLANK,
+    ['|'] = CHAR_SHELL, ['&'] = CHAR_SHELL, [';'] = CHAR_SHELL, ['<'] = CHAR_SHELL,
+    ['>'] = CHAR_SHELL, ['('] = CHAR_SHELL, [')'] = CHAR_SHELL, ['$'] = CHAR_SHELL,
+    ['`'] = CHAR_SHELL, ['\\'] = CHAR_SHELL, ['"'] = CHAR_SHELL, ['\''] = CHAR_SHELL,
+    ['*'] = CHAR_SHELL, ['?'] = CHAR_SHELL, ['['] = CHAR_SHELL, [']'] = CHAR_SHELL,
+    ['{'] = CHAR_SHELL, ['}'] = CHAR_SHELL, ['#'] = CHAR_SHELL, ['~'] = CHAR_SHELL,
+    ['!'] = CHAR_SHELL, ['%'] = CHAR_SHELL, ['\r'] = CHAR_SHELL, ['\n'] = CHAR_SHELL
+};
+
+// Shell keywords and builtins with no program of the same name
+static const char* const shell_words[] = {
+    ".", ":", "alias", "bg", "break", "case", "cd", "command", "continue", "do", "done",
+    "elif", "else", "esac", "eval", "exec", "exit", "export", "fc", "fg", "fi", "for",
+    "getopts", "hash", "if", "in", "jobs", "local", "read", "readonly", "return", "set",
+    "shift", "source", "then", "times", "trap", "type", "ulimit", "umask", "unalias",
+    "unset", "until", "wait", "while", NULL
+};
+
+// Split a command into argv (in `arena`) if it can be exec'd without the
+// shell: no shell syntax, no assignment or builtin as its first word, and
+// at most JOB_ARGV_MAX words. NULL otherwise (or when out of memory).
+static char** split_command(arena_t* arena, const char* command) {
+    // One pass: syntax check and word boundaries
+    uint32_t starts[JOB_ARGV_MAX], ends[JOB_ARGV_MAX];
+    int argc = 0, in_word = 0;
+    uint32_t len = 0;
+    for (; command[len]; len++) {
+        int class = char_class[(unsigned char)command[len]];
+        if (class == CHAR_SHELL) return NULL;
+        if (class == CHAR_WORD && !in_word) {
+            if (argc == JOB_ARGV_MAX) return NULL;
+            starts[argc] = len;
+            in_word = 1;
+        } else if (class == CHAR_BLANK && in_word) {
+            ends[argc++] = len;
+            in_word = 0;
+        }
+    }
+    if (in_word) ends[argc++] = len;
+    if (argc == 0) return NULL;
+
+    const char* first = command + starts[0];
+    size_t first_len = ends[0] - starts[0];
+    if (memchr(first, '=', first_len)) return NULL;
+    if ((*first >= 'a' && *first <= 'z') || *first == '.' || *first == ':') {
+        for (int i = 0; shell_words[i]; i++) {
+            if (strncmp(shell_words[i], first, first_len) == 0 &&
+                shell_words[i][first_len] == '\0') return NULL;
+        }
+    }
+
+    // The pointers, then one copy of the words, NUL-terminated in place
+    char** argv = arena_alloc(arena, (size_t)(argc + 1) * sizeof(char*) + len + 1);
+    if (!argv) return NULL;
+    char* words = (char*)(argv + argc + 1);
+    memcpy(words, command, len);
+    for (int i = 0; i < argc; i++) {
+        argv[i] = words + starts[i];
+        words[ends[i]] = '\0';
+    }
+    return argv;
+}
+
+// A NAME=value line, as read so far in a file
+typedef struct {
+    const char* name;
+    size_t name_len;
+    const char* value;
+    size_t value_len;
+} env_var_t;
+
+// Parse [line, end) as NAME=value (spaces around '=' and quotes around the
+// value are dropped) into `vars`, replacing an earlier value of NAME.
+// Returns 0 if the line is not an assignment.
+static int parse_env_line(const char* line, const char* end, env_var_t* vars, int* count,
+                          const char* path) {
+    const char* p = line;
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    const char* name = p;
+    if (p == end || !(isalpha((unsigned char)*p) || *p == '_')) return 0;
+    while (p < end && (isalnum((unsigned char)*p) || *p == '_')) p++;
+    size_t name_len = (size_t)(p - name);
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    if (p == end || *p != '=') return 0;
+
+    const char* value = p + 1;
+    while (value < end && (*value == ' ' || *value == '\t')) value++;
+    const char* value_end = end;
+    while (value_end > value && isspace((unsigned char)value_end[-1])) value_end--;
+    if (value_end - value >= 2 && (*value == '"' || *value == '\'') && value_end[-1] == *value) {
+        value++;
+        value_end--;
+    }
+
+    // Set from the job's user at each launch
+    if ((name_len == 4 && memcmp(name, "USER", 4) == 0) ||
+        (name_len == 7 && memcmp(name, "LOGNAME", 7) == 0)) {
+        log_message(LOG_WARNING, "Ignoring %.*s in %s: set from the job's user",
+                    (int)name_len, name, path);
+        return 1;
+    }
+
+    int i = 0;
+    while (i < *count && !(vars[i].name_len == name_len &&
+                           memcmp(vars[i].name, name, name_len) == 0)) {
+        i++;
+    }
+    if (i == JOB_ENV_MAX) {
+        log_message(LOG_WARNING, "Too many variables in %s, ignoring %.*s", path,
+                    (int)name_len, name);
+        return 1;
+    }
+    vars[i] = (env_var_t){name, name_len, value, (size_t)(value_end - value)};
+    if (i == *count) (*count)++;
+    return 1;
+}
+
+// Compile the variables into an environment in `arena`; NULL when out of memory
+static const job_env_t* env_compile(arena_t* arena, const env_var_t* vars, int count) {
+    job_env_t* env = arena_alloc(arena, sizeof(job_env_t));
+    char** envp = arena_alloc(arena, (size_t)(count + 1) * sizeof(char*));
+    if (!env || !envp) return NULL;
+
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        const env_var_t* var = &vars[i];
+        int is_shell = var->name_len == 5 && memcmp(var->name, "SHELL", 5) == 0;
+        int is_home = var->name_len == 4 && memcmp(var->name, "HOME", 4) == 0;
+        if ((is_shell || is_home) && var->value_len == 0) continue;  // Keep the default
+
+        char* entry = arena_alloc(arena, var->name_len + var->value_len + 2);
+        if (!entry) return NULL;
+        memcpy(entry, var->name, var->name_len);
+        entry[var->name_len] = '=';
+        memcpy(entry + var->name_len + 1, var->value, var->value_len);
+        envp[n++] = entry;
+
+        if (is_shell) env->shell = entry + 6;
+        if (is_home) env->home = entry + 5;
+        if (var->name_len == 4 && memcmp(var->name, "PATH", 4) == 0) env->has_path = 1;
+    }
+    envp[n] = NULL;
+    env->envp = envp;
+    env->count = n;
+    return env;
+}
+
+// Parse the crontab line [line, end) into `job` (key already set), with
+// its strings in `arena` and its pattern in a new job_table slot (not yet
+// attached); system files have a user column after the schedule. "H"
+// fields are resolved from job->key.
+static int parse_crontab_line(const char* line, const char* end, int has_user,
+                              arena_t* arena, cron_job_t* job) {
+    // Skip comments and empty lines
+    const char* p = line;
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    if (p == end || *p == '#') return 0;
+
+    // Schedule: 5 fields (min hour day month weekday), parsed where they lie
+    jcron_span_t fields[5];
+    for (int field = 0; field < 5; field++) {
+        fields[field].start = next_word(&p, end, &fields[field].len);
+        if (!fields[field].start) return -1;
+    }
+
+    const char* user = NULL;
+    size_t user_len = 0;
+    if (has_user && !(user = next_word(&p, end, &user_len))) return -1;
+
+    // The command is the rest of the line
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    if (p == end) return -1;
+
+    // Parse the schedule
+    jcron_pattern_t pattern;
+    if (jcron_parse_fields(fields, JCRON_FIELDS_5, job->key, &pattern) != JCRON_OK) {
+        return -1;
+    }
+
+    // As written, from the first field to the last
+    size_t schedule_len = (size_t)(fields[4].start + fields[4].len - fields[0].start);
+    job->schedule = arena_strndup(arena, fields[0].start, schedule_len);
+    job->command = arena_strndup(arena, p, (size_t)(end - p));
+    job->user = user ? arena_strndup(arena, user, user_len) : NULL;
+    if (!job->schedule || !job->command || (user && !job->user)) return -2;
+    if (jcron_table_insert(&job_table, &pattern, job->key, NULL, &job->slot) != JCRON_OK) {
+        return -2;
+    }
+    return 1;
+}
+
+// Parse a whole file into a job list (file order) allocated from the version's arena
+static cron_job_t* read_crontab_file(const crontab_file_t* file, crontab_version_t* version,
+                                     int* count) {
+    *count = 0;
+    int fd = open(file->path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        log_message(LOG_WARNING, "Cannot open crontab file: %s", file->path);
+        if (fd >= 0) close(fd);
+        return NULL;
+    }
+
+    // Tokenized in place: nothing is copied but the strings a job keeps
+    size_t size = (size_t)st.st_size;
+    const char* data = NULL;
+    if (size > 0) {
+        data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            log_message(LOG_WARNING, "Cannot map crontab file %s: %s", file->path,
+                        strerror(errno));
+            close(fd);
+            return NULL;
+        }
+        madvise((void*)data, size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    arena_t* arena = &version->arena;
+    cron_job_t* head = NULL;
+    cron_job_t** tail = &head;
+    uint64_t path_hash = fnv1a(FNV_OFFSET, file->path);
+    job_options_t options = {0};
+    env_var_t vars[JOB_ENV_MAX];
+    int var_count = 0;
+    const job_env_t* env = NULL;     // Compiled from vars for the next job that needs it
+    int env_stale = 0;
+    char* owner = NULL;
+    limit_group_t* user_group = NULL;
+    cred_user_t* creds = NULL;
+    limit_group_t* file_group = limit_group_file(file->path);
+    cron_job_t* job = NULL;
+
+    const char* line = data;
+    while (line && line < data + size) {
+        const char* eol = memchr(line, '\n', (size_t)(data + size - line));
+        if (!eol) eol = data + size;
+        const char* next = eol + 1;
+
+        // JCRON_* settings apply to the jobs that follow in this file
+        const char* p = line;
+        while (p < eol && (*p == ' ' || *p == '\t')) p++;
+        if (eol - p > 6 && memcmp(p, "JCRON_", 6) == 0) {
+            char setting[256];
+            size_t len = (size_t)(eol - line) < sizeof(setting) - 1
+                       ? (size_t)(eol - line) : sizeof(setting) - 1;
+            memcpy(setting, line, len);
+            setting[len] = '\0';
+            if (job_options_parse(setting, &options)) {
+                line = next;
+                continue;
+            }
+        }
+        // NAME=value lines set the environment of the jobs that follow
+        if (parse_env_line(line, eol, vars, &var_count, file->path)) {
+            env_stale = 1;
+            line = next;
+            continue;
+        }
+
+        // A line that is not a job leaves its record for the next one
+        if (!job && !(job = arena_alloc(arena, sizeof(cron_job_t)))) break;
+        job->key = fnv1a_span(path_hash, line, (size_t)(eol - line));
+
+        int result = parse_crontab_line(line, eol, file->owner == NULL, arena, job);
+        if (result != 1) {
+            if (result == -1) {
+                log_message(LOG_WARNING, "Invalid line in %s: %.*s", file->path,
+                            (int)(eol - line), line);
+            }
+            if (result == -2) break;
+            memset(job, 0, sizeof(cron_job_t));
+            line = next;
+            continue;
+        }
+
+        if (!job->user && file->owner) {
+            if (!owner && !(owner = arena_strndup(arena, file->owner, strlen(file->owner)))) {
+                jcron_table_remove(&job_table, job->slot);
+                break;
+            }
+            job->user = owner;
+        }
+        if (env_stale) {
+            if (!(env = env_compile(arena, vars, var_count))) {
+                jcron_table_remove(&job_table, job->slot);
+                break;
+            }
+            env_stale = 0;
+        }
+        job->env = env;
+        job->version = version;
+        if (!env || !env->shell || strcmp(env->shell, "/bin/sh") == 0) {
+            job->argv = split_command(arena, job->command);  // NULL: through the shell
+        }
+        job->options = options;
+        if (spread_window > 0) {
+            job->spread = (int32_t)((job->key >> 32) % (uint64_t)spread_window);
+        }
+        // Consecutive lines are usually for the same user
+        const char* user = job->user ? job->user : "root";
+        if (!user_group || strcmp(user, user_group->name) != 0) {
+            user_group = limit_group_user(user);
+        }
+        if (job->user && (!creds || strcmp(job->user, creds->name) != 0)) {
+            creds = creds_user(job->user);
+        }
+        job->creds = job->user ? creds : NULL;
+        job->user_group = user_group;
+        job->file_group = file_group;
+
+        *tail = job;
+        tail = &job->next;
+        (*count)++;
+        job = NULL;
+        line = next;
+    }
+    if (line && line < data + size) {
+        log_message(LOG_ERR, "Out of memory loading %s, %d jobs loaded", file->path, *count);
+    }
+
+    if (data) munmap((void*)data, size);
+    return head;
+}
+
+/* ========================================================================
+ * Job Table
+ * ======================================================================== */
+
+// Make a new job's slot live and queue its first fire after the current minute
+static void job_attach(cron_job_t* job) {
+    job_table.data[job->slot] = job;
+    job_count++;
+
+    int64_t next_minute = (now_ms() / 60000 + 1) * 60;
+    int ret = shard_schedule(job, next_minute);
+    if (ret == JCRON_ERR_NO_MATCH) {
+        log_message(LOG_WARNING, "Job never fires, not scheduled: %s", job->schedule);
+    } else if (ret != JCRON_OK) {
+        log_message(LOG_ERR, "Cannot schedule job: %s", job->schedule);
+    }
+}
+
+// Unschedule a job; its live runs finish unattached. Its record goes with
+// the file's arena.
+static void job_retire(cron_job_t* job) {
+    state_forget(job);
+    job_queue_forget(job);
+    catchup_forget(job);
+    exec_detach_job(job);
+    shard_unschedule(job);
+    jcron_table_remove(&job_table, job->slot);
+    job_count--;
+}
+
+// Carry an unchanged job's state into its record from the new arena; the
+// slot parsed for the record is given back
+static void job_move(cron_job_t* live, cron_job_t* job) {
+    jcron_table_remove(&job_table, job->slot);
+
+    // Strings and settings above the line come from the new version
+    cron_job_t moved = *live;
+    moved.schedule = job->schedule;
+    moved.command = job->command;
+    moved.argv = job->argv;
+    moved.env = job->env;
+    moved.version = job->version;
+    moved.user = job->user;
+    moved.creds = job->creds;
+    moved.options = job->options;
+    moved.next = NULL;
+    *job = moved;
+
+    job_table.data[job->slot] = job;
+    if (live->running) exec_move_job(live, job);
+    if (live->queued) job_queue_move(live, job);
+    if (live->catchup_queued) catchup_move(live, job);
+}
+
+cron_job_t* crontab_job(uint32_t slot) {
+    return slot < job_table.high ? job_table.data[slot] : NULL;
+}
+
+int crontab_job_count(void) {
+    return job_count;
+}
+
+uint32_t crontab_slot_limit(void) {
+    return job_table.high;
+}
+
+/* ========================================================================
+ * Control Jobs
+ * ======================================================================== */
+
+// Give a redefined job the run state of the record it replaces, then drop
+// the old record's slot and version
+static void job_replace(cron_job_t* live, cron_job_t* job) {
+    job->last_run = live->last_run;
+    job->last_status = live->last_status;
+    job->last_duration_ms = live->last_duration_ms;
+    job->running = live->running;
+    job->queued = live->queued;
+    job->catchup_queued = live->catchup_queued;
+    job->state_record = live->state_record;
+    job->held_fire = live->held_fire;
+    job->paused = live->paused;
+    if (live->running) exec_move_job(live, job);
+    if (live->queued) job_queue_move(live, job);
+    if (live->catchup_queued) catchup_move(live, job);
+
+    shard_unschedule(live);
+    jcron_table_remove(&job_table, live->slot);
+    job_count--;
+    crontab_version_release(live->version);
+}
+
+int crontab_job_define(const char* name, const char* schedule, const char* user,
+                       const char* command, cron_job_t* live, cron_job_t** out) {
+    crontab_version_t* version = calloc(1, sizeof(crontab_version_t));
+    if (!version) return JCRON_ERR_NO_MEMORY;
+    version->refs = 1;
+    arena_t* arena = &version->arena;
+    // Record, strings and argv in one block (a second one if argv is long)
+    arena->first_block = sizeof(cron_job_t) + 256 +
+                         2 * (strlen(schedule) + (user ? strlen(user) : 0) + strlen(command));
+    cron_job_t* job = arena_alloc(arena, sizeof(cron_job_t));
+    if (!job) {
+        crontab_version_release(version);
+        return JCRON_ERR_NO_MEMORY;
+    }
+
+    // No file path starts with "control:"
+    job->key = fnv1a(fnv1a(FNV_OFFSET, "control:"), name);
+
+    // Exactly five fields
+    const char* p = schedule;
+    const char* end = schedule + strlen(schedule);
+    jcron_span_t fields[5] = {{0}};
+    size_t rest;
+    jcron_pattern_t pattern;
+    for (int field = 0; field < 5; field++) {
+        fields[field].start = next_word(&p, end, &fields[field].len);
+        if (!fields[field].start) break;
+    }
+    if (!fields[4].start || next_word(&p, end, &rest) ||
+        jcron_parse_fields(fields, JCRON_FIELDS_5, job->key, &pattern) != JCRON_OK) {
+        crontab_version_release(version);
+        return JCRON_ERR_INVALID_PATTERN;
+    }
+
+    size_t schedule_len = (size_t)(fields[4].start + fields[4].len - fields[0].start);
+    job->schedule = arena_strndup(arena, fields[0].start, schedule_len);
+    job->command = arena_strndup(arena, command, strlen(command));
+    job->user = user ? arena_strndup(arena, user, strlen(user)) : NULL;
+    if (!job->schedule || !job->command || (user && !job->user) ||
+        jcron_table_insert(&job_table, &pattern, job->key, NULL, &job->slot) != JCRON_OK) {
+        crontab_version_release(version);
+        return JCRON_ERR_NO_MEMORY;
+    }
+
+    job->argv = split_command(arena, job->command);  // NULL: through the shell
+    job->version = version;
+    job->control = 1;
+    if (spread_window > 0) {
+        job->spread = (int32_t)((job->key >> 32) % (uint64_t)spread_window);
+    }
+    job->user_group = limit_group_user(job->user ? job->user : "root");
+    job->file_group = limit_group_file("control");
+    job->creds = job->user ? creds_user(job->user) : NULL;
+
+    if (live) job_replace(live, job);
+    job_attach(job);
+    *out = job;
+    return JCRON_OK;
+}
+
+void crontab_job_remove(cron_job_t* job) {
+    crontab_version_t* version = job->version;  // Holds the record
+    job_retire(job);
+    crontab_version_release(version);
+}
+
+void crontab_schedule_from(cron_job_t* job, int64_t from) {
+    shard_schedule(job, from);
+}
+
+int crontab_init(jcron_sched_backend_t backend) {
+    // The current minute has already started; cron fires at its beginning
+    int64_t next_minute = (now_ms() / 60000 + 1) * 60;
+
+    int ret = backend == JCRON_SCHED_WHEEL
+        ? jcron_sched_init_wheel(&job_sched, 256, next_minute - 1)
+        : jcron_sched_init(&job_sched, 256);
+    if (ret == JCRON_OK) ret = jcron_table_init(&job_table, 256, 0);
+    if (ret != JCRON_OK) {
+        log_message(LOG_ERR, "Out of memory building job schedule");
+    }
+    return ret;
+}
+
+/* ========================================================================
+ * Files
+ * ======================================================================== */
+
+void crontab_version_hold(crontab_version_t* version) {
+    if (version) version->refs++;
+}
+
+void crontab_version_release(crontab_version_t* version) {
+    if (version && --version->refs == 0) {
+        arena_free(&version->arena);
+        free(version);
+    }
+}
+
+static crontab_file_t* file_find(const char* path, uint64_t hash) {
+    if (!file_bucket_count) return NULL;
+    for (crontab_file_t* file = file_buckets[hash & (file_bucket_count - 1)]; file;
+         file = file->hash_next) {
+        if (file->hash == hash && strcmp(file->path, path) == 0) return file;
+    }
+    return NULL;
+}
+
+static int file_buckets_grow(void) {
+    uint32_t count = file_bucket_count ? file_bucket_count * 2 : 64;
+    crontab_file_t** buckets = calloc(count, sizeof(crontab_file_t*));
+    if (!buckets) return JCRON_ERR_NO_MEMORY;
+
+    for (crontab_file_t* file = files; file; file = file->next) {
+        uint32_t b = (uint32_t)(file->hash & (count - 1));
+        file->hash_next = buckets[b];
+        buckets[b] = file;
+    }
+    free(file_buckets);
+    file_buckets = buckets;
+    file_bucket_count = count;
+    return JCRON_OK;
+}
+
+static crontab_file_t* file_add(const char* path, const char* owner, uint64_t hash) {
+    if (file_count >= file_bucket_count && file_buckets_grow() != JCRON_OK) return NULL;
+
+    crontab_file_t* file = calloc(1, sizeof(crontab_file_t));
+    if (!file || !(file->path = strdup(path)) || (owner && !(file->owner = strdup(owner)))) {
+        if (file) free(file->path);
+        free(file);
+        return NULL;
+    }
+    file->hash = hash;
+
+    uint32_t b = (uint32_t)(hash & (file_bucket_count - 1));
+    file->hash_next = file_buckets[b];
+    file_buckets[b] = file;
+
+    file->next = files;
+    if (files) files->prev = file;
+    files = file;
+    file_count++;
+    return file;
+}
+
+static void file_remove(crontab_file_t* file) {
+    for (cron_job_t* job = file->jobs; job; ) {
+        cron_job_t* next = job->next;
+        job_retire(job);
+        job = next;
+    }
+
+    crontab_file_t** link = &file_buckets[file->hash & (file_bucket_count - 1)];
+    while (*link != file) link = &(*link)->hash_next;
+    *link = file->hash_next;
+
+    if (file->prev) file->prev->next = file->next;
+    else files = file->next;
+    if (file->next) file->next->prev = file->prev;
+    file_count--;
+
+    crontab_version_release(file->version);
+    free(file->path);
+    free(file->owner);
+    free(file);
+}
+
+/**
+ * Re-read a file and apply the line diff to its jobs
+ *
+ * @return 1 if the file was re-read or removed, 0 if unchanged
+ */
+static int file_apply(crontab_file_t* file, int force) {
+    struct stat st;
+    if (stat(file->path, &st) != 0 || !S_ISREG(st.st_mode)) {
+        log_message(LOG_INFO, "Crontab removed: %s (%d jobs)", file->path, file->job_count);
+        file_remove(file);
+        return 1;
+    }
+    if (!force && st.st_dev == file->dev && st.st_ino == file->ino &&
+        st.st_size == file->size && st.st_mtim.tv_sec == file->mtime.tv_sec &&
+        st.st_mtim.tv_nsec == file->mtime.tv_nsec) {
+        return 0;
+    }
+    file->dev = st.st_dev;
+    file->ino = st.st_ino;
+    file->size = st.st_size;
+    file->mtime = st.st_mtim;
+
+    int fresh_count;
+    crontab_version_t* version = calloc(1, sizeof(crontab_version_t));
+    if (!version) {
+        log_message(LOG_ERR, "Out of memory reloading %s", file->path);
+        file->mtime.tv_sec = -1;
+        return 0;
+    }
+    version->refs = 1;
+    cron_job_t* fresh = read_crontab_file(file, version, &fresh_count);
+
+    // Index the live jobs by key (linear probing, power-of-two table);
+    // matched entries become tombstones so duplicate lines pair up in order
+    static cron_job_t tombstone;
+    uint32_t mask = 15;
+    while (mask + 1 < (uint32_t)file->job_count * 2) mask = mask * 2 + 1;
+    cron_job_t** table = calloc(mask + 1, sizeof(cron_job_t*));
+    if (!table) {
+        log_message(LOG_ERR, "Out of memory reloading %s", file->path);
+        for (cron_job_t* job = fresh; job; job = job->next) {
+            jcron_table_remove(&job_table, job->slot);
+        }
+        crontab_version_release(version);
+        file->mtime.tv_sec = -1;  // Retry on the next reload
+        return 0;
+    }
+    for (cron_job_t* job = file->jobs; job; job = job->next) {
+        uint32_t i = (uint32_t)job->key & mask;
+        while (table[i]) i = (i + 1) & mask;
+        table[i] = job;
+    }
+
+    // Keep live jobs whose line is unchanged; attach the rest
+    cron_job_t* head = NULL;
+    cron_job_t** tail = &head;
+    int kept = 0, added = 0, removed = 0;
+
+    for (cron_job_t* job = fresh; job; ) {
+        cron_job_t* next = job->next;
+        cron_job_t* live = NULL;
+
+        for (uint32_t i = (uint32_t)job->key & mask; table[i]; i = (i + 1) & mask) {
+            cron_job_t* candidate = table[i];
+            if (candidate != &tombstone && candidate->key == job->key &&
+                strcmp(candidate->schedule, job->schedule) == 0 &&
+                strcmp(candidate->command, job->command) == 0) {
+                table[i] = &tombstone;
+                live = candidate;
+                break;
+            }
+        }
+
+        if (live) {
+            job_move(live, job);
+            kept++;
+        } else {
+            job_attach(job);
+            added++;
+        }
+
+        *tail = job;
+        tail = &job->next;
+        job = next;
+    }
+    *tail = NULL;
+
+    // Lines that were not matched are gone from the file
+    for (uint32_t i = 0; i <= mask; i++) {
+        if (table[i] && table[i] != &tombstone) {
+            job_retire(table[i]);
+            removed++;
+        }
+    }
+    free(table);
+
+    // Kept jobs have moved out; only runs still alive point into the old version
+    crontab_version_release(file->version);
+    file->version = version;
+
+    file->jobs = head;
+    file->job_count = kept + added;
+    if (added || removed) {
+        log_message(LOG_INFO, "Crontab reloaded: %s (%d kept, %d added, %d removed)",
+                    file->path, kept, added, removed);
+    }
+    return 1;
+}
+
+// Owner for a crontab path, or "" for system files; NULL if not a crontab
+static const char* crontab_owner(const char* path) {
+    if (strcmp(path, crontab_paths.crontab) == 0) return "";
+
+    const char* slash = strrchr(path, '/');
+    if (!slash || slash[1] == '.' || slash[1] == '\0') return NULL;
+
+    size_t dir_len = (size_t)(slash - path);
+    if (strlen(crontab_paths.cron_d) == dir_len &&
+        strncmp(path, crontab_paths.cron_d, dir_len) == 0) return "";
+    if (strlen(crontab_paths.spool) == dir_len &&
+        strncmp(path, crontab_paths.spool, dir_len) == 0) return slash + 1;
+    return NULL;
+}
+
+// Look up or create the file entry for a path and apply it
+static int reload_path(const char* path, int force) {
+    const char* owner = crontab_owner(path);
+    if (!owner) return 0;
+
+    uint64_t hash = fnv1a(FNV_OFFSET, path);
+    crontab_file_t* file = file_find(path, hash);
+    if (!file) {
+        if (access(path, F_OK) != 0) return 0;
+        file = file_add(path, owner[0] ? owner : NULL, hash);
+        if (!file) {
+            log_message(LOG_ERR, "Out of memory loading %s", path);
+            return 0;
+        }
+    }
+    file->seen = 1;
+    return file_apply(file, force);
+}
+
+int crontab_reload_path(const char* path) {
+    return reload_path(path, 0);
+}
+
+static int visible(const struct dirent* entry) {
+    return entry->d_name[0] != '.';
+}
+
+// In name order, so jobs get the same slots (and same-second fires the
+// same order) on every run
+static int reload_dir(const char* dir_path, int force) {
+    struct dirent** entries;
+    int count = scandir(dir_path, &entries, visible, alphasort);
+    if (count < 0) return 0;
+
+    int changed = 0;
+    for (int i = 0; i < count; i++) {
+        char filepath[PATH_MAX];
+        snprintf(filepath, sizeof(filepath), "%s/%s", dir_path, entries[i]->d_name);
+        changed += reload_path(filepath, force);
+        free(entries[i]);
+    }
+    free(entries);
+    return changed;
+}
+
+int crontab_load_all(int force) {
+    for (crontab_file_t* file = files; file; file = file->next) file->seen = 0;
+
+    int changed = reload_path(crontab_paths.crontab, force);
+    changed += reload_dir(crontab_paths.cron_d, force);
+    changed += reload_dir(crontab_paths.spool, force);
+
+    // Sweep files that no longer exist
+    for (crontab_file_t* file = files; file; ) {
+        crontab_file_t* next = file->next;
+        if (!file->seen) {
+            log_message(LOG_INFO, "Crontab removed: %s (%d jobs)", file->path, file->job_count);
+            file_remove(file);
+            changed++;
+        }
+        file = next;
+    }
+    return changed;
+}
+
+void crontab_free(void) {
+    while (files) file_remove(files);
+
+    free(file_buckets);
+    file_buckets = NULL;
+    file_bucket_count = 0;
+    jcron_table_free(&job_table);
+    jcron_sched_free(&job_sched);
+}
+
+/* ========================================================================
+ * inotify
+ * ======================================================================== */
+
+#define WATCH_MASK (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | \
+                    IN_CREATE | IN_ATTRIB)
+
+// One watched directory; the system crontab is watched through its parent
+typedef struct {
+    int wd;
+    char dir[PATH_MAX];
+    const char* only;    // Only this name matters (NULL = every entry)
+} crontab_watch_t;
+
+static int inotify_fd = -1;
+static crontab_watch_t watches[3];
+
+static void watch_dir(crontab_watch_t* watch, const char* dir, const char* only) {
+    snprintf(watch->dir, sizeof(watch->dir), "%s", dir);
+    watch->only = only;
+    watch->wd = inotify_add_watch(inotify_fd, watch->dir, WATCH_MASK | IN_ONLYDIR);
+    if (watch->wd < 0) {
+        log_message(LOG_INFO, "Not watching %s: %s", watch->dir, strerror(errno));
+    }
+}
+
+int crontab_watch(void) {
+    if (inotify_fd < 0) {
+        inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_fd < 0) {
+            log_message(LOG_WARNING, "inotify unavailable, reload with SIGHUP: %s",
+                        strerror(errno));
+            return -1;
+        }
+    }
+
+    // The system crontab is watched through its directory, since editors
+    // replace files by rename. Re-adding a watch returns the existing one.
+    char parent[PATH_MAX];
+    snprintf(parent, sizeof(parent), "%s", crontab_paths.crontab);
+    char* slash = strrchr(parent, '/');
+    if (slash && slash != parent) {
+        *slash = '\0';
+        watch_dir(&watches[0], parent, crontab_paths.crontab + (slash - parent) + 1);
+    }
+    watch_dir(&watches[1], crontab_paths.cron_d, NULL);
+    watch_dir(&watches[2], crontab_paths.spool, NULL);
+    return inotify_fd;
+}
+
+int crontab_watch_handle(void) {
+    // Paths named by this batch of events, each reloaded once
+    char (*pending)[PATH_MAX] = NULL;
+    int pending_count = 0, pending_capacity = 0;
+    int overflow = 0;
+
+    char buffer[64 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t len;
+    while ((len = read(inotify_fd, buffer, sizeof(buffer))) > 0) {
+        for (char* p = buffer; p < buffer + len; ) {
+            const struct inotify_event* event = (const struct inotify_event*)p;
+            p += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & (IN_Q_OVERFLOW | IN_IGNORED)) {
+                overflow = 1;  // Lost events, or a watched directory went away
+                continue;
+            }
+            if (!event->len || event->name[0] == '.') continue;
+
+            crontab_watch_t* watch = NULL;
+            for (int i = 0; i < 3; i++) {
+                if (watches[i].wd == event->wd) watch = &watches[i];
+            }
+            if (!watch || (watch->only && strcmp(watch->only, event->name) != 0)) continue;
+            if (overflow) continue;
+
+            char path[PATH_MAX];
+            if (snprintf(path, sizeof(path), "%s/%s", watch->dir, event->name) >=
+                (int)sizeof(path)) continue;
+
+            int seen = 0;
+            for (int i = 0; i < pending_count && !seen; i++) {
+                seen = strcmp(pending[i], path) == 0;
+            }
+            if (seen) continue;
+
+            if (pending_count == pending_capacity) {
+                int capacity = pending_capacity ? pending_capacity * 2 : 16;
+                char (*grown)[PATH_MAX] = realloc(pending, (size_t)capacity * PATH_MAX);
+                if (!grown) {
+                    overflow = 1;
+                    continue;
+                }
+                pending = grown;
+                pending_capacity = capacity;
+            }
+            memcpy(pending[pending_count++], path, sizeof(path));
+        }
+    }
+
+    int changed = 0;
+    if (overflow) {
+        changed = crontab_load_all(0);
+    } else {
+        for (int i = 0; i < pending_count; i++) {
+            changed += reload_path(pending[i], 0);
+        }
+    }
+    free(pending);
+    return changed;
+}
@@ -0,0 +1,790 @@
+/**
+ * JCRON Daemon - Non-blocking Job Execution
+ *
+ * Jobs are started with vfork() + execve() and never waited for inline:
+ * the main loop calls exec_reap() when SIGCHLD arrives on its signalfd.
+ * vfork() rather than posix_spawn() because user jobs need setgroups,
+ * setgid, setuid and chdir between fork and exec; like posix_spawn it does
+ * not copy the daemon's page tables, so launch cost is independent of
+ * daemon size. Users were resolved at load (creds.c), so a launch makes no
+ * NSS lookups.
+ *
+ * Jobs with a timeout get SIGTERM at the deadline and SIGKILL after a
+ * grace period, sent to the whole process group. The main loop keeps one
+ * CLOCK_MONOTONIC timerfd armed at exec_next_deadline().
+ *
+ * With a launch pool (-t) the main thread only prepares each spawn request
+ * and registers the run; the vfork() + exec happens on a pool thread
+ * (vfork suspends only the calling thread, so launches proceed in
+ * parallel). Requests are dealt round-robin onto per-thread rings and idle
+ * threads steal from the others; results come back on a completion ring
+ * drained by exec_complete(). A child can exit before its launch is
+ * reported: exec_reap() keeps such exits until the run learns its pid.
+ *
+ * With the launch helper (-z, zygote.c) the request goes over its socket
+ * instead and the helper's reply completes it the same way; its children
+ * are still ours to reap. If the helper dies, launches it had not answered
+ * fail and later ones happen in the daemon again.
+ */
+
+#include "jcrond.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define JOB_PATH "PATH=/usr/local/sbin:/usr/local/bin:/sbin:/bin:/usr/sbin:/usr/bin"
+
+// Time between the timeout SIGTERM and SIGKILL
+#define KILL_GRACE_NS (5 * 1000000000LL)
+
+#define POOL_RING 4096
+
+typedef struct spawn_request spawn_request_t;
+
+// One live child
+typedef struct {
+    pid_t pid;           // 0 while the pool or the helper is still launching it
+    spawn_request_t* spawning;  // Request in flight, until it reports back
+    cron_job_t* job;     // NULL once detached by a reload
+    const char* command; // For logging after the job is gone
+    crontab_version_t* version; // Keeps the command, argv and env alive
+    creds_t* creds;      // Keeps the groups and HOME/USER/LOGNAME alive
+    int64_t scheduled;   // Fire time this run belongs to
+    int64_t start_ns;    // Monotonic launch time
+    int64_t deadline_ns; // Next timeout action, or -1
+    int terminated;      // SIGTERM already sent for the timeout
+    limit_group_t* user_group;  // Released on reap, even after a reload
+    limit_group_t* file_group;
+} job_run_t;
+
+static job_run_t* runs = NULL;
+static int run_count = 0;
+static int run_capacity = 0;
+
+// Exits of children whose launch has not been reported yet
+typedef struct {
+    pid_t pid;
+    int status;
+    struct rusage usage;
+} early_exit_t;
+
+static early_exit_t* early_exits = NULL;
+static int early_count = 0;
+static int early_capacity = 0;
+static int spawning_count = 0;
+
+// Runs and early exits by pid, for the reaper and finished launches:
+// open addressing with linear probing, at most half full
+typedef struct {
+    pid_t pid;           // 0 for a free slot
+    int index;           // Into runs[], or -1 - index into early_exits[]
+} pid_slot_t;
+
+static pid_slot_t* pid_slots = NULL;
+static uint32_t pid_mask = 0;    // Slot count - 1
+
+// Everything the child needs, prepared before vfork()
+struct spawn_request {
+    uid_t uid;
+    gid_t gid;
+    int drop_privileges;
+    const gid_t* groups;
+    int group_count;     // -1 to keep ours
+    const char* path;    // Program to exec, searched in PATH without a slash
+    char* const* argv;   // The job's words, or shell_argv
+    char* shell_argv[4];
+    char* envp[JOB_ENV_MAX + 6];
+    const char* cwd;     // Working directory once privileges are dropped
+    sigset_t unblocked;  // The daemon blocks the signals it reads from its signalfd
+    int timeout_sec;
+    int output_fd;       // Pipe for stdout and stderr, or -1 to inherit ours
+    int64_t queued_ns;   // When exec_launch() handed it over, for spawn latency
+    int run_index;       // Its run in runs[], kept by the main thread
+    // Filled in by the launching thread
+    pid_t pid;           // -1 on failure
+    int error;
+    int64_t start_ns;
+};
+
+// Launch pool
+typedef struct {
+    pthread_t thread;
+    int index;
+    ring_t work;         // spawn_request_t*, stolen by idle threads
+} launcher_t;
+
+static launcher_t* launchers = NULL;
+static int launcher_count = 0;
+static uint32_t next_launcher = 0;
+static sem_t work_ready;         // One post per queued request
+static int pool_stopping = 0;
+static ring_t completions;       // spawn_request_t*, back to the main thread
+static int complete_fd = -1;
+
+// Runs in the vfork() child: it shares our memory, so only
+// async-signal-safe calls, and it must end in exec or _exit. Credentials
+// change through raw syscalls: glibc's setuid() would try to apply the
+// change to every thread of the (shared) daemon.
+static void child_exec(const spawn_request_t* req) {
+    sigprocmask(SIG_SETMASK, &req->unblocked, NULL);
+    if (req->output_fd >= 0 &&
+        (dup2(req->output_fd, STDOUT_FILENO) < 0 || dup2(req->output_fd, STDERR_FILENO) < 0)) {
+        _exit(126);
+    }
+    setpgid(0, 0);
+    if (req->drop_privileges) {
+        if ((req->group_count >= 0 &&
+             syscall(SYS_setgroups, (size_t)req->group_count, req->groups) != 0) ||
+            syscall(SYS_setgid, req->gid) != 0 || syscall(SYS_setuid, req->uid) != 0) {
+            _exit(126);
+        }
+        if (chdir(req->cwd) != 0 && chdir("/tmp") != 0) _exit(126);
+    }
+    exec_search(req->path, req->argv, req->envp);
+    _exit(errno == ENOENT ? 127 : 126);
+}
+
+void exec_search(const char* file, char* const argv[], char* const envp[]) {
+    if (strchr(file, '/')) {
+        execve(file, argv, envp);
+        return;
+    }
+
+    const char* path = JOB_PATH + 5;
+    for (char* const* e = envp; *e; e++) {
+        if (strncmp(*e, "PATH=", 5) == 0) {
+            path = *e + 5;
+            break;
+        }
+    }
+
+    // As the shell does: skip directories that do not have it, but report
+    // EACCES if one had it unexecutable
+    size_t file_len = strlen(file);
+    int denied = 0;
+    char candidate[PATH_MAX];
+    for (const char* dir = path; ; ) {
+        const char* end = strchr(dir, ':');
+        if (!end) end = dir + strlen(dir);
+        size_t dir_len = (size_t)(end - dir);
+        if (dir_len + 2 + file_len < sizeof(candidate)) {
+            memcpy(candidate, dir, dir_len);
+            if (dir_len == 0) candidate[dir_len++] = '.';  // Empty entry: current directory
+            candidate[dir_len] = '/';
+            memcpy(candidate + dir_len + 1, file, file_len + 1);
+            execve(candidate, argv, envp);
+            if (errno == EACCES) denied = 1;
+            else if (errno != ENOENT && errno != ENOTDIR) return;
+        }
+        if (!*end) break;
+        dir = end + 1;
+    }
+    errno = denied ? EACCES : ENOENT;
+}
+
+static void spawn(spawn_request_t* req) {
+    req->start_ns = monotonic_ns();
+    req->pid = vfork();
+    if (req->pid == 0) {
+        child_exec(req);
+    }
+    req->error = req->pid < 0 ? errno : 0;
+    if (req->pid > 0) metric_observe(HIST_SPAWN, (monotonic_ns() - req->queued_ns) / 1000);
+}
+
+static void log_started(const job_run_t* run) {
+    const char* user = run->job && run->job->user ? run->job->user : "root";
+    int64_t late_us = now_us() - run->scheduled * 1000000;
+    metric_observe(HIST_LATENESS, late_us);
+    log_message(LOG_INFO, "Started job: %s (pid %d, user %s, late %lld ms)",
+                run->command, (int)run->pid, user, (long long)(late_us / 1000));
+}
+
+static int helper_send(spawn_request_t* req) {
+    zygote_spawn_t spawn = {req->uid, req->gid, req->drop_privileges, req->groups,
+                            req->group_count, req->path, req->argv, req->envp,
+                            req->drop_privileges ? req->cwd : NULL,
+                            {-1, req->output_fd, req->output_fd}};
+    return zygote_send((uint64_t)(uintptr_t)req, &spawn);
+}
+
+static int helper_lost(void);
+
+static uint32_t pid_hash(pid_t pid) {
+    uint32_t h = (uint32_t)pid * 0x9E3779B1u;
+    return (h ^ (h >> 16)) & pid_mask;
+}
+
+static pid_slot_t* pid_find(pid_t pid) {
+    if (!pid_slots) return NULL;
+    for (uint32_t k = pid_hash(pid); pid_slots[k].pid; k = (k + 1) & pid_mask) {
+        if (pid_slots[k].pid == pid) return &pid_slots[k];
+    }
+    return NULL;
+}
+
+// Room for `count` pids in all
+static int pid_reserve(int count) {
+    if (pid_slots && (uint32_t)count * 2 <= pid_mask + 1) return 0;
+    uint32_t size = pid_slots ? (pid_mask + 1) * 2 : 128;
+    while ((uint32_t)count * 2 > size) size *= 2;
+    pid_slot_t* grown = calloc(size, sizeof(pid_slot_t));
+    if (!grown) return -1;
+    pid_slot_t* old = pid_slots;
+    uint32_t old_size = old ? pid_mask + 1 : 0;
+    pid_slots = grown;
+    pid_mask = size - 1;
+    for (uint32_t k = 0; k < old_size; k++) {
+        if (!old[k].pid) continue;
+        uint32_t j = pid_hash(old[k].pid);
+        while (pid_slots[j].pid) j = (j + 1) & pid_mask;
+        pid_slots[j] = old[k];
+    }
+    free(old);
+    return 0;
+}
+
+// reserve_run() and exec_reap() keep room for every run and early exit
+static void pid_insert(pid_t pid, int index) {
+    uint32_t k = pid_hash(pid);
+    while (pid_slots[k].pid && pid_slots[k].pid != pid) k = (k + 1) & pid_mask;
+    pid_slots[k] = (pid_slot_t){pid, index};
+}
+
+// Backward-shift deletion: no tombstones, so probes stay short
+static void pid_remove(pid_t pid) {
+    pid_slot_t* slot = pid_find(pid);
+    if (!slot) return;
+    uint32_t hole = (uint32_t)(slot - pid_slots);
+    for (uint32_t k = (hole + 1) & pid_mask; pid_slots[k].pid; k = (k + 1) & pid_mask) {
+        uint32_t home = pid_hash(pid_slots[k].pid);
+        // Movable unless its home lies cyclically in (hole, k]
+        if (((k - home) & pid_mask) >= ((k - hole) & pid_mask)) {
+            pid_slots[hole] = pid_slots[k];
+            hole = k;
+        }
+    }
+    pid_slots[hole].pid = 0;
+}
+
+// Drop runs[i], moving the last run into its place
+static void run_remove(int i) {
+    if (runs[i].pid > 0) pid_remove(runs[i].pid);
+    runs[i] = runs[--run_count];
+    if (i == run_count) return;
+    if (runs[i].pid > 0) pid_find(runs[i].pid)->index = i;
+    if (runs[i].spawning) runs[i].spawning->run_index = i;
+}
+
+// Drop early_exits[e] the same way
+static void early_remove(int e) {
+    pid_remove(early_exits[e].pid);
+    early_exits[e] = early_exits[--early_count];
+    if (e < early_count) pid_find(early_exits[e].pid)->index = -1 - e;
+}
+
+// Once no launch is pending, the early exits were children not ours
+static void drop_early_exits(void) {
+    while (spawning_count == 0 && early_count > 0) early_remove(early_count - 1);
+}
+
+// Room for one more run
+static int reserve_run(void) {
+    if (pid_reserve(run_count + early_count + 1) != 0) return -1;
+    if (run_count < run_capacity) return 0;
+    int capacity = run_capacity ? run_capacity * 2 : 64;
+    job_run_t* grown = realloc(runs, (size_t)capacity * sizeof(job_run_t));
+    if (!grown) return -1;
+    runs = grown;
+    run_capacity = capacity;
+    return 0;
+}
+
+pid_t exec_launch(cron_job_t* job, int64_t scheduled) {
+    // Resolved at load: only a reference is taken here
+    creds_t* creds = NULL;
+    if (job->user) {
+        creds = job->creds ? creds_get(job->creds) : NULL;
+        if (!creds) {
+            log_message(LOG_ERR, "Unknown user %s for job: %s", job->user, job->command);
+            counters.launch_failed++;
+            return -1;
+        }
+    }
+
+    spawn_request_t local;
+    int handed_off = launcher_count > 0 || zygote_running();
+    spawn_request_t* req = handed_off ? malloc(sizeof(spawn_request_t)) : &local;
+    if (!req) {
+        log_message(LOG_ERR, "Out of memory launching job: %s", job->command);
+        counters.launch_failed++;
+        creds_release(creds);
+        return -1;
+    }
+    memset(req, 0, sizeof(*req));
+    req->group_count = -1;
+    char* env_home = "HOME=/";
+    char* env_user = "USER=root";
+    char* env_logname = "LOGNAME=root";
+    if (creds) {
+        req->uid = creds->uid;
+        req->gid = creds->gid;
+        req->groups = creds->groups;
+        req->group_count = creds->group_count;
+        req->drop_privileges = 1;
+        env_home = creds->env_home;
+        env_user = creds->env_user;
+        env_logname = creds->env_logname;
+    }
+
+    // The crontab's variables were compiled at load: only pointers are copied
+    const job_env_t* env = job->env;
+    int envc = 0;
+    if (!env || !env->has_path) req->envp[envc++] = JOB_PATH;
+    if (!env || !env->shell) req->envp[envc++] = "SHELL=/bin/sh";
+    if (!env || !env->home) req->envp[envc++] = env_home;
+    req->envp[envc++] = env_user;
+    req->envp[envc++] = env_logname;
+    if (env) {
+        memcpy(&req->envp[envc], env->envp, (size_t)env->count * sizeof(char*));
+        envc += env->count;
+    }
+    req->envp[envc] = NULL;
+    req->cwd = env && env->home ? env->home : env_home + 5;
+
+    if (job->argv) {
+        req->path = job->argv[0];
+        req->argv = job->argv;
+    } else {
+        const char* shell = env && env->shell ? env->shell : "/bin/sh";
+        const char* name = strrchr(shell, '/');
+        req->path = shell;
+        req->shell_argv[0] = (char*)(name ? name + 1 : shell);
+        req->shell_argv[1] = "-c";
+        req->shell_argv[2] = job->command;
+        req->argv = req->shell_argv;
+    }
+    sigemptyset(&req->unblocked);
+    req->timeout_sec = job->options.timeout_sec;
+
+    if (reserve_run() != 0) {
+        log_message(LOG_ERR, "Out of memory launching job: %s", job->command);
+        counters.launch_failed++;
+        if (req != &local) free(req);
+        creds_release(creds);
+        return -1;
+    }
+
+    req->output_fd = output_open(job, scheduled);
+    req->queued_ns = monotonic_ns();
+
+    // Sent before the run exists: its reply is only read by exec_complete()
+    int via_helper = 0;
+    if (zygote_running()) {
+        if (helper_send(req) == 0) {
+            via_helper = 1;
+        } else {
+            log_message(LOG_ERR, "Cannot reach launch helper: %s", strerror(errno));
+            helper_lost();  // May launch held fires, taking our reserved slot
+            handed_off = launcher_count > 0;
+            if (reserve_run() != 0) {
+                log_message(LOG_ERR, "Out of memory launching job: %s", job->command);
+                counters.launch_failed++;
+                if (req->output_fd >= 0) close(req->output_fd);
+                free(req);
+                creds_release(creds);
+                return -1;
+            }
+        }
+    }
+
+    // The run keeps the job's file version and credentials: a reload may
+    // replace them while a pool thread is still reading its argv and env,
+    // or the run is alive. The run takes over our reference to creds.
+    job_run_t* run = &runs[run_count];
+    *run = (job_run_t){0, NULL, job, job->command, job->version, creds, scheduled, 0, -1, 0,
+                       job->user_group, job->file_group};
+    if (handed_off) {
+        crontab_version_hold(run->version);
+        // Counted as running from now on, so limits and overlap see it
+        run->spawning = req;
+        req->run_index = run_count++;
+        spawning_count++;
+        job->running++;
+        if (job->user_group) job->user_group->running++;
+        if (job->file_group) job->file_group->running++;
+        if (via_helper) return 0;
+
+        launcher_t* launcher = &launchers[next_launcher++ % (uint32_t)launcher_count];
+        while (ring_push(&launcher->work, &req) != 0) sched_yield();
+        sem_post(&work_ready);
+        return 0;
+    }
+
+    spawn(req);
+    if (req->output_fd >= 0) close(req->output_fd);  // The child has its copy
+    pid_t pid = req->pid;
+    if (pid < 0) {
+        log_message(LOG_ERR, "Failed to fork for job %s: %s", job->command,
+                    strerror(req->error));
+        counters.launch_failed++;
+        creds_release(creds);
+    } else {
+        crontab_version_hold(run->version);
+        run->pid = pid;
+        run->start_ns = req->start_ns;
+        if (req->timeout_sec > 0) {
+            run->deadline_ns = req->start_ns + req->timeout_sec * 1000000000LL;
+        }
+        pid_insert(pid, run_count++);
+        job->running++;
+        if (job->user_group) job->user_group->running++;
+        if (job->file_group) job->file_group->running++;
+        counters.launched++;
+        log_started(run);
+    }
+    if (req != &local) free(req);  // Was meant for the helper, which is gone
+    return pid;
+}
+
+// Log and record the exit of runs[i], then drop it
+static void run_exited(int i, pid_t pid, int status, const struct rusage* usage) {
+    job_run_t* run = &runs[i];
+    int64_t duration_ms = (monotonic_ns() - run->start_ns) / 1000000;
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) metric_add(METRIC_RUNS_FAILED, 1);
+    if (WIFEXITED(status)) {
+        log_message(WEXITSTATUS(status) ? LOG_WARNING : LOG_INFO,
+                    "Job finished: %s (pid %d, exit %d, %lld ms, user %ld.%03lds, "
+                    "sys %ld.%03lds, maxrss %ld KB)",
+                    run->command, (int)pid, WEXITSTATUS(status), (long long)duration_ms,
+                    (long)usage->ru_utime.tv_sec, (long)usage->ru_utime.tv_usec / 1000,
+                    (long)usage->ru_stime.tv_sec, (long)usage->ru_stime.tv_usec / 1000,
+                    usage->ru_maxrss);
+    } else if (WIFSIGNALED(status)) {
+        log_message(LOG_WARNING, "Job terminated by signal %d: %s (pid %d, %lld ms)",
+                    WTERMSIG(status), run->command, (int)pid, (long long)duration_ms);
+    }
+
+    cron_job_t* job = run->job;
+    if (run->user_group) run->user_group->running--;
+    if (run->file_group) run->file_group->running--;
+    crontab_version_release(run->version);
+    creds_release(run->creds);
+    run_remove(i);
+
+    if (job) {
+        job->last_status = status;
+        job->last_duration_ms = duration_ms;
+        state_record_exit(job);
+        job->running--;
+        job_finished(job);
+    }
+}
+
+int exec_reap(void) {
+    int reaped = 0;
+    int status;
+    struct rusage usage;
+    pid_t pid;
+
+    while ((pid = wait4(-1, &status, WNOHANG, &usage)) > 0) {
+        pid_slot_t* slot = pid_find(pid);
+        if (slot && slot->index >= 0) {
+            run_exited(slot->index, pid, status, &usage);
+            reaped++;
+        } else if (spawning_count > 0 && !slot) {
+            // Possibly a run whose launch is still on its way back
+            if (early_count == early_capacity) {
+                int capacity = early_capacity ? early_capacity * 2 : 16;
+                early_exit_t* grown = realloc(early_exits, (size_t)capacity * sizeof(*grown));
+                if (!grown) continue;
+                early_exits = grown;
+                early_capacity = capacity;
+            }
+            if (pid_reserve(run_count + early_count + 1) != 0) continue;
+            pid_insert(pid, -1 - early_count);
+            early_exits[early_count++] = (early_exit_t){pid, status, usage};
+        }
+    }
+    return reaped;
+}
+
+int exec_running(void) {
+    return run_count;
+}
+
+// Record the result of a launch handed to the pool or the helper
+static void launch_done(spawn_request_t* req) {
+    int i = req->run_index;
+    spawning_count--;
+    if (req->output_fd >= 0) close(req->output_fd);  // The child has its copy
+    if (i >= run_count || runs[i].spawning != req) {  // Cannot happen: runs outlive their launch
+        free(req);
+        return;
+    }
+
+    job_run_t* run = &runs[i];
+    run->spawning = NULL;
+    if (req->pid < 0) {
+        log_message(LOG_ERR, "Failed to fork for job %s: %s", run->command,
+                    strerror(req->error));
+        counters.launch_failed++;
+        cron_job_t* job = run->job;
+        if (run->user_group) run->user_group->running--;
+        if (run->file_group) run->file_group->running--;
+        crontab_version_release(run->version);
+        creds_release(run->creds);
+        run_remove(i);
+        if (job) {
+            job->running--;
+            job_finished(job);
+        }
+        free(req);
+        return;
+    }
+
+    run->pid = req->pid;
+    run->start_ns = req->start_ns;
+    if (req->timeout_sec > 0) {
+        run->deadline_ns = req->start_ns + req->timeout_sec * 1000000000LL;
+    }
+    if (run->terminated) {
+        // Superseded (OVERLAP_KILL) while it was being launched
+        kill(-run->pid, SIGTERM);
+        run->deadline_ns = monotonic_ns() + KILL_GRACE_NS;
+    }
+    counters.launched++;
+    log_started(run);
+    free(req);
+
+    pid_slot_t* slot = pid_find(run->pid);
+    if (!slot) {
+        pid_insert(run->pid, i);
+        return;
+    }
+    // Exited before we heard of it
+    int e = -1 - slot->index;
+    early_exit_t exited = early_exits[e];
+    early_remove(e);
+    run_exited(i, exited.pid, exited.status, &exited.usage);
+}
+
+// The helper is gone: fail what it never answered, launch in the daemon
+static int helper_lost(void) {
+    log_message(LOG_ERR, "Launch helper exited, launching in the daemon");
+    zygote_stop();
+
+    int failed = 0;
+    for (int i = run_count - 1; i >= 0; i--) {
+        if (i >= run_count || !runs[i].spawning) continue;
+        spawn_request_t* req = runs[i].spawning;
+        req->pid = -1;
+        req->error = EPIPE;
+        launch_done(req);
+        failed++;
+    }
+    drop_early_exits();
+    return failed;
+}
+
+int exec_complete(void) {
+    int completed = 0;
+    spawn_request_t* req;
+
+    while (launcher_count > 0 && ring_pop(&completions, &req) == 0) {
+        launch_done(req);
+        completed++;
+    }
+    if (zygote_running()) {
+        zygote_reply_t reply;
+        int got;
+        while ((got = zygote_receive(&reply)) == 1) {
+            req = (spawn_request_t*)(uintptr_t)reply.id;
+            if (reply.pid > 0) {
+                metric_observe(HIST_SPAWN, (monotonic_ns() - req->queued_ns) / 1000);
+            }
+            req->pid = reply.pid;
+            req->error = reply.error;
+            req->start_ns = reply.start_ns;
+            launch_done(req);
+            completed++;
+        }
+        if (got < 0) completed += helper_lost();
+    }
+    drop_early_exits();
+    return completed;
+}
+
+int exec_complete_fd(void) {
+    return complete_fd;
+}
+
+/* ========================================================================
+ * Launch Pool
+ * ======================================================================== */
+
+// Own ring first, then steal from the others
+static spawn_request_t* take_work(launcher_t* self) {
+    spawn_request_t* req;
+    for (;;) {
+        for (int k = 0; k < launcher_count; k++) {
+            launcher_t* victim = &launchers[(self->index + k) % launcher_count];
+            if (ring_pop(&victim->work, &req) == 0) return req;
+        }
+        // The semaphore promised a request; its push is still landing
+        if (__atomic_load_n(&pool_stopping, __ATOMIC_ACQUIRE)) return NULL;
+        sched_yield();
+    }
+}
+
+static void* launcher_main(void* arg) {
+    launcher_t* self = arg;
+    thread_pin(self->index);
+
+    for (;;) {
+        while (sem_wait(&work_ready) != 0 && errno == EINTR) {}
+        spawn_request_t* req = take_work(self);
+        if (!req) break;  // Woken to stop
+
+        spawn(req);
+        while (ring_push(&completions, &req) != 0) sched_yield();
+        uint64_t one = 1;
+        ssize_t ignored = write(complete_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+    return NULL;
+}
+
+int exec_pool_start(int threads) {
+    if (threads <= 0 || launcher_count > 0) return 0;
+
+    launchers = calloc((size_t)threads, sizeof(launcher_t));
+    complete_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (!launchers || complete_fd < 0 || sem_init(&work_ready, 0, 0) != 0 ||
+        ring_init(&completions, POOL_RING * (uint32_t)threads, sizeof(spawn_request_t*)) != 0) {
+        goto fail;
+    }
+
+    pool_stopping = 0;
+    int started = 0;
+    for (; started < threads; started++) {
+        launcher_t* launcher = &launchers[started];
+        launcher->index = started;
+        if (ring_init(&launcher->work, POOL_RING, sizeof(spawn_request_t*)) != 0 ||
+            pthread_create(&launcher->thread, NULL, launcher_main, launcher) != 0) {
+            ring_free(&launcher->work);
+            break;
+        }
+    }
+    if (started < threads) {
+        launcher_count = started;
+        exec_pool_stop();
+        goto fail;
+    }
+    launcher_count = threads;
+    return 0;
+
+fail:
+    log_message(LOG_ERR, "Cannot start %d launch threads, launching on the main thread",
+                threads);
+    free(launchers);
+    launchers = NULL;
+    if (complete_fd >= 0) close(complete_fd);
+    complete_fd = -1;
+    ring_free(&completions);
+    return -1;
+}
+
+void exec_pool_stop(void) {
+    // Launches still in flight finish; their runs then belong to the reaper
+    while (spawning_count > 0) {
+        exec_complete();
+        if (spawning_count > 0) sched_yield();
+    }
+    if (launcher_count == 0) return;
+    __atomic_store_n(&pool_stopping, 1, __ATOMIC_RELEASE);
+    for (int i = 0; i < launcher_count; i++) sem_post(&work_ready);
+    for (int i = 0; i < launcher_count; i++) {
+        pthread_join(launchers[i].thread, NULL);
+        ring_free(&launchers[i].work);
+    }
+    sem_destroy(&work_ready);
+    free(launchers);
+    launchers = NULL;
+    launcher_count = 0;
+    close(complete_fd);
+    complete_fd = -1;
+    ring_free(&completions);
+}
+
+void exec_detach_job(const cron_job_t* job) {
+    for (int i = 0; i < run_count; i++) {
+        if (runs[i].job == job) runs[i].job = NULL;
+    }
+}
+
+void exec_move_job(const cron_job_t* from, cron_job_t* to) {
+    for (int i = 0; i < run_count; i++) {
+        if (runs[i].job == from) runs[i].job = to;
+    }
+}
+
+int exec_terminate_job(const cron_job_t* job) {
+    int signalled = 0;
+    for (int i = 0; i < run_count; i++) {
+        job_run_t* run = &runs[i];
+        if (run->job != job || run->terminated) continue;
+
+        run->terminated = 1;
+        signalled++;
+        if (run->pid == 0) continue;  // Signalled once its launch reports back
+        kill(-run->pid, SIGTERM);
+        run->deadline_ns = monotonic_ns() + KILL_GRACE_NS;
+    }
+    return signalled;
+}
+
+int64_t exec_next_deadline(void) {
+    int64_t earliest = -1;
+    for (int i = 0; i < run_count; i++) {
+        int64_t deadline = runs[i].deadline_ns;
+        if (deadline >= 0 && (earliest < 0 || deadline < earliest)) earliest = deadline;
+    }
+    return earliest;
+}
+
+void exec_enforce_timeouts(void) {
+    int64_t now = monotonic_ns();
+
+    for (int i = 0; i < run_count; i++) {
+        job_run_t* run = &runs[i];
+        if (run->deadline_ns < 0 || run->deadline_ns > now) continue;
+
+        if (!run->terminated) {
+            log_message(LOG_WARNING, "Job timed out, terminating: %s (pid %d, %lld ms)",
+                        run->command, (int)run->pid,
+                        (long long)((now - run->start_ns) / 1000000));
+            kill(-run->pid, SIGTERM);
+            run->terminated = 1;
+            run->deadline_ns = now + KILL_GRACE_NS;
+            counters.timeouts++;
+        } else {
+            log_message(LOG_WARNING, "Job ignored SIGTERM, killing: %s (pid %d)",
+                        run->command, (int)run->pid);
+            kill(-run->pid, SIGKILL);
+            run->deadline_ns = -1;
+        }
+    }
+}
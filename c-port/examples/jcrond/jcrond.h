@@ -0,0 +1,1165 @@
+/**
+ * JCRON Daemon - Internal Interfaces
+ *
+ * Shared between examples/jcrond.c (main loop, crontab loading) and the
+ * daemon modules in examples/jcrond/. Every translation unit includes this
+ * header first; it defines _GNU_SOURCE for the Linux APIs used throughout.
+ */
+
+#ifndef JCROND_H
+#define JCROND_H
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  /* PATH_MAX, vfork, signalfd, epoll under -std=c99 */
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include "jcron.h"
+#include "jcron_sched.h"
+#include "jcron_table.h"
+
+// What to do when a job fires while a previous run is still alive
+typedef enum {
+    OVERLAP_ALLOW = 0,   // Start another run (classic cron)
+    OVERLAP_SKIP,        // Drop the new fire
+    OVERLAP_QUEUE,       // Hold one fire until the current run exits
+    OVERLAP_KILL         // Terminate the old run, start the new one
+} overlap_policy_t;
+
+// What to do with fires missed while down, suspended or across a clock jump
+typedef enum {
+    CATCHUP_SKIP = 0,    // Drop them (classic cron)
+    CATCHUP_ONCE,        // Run the latest one
+    CATCHUP_ALL          // Run each, up to catchup_max most recent
+} catchup_policy_t;
+
+// Per-job settings from JCRON_* lines; apply to the jobs below them
+typedef struct {
+    overlap_policy_t overlap;
+    catchup_policy_t catchup;
+    int catchup_max;     // CATCHUP_ALL bound
+    int timeout_sec;     // Hard run-time limit (0 = none)
+    int priority;        // Higher leaves the admission queue first
+} job_options_t;
+
+// Most NAME=value lines one environment takes (later ones are ignored)
+#define JOB_ENV_MAX 64
+
+// Most words a command is exec'd with directly (longer ones go to the shell)
+#define JOB_ARGV_MAX 64
+
+// Variables set by a crontab's NAME=value lines, compiled once for the
+// jobs below them. Launches add cron's defaults for what it leaves unset
+// (PATH, SHELL, HOME) and the job's USER and LOGNAME.
+typedef struct {
+    char** envp;         // "NAME=value", NULL-terminated
+    int count;
+    const char* shell;   // SHELL, or NULL for /bin/sh
+    const char* home;    // HOME, or NULL for the user's home directory
+    int has_path;        // PATH is set (otherwise cron's default)
+} job_env_t;
+
+// One version of a crontab file (crontab.c)
+typedef struct crontab_version crontab_version_t;
+
+// A user's credentials and job environment strings, resolved once
+// (creds.c); shared by launches and freed with the last of them
+typedef struct {
+    uid_t uid;
+    gid_t gid;
+    gid_t* groups;       // Supplementary groups, primary included
+    int group_count;     // -1: not root, jobs keep the daemon's groups
+    char* env_home;      // "HOME=<home directory>"
+    char* env_user;      // "USER=<name>"
+    char* env_logname;   // "LOGNAME=<name>"
+    int refs;
+} creds_t;
+
+// A job's user, interned by name; its record is replaced when the account
+// files change
+typedef struct cred_user {
+    char* name;
+    creds_t* creds;      // NULL if the user is unknown
+    uint32_t generation;
+    struct cred_user* next;
+} cred_user_t;
+
+// Running-job counter shared by every job of one user or one crontab file
+typedef struct limit_group {
+    char* name;
+    int running;
+    struct limit_group* next;
+} limit_group_t;
+
+// Job structure (its parsed pattern is in job_table, at its slot)
+typedef struct cron_job {
+    char* schedule;      // Original cron schedule string
+    char* command;       // Command to execute
+    char** argv;         // Its words, exec'd directly; NULL if it needs the shell
+    const job_env_t* env; // From the NAME=value lines above it (NULL: defaults only)
+    crontab_version_t* version; // Holds the strings, argv and env (NULL if not loaded)
+    char* user;          // User to run as (NULL for root)
+    cred_user_t* creds;  // Its credentials (NULL for root, or out of memory)
+    job_options_t options;
+    uint64_t key;        // FNV-1a of file path + line: identity across reloads
+    int32_t spread;      // Seconds each fire is delayed by (see spread_window)
+    uint32_t slot;       // Slot in job_table and the scheduler
+    limit_group_t* user_group;
+    limit_group_t* file_group;
+    time_t last_run;     // Last scheduled fire time
+    int last_status;     // Last wait status (see waitpid)
+    int64_t last_duration_ms; // Wall time of the last completed run
+    int running;         // Runs of this job currently alive
+    int queued;          // Fires waiting in the admission queue
+    int catchup_queued;  // Fires waiting in the catch-up queue
+    uint32_t state_record;   // Record in the state file (checked against key)
+    int64_t held_fire;   // OVERLAP_QUEUE: fire held for the current run (0 = none)
+    int control;         // Added over the control socket: no file, this node's own
+    int paused;          // Not scheduled until resumed (control socket)
+    struct cron_job* next;   // Next job of the same crontab file
+} cron_job_t;
+
+// Crontab locations (overridable for tests and benchmarks)
+typedef struct {
+    const char* crontab;   // System crontab (user column)
+    const char* cron_d;    // System crontab directory (user column)
+    const char* spool;     // Per-user crontabs, named after the user
+} jcrond_paths_t;
+
+// Admission limits (0 = unlimited)
+typedef struct {
+    int max_running;     // Runs alive at once, daemon-wide
+    int max_per_user;
+    int max_per_file;
+    int queue_capacity;  // Fires that may wait for a free slot
+} jcrond_limits_t;
+
+// Monotonic counters, logged on SIGUSR1 and at shutdown
+typedef struct {
+    uint64_t launched;
+    uint64_t launch_failed;
+    uint64_t queued;           // Fires that had to wait for a slot
+    uint64_t queue_dropped;    // Fires lost to a full queue
+    uint64_t queue_wait_ms;    // Total time spent waiting in the queue
+    uint64_t queue_wait_max_ms;
+    uint32_t queue_depth;      // Current depth (gauge)
+    uint32_t queue_depth_max;
+    uint64_t overlap_skipped;
+    uint64_t overlap_held;
+    uint64_t overlap_killed;
+    uint64_t timeouts;
+    uint64_t catchup_missed;   // Fires found missed
+    uint64_t catchup_queued;   // ...queued for catch-up by policy
+    uint64_t catchup_skipped;  // ...dropped by policy
+    uint64_t state_commits;    // Journal group commits
+    uint64_t state_syncs;      // ...of which fdatasync()ed
+    uint64_t state_checkpoints;
+    uint64_t output_bytes;     // Job output captured into logs
+} jcrond_counters_t;
+
+extern jcrond_limits_t limits;
+extern jcrond_counters_t counters;
+
+/* ========================================================================
+ * Utilities (util.c)
+ * ======================================================================== */
+
+// Wall-clock time in milliseconds (CLOCK_REALTIME)
+int64_t now_ms(void);
+
+// Wall-clock time in microseconds (CLOCK_REALTIME)
+int64_t now_us(void);
+
+// Monotonic time in nanoseconds, for durations
+int64_t monotonic_ns(void);
+
+// Pin the calling thread to CPU `index` modulo the CPU count
+void thread_pin(int index);
+
+/* ========================================================================
+ * Logging (log.c)
+ * ======================================================================== */
+
+// JSON-lines file to log to instead of syslog (-J; NULL = syslog)
+extern const char* log_json_path;
+
+// Syslog socket the writer sends to (overridable for tests and benchmarks)
+extern const char* log_syslog_path;
+
+/**
+ * Log a message (syslog priority, printf format), from any thread
+ *
+ * With the writer running: formats into a fixed-size record and queues
+ * it, no syscall. Below LOG_WARNING the record is dropped (and counted)
+ * if the queue is full; more severe ones wait for room. Otherwise:
+ * vsyslog().
+ */
+void log_message(int priority, const char* format, ...);
+
+/**
+ * Start the writer thread; log_message() queues from then on
+ *
+ * Call after daemonizing, and after setlogmask(): the mask is read once.
+ *
+ * @return 0, or -1 if logging stays synchronous
+ */
+int log_start(void);
+
+/**
+ * Write what is queued and stop the writer (call once the other threads
+ * have stopped); later messages go to vsyslog()
+ */
+void log_stop(void);
+
+/**
+ * Reopen the JSON-lines file (log rotation) or reconnect to syslog
+ */
+void log_reopen(void);
+
+/* ========================================================================
+ * Lock-free Queues (ring.c)
+ * ======================================================================== */
+
+// Bounded multi-producer, multi-consumer queue of fixed-size elements
+typedef struct {
+    uint64_t* sequence;      // Per cell: whose turn it is
+    unsigned char* cells;
+    uint32_t mask;
+    size_t elem_size;
+    char pad0[64];           // Producers and consumers on their own cache lines
+    uint64_t tail;
+    char pad1[64];
+    uint64_t head;
+    char pad2[64];
+} ring_t;
+
+/**
+ * Allocate a ring of at least `capacity` elements (rounded to a power of two)
+ *
+ * @return 0, or -1 when out of memory
+ */
+int ring_init(ring_t* ring, uint32_t capacity, size_t elem_size);
+
+void ring_free(ring_t* ring);
+
+/**
+ * Copy an element in (any thread)
+ *
+ * @return 0, or -1 when the ring is full
+ */
+int ring_push(ring_t* ring, const void* elem);
+
+/**
+ * Copy the oldest element out (any thread)
+ *
+ * @return 0, or -1 when the ring is empty
+ */
+int ring_pop(ring_t* ring, void* elem);
+
+/* ========================================================================
+ * Arenas (arena.c)
+ * ======================================================================== */
+
+typedef struct arena_block arena_block_t;
+
+// Memory that is freed all at once; zero-initialize before use
+typedef struct {
+    arena_block_t* blocks;   // Newest first
+    size_t reserved;         // Bytes malloc'd
+    size_t first_block;      // Size of the first block (0: the default, 2 KiB)
+} arena_t;
+
+/**
+ * Allocate zeroed memory (16-byte aligned)
+ *
+ * @return Pointer valid until arena_free(), or NULL when out of memory
+ */
+void* arena_alloc(arena_t* arena, size_t size);
+
+/**
+ * Copy `len` bytes of `s` and a terminating NUL
+ *
+ * @return The copy, or NULL when out of memory
+ */
+char* arena_strndup(arena_t* arena, const char* s, size_t len);
+
+/**
+ * Free everything allocated from the arena; it can be used again
+ */
+void arena_free(arena_t* arena);
+
+/* ========================================================================
+ * Job Execution (exec.c)
+ * ======================================================================== */
+
+/**
+ * Start a job without waiting for it
+ *
+ * Assembles the environment in the parent from the job's cached
+ * credentials, then vfork()s and, after setgroups/setgid/setuid, execs the
+ * job's argv directly or its command with the shell (SHELL, default
+ * /bin/sh) in the child. The child leads its own process group so
+ * timeouts and kills reach everything it starts, and its stdout
+ * and stderr go to the job's output log when capture is on. Returns as
+ * soon as the child has exec'd (or failed to), or, with a launch pool or
+ * the launch helper, as soon as the request is queued. Bypasses admission
+ * control; the main loop goes through job_submit().
+ *
+ * @param job       Job to run (its `running` count is incremented)
+ * @param scheduled Fire time the run belongs to (Unix timestamp)
+ * @return          Child pid, 0 if handed to the launch pool or helper, or -1
+ */
+pid_t exec_launch(cron_job_t* job, int64_t scheduled);
+
+/**
+ * execve() `file`, searched in the PATH of `envp` if it has no slash
+ *
+ * Like execvpe(), but with the job's PATH rather than the daemon's, and
+ * safe in a vfork() or clone() child: no allocation. Returns only on
+ * failure, with errno set (ENOENT if no directory has it).
+ */
+void exec_search(const char* file, char* const argv[], char* const envp[]);
+
+/**
+ * Start `threads` launch threads; exec_launch() hands them its requests
+ *
+ * Call after daemonizing (fork() keeps only the calling thread).
+ *
+ * @return 0, or -1 (launches stay on the calling thread)
+ */
+int exec_pool_start(int threads);
+
+/**
+ * Wait for launches in flight and stop the launch threads
+ */
+void exec_pool_stop(void);
+
+/**
+ * Record launches the pool or the helper has finished (call when
+ * exec_complete_fd() or zygote_fd() is readable, then job_dispatch())
+ *
+ * @return Number of launches completed or failed
+ */
+int exec_complete(void);
+
+/**
+ * eventfd readable when the launch pool has results, or -1 without a pool
+ */
+int exec_complete_fd(void);
+
+/**
+ * Reap every exited child (call on SIGCHLD)
+ *
+ * Logs and records exit status, duration and rusage per run, and releases
+ * held OVERLAP_QUEUE fires. Call job_dispatch() afterwards.
+ *
+ * @return Number of runs reaped
+ */
+int exec_reap(void);
+
+/**
+ * Number of runs currently alive
+ */
+int exec_running(void);
+
+/**
+ * Drop references to a job that is about to be freed (crontab reload)
+ *
+ * Its runs keep going; their completion is still logged, but no longer
+ * recorded on the job.
+ */
+void exec_detach_job(const cron_job_t* job);
+
+/**
+ * Point a job's runs at its new record (crontab reload of an unchanged line)
+ */
+void exec_move_job(const cron_job_t* from, cron_job_t* to);
+
+/**
+ * SIGTERM every live run of a job (its process group), with SIGKILL
+ * following after the timeout grace period
+ *
+ * @return Number of runs signalled
+ */
+int exec_terminate_job(const cron_job_t* job);
+
+/**
+ * Earliest timeout deadline of a live run (CLOCK_MONOTONIC, ns)
+ *
+ * @return Deadline, or -1 when no run has a timeout
+ */
+int64_t exec_next_deadline(void);
+
+/**
+ * Act on expired deadlines: SIGTERM first, SIGKILL after a grace period
+ */
+void exec_enforce_timeouts(void);
+
+/* ========================================================================
+ * Launch Helper (zygote.c)
+ * ======================================================================== */
+
+// What the helper is asked to spawn
+typedef struct {
+    uid_t uid;
+    gid_t gid;
+    int drop_privileges;     // Switch to uid/gid (and groups) before exec
+    const gid_t* groups;     // Supplementary groups to set
+    int group_count;         // -1 to keep the helper's
+    const char* path;        // Program to exec
+    char* const* argv;       // NULL-terminated
+    char* const* envp;       // NULL-terminated
+    const char* cwd;         // Working directory, or NULL to keep the helper's
+    int fds[3];              // New stdin/stdout/stderr, or -1 to inherit
+} zygote_spawn_t;
+
+// The helper's answer to one request
+typedef struct {
+    uint64_t id;             // As passed to zygote_send()
+    int32_t pid;             // -1 on failure
+    int32_t error;           // errno of the failure
+    int64_t start_ns;        // CLOCK_MONOTONIC at the clone
+} zygote_reply_t;
+
+/**
+ * Run the launch helper if this process was started as one
+ *
+ * Call first thing in main(): the helper is a re-exec of the daemon's
+ * binary, recognised by its arguments.
+ *
+ * @return Exit status of the helper, or -1 if this is not one
+ */
+int zygote_main(int argc, char* argv[]);
+
+/**
+ * Start the launch helper; exec_launch() then sends it every spawn
+ *
+ * @return 0, or -1 (launches stay in the daemon)
+ */
+int zygote_start(void);
+
+/**
+ * Close the helper's socket; it exits once it has read what is queued
+ */
+void zygote_stop(void);
+
+/**
+ * 1 if the helper is running
+ */
+int zygote_running(void);
+
+/**
+ * Socket readable when the helper has replies, or -1 without a helper
+ *
+ * Call exec_complete() when it is readable; never read it directly.
+ */
+int zygote_fd(void);
+
+/**
+ * The helper's pid (a child of the daemon), or -1
+ */
+pid_t zygote_pid(void);
+
+/**
+ * Send one spawn request; the fds are duplicated into the helper
+ *
+ * Blocks only while the socket is full, which the helper drains.
+ *
+ * @return 0, or -1 with errno set (E2BIG, or the helper is gone)
+ */
+int zygote_send(uint64_t id, const zygote_spawn_t* spawn);
+
+/**
+ * Take one reply without blocking
+ *
+ * @return 1 with a reply, 0 if none is waiting, -1 if the helper is gone
+ */
+int zygote_receive(zygote_reply_t* reply);
+
+/* ========================================================================
+ * Credential Cache (creds.c)
+ * ======================================================================== */
+
+/**
+ * Intern a user, resolving it now if it is new
+ *
+ * Users are never freed. Call at crontab load, on the main thread.
+ *
+ * @return The user (its record NULL if unknown), or NULL out of memory
+ */
+cred_user_t* creds_user(const char* name);
+
+/**
+ * The user's current record, held for the caller
+ *
+ * Looks the user up again if the account files changed since its record
+ * was made (they are checked at most once a second). O(1) otherwise.
+ *
+ * @return Held record (release with creds_release()), or NULL if unknown
+ */
+creds_t* creds_get(cred_user_t* user);
+
+/**
+ * Drop a reference to a record (NULL-safe)
+ */
+void creds_release(creds_t* creds);
+
+/**
+ * Compare /etc/passwd and /etc/group with what was last seen, and have
+ * every user looked up again if either changed
+ *
+ * @return 1 if they changed
+ */
+int creds_check(void);
+
+/**
+ * Have every user looked up again at its next launch, changed files or
+ * not (SIGHUP: NSS sources other than files may have changed)
+ */
+void creds_invalidate(void);
+
+/* ========================================================================
+ * Admission Control (limits.c)
+ * ======================================================================== */
+
+/**
+ * Intern the shared counter for a user or a crontab file
+ *
+ * Groups are never freed, so runs that outlive a reload still release
+ * their slot.
+ */
+limit_group_t* limit_group_user(const char* user);
+limit_group_t* limit_group_file(const char* path);
+
+/**
+ * Parse a "JCRON_OVERLAP=skip" style line into options
+ *
+ * Recognises JCRON_OVERLAP (allow|skip|queue|kill), JCRON_CATCHUP
+ * (skip|once|all[:max]), JCRON_TIMEOUT (seconds) and JCRON_PRIORITY
+ * (integer).
+ *
+ * @return 1 if the line was a JCRON_* setting (even an invalid one), 0 otherwise
+ */
+int job_options_parse(const char* line, job_options_t* options);
+
+/**
+ * Handle a fire: apply the job's overlap policy, then launch it if the
+ * limits allow, or park it in the bounded priority queue
+ */
+void job_submit(cron_job_t* job, int64_t scheduled);
+
+/**
+ * Launch queued fires that now fit the limits, highest priority first
+ */
+void job_dispatch(void);
+
+/**
+ * Release a held OVERLAP_QUEUE fire once the job has no live run
+ */
+void job_finished(cron_job_t* job);
+
+/**
+ * Forget the queued fires of a job that is about to be freed
+ */
+void job_queue_forget(const cron_job_t* job);
+
+/**
+ * Point a job's queued fires at its new record; `from` still holds the count
+ */
+void job_queue_move(const cron_job_t* from, cron_job_t* to);
+
+/**
+ * Log the counters
+ */
+void counters_log(void);
+
+/* ========================================================================
+ * Crontab Table (crontab.c)
+ * ======================================================================== */
+
+extern jcrond_paths_t crontab_paths;
+
+// A crontab file version: its arena holds the jobs parsed from it
+struct crontab_version {
+    arena_t arena;
+    int refs;            // The file while current, plus one per live run
+};
+
+/**
+ * Keep a file version alive for a run (NULL is ignored)
+ */
+void crontab_version_hold(crontab_version_t* version);
+
+/**
+ * Drop a reference; the last one frees the version (NULL is ignored)
+ */
+void crontab_version_release(crontab_version_t* version);
+
+// Next-fire scheduler over the slots of every loaded job
+extern jcron_sched_t job_sched;
+
+// Every loaded job by slot: its pattern, key and record (`data`)
+extern jcron_table_t job_table;
+
+// Fires are delayed by up to this many seconds (-W), by a fixed offset
+// hashed from each job's key, so jobs sharing a minute do not all start
+// at its first second (0 = off)
+extern int spread_window;
+
+/**
+ * Create the empty job table and its scheduler
+ *
+ * @return JCRON_OK or error code
+ */
+int crontab_init(jcron_sched_backend_t backend);
+
+/**
+ * Free every job and file (runs and queued fires are detached first)
+ */
+void crontab_free(void);
+
+/**
+ * Rescan every crontab location and apply the differences
+ *
+ * Files whose inode, size and mtime are unchanged are not re-read unless
+ * `force` is set; vanished files drop their jobs. Unchanged lines keep
+ * their job, slot and pending fire.
+ *
+ * @return Number of files re-read or removed
+ */
+int crontab_load_all(int force);
+
+/**
+ * Re-read one crontab path (or drop it if it is gone)
+ *
+ * Paths outside the crontab locations are ignored.
+ *
+ * @return 1 if the table changed, 0 otherwise
+ */
+int crontab_reload_path(const char* path);
+
+/**
+ * Job in a scheduler slot, or NULL
+ */
+cron_job_t* crontab_job(uint32_t slot);
+
+/**
+ * One past the highest slot in use (iterate slots with crontab_job())
+ */
+uint32_t crontab_slot_limit(void);
+
+/**
+ * Reschedule a job at its first fire at or after `from`
+ */
+void crontab_schedule_from(cron_job_t* job, int64_t from);
+
+/**
+ * Number of loaded jobs
+ */
+int crontab_job_count(void);
+
+/**
+ * Create a control-socket job, or replace one with a new definition
+ *
+ * The job gets its own version (no file) and the key of its name. A
+ * replacement takes over the old job's run state, runs and queued fires,
+ * and is rescheduled; the old record is freed with its last run. O(log n).
+ *
+ * @param name     Job name (its key; unique among control jobs)
+ * @param schedule Five cron fields ("H" allowed)
+ * @param user     User to run as, or NULL for root
+ * @param command  Command line
+ * @param live     Job to replace, or NULL
+ * @param out      The new job
+ * @return JCRON_OK, JCRON_ERR_INVALID_PATTERN, or JCRON_ERR_NO_MEMORY
+ */
+int crontab_job_define(const char* name, const char* schedule, const char* user,
+                       const char* command, cron_job_t* live, cron_job_t** out);
+
+/**
+ * Unschedule and free a control-socket job (its live runs finish
+ * unattached). O(log n).
+ */
+void crontab_job_remove(cron_job_t* job);
+
+/**
+ * Watch the crontab locations with inotify
+ *
+ * Directories that do not exist yet are skipped; call again (e.g. on
+ * SIGHUP) to pick them up.
+ *
+ * @return inotify descriptor for the event loop, or -1
+ */
+int crontab_watch(void);
+
+/**
+ * Drain inotify events and reload the files they name
+ *
+ * A queue overflow falls back to crontab_load_all(0).
+ *
+ * @return Number of files re-read or removed
+ */
+int crontab_watch_handle(void);
+
+/* ========================================================================
+ * Control Socket (control.c)
+ * ======================================================================== */
+
+// Unix socket served by control_start() (-C; NULL disables it)
+extern const char* control_path;
+
+// Largest request frame, header included
+#define CONTROL_FRAME_MAX 65536
+
+// Longest job name, schedule and user
+#define CONTROL_NAME_MAX 255
+
+// What a request asks for; jobs are named by the client
+typedef enum {
+    CONTROL_ADD = 1,     // name, schedule, user (empty: root), command
+    CONTROL_UPDATE,      // Same fields; the job keeps its run state
+    CONTROL_REMOVE,      // name
+    CONTROL_PAUSE,       // name: no fires until resumed
+    CONTROL_RESUME,      // name: scheduled again from the next minute
+    CONTROL_RUN,         // name: fire now (overlap policy and limits apply)
+    CONTROL_LIST         // Every control job, one CONTROL_ENTRY reply each
+} control_op_t;
+
+typedef enum {
+    CONTROL_OK = 0,
+    CONTROL_ENTRY,           // One job of a LIST; the final reply is CONTROL_OK
+    CONTROL_ERR_EXISTS,      // ADD of a name in use
+    CONTROL_ERR_NOT_FOUND,
+    CONTROL_ERR_INVALID,     // Malformed request, or a bad schedule
+    CONTROL_ERR_NO_MEMORY
+} control_status_t;
+
+// Request frame: this header, then the name, schedule, user and command
+// bytes back to back (no NULs). Integers in host byte order.
+typedef struct {
+    uint32_t length;         // Whole frame, header included
+    uint32_t tag;            // Echoed in the reply
+    uint8_t op;              // control_op_t
+    uint8_t reserved;
+    uint16_t name_len;
+    uint16_t schedule_len;
+    uint16_t user_len;
+    uint32_t command_len;
+} control_request_t;
+
+// Reply frame: this header, then for CONTROL_ENTRY the job's strings in
+// request order
+typedef struct {
+    uint32_t length;         // Whole frame, header included
+    uint32_t tag;            // The request's
+    uint8_t op;              // The request's
+    uint8_t status;          // control_status_t
+    uint8_t paused;          // CONTROL_ENTRY: the job is paused
+    uint8_t reserved;
+    uint16_t name_len;       // CONTROL_ENTRY string lengths
+    uint16_t schedule_len;
+    uint16_t user_len;
+    uint16_t reserved2;
+    uint32_t command_len;
+    int64_t next_fire;       // CONTROL_ENTRY: next fire (0: none, or paused)
+    int64_t last_run;        // CONTROL_ENTRY: last fire (0: never)
+} control_reply_t;
+
+/**
+ * Listen on control_path (only root and the daemon's user may connect)
+ *
+ * @return 0, or -1 if the socket cannot be created
+ */
+int control_start(void);
+
+/**
+ * Accept clients and answer their complete requests (call when
+ * control_fd() is readable)
+ */
+void control_handle(void);
+
+/**
+ * epoll fd readable when a client needs attention, or -1 when not serving
+ */
+int control_fd(void);
+
+/**
+ * Close the socket and drop its clients (control jobs stay loaded)
+ */
+void control_stop(void);
+
+/* ========================================================================
+ * Schedule Simulation (simulate.c)
+ * ======================================================================== */
+
+/**
+ * Parse a --from/--to time: a Unix timestamp, or YYYY-MM-DD[THH:MM[:SS]]
+ * in UTC
+ *
+ * @return Unix timestamp, or -1 if malformed
+ */
+int64_t simulate_parse_time(const char* text);
+
+/**
+ * Replay the loaded jobs' schedule from `from` to `to` (inclusive) on a
+ * virtual clock, without launching anything
+ *
+ * Reinitializes job_sched with `backend` at `from`. Prints one line per
+ * fire ("<UTC time> <user> <command>", in fire order), or with `summary`
+ * the fires per day (counted from `from`), the total and the busiest
+ * minute. Deterministic for the same crontabs.
+ *
+ * @return Number of fires, or -1 when out of memory
+ */
+int64_t simulate_run(jcron_sched_backend_t backend, int64_t from, int64_t to, int summary,
+                     FILE* out);
+
+/* ========================================================================
+ * Sharded Scheduling (shard.c)
+ * ======================================================================== */
+
+// Scheduler threads (0 = the main thread pops job_sched itself)
+extern int shard_count;
+
+// A due fire, popped by a shard thread
+typedef struct {
+    uint32_t slot;
+    int64_t when;
+    uint64_t key;        // Job key when scheduled, so a reused slot is not fired
+} shard_fire_t;
+
+/**
+ * Split scheduling over `count` threads and move job_sched's pending fires
+ * to them. Call after daemonizing.
+ *
+ * @return 0, or -1 (scheduling stays on the main thread)
+ */
+int shards_start(int count, jcron_sched_backend_t backend);
+
+/**
+ * Stop the scheduler threads (pending fires are dropped)
+ */
+void shards_stop(void);
+
+int shards_running(void);
+
+/**
+ * Set `slot` to the first fire at or after `from` of a pattern whose fires
+ * are delayed by `spread` seconds. Every schedule goes through here.
+ *
+ * @return JCRON_OK, or the jcron_next() error (the slot is then removed)
+ */
+int sched_set_next(jcron_sched_t* sched, uint32_t slot, const jcron_pattern_t* pattern,
+                   int32_t spread, int64_t from);
+
+/**
+ * Schedule a job at its first fire at or after `from`, on its shard or in
+ * job_sched. A job that never fires again, is paused, or belongs to
+ * another cluster node, is unscheduled.
+ *
+ * @return JCRON_OK, or the jcron_sched_set_next() error without shards
+ */
+int shard_schedule(cron_job_t* job, int64_t from);
+
+/**
+ * Drop a job's pending fire
+ */
+void shard_unschedule(cron_job_t* job);
+
+/**
+ * eventfd readable when shards have queued fires, or -1 without shards
+ */
+int shard_fire_fd(void);
+
+/**
+ * Take the next due fire from the shards
+ *
+ * @return 0, or -1 when there is none
+ */
+int shard_pop_fire(shard_fire_t* fire);
+
+/**
+ * Make every shard recompute its sleep (the wall clock was set)
+ */
+void shards_wake(void);
+
+/* ========================================================================
+ * Multi-node Ownership (cluster.c)
+ * ======================================================================== */
+
+// Shards jobs are placed in; every node of a cluster must agree on it
+#define CLUSTER_SHARDS 256
+
+// Most nodes one cluster takes (-N)
+#define CLUSTER_MAX_NODES 64
+
+// Lock directory shared by the nodes (-D; local, or NFS for several hosts).
+// Control-socket jobs are not shared: each node runs the ones it was given.
+extern const char* cluster_dir;
+
+// How often nodes probe each other and move shards (the takeover bound)
+extern int cluster_interval_ms;
+
+/**
+ * Join the cluster as `node` of `nodes` (0-based): open the lock files
+ * and hold this node's. Call before the crontabs are loaded: from then on
+ * shard_schedule() schedules only jobs of owned shards, and none are
+ * owned until cluster_check() takes them.
+ *
+ * @return 0, or -1 (the id is taken by a live node, or the directory is
+ *         unusable)
+ */
+int cluster_start(int node, int nodes);
+
+/**
+ * Shard of a job key
+ */
+uint32_t cluster_shard(uint64_t key);
+
+/**
+ * 1 if this node owns the key's shard (always, without a cluster)
+ */
+int cluster_owns(uint64_t key);
+
+/**
+ * 1 if a fire a shard thread popped for the key is this node's to run: the
+ * shard is owned, or it was let go after the fire was due (the new owner
+ * resumes after that)
+ */
+int cluster_owns_fire(uint64_t key, int64_t when);
+
+/**
+ * Shards owned (CLUSTER_SHARDS without a cluster)
+ */
+int cluster_owned(void);
+
+/**
+ * Probe the other nodes and move shards to their preferred live node, if
+ * cluster_next_ns() has passed (call from the main loop after taking due
+ * fires). Jobs of taken shards are scheduled from where their last owner
+ * stopped; jobs of released ones are unscheduled.
+ *
+ * @param handled_ms Time fires have been taken up to
+ * @return Number of shards taken or released
+ */
+int cluster_check(int64_t handled_ms);
+
+/**
+ * When cluster_check() next has work (CLOCK_MONOTONIC, ns), or -1
+ */
+int64_t cluster_next_ns(void);
+
+/**
+ * Let go of every shard, recording the time fired up to so the next owners
+ * resume there, and leave the cluster
+ */
+void cluster_stop(int64_t handled_ms);
+
+/* ========================================================================
+ * Missed-Run Catch-up (catchup.c)
+ * ======================================================================== */
+
+// Catch-up launches per second (token bucket, burst of one second)
+extern int catchup_rate;
+
+// Fires later than this (seconds) count as missed, not late
+#define CATCHUP_GRACE 120
+
+/**
+ * Handle the missed fires of a job in [first, until)
+ *
+ * `first` is the job's overdue fire. Counts the missed fires, applies the
+ * job's catch-up policy and queues the chosen fires for rate-limited
+ * submission. Sets last_run to the latest missed fire.
+ */
+void catchup_missed(cron_job_t* job, int64_t first, int64_t until);
+
+/**
+ * Submit queued catch-up fires the rate limit allows now
+ */
+void catchup_drain(void);
+
+/**
+ * When the next queued catch-up fire may be submitted (CLOCK_MONOTONIC, ns)
+ *
+ * @return Time, or -1 when nothing is queued
+ */
+int64_t catchup_next_ns(void);
+
+/**
+ * Forget the queued catch-up fires of a job that is about to be freed
+ */
+void catchup_forget(cron_job_t* job);
+
+/**
+ * Point a job's queued catch-up fires at its new record
+ */
+void catchup_move(const cron_job_t* from, cron_job_t* to);
+
+/* ========================================================================
+ * Run State (state.c)
+ * ======================================================================== */
+
+// State file path (NULL disables persistence)
+extern const char* state_path;
+
+/**
+ * Open the state file, replay its journal and restore the last run, exit
+ * status and duration of loaded jobs. Each job is rescheduled from its
+ * last run, so fires missed while down are caught up.
+ *
+ * @return Number of jobs restored, or -1 if the file could not be opened
+ */
+int state_load(void);
+
+/**
+ * Record that a job fired at its last_run (durable at the next commit,
+ * which must come before the fire is launched)
+ */
+void state_record_fire(cron_job_t* job);
+
+/**
+ * Record a job's last exit status and duration
+ */
+void state_record_exit(cron_job_t* job);
+
+/**
+ * Drop the state of a job removed from its crontab
+ */
+void state_forget(cron_job_t* job);
+
+/**
+ * Append the updates recorded since the last commit to the journal with
+ * one write, and fdatasync it if any of them is a fire (group commit)
+ *
+ * @return 0 on success, -1 on error
+ */
+int state_commit(void);
+
+/**
+ * Commit, checkpoint the snapshot and close the state file
+ */
+void state_close(void);
+
+/* ========================================================================
+ * Job Output (output.c)
+ * ======================================================================== */
+
+// Directory of per-job output logs (NULL: jobs inherit the daemon's stdio)
+extern const char* output_dir;
+
+// Ring size of each job's log, in bytes
+extern uint64_t output_capacity;
+
+/**
+ * Open a capture pipe for one run and record the run in the job's log
+ *
+ * @return Write end for the child's stdout and stderr (close it once the
+ *         child has it), or -1 to leave the child on the daemon's stdio
+ */
+int output_open(const cron_job_t* job, int64_t scheduled);
+
+/**
+ * Splice the output waiting in capture pipes into the logs (call when
+ * output_fd() is readable); pipes whose writers are all gone are closed
+ */
+void output_drain(void);
+
+/**
+ * epoll fd readable when a capture pipe has output, or -1 when disabled
+ */
+int output_fd(void);
+
+/**
+ * Number of capture pipes still open
+ */
+int output_open_count(void);
+
+/**
+ * Print the output of the last `runs` runs of every job whose command
+ * contains `pattern` (jcrond -o)
+ *
+ * @return Number of jobs matched
+ */
+int output_print(const char* pattern, int runs);
+
+/* ========================================================================
+ * Metrics (metrics.c)
+ * ======================================================================== */
+
+// Per-CPU counters, safe to bump from any thread
+typedef enum {
+    METRIC_FIRES = 0,        // Fires submitted (before overlap and limits)
+    METRIC_RUNS_FAILED,      // Runs that exited non-zero or on a signal
+    METRIC_LOG_DROPPED,      // Log messages lost to a full log ring
+    METRIC_COUNT
+} metric_t;
+
+// Per-CPU latency histograms, in microseconds
+typedef enum {
+    HIST_LATENESS = 0,       // Actual start minus scheduled time
+    HIST_SPAWN,              // Launch request to child exec'd
+    HIST_COUNT
+} histogram_t;
+
+// Unix socket served by metrics_start() (NULL disables the endpoint)
+extern const char* metrics_path;
+
+/**
+ * Allocate the per-CPU slots; until then recording is a no-op
+ *
+ * @return 0, or -1 when out of memory
+ */
+int metrics_init(void);
+
+/**
+ * Add to a counter (relaxed atomic on this CPU's slot)
+ */
+void metric_add(metric_t metric, uint64_t n);
+
+/**
+ * Record one value (negative values count as 0)
+ */
+void metric_observe(histogram_t histogram, int64_t value_us);
+
+/**
+ * Sum of a counter over every CPU
+ */
+uint64_t metric_value(metric_t metric);
+
+/**
+ * Render every metric as Prometheus text into a malloc'd buffer
+ *
+ * @return 0, or -1 when out of memory
+ */
+int metrics_render(char** text, size_t* len);
+
+/**
+ * Listen on metrics_path (HTTP/1.0 over a Unix socket)
+ *
+ * @return 0, or -1 if the socket cannot be created
+ */
+int metrics_start(void);
+
+/**
+ * Accept scrapes and answer the complete ones (call when metrics_fd() is
+ * readable)
+ */
+void metrics_handle(void);
+
+/**
+ * epoll fd readable when a scrape needs attention, or -1 when not serving
+ */
+int metrics_fd(void);
+
+/**
+ * Close the endpoint and remove its socket
+ */
+void metrics_stop(void);
+
+#endif /* JCROND_H */
@@ -0,0 +1,322 @@
+/**
+ * JCRON Daemon - Admission Control
+ *
+ * Every fire goes through job_submit(): the job's overlap policy decides
+ * whether it runs at all, then the global, per-user and per-file limits
+ * decide whether it runs now. Fires over a limit wait in a bounded queue
+ * ordered by priority (then arrival) and are launched by job_dispatch()
+ * as runs exit. When the queue is full the lowest-priority fire is dropped.
+ */
+
+#include "jcrond.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+
+jcrond_limits_t limits = {
+    .max_running = 256,
+    .max_per_user = 0,
+    .max_per_file = 0,
+    .queue_capacity = 1024
+};
+
+jcrond_counters_t counters;
+
+/* ========================================================================
+ * Limit Groups
+ * ======================================================================== */
+
+// Interned by name; chained hash tables of fixed size
+#define GROUP_BUCKETS 1024
+
+static limit_group_t* user_groups[GROUP_BUCKETS];
+static limit_group_t* file_groups[GROUP_BUCKETS];
+
+static limit_group_t* limit_group_intern(limit_group_t** buckets, const char* name) {
+    uint32_t hash = 2166136261u;  // FNV-1a
+    for (const char* p = name; *p; p++) {
+        hash = (hash ^ (unsigned char)*p) * 16777619u;
+    }
+    limit_group_t** list = &buckets[hash % GROUP_BUCKETS];
+
+    for (limit_group_t* group = *list; group; group = group->next) {
+        if (strcmp(group->name, name) == 0) return group;
+    }
+
+    limit_group_t* group = calloc(1, sizeof(limit_group_t));
+    if (!group || !(group->name = strdup(name))) {
+        free(group);
+        return NULL;  // Unlimited rather than unschedulable
+    }
+    group->next = *list;
+    *list = group;
+    return group;
+}
+
+limit_group_t* limit_group_user(const char* user) {
+    return limit_group_intern(user_groups, user);
+}
+
+limit_group_t* limit_group_file(const char* path) {
+    return limit_group_intern(file_groups, path);
+}
+
+/* ========================================================================
+ * Job Options
+ * ======================================================================== */
+
+int job_options_parse(const char* line, job_options_t* options) {
+    while (*line == ' ' || *line == '\t') line++;
+    if (strncmp(line, "JCRON_", 6) != 0) return 0;
+
+    const char* eq = strchr(line, '=');
+    if (!eq) return 0;
+
+    size_t name_len = (size_t)(eq - line);
+    while (name_len > 0 && isspace((unsigned char)line[name_len - 1])) name_len--;
+
+    const char* value = eq + 1;
+    while (*value == ' ' || *value == '\t') value++;
+
+    char* end;
+    if (name_len == 13 && strncmp(line, "JCRON_OVERLAP", 13) == 0) {
+        if (strncmp(value, "allow", 5) == 0) options->overlap = OVERLAP_ALLOW;
+        else if (strncmp(value, "skip", 4) == 0) options->overlap = OVERLAP_SKIP;
+        else if (strncmp(value, "queue", 5) == 0) options->overlap = OVERLAP_QUEUE;
+        else if (strncmp(value, "kill", 4) == 0) options->overlap = OVERLAP_KILL;
+        else log_message(LOG_WARNING, "Invalid JCRON_OVERLAP (allow|skip|queue|kill): %s", value);
+    } else if (name_len == 13 && strncmp(line, "JCRON_CATCHUP", 13) == 0) {
+        if (strncmp(value, "skip", 4) == 0) {
+            options->catchup = CATCHUP_SKIP;
+        } else if (strncmp(value, "once", 4) == 0) {
+            options->catchup = CATCHUP_ONCE;
+        } else if (strncmp(value, "all", 3) == 0) {
+            long max = value[3] == ':' ? strtol(value + 4, &end, 10) : 10;
+            if (max < 1 || max > 1000) {
+                log_message(LOG_WARNING, "Invalid JCRON_CATCHUP bound (1..1000): %s", value);
+            } else {
+                options->catchup = CATCHUP_ALL;
+                options->catchup_max = (int)max;
+            }
+        } else {
+            log_message(LOG_WARNING, "Invalid JCRON_CATCHUP (skip|once|all[:max]): %s", value);
+        }
+    } else if (name_len == 13 && strncmp(line, "JCRON_TIMEOUT", 13) == 0) {
+        long seconds = strtol(value, &end, 10);
+        if (end == value || seconds < 0 || seconds > 365L * 86400) {
+            log_message(LOG_WARNING, "Invalid JCRON_TIMEOUT (seconds): %s", value);
+        } else {
+            options->timeout_sec = (int)seconds;
+        }
+    } else if (name_len == 14 && strncmp(line, "JCRON_PRIORITY", 14) == 0) {
+        long priority = strtol(value, &end, 10);
+        if (end == value || priority < -1000 || priority > 1000) {
+            log_message(LOG_WARNING, "Invalid JCRON_PRIORITY (-1000..1000): %s", value);
+        } else {
+            options->priority = (int)priority;
+        }
+    } else {
+        log_message(LOG_WARNING, "Unknown setting: %.*s", (int)name_len, line);
+    }
+    return 1;
+}
+
+/* ========================================================================
+ * Admission Queue
+ * ======================================================================== */
+
+// One waiting fire
+typedef struct {
+    cron_job_t* job;
+    int64_t scheduled;
+    int64_t enqueued_ns;
+    int priority;
+} queued_fire_t;
+
+// Sorted by priority (desc), then arrival: dispatch scans from the front
+static queued_fire_t* queue = NULL;
+static int queue_len = 0;
+
+static int admissible(const cron_job_t* job) {
+    if (limits.max_running && exec_running() >= limits.max_running) return 0;
+    if (limits.max_per_user && job->user_group &&
+        job->user_group->running >= limits.max_per_user) return 0;
+    if (limits.max_per_file && job->file_group &&
+        job->file_group->running >= limits.max_per_file) return 0;
+    return 1;
+}
+
+static void queue_remove_at(int i) {
+    queue[i].job->queued--;
+    memmove(&queue[i], &queue[i + 1], (size_t)(queue_len - i - 1) * sizeof(queued_fire_t));
+    queue_len--;
+    counters.queue_depth = (uint32_t)queue_len;
+}
+
+static void queue_push(cron_job_t* job, int64_t scheduled) {
+    if (limits.queue_capacity <= 0) {
+        log_message(LOG_WARNING, "Limit reached and queueing disabled, dropped: %s", job->command);
+        counters.queue_dropped++;
+        return;
+    }
+    if (!queue && !(queue = malloc((size_t)limits.queue_capacity * sizeof(queued_fire_t)))) {
+        log_message(LOG_ERR, "Out of memory queueing job: %s", job->command);
+        counters.queue_dropped++;
+        return;
+    }
+
+    int priority = job->options.priority;
+    if (queue_len == limits.queue_capacity) {
+        // Full: the newcomer displaces the last entry only if it outranks it
+        queued_fire_t* last = &queue[queue_len - 1];
+        if (last->priority >= priority) {
+            log_message(LOG_WARNING, "Queue full, dropped: %s", job->command);
+            counters.queue_dropped++;
+            return;
+        }
+        log_message(LOG_WARNING, "Queue full, dropped lower priority: %s", last->job->command);
+        counters.queue_dropped++;
+        queue_remove_at(queue_len - 1);
+    }
+
+    // Insert after every entry of equal or higher priority
+    int lo = 0, hi = queue_len;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (queue[mid].priority >= priority) lo = mid + 1;
+        else hi = mid;
+    }
+    memmove(&queue[lo + 1], &queue[lo], (size_t)(queue_len - lo) * sizeof(queued_fire_t));
+    queue[lo] = (queued_fire_t){job, scheduled, monotonic_ns(), priority};
+    queue_len++;
+    job->queued++;
+
+    counters.queued++;
+    counters.queue_depth = (uint32_t)queue_len;
+    if (counters.queue_depth > counters.queue_depth_max) {
+        counters.queue_depth_max = counters.queue_depth;
+    }
+}
+
+void job_dispatch(void) {
+    int i = 0;
+    while (i < queue_len) {
+        if (limits.max_running && exec_running() >= limits.max_running) break;
+
+        queued_fire_t fire = queue[i];
+        if (!admissible(fire.job)) {
+            i++;  // Blocked by its user or file limit; later entries may fit
+            continue;
+        }
+
+        queue_remove_at(i);
+        uint64_t waited_ms = (uint64_t)((monotonic_ns() - fire.enqueued_ns) / 1000000);
+        counters.queue_wait_ms += waited_ms;
+        if (waited_ms > counters.queue_wait_max_ms) counters.queue_wait_max_ms = waited_ms;
+        exec_launch(fire.job, fire.scheduled);
+    }
+}
+
+/* ========================================================================
+ * Submission
+ * ======================================================================== */
+
+void job_submit(cron_job_t* job, int64_t scheduled) {
+    metric_add(METRIC_FIRES, 1);
+    if (job->running > 0 || job->queued > 0) {
+        switch (job->options.overlap) {
+            case OVERLAP_ALLOW:
+                break;
+            case OVERLAP_SKIP:
+                log_message(LOG_INFO, "Still running, skipped: %s", job->command);
+                counters.overlap_skipped++;
+                return;
+            case OVERLAP_QUEUE:
+                // Hold at most one fire; later ones fold into it
+                if (job->held_fire) {
+                    counters.overlap_skipped++;
+                } else {
+                    job->held_fire = scheduled;
+                    counters.overlap_held++;
+                }
+                return;
+            case OVERLAP_KILL:
+                // A fire still waiting for a slot is superseded, not doubled
+                for (int i = 0; i < queue_len; i++) {
+                    if (queue[i].job == job) {
+                        queue[i].scheduled = scheduled;
+                        return;
+                    }
+                }
+                if (exec_terminate_job(job) > 0) {
+                    log_message(LOG_INFO, "Still running, terminated previous run: %s",
+                                job->command);
+                    counters.overlap_killed++;
+                }
+                break;
+        }
+    }
+
+    // Dispatch runs whenever a slot frees up, so every queued fire is blocked
+    // by some limit: a fire that fits now takes nothing from them
+    if (admissible(job)) {
+        exec_launch(job, scheduled);
+    } else {
+        queue_push(job, scheduled);
+    }
+}
+
+void job_finished(cron_job_t* job) {
+    if (job->held_fire && job->running == 0 && job->queued == 0) {
+        int64_t scheduled = job->held_fire;
+        job->held_fire = 0;
+        job_submit(job, scheduled);
+    }
+}
+
+void job_queue_forget(const cron_job_t* job) {
+    for (int i = queue_len - 1; job->queued > 0 && i >= 0; i--) {
+        if (queue[i].job == job) {
+            log_message(LOG_INFO, "Job removed by reload, dropped queued run: %s", job->command);
+            queue_remove_at(i);
+        }
+    }
+}
+
+void job_queue_move(const cron_job_t* from, cron_job_t* to) {
+    for (int i = 0; from->queued > 0 && i < queue_len; i++) {
+        if (queue[i].job == from) queue[i].job = to;
+    }
+}
+
+void counters_log(void) {
+    log_message(LOG_INFO,
+                "Counters: launched %llu, failed %llu, running %d, queue depth %u (max %u), "
+                "queued %llu, dropped %llu, queue wait %llu ms (max %llu ms), "
+                "overlap skipped %llu, held %llu, killed %llu, timeouts %llu, "
+                "catch-up missed %llu, queued %llu, skipped %llu, "
+                "state commits %llu, syncs %llu, checkpoints %llu, output %llu bytes, "
+                "log dropped %llu",
+                (unsigned long long)counters.launched,
+                (unsigned long long)counters.launch_failed, exec_running(),
+                counters.queue_depth, counters.queue_depth_max,
+                (unsigned long long)counters.queued,
+                (unsigned long long)counters.queue_dropped,
+                (unsigned long long)counters.queue_wait_ms,
+                (unsigned long long)counters.queue_wait_max_ms,
+                (unsigned long long)counters.overlap_skipped,
+                (unsigned long long)counters.overlap_held,
+                (unsigned long long)counters.overlap_killed,
+                (unsigned long long)counters.timeouts,
+                (unsigned long long)counters.catchup_missed,
+                (unsigned long long)counters.catchup_queued,
+                (unsigned long long)counters.catchup_skipped,
+                (unsigned long long)counters.state_commits,
+                (unsigned long long)counters.state_syncs,
+                (unsigned long long)counters.state_checkpoints,
+                (unsigned long long)counters.output_bytes,
+                (unsigned long long)metric_value(METRIC_LOG_DROPPED));
+}
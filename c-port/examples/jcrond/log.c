@@ -0,0 +1,349 @@
+/**
+ * JCRON Daemon - Asynchronous Logging
+ *
+ * log_message() formats into a fixed-size record on the caller's stack and
+ * copies it into a lock-free ring; a writer thread drains the ring in
+ * batches and ships each batch with one sendmmsg() to the syslog socket,
+ * or one writev() to a JSON-lines file (-J). The fire path never makes a
+ * syscall to log, and never waits on syslogd.
+ *
+ * When the ring is full, records below LOG_WARNING are dropped and
+ * counted (log_dropped_total in the metrics, and a warning in the log once
+ * the writer catches up); warnings and errors wait for room. Messages
+ * longer than a record are truncated.
+ *
+ * Until log_start() (and after log_stop()) log_message() calls vsyslog()
+ * directly, so startup, shutdown and tools that never start the writer
+ * log synchronously as before.
+ */
+
+#include "jcrond.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <syslog.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+// Records the ring holds (4 MiB)
+#define LOG_RING 8192
+
+// Message bytes per record (the record is 512 bytes)
+#define LOG_RECORD_TEXT (512 - 16)
+
+// Records written per sendmmsg()/writev()
+#define LOG_BATCH 64
+
+// Longest formatted line: syslog header or JSON escaping included
+#define LOG_LINE_MAX (6 * LOG_RECORD_TEXT + 128)
+
+const char* log_json_path = NULL;
+const char* log_syslog_path = "/dev/log";
+
+// One message as queued by log_message()
+typedef struct {
+    int64_t time_us;
+    int32_t priority;
+    uint32_t len;
+    char text[LOG_RECORD_TEXT];
+} log_record_t;
+
+static ring_t records;
+static pthread_t writer;
+static sem_t wake;
+static int writer_running = 0;   // log_message() queues records
+static int writer_asleep = 0;    // Waiting on `wake`: the next record posts it
+static int writer_stopping = 0;
+static int reopen_pending = 0;
+static int log_mask = 0xff;      // setlogmask() as of log_start()
+
+// Writer thread state
+static int sink_fd = -1;
+static uint64_t dropped_reported = 0;
+static char lines[LOG_BATCH + 1][LOG_LINE_MAX];
+
+/* ========================================================================
+ * Sinks (writer thread)
+ * ======================================================================== */
+
+static void sink_open(void) {
+    if (log_json_path) {
+        sink_fd = open(log_json_path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0640);
+        if (sink_fd < 0) {
+            syslog(LOG_ERR, "Cannot open log file %s, logging to syslog: %s",
+                   log_json_path, strerror(errno));
+        }
+        return;
+    }
+
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", log_syslog_path);
+    sink_fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (sink_fd >= 0 && connect(sink_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(sink_fd);
+        sink_fd = -1;
+    }
+}
+
+static void sink_close(void) {
+    if (sink_fd >= 0) close(sink_fd);
+    sink_fd = -1;
+}
+
+// RFC 3164, as syslog(3) sends it: "<pri>Mmm dd hh:mm:ss jcrond[pid]: text"
+static size_t format_syslog(char* out, const log_record_t* record) {
+    time_t seconds = (time_t)(record->time_us / 1000000);
+    struct tm tm;
+    localtime_r(&seconds, &tm);
+    int priority = record->priority & LOG_FACMASK ? record->priority
+                                                 : record->priority | LOG_CRON;
+    int len = snprintf(out, LOG_LINE_MAX, "<%d>", priority);
+    len += (int)strftime(out + len, LOG_LINE_MAX - (size_t)len, "%b %e %H:%M:%S ", &tm);
+    len += snprintf(out + len, LOG_LINE_MAX - (size_t)len, "jcrond[%d]: ", (int)getpid());
+    memcpy(out + len, record->text, record->len);
+    return (size_t)len + record->len;
+}
+
+static size_t format_json(char* out, const log_record_t* record) {
+    static const char* const levels[] = {"emerg", "alert", "crit", "error",
+                                         "warning", "notice", "info", "debug"};
+    time_t seconds = (time_t)(record->time_us / 1000000);
+    struct tm tm;
+    gmtime_r(&seconds, &tm);
+    char stamp[32];
+    strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &tm);
+    char* p = out + sprintf(out, "{\"time\":\"%s.%06dZ\",\"level\":\"%s\",\"message\":\"", stamp,
+                            (int)(record->time_us % 1000000), levels[LOG_PRI(record->priority)]);
+
+    for (uint32_t i = 0; i < record->len; i++) {
+        unsigned char c = (unsigned char)record->text[i];
+        if (c == '"' || c == '\\') {
+            *p++ = '\\';
+            *p++ = (char)c;
+        } else if (c < 0x20) {
+            p += sprintf(p, "\\u%04x", c);
+        } else {
+            *p++ = (char)c;
+        }
+    }
+    memcpy(p, "\"}\n", 3);
+    return (size_t)(p + 3 - out);
+}
+
+// Ship formatted lines; records the sink cannot take go to syslog(3)
+static void sink_write(const log_record_t* const* sources, struct iovec* iov, int count) {
+    if (sink_fd >= 0 && log_json_path) {
+        struct iovec* next = iov;
+        int left = count;
+        while (left > 0) {
+            ssize_t n = writev(sink_fd, next, left);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            // Short write: skip what went out
+            while (left > 0 && (size_t)n >= next->iov_len) {
+                n -= (ssize_t)next->iov_len;
+                next++;
+                left--;
+            }
+            if (left > 0) {
+                next->iov_base = (char*)next->iov_base + n;
+                next->iov_len -= (size_t)n;
+            }
+        }
+        if (left == 0) return;
+        sources += count - left;
+        count = left;
+    } else if (sink_fd >= 0) {
+        struct mmsghdr messages[LOG_BATCH + 1];
+        memset(messages, 0, sizeof(messages));
+        for (int i = 0; i < count; i++) {
+            messages[i].msg_hdr.msg_iov = &iov[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+        int sent = 0;
+        for (int retried = 0; sent < count; ) {
+            int n = sendmmsg(sink_fd, messages + sent, (unsigned int)(count - sent), 0);
+            if (n > 0) {
+                sent += n;
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (!retried++) {
+                sink_close();  // syslogd restarted: its socket is a new one
+                sink_open();
+                if (sink_fd < 0) break;
+            } else {
+                break;
+            }
+        }
+        if (sent == count) return;
+        sources += sent;
+        count -= sent;
+    }
+
+    for (int i = 0; i < count; i++) {
+        syslog(sources[i]->priority, "%.*s", (int)sources[i]->len, sources[i]->text);
+    }
+}
+
+/* ========================================================================
+ * Writer Thread
+ * ======================================================================== */
+
+static int take_batch(log_record_t* batch) {
+    int count = 0;
+    while (count < LOG_BATCH && ring_pop(&records, &batch[count]) == 0) count++;
+    return count;
+}
+
+static void write_batch(const log_record_t* batch, int count) {
+    const log_record_t* sources[LOG_BATCH + 1];
+    struct iovec iov[LOG_BATCH + 1];
+    int n = 0;
+
+    // Drops since the last report go first, as a warning of their own
+    log_record_t report;
+    uint64_t dropped = metric_value(METRIC_LOG_DROPPED);
+    if (dropped != dropped_reported) {
+        report.time_us = now_us();
+        report.priority = LOG_WARNING;
+        int len = snprintf(report.text, sizeof(report.text),
+                           "Log ring full: %llu messages dropped",
+                           (unsigned long long)(dropped - dropped_reported));
+        report.len = (uint32_t)len;
+        dropped_reported = dropped;
+        sources[n++] = &report;
+    }
+    for (int i = 0; i < count; i++) sources[n++] = &batch[i];
+
+    for (int i = 0; i < n; i++) {
+        size_t len = log_json_path ? format_json(lines[i], sources[i])
+                                   : format_syslog(lines[i], sources[i]);
+        iov[i] = (struct iovec){lines[i], len};
+    }
+    sink_write(sources, iov, n);
+}
+
+static void* writer_main(void* arg) {
+    (void)arg;
+    static log_record_t batch[LOG_BATCH];
+    sink_open();
+
+    for (;;) {
+        if (__atomic_exchange_n(&reopen_pending, 0, __ATOMIC_ACQ_REL)) {
+            sink_close();
+            sink_open();
+        }
+        int count = take_batch(batch);
+        if (count > 0) {
+            write_batch(batch, count);
+            continue;
+        }
+        if (__atomic_load_n(&writer_stopping, __ATOMIC_ACQUIRE)) break;
+
+        // Announce the sleep, then look once more: a record pushed before
+        // the announcement was seen is taken now, one pushed after posts
+        __atomic_store_n(&writer_asleep, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        count = take_batch(batch);
+        if (count > 0) {
+            __atomic_store_n(&writer_asleep, 0, __ATOMIC_RELAXED);
+            write_batch(batch, count);
+            continue;
+        }
+        while (sem_wait(&wake) != 0 && errno == EINTR) {}
+    }
+
+    sink_close();
+    return NULL;
+}
+
+static void wake_writer(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_exchange_n(&writer_asleep, 0, __ATOMIC_SEQ_CST)) sem_post(&wake);
+}
+
+/* ========================================================================
+ * Interface
+ * ======================================================================== */
+
+void log_message(int priority, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    if (!__atomic_load_n(&writer_running, __ATOMIC_ACQUIRE)) {
+        vsyslog(priority, format, args);
+        va_end(args);
+        return;
+    }
+    if (!(LOG_MASK(LOG_PRI(priority)) & log_mask)) {
+        va_end(args);
+        return;
+    }
+
+    log_record_t record;
+    record.time_us = now_us();
+    record.priority = priority;
+    int len = vsnprintf(record.text, sizeof(record.text), format, args);
+    va_end(args);
+    record.len = len < 0 ? 0 : len < (int)sizeof(record.text) ? (uint32_t)len
+                                                               : sizeof(record.text) - 1;
+
+    while (ring_push(&records, &record) != 0) {
+        if (LOG_PRI(priority) > LOG_WARNING) {
+            metric_add(METRIC_LOG_DROPPED, 1);
+            return;
+        }
+        wake_writer();
+        sched_yield();
+    }
+    wake_writer();
+}
+
+int log_start(void) {
+    if (writer_running) return 0;
+    if (ring_init(&records, LOG_RING, sizeof(log_record_t)) != 0 || sem_init(&wake, 0, 0) != 0) {
+        ring_free(&records);
+        syslog(LOG_ERR, "Cannot start log writer, logging synchronously");
+        return -1;
+    }
+    log_mask = setlogmask(0);
+    dropped_reported = metric_value(METRIC_LOG_DROPPED);
+    writer_stopping = 0;
+    writer_asleep = 0;
+    if (pthread_create(&writer, NULL, writer_main, NULL) != 0) {
+        sem_destroy(&wake);
+        ring_free(&records);
+        syslog(LOG_ERR, "Cannot start log writer, logging synchronously");
+        return -1;
+    }
+    __atomic_store_n(&writer_running, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+void log_stop(void) {
+    if (!writer_running) return;
+    // Later messages go to vsyslog(); the writer drains what is queued
+    __atomic_store_n(&writer_running, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&writer_stopping, 1, __ATOMIC_RELEASE);
+    sem_post(&wake);
+    pthread_join(writer, NULL);
+    sem_destroy(&wake);
+    ring_free(&records);
+}
+
+void log_reopen(void) {
+    if (!writer_running) return;
+    __atomic_store_n(&reopen_pending, 1, __ATOMIC_RELEASE);
+    wake_writer();
+}
@@ -0,0 +1,387 @@
+/**
+ * JCRON Daemon - Metrics Endpoint
+ *
+ * Counters and latency histograms, served as Prometheus text over a Unix
+ * socket (-M, e.g. curl --unix-socket /run/jcrond.metrics http://x/metrics).
+ *
+ * Hot-path updates go to a per-CPU slot picked with sched_getcpu() and are
+ * relaxed atomic adds on a cache line no other CPU writes, so recording a
+ * fire or a launch costs a few nanoseconds from any thread (launch pool
+ * threads record their own spawns). A scrape sums the slots.
+ *
+ * Histograms are HDR-style: values below 128 us are exact, above that each
+ * power of two is split into 64 sub-buckets (under 1.6% error) up to
+ * 2^36 us (19 hours). Prometheus gets cumulative buckets at fixed bounds
+ * plus exact-to-the-bucket quantiles as separate gauges.
+ *
+ * The listening socket and its clients sit in an epoll set of their own;
+ * the main loop watches only metrics_fd() and calls metrics_handle().
+ * The daemon's other counters (limits.c) are main-thread only and are
+ * exported as they are.
+ */
+
+#include "jcrond.h"
+
+#include <errno.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define HIST_SUB_BITS 6
+#define HIST_SUB_COUNT (1 << HIST_SUB_BITS)
+#define HIST_MAX_LOG 36
+#define HIST_BUCKETS ((HIST_MAX_LOG - HIST_SUB_BITS + 1) * HIST_SUB_COUNT)
+#define MAX_SLOTS 64
+#define MAX_CLIENTS 16
+#define REQUEST_MAX 2048
+
+const char* metrics_path = "/run/jcrond.metrics";
+
+// One CPU's share; written by whichever threads run on that CPU
+typedef struct {
+    uint64_t counters[METRIC_COUNT];
+    uint64_t sums[HIST_COUNT];
+    uint64_t buckets[HIST_COUNT][HIST_BUCKETS];
+} __attribute__((aligned(64))) metrics_slot_t;
+
+static metrics_slot_t* slots = NULL;
+static int slot_count = 0;
+
+// A scrape in progress: the request is read before the answer is written
+typedef struct {
+    int fd;
+    size_t len;
+    char request[REQUEST_MAX];
+    char* out;               // Rendered answer, once the request is in
+    size_t out_len, out_sent;
+} metrics_client_t;
+
+static int epoll_fd = -1;
+static int listen_fd = -1;
+static int client_count = 0;
+
+/* ========================================================================
+ * Recording
+ * ======================================================================== */
+
+int metrics_init(void) {
+    if (slots) return 0;
+    long cpus = sysconf(_SC_NPROCESSORS_CONF);
+    int count = cpus < 1 ? 1 : cpus > MAX_SLOTS ? MAX_SLOTS : (int)cpus;
+    void* memory;
+    if (posix_memalign(&memory, 64, (size_t)count * sizeof(metrics_slot_t)) != 0) return -1;
+    memset(memory, 0, (size_t)count * sizeof(metrics_slot_t));
+    slots = memory;
+    slot_count = count;
+    return 0;
+}
+
+static metrics_slot_t* my_slot(void) {
+    int cpu = sched_getcpu();
+    return &slots[(cpu < 0 ? 0 : cpu) % slot_count];
+}
+
+void metric_add(metric_t metric, uint64_t n) {
+    if (!slots) return;
+    __atomic_fetch_add(&my_slot()->counters[metric], n, __ATOMIC_RELAXED);
+}
+
+static int bucket_of(uint64_t value) {
+    if (value < 2 * HIST_SUB_COUNT) return (int)value;
+    int log = 63 - __builtin_clzll(value);
+    if (log >= HIST_MAX_LOG) return HIST_BUCKETS - 1;
+    int shift = log - HIST_SUB_BITS;
+    return (shift + 1) * HIST_SUB_COUNT + (int)(value >> shift) - HIST_SUB_COUNT;
+}
+
+// Highest value that lands in `bucket`
+static uint64_t bucket_top(int bucket) {
+    if (bucket < 2 * HIST_SUB_COUNT) return (uint64_t)bucket;
+    int shift = bucket / HIST_SUB_COUNT - 1;
+    uint64_t sub = (uint64_t)(bucket % HIST_SUB_COUNT + HIST_SUB_COUNT);
+    return ((sub + 1) << shift) - 1;
+}
+
+void metric_observe(histogram_t histogram, int64_t value_us) {
+    if (!slots) return;
+    uint64_t value = value_us < 0 ? 0 : (uint64_t)value_us;
+    metrics_slot_t* slot = my_slot();
+    __atomic_fetch_add(&slot->buckets[histogram][bucket_of(value)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&slot->sums[histogram], value, __ATOMIC_RELAXED);
+}
+
+uint64_t metric_value(metric_t metric) {
+    uint64_t total = 0;
+    for (int s = 0; s < slot_count; s++) {
+        total += __atomic_load_n(&slots[s].counters[metric], __ATOMIC_RELAXED);
+    }
+    return total;
+}
+
+/* ========================================================================
+ * Exposition
+ * ======================================================================== */
+
+static void print_counter(FILE* out, const char* name, const char* help, uint64_t value) {
+    fprintf(out, "# HELP jcrond_%s %s\n# TYPE jcrond_%s counter\njcrond_%s %llu\n",
+            name, help, name, name, (unsigned long long)value);
+}
+
+static void print_gauge(FILE* out, const char* name, const char* help, double value) {
+    fprintf(out, "# HELP jcrond_%s %s\n# TYPE jcrond_%s gauge\njcrond_%s %.17g\n",
+            name, help, name, name, value);
+}
+
+static void print_histogram(FILE* out, histogram_t histogram, const char* name,
+                            const char* help) {
+    static const double bounds[] = {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01,
+                                    0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60, 300};
+    static uint64_t buckets[HIST_BUCKETS];
+    uint64_t count = 0, sum = 0;
+    for (int b = 0; b < HIST_BUCKETS; b++) {
+        buckets[b] = 0;
+        for (int s = 0; s < slot_count; s++) {
+            buckets[b] += __atomic_load_n(&slots[s].buckets[histogram][b], __ATOMIC_RELAXED);
+        }
+        count += buckets[b];
+    }
+    for (int s = 0; s < slot_count; s++) {
+        sum += __atomic_load_n(&slots[s].sums[histogram], __ATOMIC_RELAXED);
+    }
+
+    fprintf(out, "# HELP jcrond_%s_seconds %s\n# TYPE jcrond_%s_seconds histogram\n",
+            name, help, name);
+    uint64_t cumulative = 0;
+    int b = 0;
+    for (size_t i = 0; i < sizeof(bounds) / sizeof(bounds[0]); i++) {
+        uint64_t bound_us = (uint64_t)(bounds[i] * 1e6 + 0.5);
+        for (; b < HIST_BUCKETS && bucket_top(b) <= bound_us; b++) cumulative += buckets[b];
+        fprintf(out, "jcrond_%s_seconds_bucket{le=\"%g\"} %llu\n", name, bounds[i],
+                (unsigned long long)cumulative);
+    }
+    fprintf(out, "jcrond_%s_seconds_bucket{le=\"+Inf\"} %llu\n", name,
+            (unsigned long long)count);
+    fprintf(out, "jcrond_%s_seconds_sum %.6f\n", name, sum / 1e6);
+    fprintf(out, "jcrond_%s_seconds_count %llu\n", name, (unsigned long long)count);
+
+    static const double quantiles[] = {0.5, 0.9, 0.99, 0.999, 1};
+    fprintf(out, "# HELP jcrond_%s_quantile_seconds %s (HDR quantiles)\n"
+            "# TYPE jcrond_%s_quantile_seconds gauge\n", name, help, name);
+    for (size_t q = 0; q < sizeof(quantiles) / sizeof(quantiles[0]); q++) {
+        uint64_t rank = (uint64_t)(quantiles[q] * (double)count + 0.5);
+        if (rank < 1) rank = 1;
+        uint64_t seen = 0;
+        uint64_t value = 0;
+        for (int i = 0; count > 0 && i < HIST_BUCKETS; i++) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                value = bucket_top(i);
+                break;
+            }
+        }
+        fprintf(out, "jcrond_%s_quantile_seconds{quantile=\"%g\"} %.6f\n", name, quantiles[q],
+                value / 1e6);
+    }
+}
+
+int metrics_render(char** text, size_t* len) {
+    FILE* out = open_memstream(text, len);
+    if (!out) return -1;
+
+    print_gauge(out, "jobs", "Jobs loaded", crontab_job_count());
+    print_gauge(out, "running", "Runs alive", exec_running());
+    print_gauge(out, "queue_depth", "Fires waiting for a free slot", counters.queue_depth);
+    print_gauge(out, "cluster_shards_owned", "Job shards this node owns (of 256)",
+                cluster_owned());
+    print_counter(out, "fires_total", "Fires handled (before overlap and limits)",
+                  metric_value(METRIC_FIRES));
+    print_counter(out, "launched_total", "Runs started", counters.launched);
+    print_counter(out, "launch_failures_total", "Runs that could not be started",
+                  counters.launch_failed);
+    print_counter(out, "runs_failed_total", "Runs that exited non-zero or on a signal",
+                  metric_value(METRIC_RUNS_FAILED));
+    print_counter(out, "overlap_skipped_total", "Fires dropped by the overlap policy",
+                  counters.overlap_skipped);
+    print_counter(out, "overlap_killed_total", "Runs terminated by a newer fire",
+                  counters.overlap_killed);
+    print_counter(out, "queued_total", "Fires that waited for a free slot", counters.queued);
+    print_counter(out, "queue_dropped_total", "Fires lost to a full queue",
+                  counters.queue_dropped);
+    print_counter(out, "timeouts_total", "Runs terminated at their timeout", counters.timeouts);
+    print_counter(out, "catchup_missed_total", "Fires found missed", counters.catchup_missed);
+    print_counter(out, "catchup_queued_total", "Missed fires queued for catch-up",
+                  counters.catchup_queued);
+    print_counter(out, "state_syncs_total", "Run-state journal syncs", counters.state_syncs);
+    print_counter(out, "output_bytes_total", "Job output captured", counters.output_bytes);
+    print_counter(out, "log_dropped_total", "Log messages lost to a full log ring",
+                  metric_value(METRIC_LOG_DROPPED));
+    print_histogram(out, HIST_LATENESS, "fire_lateness",
+                    "Actual start minus scheduled time of each run");
+    print_histogram(out, HIST_SPAWN, "spawn_latency",
+                    "Launch request to child exec'd, including any wait for a launcher");
+
+    if (fclose(out) != 0) return -1;
+    return 0;
+}
+
+/* ========================================================================
+ * Endpoint
+ * ======================================================================== */
+
+int metrics_start(void) {
+    if (!metrics_path || listen_fd >= 0) return 0;
+    if (metrics_init() != 0) return -1;
+
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    if (strlen(metrics_path) >= sizeof(addr.sun_path)) {
+        log_message(LOG_ERR, "Metrics socket path too long: %s", metrics_path);
+        return -1;
+    }
+    strcpy(addr.sun_path, metrics_path);
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    unlink(metrics_path);
+    if (listen_fd < 0 || epoll_fd < 0 ||
+        bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        chmod(metrics_path, 0660) != 0 || listen(listen_fd, 16) != 0) {
+        log_message(LOG_ERR, "Cannot serve metrics on %s: %s", metrics_path, strerror(errno));
+        metrics_stop();
+        return -1;
+    }
+
+    struct epoll_event event = {.events = EPOLLIN};
+    event.data.ptr = NULL;  // The listening socket
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event);
+    return 0;
+}
+
+static void client_close(metrics_client_t* client) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+    free(client->out);
+    free(client);
+    client_count--;
+}
+
+// Send what is pending; -1 if the client is gone
+static int client_flush(metrics_client_t* client) {
+    while (client->out_sent < client->out_len) {
+        ssize_t n = send(client->fd, client->out + client->out_sent,
+                         client->out_len - client->out_sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) return 0;
+        if (n <= 0) return -1;
+        client->out_sent += (size_t)n;
+    }
+    return 0;
+}
+
+// Send the answer, the rest when the client has room for it
+static void client_send(metrics_client_t* client) {
+    if (client_flush(client) != 0 || client->out_sent == client->out_len) {
+        client_close(client);
+    }
+}
+
+static void client_answer(metrics_client_t* client) {
+    char* text = NULL;
+    size_t len = 0;
+    char header[128];
+    int header_len;
+    if (metrics_render(&text, &len) == 0) {
+        header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                              "Content-Length: %zu\r\n\r\n", len);
+    } else {
+        header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.0 500 Internal Server Error\r\n\r\n");
+        len = 0;
+    }
+
+    client->out = malloc((size_t)header_len + len);
+    if (!client->out) {
+        free(text);
+        client_close(client);
+        return;
+    }
+    memcpy(client->out, header, (size_t)header_len);
+    if (len > 0) memcpy(client->out + header_len, text, len);
+    client->out_len = (size_t)header_len + len;
+    free(text);
+
+    if (client_flush(client) != 0 || client->out_sent == client->out_len) {
+        client_close(client);
+        return;
+    }
+    // Never blocks the main loop: a slow reader gets the rest on EPOLLOUT
+    struct epoll_event event = {.events = EPOLLOUT};
+    event.data.ptr = client;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, client->fd, &event);
+}
+
+static void client_read(metrics_client_t* client) {
+    for (;;) {
+        ssize_t n = read(client->fd, client->request + client->len,
+                         sizeof(client->request) - 1 - client->len);
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) return;  // Rest of the request later
+        if (n <= 0) break;  // Closed its end: answer what we have
+        client->len += (size_t)n;
+        client->request[client->len] = '\0';
+        if (strstr(client->request, "\r\n\r\n") || strstr(client->request, "\n\n") ||
+            client->len == sizeof(client->request) - 1) {
+            break;
+        }
+    }
+    client_answer(client);
+}
+
+void metrics_handle(void) {
+    if (epoll_fd < 0) return;
+    struct epoll_event events[MAX_CLIENTS + 1];
+    int n = epoll_wait(epoll_fd, events, MAX_CLIENTS + 1, 0);
+    for (int i = 0; i < n; i++) {
+        metrics_client_t* client = events[i].data.ptr;
+        if (client) {
+            if (client->out) client_send(client);
+            else client_read(client);
+            continue;
+        }
+
+        int fd;
+        while ((fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+            client = client_count < MAX_CLIENTS ? calloc(1, sizeof(metrics_client_t)) : NULL;
+            if (!client) {
+                close(fd);  // Too many scrapes at once
+                continue;
+            }
+            client->fd = fd;
+            client_count++;
+            struct epoll_event event = {.events = EPOLLIN};
+            event.data.ptr = client;
+            epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+        }
+    }
+}
+
+int metrics_fd(void) {
+    return epoll_fd;
+}
+
+void metrics_stop(void) {
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        unlink(metrics_path);
+    }
+    if (epoll_fd >= 0) close(epoll_fd);  // Clients still open are dropped with it
+    listen_fd = -1;
+    epoll_fd = -1;
+}
@@ -0,0 +1,318 @@
+/**
+ * JCRON Daemon - Job Output Capture
+ *
+ * Each run's stdout and stderr share one pipe into the daemon. What
+ * arrives is moved with splice() straight from the pipe into the job's log
+ * file, so job output never passes through a userspace buffer.
+ *
+ * A log file holds one job (named after its key) and is a ring: a 4 KiB
+ * header, then `output_capacity` bytes of data written at (offset mod
+ * capacity), so a chatty job overwrites its own oldest output and the file
+ * never grows. The header also keeps the byte range of the last
+ * OUTPUT_RUNS runs, which is what `jcrond -o` prints. Runs of the same job
+ * that overlap write into the same ring as their output arrives.
+ *
+ * Pipes are watched by an epoll set of their own; the main loop watches
+ * only output_fd() and calls output_drain().
+ */
+
+#include "jcrond.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define OUTPUT_MAGIC "JCROUT1"
+#define OUTPUT_RUNS 64
+#define OUTPUT_HEADER_SIZE 4096
+#define OUTPUT_PIPE_SIZE (256 * 1024)
+#define OUTPUT_DRAIN_BYTES (1 << 20)   // Per pipe per output_drain(), for fairness
+
+const char* output_dir = "/var/lib/jcrond/output";
+uint64_t output_capacity = 1 << 20;
+
+// One run's output: bytes [start, end) of the job's stream
+typedef struct {
+    int64_t scheduled;
+    int64_t started_ms;   // Wall clock at launch
+    uint64_t start;
+    uint64_t end;         // Grows while output arrives
+    int32_t open;         // 1 until the pipe closes
+    int32_t reserved;
+} output_run_t;
+
+// Log file header (the data ring follows at OUTPUT_HEADER_SIZE)
+typedef struct {
+    char magic[8];
+    uint64_t capacity;
+    uint64_t written;     // Bytes ever written; the next one goes at written % capacity
+    uint64_t runs;        // Runs ever recorded; run n is in run[n % OUTPUT_RUNS]
+    char command[256];
+    output_run_t run[OUTPUT_RUNS];
+} output_header_t;
+
+// A pipe being drained
+typedef struct {
+    int pipe_fd;
+    int file_fd;
+    output_header_t* header;
+    output_run_t* run;
+} output_stream_t;
+
+static int epoll_fd = -1;
+static int stream_count = 0;
+
+/* ========================================================================
+ * Log Files
+ * ======================================================================== */
+
+static output_header_t* log_open(uint64_t key, const char* command, int* fd_out) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%016llx.log", output_dir, (unsigned long long)key);
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size != OUTPUT_HEADER_SIZE + output_capacity) {
+        // New, or sized for another capacity: start over
+        if (ftruncate(fd, 0) != 0 ||
+            ftruncate(fd, (off_t)(OUTPUT_HEADER_SIZE + output_capacity)) != 0) {
+            close(fd);
+            return NULL;
+        }
+    }
+    output_header_t* header = mmap(NULL, OUTPUT_HEADER_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED,
+                                   fd, 0);
+    if (header == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+    if (memcmp(header->magic, OUTPUT_MAGIC, sizeof(header->magic)) != 0 ||
+        header->capacity != output_capacity) {
+        memset(header, 0, OUTPUT_HEADER_SIZE);
+        memcpy(header->magic, OUTPUT_MAGIC, sizeof(header->magic));
+        header->capacity = output_capacity;
+    }
+    snprintf(header->command, sizeof(header->command), "%s", command);
+    *fd_out = fd;
+    return header;
+}
+
+static void stream_close(output_stream_t* stream) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, stream->pipe_fd, NULL);
+    close(stream->pipe_fd);
+    stream->run->open = 0;
+    munmap(stream->header, OUTPUT_HEADER_SIZE);
+    close(stream->file_fd);
+    free(stream);
+    stream_count--;
+}
+
+/* ========================================================================
+ * Capture
+ * ======================================================================== */
+
+// Create the directory (and its parent) and the epoll set on first use
+static int output_init(void) {
+    if (epoll_fd >= 0) return 0;
+    char parent[PATH_MAX];
+    snprintf(parent, sizeof(parent), "%s", output_dir);
+    char* slash = strrchr(parent, '/');
+    if (slash && slash != parent) {
+        *slash = '\0';
+        mkdir(parent, 0755);
+    }
+    mkdir(output_dir, 0700);
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    return epoll_fd < 0 ? -1 : 0;
+}
+
+int output_open(const cron_job_t* job, int64_t scheduled) {
+    if (!output_dir || output_init() != 0) return -1;
+
+    int pipe_fds[2];
+    if (pipe2(pipe_fds, O_CLOEXEC) != 0) return -1;
+    fcntl(pipe_fds[0], F_SETFL, O_NONBLOCK);  // The job's end stays blocking
+    fcntl(pipe_fds[0], F_SETPIPE_SZ, OUTPUT_PIPE_SIZE);
+
+    output_stream_t* stream = calloc(1, sizeof(output_stream_t));
+    if (!stream) goto fail;
+    stream->pipe_fd = pipe_fds[0];
+    stream->header = log_open(job->key, job->command, &stream->file_fd);
+    if (!stream->header) {
+        log_message(LOG_ERR, "Cannot open output log for %s in %s: %s", job->command,
+                    output_dir, strerror(errno));
+        goto fail;
+    }
+
+    output_header_t* header = stream->header;
+    stream->run = &header->run[header->runs++ % OUTPUT_RUNS];
+    *stream->run = (output_run_t){scheduled, now_ms(), header->written, header->written, 1, 0};
+
+    struct epoll_event event = {.events = EPOLLIN};
+    event.data.ptr = stream;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pipe_fds[0], &event) != 0) {
+        stream->run->open = 0;
+        munmap(header, OUTPUT_HEADER_SIZE);
+        close(stream->file_fd);
+        goto fail;
+    }
+    stream_count++;
+    return pipe_fds[1];
+
+fail:
+    free(stream);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    return -1;
+}
+
+// Splice what the pipe holds into the ring; 1 once the pipe has closed
+static int stream_drain(output_stream_t* stream) {
+    output_header_t* header = stream->header;
+    uint64_t moved = 0;
+    int closed = 0;
+
+    while (moved < OUTPUT_DRAIN_BYTES) {
+        // Never across the end of the ring
+        uint64_t at = header->written % header->capacity;
+        loff_t offset = (loff_t)(OUTPUT_HEADER_SIZE + at);
+        size_t len = (size_t)(header->capacity - at);
+        if (len > OUTPUT_DRAIN_BYTES - moved) len = (size_t)(OUTPUT_DRAIN_BYTES - moved);
+
+        ssize_t n = splice(stream->pipe_fd, NULL, stream->file_fd, &offset, len,
+                           SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (n == 0) {
+            closed = 1;
+            break;
+        }
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EINTR) break;
+            log_message(LOG_ERR, "Cannot capture job output: %s", strerror(errno));
+            closed = 1;
+            break;
+        }
+        header->written += (uint64_t)n;
+        stream->run->end = header->written;
+        moved += (uint64_t)n;
+    }
+    counters.output_bytes += moved;
+    return closed;
+}
+
+void output_drain(void) {
+    if (epoll_fd < 0) return;
+    // Level-triggered: pipes left with data wake the main loop again
+    struct epoll_event events[64];
+    int n = epoll_wait(epoll_fd, events, 64, 0);
+    for (int i = 0; i < n; i++) {
+        output_stream_t* stream = events[i].data.ptr;
+        if (stream_drain(stream)) stream_close(stream);
+    }
+}
+
+int output_fd(void) {
+    if (output_dir) output_init();
+    return epoll_fd;
+}
+
+int output_open_count(void) {
+    return stream_count;
+}
+
+/* ========================================================================
+ * Retrieval
+ * ======================================================================== */
+
+// Copy [from, to) of the ring at `fd` to stdout, wrapping at the end
+static void print_range(int fd, uint64_t capacity, uint64_t from, uint64_t to) {
+    fflush(stdout);
+    while (from < to) {
+        uint64_t at = from % capacity;
+        size_t len = (size_t)(to - from);
+        if (len > capacity - at) len = (size_t)(capacity - at);
+        off_t offset = (off_t)(OUTPUT_HEADER_SIZE + at);
+        ssize_t n = sendfile(STDOUT_FILENO, fd, &offset, len);
+        if (n < 0 && (errno == EINVAL || errno == ENOSYS)) {
+            // stdout that sendfile() cannot write to (a socket on some kernels)
+            char buf[65536];
+            n = pread(fd, buf, len < sizeof(buf) ? len : sizeof(buf), offset);
+            if (n > 0) n = write(STDOUT_FILENO, buf, (size_t)n);
+        }
+        if (n <= 0) return;
+        from += (uint64_t)n;
+    }
+}
+
+static void print_log(const char* path, const char* pattern, int runs, int* matched) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    output_header_t header;
+    if (pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        memcmp(header.magic, OUTPUT_MAGIC, sizeof(header.magic)) != 0 || header.capacity == 0) {
+        close(fd);
+        return;
+    }
+    header.command[sizeof(header.command) - 1] = '\0';
+    if (!strstr(header.command, pattern)) {
+        close(fd);
+        return;
+    }
+
+    (*matched)++;
+    printf("==> %s (%s)\n", header.command, path);
+    uint64_t first = header.runs > (uint64_t)runs ? header.runs - (uint64_t)runs : 0;
+    if (header.runs > OUTPUT_RUNS && first < header.runs - OUTPUT_RUNS) {
+        first = header.runs - OUTPUT_RUNS;
+    }
+    // Bytes older than one capacity have been overwritten
+    uint64_t oldest = header.written > header.capacity ? header.written - header.capacity : 0;
+
+    for (uint64_t r = first; r < header.runs; r++) {
+        const output_run_t* run = &header.run[r % OUTPUT_RUNS];
+        time_t started = (time_t)(run->started_ms / 1000);
+        char when[32];
+        strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", localtime(&started));
+
+        uint64_t start = run->start > oldest ? run->start : oldest;
+        uint64_t end = run->end > start ? run->end : start;
+        const char* lost = run->end <= oldest && run->end > run->start ? ", overwritten"
+                         : run->start < oldest ? ", beginning overwritten" : "";
+        printf("--- run started %s, %llu bytes%s%s\n", when,
+               (unsigned long long)(run->end - run->start), lost,
+               run->open ? ", still running" : "");
+        print_range(fd, header.capacity, start, end);
+    }
+    close(fd);
+}
+
+int output_print(const char* pattern, int runs) {
+    if (!output_dir) return 0;
+    DIR* dir = opendir(output_dir);
+    if (!dir) {
+        fprintf(stderr, "Cannot open %s: %s\n", output_dir, strerror(errno));
+        return 0;
+    }
+
+    int matched = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir))) {
+        size_t len = strlen(entry->d_name);
+        if (len < 5 || strcmp(entry->d_name + len - 4, ".log") != 0) continue;
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", output_dir, entry->d_name);
+        print_log(path, pattern, runs, &matched);
+    }
+    closedir(dir);
+    return matched;
+}
@@ -0,0 +1,82 @@
+/**
+ * JCRON Daemon - Lock-free Bounded Queues
+ *
+ * Fixed-capacity ring with a sequence number per cell (Vyukov's bounded
+ * MPMC queue). Producers claim a cell by advancing the tail with one CAS,
+ * consumers claim one by advancing the head; the cell's sequence number
+ * tells each side whether the other has finished with it. Nothing blocks
+ * and nothing allocates after ring_init(), so a stalled thread can delay
+ * only the cell it holds.
+ *
+ * The threads that talk through these rings sleep on eventfds or
+ * semaphores of their own; a ring only moves the data.
+ */
+
+#include "jcrond.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+int ring_init(ring_t* ring, uint32_t capacity, size_t elem_size) {
+    memset(ring, 0, sizeof(*ring));
+    uint32_t size = 2;
+    while (size < capacity) size *= 2;
+
+    ring->sequence = malloc((size_t)size * sizeof(uint64_t));
+    ring->cells = malloc((size_t)size * elem_size);
+    if (!ring->sequence || !ring->cells) {
+        ring_free(ring);
+        return -1;
+    }
+    for (uint32_t i = 0; i < size; i++) ring->sequence[i] = i;
+    ring->mask = size - 1;
+    ring->elem_size = elem_size;
+    return 0;
+}
+
+void ring_free(ring_t* ring) {
+    free(ring->sequence);
+    free(ring->cells);
+    memset(ring, 0, sizeof(*ring));
+}
+
+int ring_push(ring_t* ring, const void* elem) {
+    uint64_t pos = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    for (;;) {
+        uint64_t* sequence = &ring->sequence[pos & ring->mask];
+        int64_t diff = (int64_t)(__atomic_load_n(sequence, __ATOMIC_ACQUIRE) - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&ring->tail, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                memcpy(ring->cells + (pos & ring->mask) * ring->elem_size, elem, ring->elem_size);
+                __atomic_store_n(sequence, pos + 1, __ATOMIC_RELEASE);
+                return 0;
+            }
+            // pos was reloaded by the failed CAS
+        } else if (diff < 0) {
+            return -1;  // Full
+        } else {
+            pos = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+int ring_pop(ring_t* ring, void* elem) {
+    uint64_t pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    for (;;) {
+        uint64_t* sequence = &ring->sequence[pos & ring->mask];
+        int64_t diff = (int64_t)(__atomic_load_n(sequence, __ATOMIC_ACQUIRE) - (pos + 1));
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&ring->head, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                memcpy(elem, ring->cells + (pos & ring->mask) * ring->elem_size, ring->elem_size);
+                __atomic_store_n(sequence, pos + ring->mask + 1, __ATOMIC_RELEASE);
+                return 0;
+            }
+        } else if (diff < 0) {
+            return -1;  // Empty
+        } else {
+            pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+        }
+    }
+}
@@ -0,0 +1,342 @@
+/**
+ * JCRON Daemon - Sharded Scheduling
+ *
+ * With -t N the job table is split into N shards, each with its own
+ * jcron_sched_t on its own thread (pinned to a CPU). A shard sleeps until
+ * its earliest fire, pops what is due, computes each job's next fire and
+ * hands the due fires to the main thread through one lock-free fire ring.
+ * Schedule changes reach a shard through its own command ring; a shard
+ * owns a copy of each job's pattern, so it never reads the job table.
+ *
+ * Jobs are spread by slot (slot % N), with local slot slot / N: slots are
+ * dense and reused, so shards stay evenly loaded and their per-slot
+ * arrays stay compact. There is no lock anywhere on the fire path; the
+ * main thread remains the only one touching jobs, limits and run state.
+ *
+ * Without shards (the default) the main thread pops job_sched itself and
+ * the functions here schedule into it directly.
+ *
+ * A job with a spread offset fires that many seconds after each match of
+ * its pattern. Scheduled times always include the offset, so the next
+ * match is looked up from `from - spread`.
+ */
+
+#include "jcrond.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#define SHARD_COMMANDS 65536
+#define SHARD_FIRES 65536
+
+int shard_count = 0;
+
+typedef enum {
+    SHARD_SET,           // Fire at exactly `when` (moving a schedule in)
+    SHARD_SET_NEXT,      // Fire at the first match at or after `when`
+    SHARD_REMOVE
+} shard_op_t;
+
+typedef struct {
+    shard_op_t op;
+    uint32_t slot;       // Local slot
+    uint64_t key;
+    int32_t spread;
+    int64_t when;
+    jcron_pattern_t pattern;
+} shard_command_t;
+
+typedef struct {
+    pthread_t thread;
+    int index;
+    jcron_sched_t sched;
+    jcron_pattern_t* patterns;   // By local slot
+    uint64_t* keys;
+    int32_t* spreads;
+    uint32_t capacity;
+    ring_t commands;
+    int wake_fd;                 // eventfd: commands waiting, clock changed or stop
+    int sleeping;                // Set while the thread waits on wake_fd
+} shard_t;
+
+static shard_t* shards = NULL;
+static int active = 0;
+static int stopping = 0;
+static ring_t fires;
+static int fire_fd = -1;
+
+/* ========================================================================
+ * Shard Thread
+ * ======================================================================== */
+
+static int shard_reserve(shard_t* shard, uint32_t slot) {
+    if (slot < shard->capacity) return 0;
+    uint32_t capacity = shard->capacity ? shard->capacity : 256;
+    while (capacity <= slot) capacity *= 2;
+
+    jcron_pattern_t* patterns = realloc(shard->patterns, capacity * sizeof(jcron_pattern_t));
+    if (patterns) shard->patterns = patterns;
+    uint64_t* keys = realloc(shard->keys, capacity * sizeof(uint64_t));
+    if (keys) shard->keys = keys;
+    int32_t* spreads = realloc(shard->spreads, capacity * sizeof(int32_t));
+    if (spreads) shard->spreads = spreads;
+    if (!patterns || !keys || !spreads) return -1;
+    shard->capacity = capacity;
+    return 0;
+}
+
+static void shard_apply(shard_t* shard, const shard_command_t* command) {
+    if (command->op == SHARD_REMOVE) {
+        jcron_sched_remove(&shard->sched, command->slot);
+        return;
+    }
+    if (shard_reserve(shard, command->slot) != 0) {
+        log_message(LOG_ERR, "Out of memory scheduling shard %d", shard->index);
+        return;
+    }
+    shard->patterns[command->slot] = command->pattern;
+    shard->keys[command->slot] = command->key;
+    shard->spreads[command->slot] = command->spread;
+
+    int ret = command->op == SHARD_SET
+        ? jcron_sched_set(&shard->sched, command->slot, command->when)
+        : sched_set_next(&shard->sched, command->slot, &command->pattern, command->spread,
+                         command->when);
+    if (ret != JCRON_OK) jcron_sched_remove(&shard->sched, command->slot);
+}
+
+static void notify(int fd) {
+    uint64_t one = 1;
+    ssize_t ignored = write(fd, &one, sizeof(one));
+    (void)ignored;
+}
+
+static void* shard_main(void* arg) {
+    shard_t* shard = arg;
+    thread_pin(shard->index);
+
+    while (!__atomic_load_n(&stopping, __ATOMIC_ACQUIRE)) {
+        shard_command_t command;
+        while (ring_pop(&shard->commands, &command) == 0) shard_apply(shard, &command);
+
+        // Pop due fires and queue each job's next one, as run_due_jobs()
+        // does without shards
+        int64_t now = now_ms();
+        int64_t current_minute = now / 60000 * 60;
+        int64_t when;
+        int fired = 0;
+        int backlog = 0;
+        for (int slot; (slot = jcron_sched_pop(&shard->sched, now / 1000, &when)) >= 0; ) {
+            shard_fire_t fire = {(uint32_t)slot * (uint32_t)shard_count + (uint32_t)shard->index,
+                                 when, shard->keys[slot]};
+            if (ring_push(&fires, &fire) != 0) {
+                // Main thread is behind. Keep the fire due and go back to
+                // the commands: the main thread may be blocked sending one.
+                jcron_sched_set(&shard->sched, (uint32_t)slot, when);
+                backlog = 1;
+                break;
+            }
+            fired++;
+
+            int64_t from = when + 60;
+            if (from < current_minute) from = current_minute;
+            sched_set_next(&shard->sched, (uint32_t)slot, &shard->patterns[slot],
+                           shard->spreads[slot], from);
+        }
+        if (fired || backlog) notify(fire_fd);
+
+        // Sleep until the next fire or a command. Announce the sleep first
+        // and look at the ring once more, so a push that raced with the
+        // drain above still wakes us.
+        __atomic_store_n(&shard->sleeping, 1, __ATOMIC_SEQ_CST);
+        if (ring_pop(&shard->commands, &command) == 0) {
+            __atomic_store_n(&shard->sleeping, 0, __ATOMIC_SEQ_CST);
+            shard_apply(shard, &command);
+            continue;
+        }
+
+        int timeout = -1;
+        if (backlog) {
+            timeout = 1;  // Retry once the main thread has taken some fires
+        } else if (jcron_sched_next_wakeup(&shard->sched, &when) == JCRON_OK) {
+            int64_t wait_ms = when * 1000 - now_ms();
+            timeout = wait_ms < 0 ? 0 : wait_ms > INT_MAX ? INT_MAX : (int)wait_ms;
+        }
+        struct pollfd pfd = {shard->wake_fd, POLLIN, 0};
+        if (poll(&pfd, 1, timeout) > 0) {
+            uint64_t count;
+            ssize_t ignored = read(shard->wake_fd, &count, sizeof(count));
+            (void)ignored;
+        }
+        __atomic_store_n(&shard->sleeping, 0, __ATOMIC_SEQ_CST);
+    }
+    return NULL;
+}
+
+/* ========================================================================
+ * Main Thread Side
+ * ======================================================================== */
+
+static void shard_send(const shard_command_t* command, uint32_t slot) {
+    shard_t* shard = &shards[slot % (uint32_t)shard_count];
+    while (ring_push(&shard->commands, command) != 0) {
+        notify(shard->wake_fd);  // Full: the shard may be asleep on a long wait
+        sched_yield();
+    }
+    if (__atomic_exchange_n(&shard->sleeping, 0, __ATOMIC_SEQ_CST)) notify(shard->wake_fd);
+}
+
+int shards_start(int count, jcron_sched_backend_t backend) {
+    if (count <= 0 || active) return 0;
+    if (ring_init(&fires, SHARD_FIRES, sizeof(shard_fire_t)) != 0) return -1;
+    fire_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    shards = calloc((size_t)count, sizeof(shard_t));
+    if (!shards || fire_fd < 0) goto fail;
+
+    int64_t now = now_ms() / 1000;
+    for (int i = 0; i < count; i++) {
+        shard_t* shard = &shards[i];
+        shard->index = i;
+        shard->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        int ret = backend == JCRON_SCHED_WHEEL
+            ? jcron_sched_init_wheel(&shard->sched, 256, now)
+            : jcron_sched_init(&shard->sched, 256);
+        if (shard->wake_fd < 0 || ret != JCRON_OK ||
+            ring_init(&shard->commands, SHARD_COMMANDS, sizeof(shard_command_t)) != 0) {
+            shard_count = i + 1;
+            goto fail;
+        }
+    }
+
+    shard_count = count;
+    stopping = 0;
+    for (int i = 0; i < count; i++) {
+        if (pthread_create(&shards[i].thread, NULL, shard_main, &shards[i]) != 0) {
+            log_message(LOG_ERR, "Cannot start scheduler thread: %s", strerror(errno));
+            __atomic_store_n(&stopping, 1, __ATOMIC_RELEASE);
+            for (int j = 0; j < i; j++) {
+                notify(shards[j].wake_fd);
+                pthread_join(shards[j].thread, NULL);
+            }
+            goto fail;
+        }
+    }
+    active = 1;
+
+    // Hand every pending fire over to its shard, keeping its time
+    int64_t when;
+    for (int slot; (slot = jcron_sched_pop(&job_sched, INT64_MAX, &when)) >= 0; ) {
+        cron_job_t* job = crontab_job((uint32_t)slot);
+        if (!job) continue;
+        shard_command_t command = {SHARD_SET, (uint32_t)slot / (uint32_t)count, job->key,
+                                   job->spread, when, job_table.patterns[slot]};
+        shard_send(&command, (uint32_t)slot);
+    }
+    return 0;
+
+fail:
+    log_message(LOG_ERR, "Cannot start %d scheduler shards, scheduling on the main thread",
+                count);
+    for (int i = 0; shards && i < shard_count; i++) {
+        if (shards[i].wake_fd > 0) close(shards[i].wake_fd);
+        jcron_sched_free(&shards[i].sched);
+        ring_free(&shards[i].commands);
+    }
+    free(shards);
+    shards = NULL;
+    shard_count = 0;
+    if (fire_fd >= 0) close(fire_fd);
+    fire_fd = -1;
+    ring_free(&fires);
+    return -1;
+}
+
+void shards_stop(void) {
+    if (!active) return;
+    __atomic_store_n(&stopping, 1, __ATOMIC_RELEASE);
+    for (int i = 0; i < shard_count; i++) {
+        notify(shards[i].wake_fd);
+        pthread_join(shards[i].thread, NULL);
+    }
+    for (int i = 0; i < shard_count; i++) {
+        close(shards[i].wake_fd);
+        jcron_sched_free(&shards[i].sched);
+        ring_free(&shards[i].commands);
+        free(shards[i].patterns);
+        free(shards[i].keys);
+        free(shards[i].spreads);
+    }
+    free(shards);
+    shards = NULL;
+    shard_count = 0;
+    active = 0;
+    close(fire_fd);
+    fire_fd = -1;
+    ring_free(&fires);
+}
+
+int shards_running(void) {
+    return active;
+}
+
+int sched_set_next(jcron_sched_t* sched, uint32_t slot, const jcron_pattern_t* pattern,
+                   int32_t spread, int64_t from) {
+    // jcron_next() matches from the start of the minute it is given
+    int64_t first = (from - spread + 59) / 60 * 60;
+    jcron_result_t next;
+    int ret = jcron_next(first, pattern, &next);
+    if (ret != JCRON_OK) {
+        jcron_sched_remove(sched, slot);
+        return ret;
+    }
+    return jcron_sched_set(sched, slot, next.next_time + spread);
+}
+
+int shard_schedule(cron_job_t* job, int64_t from) {
+    if (job->paused || (!job->control && !cluster_owns(job->key))) {
+        shard_unschedule(job);
+        return JCRON_OK;
+    }
+    if (!active) {
+        int ret = sched_set_next(&job_sched, job->slot, &job_table.patterns[job->slot],
+                                 job->spread, from);
+        if (ret != JCRON_OK) jcron_sched_remove(&job_sched, job->slot);
+        return ret;
+    }
+    shard_command_t command = {SHARD_SET_NEXT, job->slot / (uint32_t)shard_count, job->key,
+                               job->spread, from, job_table.patterns[job->slot]};
+    shard_send(&command, job->slot);
+    return JCRON_OK;
+}
+
+void shard_unschedule(cron_job_t* job) {
+    if (!active) {
+        jcron_sched_remove(&job_sched, job->slot);
+        return;
+    }
+    shard_command_t command = {SHARD_REMOVE, job->slot / (uint32_t)shard_count, job->key, 0, 0,
+                               {0}};
+    shard_send(&command, job->slot);
+}
+
+int shard_fire_fd(void) {
+    return fire_fd;
+}
+
+int shard_pop_fire(shard_fire_t* fire) {
+    if (!active) return -1;
+    return ring_pop(&fires, fire);
+}
+
+void shards_wake(void) {
+    for (int i = 0; active && i < shard_count; i++) notify(shards[i].wake_fd);
+}
@@ -0,0 +1,132 @@
+/**
+ * JCRON Daemon - Schedule Simulation
+ *
+ * jcrond --simulate --from T1 --to T2 loads the real crontabs and, instead
+ * of sleeping and launching, replays the scheduler on a virtual clock: the
+ * clock jumps to the next pending fire, every job due then is printed and
+ * given its next fire with jcron_next(), and so on until T2. No process is
+ * started and nothing waits for wall-clock time, so a year of a large
+ * installation takes seconds.
+ *
+ * Only the schedule is simulated: overlap, admission limits, catch-up and
+ * run state play no part. Runs are deterministic: crontab directories are
+ * read in name order, so slots are the same on every run, and fires due in
+ * the same second come out in slot order (heap scheduler).
+ */
+
+#include "jcrond.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+
+// Days a --summary keeps counts for (longer ranges are still simulated)
+#define SUMMARY_DAYS 3660
+
+int64_t simulate_parse_time(const char* text) {
+    int year, month, day, hour = 0, minute = 0, second = 0;
+    char end;
+
+    // Unix timestamp
+    long long value;
+    if (sscanf(text, "%lld%c", &value, &end) == 1) return value;
+
+    // YYYY-MM-DD[(T| )HH:MM[:SS]][Z], UTC
+    int fields = sscanf(text, "%d-%d-%d%*1[T ]%d:%d:%d", &year, &month, &day, &hour, &minute,
+                        &second);
+    if (fields != 3 && fields < 5) return -1;
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 ||
+        second > 60) return -1;
+    struct tm tm = {0};
+    tm.tm_year = year - 1900;
+    tm.tm_mon = month - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = hour;
+    tm.tm_min = minute;
+    tm.tm_sec = second;
+    return (int64_t)timegm(&tm);
+}
+
+int64_t simulate_run(jcron_sched_backend_t backend, int64_t from, int64_t to, int summary,
+                     FILE* out) {
+    // The scheduler restarts at the virtual clock; jobs keep their slots
+    jcron_sched_free(&job_sched);
+    int ret = backend == JCRON_SCHED_WHEEL
+        ? jcron_sched_init_wheel(&job_sched, job_table.high, from - 1)
+        : jcron_sched_init(&job_sched, job_table.high);
+    if (ret != JCRON_OK) return -1;
+    for (uint32_t slot = 0; slot < crontab_slot_limit(); slot++) {
+        cron_job_t* job = crontab_job(slot);
+        if (job) crontab_schedule_from(job, from);
+    }
+
+    uint32_t* per_day = NULL;
+    int64_t days = summary ? (to - from) / 86400 + 1 : 0;
+    if (days > SUMMARY_DAYS) days = SUMMARY_DAYS;
+    if (summary && !(per_day = calloc((size_t)days, sizeof(uint32_t)))) return -1;
+
+    int64_t fires = 0;
+    int64_t minute = -1, minute_fires = 0, peak_minute = from, peak_fires = 0;
+    int64_t stamp_time = -1;
+    char stamp[32] = "";
+    int64_t now;
+
+    while (jcron_sched_next_wakeup(&job_sched, &now) == JCRON_OK && now <= to) {
+        int64_t when;
+        for (int slot; (slot = jcron_sched_pop(&job_sched, now, &when)) >= 0; ) {
+            cron_job_t* job = crontab_job((uint32_t)slot);
+            if (!job) continue;
+            sched_set_next(&job_sched, (uint32_t)slot, &job_table.patterns[slot], job->spread,
+                           when + 60);
+            fires++;
+
+            if (when / 60 != minute) {
+                if (minute_fires > peak_fires) {
+                    peak_fires = minute_fires;
+                    peak_minute = minute * 60;
+                }
+                minute = when / 60;
+                minute_fires = 0;
+            }
+            minute_fires++;
+
+            if (summary) {
+                int64_t day = (when - from) / 86400;
+                if (day < days) per_day[day]++;
+                continue;
+            }
+            if (when != stamp_time) {
+                time_t seconds = (time_t)when;
+                struct tm tm;
+                gmtime_r(&seconds, &tm);
+                strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", &tm);
+                stamp_time = when;
+            }
+            fprintf(out, "%s %s %s\n", stamp, job->user ? job->user : "root", job->command);
+        }
+    }
+    if (minute_fires > peak_fires) {
+        peak_fires = minute_fires;
+        peak_minute = minute * 60;
+    }
+
+    if (summary) {
+        for (int64_t day = 0; day < days; day++) {
+            time_t seconds = (time_t)(from + day * 86400);
+            struct tm tm;
+            gmtime_r(&seconds, &tm);
+            strftime(stamp, sizeof(stamp), "%Y-%m-%d", &tm);
+            fprintf(out, "%s %u\n", stamp, per_day[day]);
+        }
+        time_t seconds = (time_t)peak_minute;
+        struct tm tm;
+        gmtime_r(&seconds, &tm);
+        strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%MZ", &tm);
+        fprintf(out, "total %lld fires, %d jobs, busiest minute %s (%lld fires)\n",
+                (long long)fires, crontab_job_count(), stamp, (long long)peak_fires);
+        free(per_day);
+    }
+    return fires;
+}
@@ -0,0 +1,483 @@
+/**
+ * JCRON Daemon - Run State Journal
+ *
+ * Each job's last fire, exit status and duration live in a memory-mapped
+ * snapshot file: a header and an array of fixed-size records, found by
+ * job key through an in-memory hash index. Updates go straight into the
+ * mapping and are also appended to a journal; state_commit() writes all
+ * entries gathered during one loop iteration with a single write() and
+ * at most one fdatasync() (group commit).
+ *
+ * The snapshot is only msync()ed at checkpoints, after which the journal
+ * is truncated. Recovery maps the snapshot and replays the journal over
+ * it. Entries carry whole records and never move a record's last fire
+ * backwards, so replaying twice, or over snapshot pages the kernel already
+ * wrote back, is harmless. A torn journal tail fails its checksum and is
+ * ignored.
+ *
+ * Fires are committed before they are launched: after a crash a fire has
+ * either been recorded or never started, so it is not run twice.
+ */
+
+#include "jcrond.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define STATE_MAGIC "JCRSTAT"
+#define STATE_VERSION 1
+#define STATE_INITIAL_CAPACITY 1024
+
+// Journal size that triggers a checkpoint
+#define STATE_CHECKPOINT_BYTES (4 << 20)
+
+// last_fire of a journal entry that frees the key's record
+#define STATE_FORGOTTEN INT64_MIN
+
+const char* state_path = "/var/lib/jcrond/state";
+
+// Snapshot file header; records follow at STATE_HEADER_SIZE
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t count;      // Records ever allocated (in use or free)
+    uint32_t capacity;   // Records the file has room for
+    uint8_t reserved[40];
+} state_header_t;
+
+#define STATE_HEADER_SIZE sizeof(state_header_t)
+
+// Snapshot record and journal entry (the checksum is only used in the journal)
+typedef struct {
+    uint64_t key;        // Job key, 0 = free record
+    int64_t last_fire;
+    int64_t last_duration_ms;
+    int32_t last_exit;   // Wait status
+    uint32_t check;
+} state_record_t;
+
+// Snapshot mapping
+static int snapshot_fd = -1;
+static state_header_t* header = NULL;
+static state_record_t* records = NULL;
+static size_t map_size = 0;
+
+// Key -> record + 1 (0 = empty), linear probing
+static uint32_t* index_table = NULL;
+static uint32_t index_mask = 0;
+static uint32_t index_used = 0;
+
+// Freed records, reused before the file grows
+static uint32_t* free_records = NULL;
+static uint32_t free_count = 0;
+static uint32_t free_capacity = 0;
+
+// Journal and the entries of the current group
+static int journal_fd = -1;
+static off_t journal_bytes = 0;
+static state_record_t* pending = NULL;
+static int pending_count = 0;
+static int pending_capacity = 0;
+static int pending_fires = 0;
+
+/* ========================================================================
+ * Index
+ * ======================================================================== */
+
+static uint32_t key_hash(uint64_t key) {
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+static uint32_t index_find(uint64_t key) {
+    if (!index_table) return UINT32_MAX;
+    for (uint32_t i = key_hash(key) & index_mask; index_table[i]; i = (i + 1) & index_mask) {
+        uint32_t record = index_table[i] - 1;
+        if (records[record].key == key) return record;
+    }
+    return UINT32_MAX;
+}
+
+static int index_insert(uint64_t key, uint32_t record);
+
+static int index_grow(void) {
+    uint32_t* old = index_table;
+    uint32_t old_size = old ? index_mask + 1 : 0;
+    uint32_t size = old_size ? old_size * 2 : 4096;
+
+    index_table = calloc(size, sizeof(uint32_t));
+    if (!index_table) {
+        index_table = old;
+        return -1;
+    }
+    index_mask = size - 1;
+    index_used = 0;
+    for (uint32_t i = 0; i < old_size; i++) {
+        if (old[i]) index_insert(records[old[i] - 1].key, old[i] - 1);
+    }
+    free(old);
+    return 0;
+}
+
+static int index_insert(uint64_t key, uint32_t record) {
+    if (!index_table || (index_used + 1) * 2 > index_mask + 1) {
+        if (index_grow() != 0) return -1;
+    }
+    uint32_t i = key_hash(key) & index_mask;
+    while (index_table[i]) i = (i + 1) & index_mask;
+    index_table[i] = record + 1;
+    index_used++;
+    return 0;
+}
+
+// Backward-shift deletion keeps probe chains intact without tombstones
+static void index_remove(uint64_t key) {
+    uint32_t i = key_hash(key) & index_mask;
+    while (index_table[i] && records[index_table[i] - 1].key != key) i = (i + 1) & index_mask;
+    if (!index_table[i]) return;
+
+    for (uint32_t j = (i + 1) & index_mask; index_table[j]; j = (j + 1) & index_mask) {
+        uint32_t home = key_hash(records[index_table[j] - 1].key) & index_mask;
+        // Move j into the hole unless its home lies cyclically in (i, j]
+        if (((j - home) & index_mask) >= ((j - i) & index_mask)) {
+            index_table[i] = index_table[j];
+            i = j;
+        }
+    }
+    index_table[i] = 0;
+    index_used--;
+}
+
+/* ========================================================================
+ * Snapshot
+ * ======================================================================== */
+
+static int snapshot_map(uint32_t capacity) {
+    size_t size = STATE_HEADER_SIZE + (size_t)capacity * sizeof(state_record_t);
+    void* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, snapshot_fd, 0);
+    if (map == MAP_FAILED) return -1;
+
+    if (header) munmap(header, map_size);
+    header = map;
+    records = (state_record_t*)((char*)map + STATE_HEADER_SIZE);
+    map_size = size;
+    return 0;
+}
+
+static int snapshot_grow(void) {
+    uint32_t capacity = header->capacity * 2;
+    off_t size = (off_t)(STATE_HEADER_SIZE + (size_t)capacity * sizeof(state_record_t));
+    if (ftruncate(snapshot_fd, size) != 0 || snapshot_map(capacity) != 0) {
+        log_message(LOG_ERR, "Cannot grow state file %s: %s", state_path, strerror(errno));
+        return -1;
+    }
+    header->capacity = capacity;
+    return 0;
+}
+
+static void free_push(uint32_t record) {
+    if (free_count == free_capacity) {
+        uint32_t capacity = free_capacity ? free_capacity * 2 : 1024;
+        uint32_t* grown = realloc(free_records, capacity * sizeof(uint32_t));
+        if (!grown) return;  // Unused until the next restart
+        free_records = grown;
+        free_capacity = capacity;
+    }
+    free_records[free_count++] = record;
+}
+
+static state_record_t* record_alloc(uint64_t key) {
+    uint32_t record;
+    if (free_count > 0) {
+        record = free_records[--free_count];
+    } else {
+        if (header->count == header->capacity && snapshot_grow() != 0) return NULL;
+        record = header->count++;
+    }
+    records[record] = (state_record_t){.key = key};
+    if (index_insert(key, record) != 0) {
+        records[record].key = 0;
+        free_push(record);
+        return NULL;
+    }
+    return &records[record];
+}
+
+static void record_free(uint32_t record) {
+    index_remove(records[record].key);
+    records[record] = (state_record_t){0};
+    free_push(record);
+}
+
+// Record of a job, through the slot cached on the job when it is still valid
+static state_record_t* record_of(cron_job_t* job, int create) {
+    if (!header) return NULL;
+    uint32_t record = job->state_record;
+    if (record >= header->count || records[record].key != job->key) {
+        record = index_find(job->key);
+        if (record == UINT32_MAX) {
+            state_record_t* created = create ? record_alloc(job->key) : NULL;
+            if (created) job->state_record = (uint32_t)(created - records);
+            return created;
+        }
+        job->state_record = record;
+    }
+    return &records[record];
+}
+
+static int snapshot_open(void) {
+    snapshot_fd = open(state_path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    struct stat st;
+    if (snapshot_fd < 0 || fstat(snapshot_fd, &st) != 0) return -1;
+
+    const state_header_t* existing = NULL;
+    state_header_t probe;
+    if ((size_t)st.st_size >= STATE_HEADER_SIZE &&
+        pread(snapshot_fd, &probe, sizeof(probe), 0) == (ssize_t)sizeof(probe)) {
+        existing = &probe;
+    }
+
+    int valid = existing && memcmp(probe.magic, STATE_MAGIC, sizeof(probe.magic)) == 0 &&
+                probe.version == STATE_VERSION && probe.record_size == sizeof(state_record_t) &&
+                probe.count <= probe.capacity && probe.capacity > 0 &&
+                (size_t)st.st_size >= STATE_HEADER_SIZE + (size_t)probe.capacity *
+                                          sizeof(state_record_t);
+    if (valid) return snapshot_map(probe.capacity);
+
+    if (st.st_size > 0) {
+        log_message(LOG_WARNING, "Ignoring state file with unknown format: %s", state_path);
+    }
+    off_t size = (off_t)(STATE_HEADER_SIZE + STATE_INITIAL_CAPACITY * sizeof(state_record_t));
+    if (ftruncate(snapshot_fd, 0) != 0 || ftruncate(snapshot_fd, size) != 0 ||
+        snapshot_map(STATE_INITIAL_CAPACITY) != 0) {
+        return -1;
+    }
+    memcpy(header->magic, STATE_MAGIC, sizeof(header->magic));
+    header->version = STATE_VERSION;
+    header->record_size = sizeof(state_record_t);
+    header->count = 0;
+    header->capacity = STATE_INITIAL_CAPACITY;
+    return 0;
+}
+
+/* ========================================================================
+ * Journal
+ * ======================================================================== */
+
+static uint32_t entry_check(const state_record_t* entry) {
+    uint32_t hash = 2166136261u;  // FNV-1a over every field but the checksum
+    const unsigned char* bytes = (const unsigned char*)entry;
+    for (size_t i = 0; i < offsetof(state_record_t, check); i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static void journal_append(const state_record_t* record) {
+    if (pending_count == pending_capacity) {
+        int capacity = pending_capacity ? pending_capacity * 2 : 1024;
+        state_record_t* grown = realloc(pending, (size_t)capacity * sizeof(state_record_t));
+        if (!grown) return;  // Still in the snapshot; durable at the next checkpoint
+        pending = grown;
+        pending_capacity = capacity;
+    }
+    state_record_t* entry = &pending[pending_count++];
+    *entry = *record;
+    entry->check = entry_check(entry);
+}
+
+static void journal_apply(const state_record_t* entry) {
+    uint32_t record = index_find(entry->key);
+    if (entry->last_fire == STATE_FORGOTTEN) {
+        if (record != UINT32_MAX) record_free(record);
+        return;
+    }
+
+    state_record_t* target = record != UINT32_MAX ? &records[record] : record_alloc(entry->key);
+    if (target && entry->last_fire >= target->last_fire) {
+        *target = *entry;
+        target->check = 0;
+    }
+}
+
+static int journal_replay(void) {
+    int replayed = 0;
+    state_record_t batch[256];
+    ssize_t got;
+    off_t offset = 0;
+
+    while ((got = pread(journal_fd, batch, sizeof(batch), offset)) > 0) {
+        int n = (int)(got / (ssize_t)sizeof(state_record_t));
+        for (int i = 0; i < n; i++) {
+            if (batch[i].check != entry_check(&batch[i])) {
+                log_message(LOG_WARNING, "State journal truncated at entry %d (torn write)",
+                            replayed);
+                return replayed;
+            }
+            journal_apply(&batch[i]);
+            replayed++;
+        }
+        if (got % (ssize_t)sizeof(state_record_t)) break;
+        offset += got;
+    }
+    return replayed;
+}
+
+// Make the snapshot durable, then start a new journal
+static int checkpoint(void) {
+    if (msync(header, map_size, MS_SYNC) != 0 || ftruncate(journal_fd, 0) != 0) {
+        log_message(LOG_ERR, "State checkpoint failed: %s", strerror(errno));
+        return -1;
+    }
+    journal_bytes = 0;
+    counters.state_checkpoints++;
+    return 0;
+}
+
+/* ========================================================================
+ * Public API
+ * ======================================================================== */
+
+int state_load(void) {
+    if (!state_path) return 0;
+
+    char journal_path[4096];
+    if (snprintf(journal_path, sizeof(journal_path), "%s.journal", state_path) >=
+            (int)sizeof(journal_path) || snapshot_open() != 0) {
+        log_message(LOG_WARNING, "Cannot open state file %s: %s", state_path, strerror(errno));
+        state_close();
+        return -1;
+    }
+    journal_fd = open(journal_path, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+    if (journal_fd < 0) {
+        log_message(LOG_WARNING, "Cannot open state journal %s: %s", journal_path,
+                    strerror(errno));
+        state_close();
+        return -1;
+    }
+
+    // Rebuild the index and free list from the snapshot, then roll forward
+    for (uint32_t record = 0; record < header->count; record++) {
+        if (records[record].key == 0 || index_find(records[record].key) != UINT32_MAX) {
+            records[record] = (state_record_t){0};
+            free_push(record);
+        } else {
+            index_insert(records[record].key, record);
+        }
+    }
+    int replayed = journal_replay();
+    if (replayed > 0) {
+        log_message(LOG_INFO, "Replayed %d state journal entries", replayed);
+    }
+    checkpoint();
+
+    // Resume each known job right after its last fire; anything between
+    // then and now pops as overdue and goes through catch-up
+    int64_t next_minute = (now_ms() / 60000 + 1) * 60;
+    int restored = 0;
+    for (uint32_t slot = 0; slot < crontab_slot_limit(); slot++) {
+        cron_job_t* job = crontab_job(slot);
+        state_record_t* record = job ? record_of(job, 0) : NULL;
+        if (!record || record->last_fire <= 0) continue;
+
+        job->last_run = (time_t)record->last_fire;
+        job->last_status = record->last_exit;
+        job->last_duration_ms = record->last_duration_ms;
+        if (record->last_fire + 60 < next_minute) {
+            crontab_schedule_from(job, record->last_fire + 60);
+        }
+        restored++;
+    }
+    return restored;
+}
+
+void state_record_fire(cron_job_t* job) {
+    state_record_t* record = record_of(job, 1);
+    if (!record) return;
+    record->last_fire = job->last_run;
+    journal_append(record);
+    pending_fires++;
+}
+
+void state_record_exit(cron_job_t* job) {
+    state_record_t* record = record_of(job, 1);
+    if (!record) return;
+    record->last_exit = job->last_status;
+    record->last_duration_ms = job->last_duration_ms;
+    journal_append(record);
+}
+
+void state_forget(cron_job_t* job) {
+    state_record_t* record = record_of(job, 0);
+    if (!record) return;
+    state_record_t tombstone = {.key = job->key, .last_fire = STATE_FORGOTTEN};
+    record_free((uint32_t)(record - records));
+    journal_append(&tombstone);
+}
+
+int state_commit(void) {
+    if (pending_count == 0 || journal_fd < 0) return 0;
+
+    const char* data = (const char*)pending;
+    size_t left = (size_t)pending_count * sizeof(state_record_t);
+    while (left > 0) {
+        ssize_t written = write(journal_fd, data, left);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            static int warned = 0;
+            if (!warned++) {
+                log_message(LOG_ERR, "Cannot write state journal: %s", strerror(errno));
+            }
+            break;  // The snapshot still has it; the next checkpoint makes it durable
+        }
+        data += written;
+        left -= (size_t)written;
+        journal_bytes += written;
+    }
+    counters.state_commits++;
+
+    // Only fires must be durable before they launch; exit records ride
+    // along with the next fire's sync or checkpoint
+    int ok = 1;
+    if (pending_fires > 0) {
+        ok = fdatasync(journal_fd) == 0;
+        counters.state_syncs++;
+    }
+    pending_count = 0;
+    pending_fires = 0;
+
+    if (journal_bytes >= STATE_CHECKPOINT_BYTES) checkpoint();
+    return ok && left == 0 ? 0 : -1;
+}
+
+void state_close(void) {
+    if (header && journal_fd >= 0) {
+        state_commit();
+        checkpoint();
+    }
+    if (header) munmap(header, map_size);
+    if (snapshot_fd >= 0) close(snapshot_fd);
+    if (journal_fd >= 0) close(journal_fd);
+    free(index_table);
+    free(free_records);
+    free(pending);
+
+    header = NULL;
+    records = NULL;
+    index_table = NULL;
+    free_records = NULL;
+    pending = NULL;
+    snapshot_fd = journal_fd = -1;
+    map_size = 0;
+    index_mask = index_used = free_count = free_capacity = 0;
+    pending_count = pending_capacity = pending_fires = 0;
+    journal_bytes = 0;
+}
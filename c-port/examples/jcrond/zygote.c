@@ -0,0 +1,354 @@
+/**
+ * JCRON Daemon - Launch Helper
+ *
+ * With -z the daemon starts a launch helper at boot: a fresh exec of its
+ * own binary (so a tiny address space, none of the job table) that spawns
+ * jobs on request. The daemon sends each spawn request (argv, env, uid,
+ * gid and groups, working directory, and up to three stdio fds as
+ * SCM_RIGHTS) over a SOCK_SEQPACKET socketpair; the helper answers with
+ * the pid.
+ *
+ * The helper clones with CLONE_PARENT, so every job is a child of the
+ * daemon, not of the helper: SIGCHLD, wait4() rusage, timeouts and process
+ * groups work exactly as for jobs the daemon spawns itself. The helper is
+ * single-threaded and never blocks on the daemon: replies queue in memory
+ * until the socket is writable, so a daemon that is itself blocked sending
+ * a request cannot deadlock it. It exits when the daemon closes its end.
+ */
+
+#include "jcrond.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define ZYGOTE_ARG "--launch-helper"
+#define ZYGOTE_MAX_MESSAGE 65536
+#define ZYGOTE_MAX_STRINGS 256
+#define ZYGOTE_STACK (64 * 1024)
+
+// Request header; group_count gids follow, then argv, envp and the
+// working directory as NUL-terminated strings
+typedef struct {
+    uint64_t id;
+    uint32_t uid;
+    uint32_t gid;
+    uint32_t drop_privileges;
+    int32_t group_count; // -1: keep the helper's groups
+    uint32_t argc;
+    uint32_t envc;
+    uint32_t fd_mask;    // Bit i: an fd for stdio descriptor i is attached
+} zygote_header_t;
+
+static int helper_fd = -1;
+static pid_t helper_pid = -1;
+
+/* ========================================================================
+ * Helper Process
+ * ======================================================================== */
+
+// A parsed request, read by the clone() child
+typedef struct {
+    const zygote_header_t* header;
+    const gid_t* groups;
+    char* argv[ZYGOTE_MAX_STRINGS + 1];
+    char* envp[ZYGOTE_MAX_STRINGS + 1];
+    const char* cwd;
+    int fds[3];
+} helper_request_t;
+
+// Runs in the clone() child, which shares the helper's memory until it
+// execs: the same rules as the daemon's vfork() child
+static int helper_child(void* arg) {
+    const helper_request_t* req = arg;
+    sigset_t none;
+    sigemptyset(&none);
+    sigprocmask(SIG_SETMASK, &none, NULL);
+    for (int i = 0; i < 3; i++) {
+        if (req->fds[i] >= 0 && dup2(req->fds[i], i) < 0) _exit(126);
+    }
+    setpgid(0, 0);
+    if (req->header->drop_privileges) {
+        if ((req->header->group_count >= 0 &&
+             syscall(SYS_setgroups, (size_t)req->header->group_count, req->groups) != 0) ||
+            syscall(SYS_setgid, req->header->gid) != 0 ||
+            syscall(SYS_setuid, req->header->uid) != 0) _exit(126);
+    }
+    if (*req->cwd && chdir(req->cwd) != 0 && chdir("/tmp") != 0) _exit(126);
+    exec_search(req->argv[0], req->argv + 1, req->envp);
+    _exit(errno == ENOENT ? 127 : 126);
+}
+
+// Split `count` strings out of [*p, end); -1 if malformed
+static int take_strings(char** p, const char* end, char** out, uint32_t count) {
+    if (count > ZYGOTE_MAX_STRINGS) return -1;
+    for (uint32_t i = 0; i < count; i++) {
+        char* nul = memchr(*p, '\0', (size_t)(end - *p));
+        if (!nul) return -1;
+        out[i] = *p;
+        *p = nul + 1;
+    }
+    out[count] = NULL;
+    return 0;
+}
+
+static zygote_reply_t helper_spawn(char* message, ssize_t len, int* fds, int fd_count) {
+    static char stack[ZYGOTE_STACK] __attribute__((aligned(16)));
+    helper_request_t req;
+    zygote_reply_t reply = {0, -1, EINVAL, monotonic_ns()};
+
+    if (len < (ssize_t)sizeof(zygote_header_t)) return reply;
+    req.header = (const zygote_header_t*)message;
+    reply.id = req.header->id;
+
+    char* p = message + sizeof(zygote_header_t);
+    const char* end = message + len;
+    size_t group_bytes = req.header->group_count > 0
+                       ? (size_t)req.header->group_count * sizeof(gid_t) : 0;
+    if (group_bytes > (size_t)(end - p)) return reply;
+    req.groups = (const gid_t*)p;
+    p += group_bytes;
+    char* cwd[2];
+    // argv[0] is the path to exec; the child's argv starts after it
+    if (req.header->argc < 2 ||
+        take_strings(&p, end, req.argv, req.header->argc) != 0 ||
+        take_strings(&p, end, req.envp, req.header->envc) != 0 ||
+        take_strings(&p, end, cwd, 1) != 0) {
+        return reply;
+    }
+    req.cwd = cwd[0];
+
+    int next = 0;
+    for (int i = 0; i < 3; i++) {
+        req.fds[i] = (req.header->fd_mask & (1u << i)) && next < fd_count ? fds[next++] : -1;
+    }
+
+    // CLONE_VFORK: we resume once the child has exec'd, so the stack is free again
+    reply.start_ns = monotonic_ns();
+    reply.pid = clone(helper_child, stack + sizeof(stack),
+                      CLONE_VM | CLONE_VFORK | CLONE_PARENT | SIGCHLD, &req);
+    reply.error = reply.pid < 0 ? errno : 0;
+    return reply;
+}
+
+static int helper_main(int fd) {
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    static char message[ZYGOTE_MAX_MESSAGE];
+    zygote_reply_t* replies = NULL;
+    size_t reply_count = 0, reply_capacity = 0;
+
+    for (;;) {
+        struct pollfd pfd = {fd, POLLIN | (reply_count ? POLLOUT : 0), 0};
+        if (poll(&pfd, 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            return 1;
+        }
+
+        // Answer first: the daemon's buffer is as bounded as ours
+        size_t sent = 0;
+        while (sent < reply_count &&
+               send(fd, &replies[sent], sizeof(zygote_reply_t), MSG_DONTWAIT | MSG_NOSIGNAL) ==
+                   (ssize_t)sizeof(zygote_reply_t)) {
+            sent++;
+        }
+        memmove(replies, replies + sent, (reply_count - sent) * sizeof(zygote_reply_t));
+        reply_count -= sent;
+
+        for (;;) {
+            union {
+                struct cmsghdr align;
+                char buf[CMSG_SPACE(3 * sizeof(int))];
+            } control;
+            struct iovec iov = {message, sizeof(message)};
+            struct msghdr msg = {0};
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = control.buf;
+            msg.msg_controllen = sizeof(control.buf);
+
+            ssize_t len = recvmsg(fd, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+            if (len == 0) return 0;  // Daemon gone
+            if (len < 0) {
+                if (errno == EAGAIN || errno == EINTR) break;
+                return 1;
+            }
+
+            int fds[3];
+            int fd_count = 0;
+            for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+                if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+                int n = (int)((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+                for (int i = 0; i < n && fd_count < 3; i++) {
+                    memcpy(&fds[fd_count++], CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+                }
+            }
+
+            zygote_reply_t reply = helper_spawn(message, len, fds, fd_count);
+            for (int i = 0; i < fd_count; i++) close(fds[i]);
+
+            if (reply_count == reply_capacity) {
+                size_t capacity = reply_capacity ? reply_capacity * 2 : 64;
+                zygote_reply_t* grown = realloc(replies, capacity * sizeof(zygote_reply_t));
+                if (!grown) return 1;
+                replies = grown;
+                reply_capacity = capacity;
+            }
+            replies[reply_count++] = reply;
+        }
+    }
+}
+
+int zygote_main(int argc, char* argv[]) {
+    if (argc != 3 || strcmp(argv[1], ZYGOTE_ARG) != 0) return -1;
+    return helper_main(atoi(argv[2]));
+}
+
+/* ========================================================================
+ * Daemon Side
+ * ======================================================================== */
+
+int zygote_start(void) {
+    if (helper_fd >= 0) return 0;
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) != 0) {
+        log_message(LOG_ERR, "Cannot create launch helper socket: %s", strerror(errno));
+        return -1;
+    }
+    char fd_arg[16];
+    snprintf(fd_arg, sizeof(fd_arg), "%d", sv[1]);
+    char* args[] = {"jcrond-launch", ZYGOTE_ARG, fd_arg, NULL};
+
+    // vfork: the helper should not cost a copy of our page tables either
+    int child_fd = sv[1];
+    pid_t pid = vfork();
+    if (pid == 0) {
+        fcntl(child_fd, F_SETFD, 0);
+        execv("/proc/self/exe", args);
+        _exit(127);
+    }
+    close(sv[1]);
+    if (pid < 0) {
+        log_message(LOG_ERR, "Cannot start launch helper: %s", strerror(errno));
+        close(sv[0]);
+        return -1;
+    }
+
+    fcntl(sv[0], F_SETFL, fcntl(sv[0], F_GETFL) | O_NONBLOCK);
+    helper_fd = sv[0];
+    helper_pid = pid;
+    log_message(LOG_INFO, "Started launch helper (pid %d)", (int)pid);
+    return 0;
+}
+
+void zygote_stop(void) {
+    if (helper_fd < 0) return;
+    close(helper_fd);  // The helper exits on end of file
+    helper_fd = -1;
+    helper_pid = -1;
+}
+
+int zygote_running(void) {
+    return helper_fd >= 0;
+}
+
+int zygote_fd(void) {
+    return helper_fd;
+}
+
+pid_t zygote_pid(void) {
+    return helper_pid;
+}
+
+int zygote_send(uint64_t id, const zygote_spawn_t* spawn) {
+    static char message[ZYGOTE_MAX_MESSAGE];
+    zygote_header_t header = {id, (uint32_t)spawn->uid, (uint32_t)spawn->gid,
+                              (uint32_t)spawn->drop_privileges, spawn->group_count, 1, 0, 0};
+
+    size_t len = sizeof(header);
+    if (spawn->group_count > 0) {
+        size_t size = (size_t)spawn->group_count * sizeof(gid_t);
+        if (len + size > sizeof(message)) {
+            errno = E2BIG;
+            return -1;
+        }
+        memcpy(message + len, spawn->groups, size);
+        len += size;
+    }
+    const char* cwd = spawn->cwd ? spawn->cwd : "";
+    const char* strings[2 * ZYGOTE_MAX_STRINGS + 2];
+    int n = 0;
+    strings[n++] = spawn->path;
+    for (int i = 0; spawn->argv[i] && header.argc <= ZYGOTE_MAX_STRINGS; i++, header.argc++) {
+        strings[n++] = spawn->argv[i];
+    }
+    for (int i = 0; spawn->envp[i] && header.envc < ZYGOTE_MAX_STRINGS; i++, header.envc++) {
+        strings[n++] = spawn->envp[i];
+    }
+    strings[n++] = cwd;
+    for (int i = 0; i < n; i++) {
+        size_t size = strlen(strings[i]) + 1;
+        if (len + size > sizeof(message)) {
+            errno = E2BIG;
+            return -1;
+        }
+        memcpy(message + len, strings[i], size);
+        len += size;
+    }
+
+    int fds[3];
+    int fd_count = 0;
+    for (int i = 0; i < 3; i++) {
+        if (spawn->fds[i] < 0) continue;
+        header.fd_mask |= 1u << i;
+        fds[fd_count++] = spawn->fds[i];
+    }
+    memcpy(message, &header, sizeof(header));
+
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(3 * sizeof(int))];
+    } control;
+    struct iovec iov = {message, len};
+    struct msghdr msg = {0};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (fd_count > 0) {
+        msg.msg_control = control.buf;
+        msg.msg_controllen = CMSG_SPACE((size_t)fd_count * sizeof(int));
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN((size_t)fd_count * sizeof(int));
+        memcpy(CMSG_DATA(cmsg), fds, (size_t)fd_count * sizeof(int));
+    }
+
+    // The helper always drains its socket, so waiting for room is bounded
+    for (;;) {
+        if (sendmsg(helper_fd, &msg, MSG_NOSIGNAL) == (ssize_t)len) return 0;
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN) return -1;
+        struct pollfd pfd = {helper_fd, POLLOUT, 0};
+        if (poll(&pfd, 1, 1000) == 0) {
+            errno = ETIMEDOUT;
+            return -1;
+        }
+    }
+}
+
+int zygote_receive(zygote_reply_t* reply) {
+    ssize_t len = recv(helper_fd, reply, sizeof(*reply), MSG_DONTWAIT);
+    if (len == (ssize_t)sizeof(*reply)) return 1;
+    if (len < 0 && (errno == EAGAIN || errno == EINTR)) return 0;
+    return -1;
+}
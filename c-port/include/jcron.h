@@ -13,6 +13,7 @@
 #define JCRON_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include <time.h>
 #include <stdbool.h>
 
@@ -39,7 +40,8 @@ typedef enum {
     JCRON_ERR_INVALID_TIME    = -2,  /* Invalid time value */
     JCRON_ERR_NO_MATCH        = -3,  /* Pattern has no future matches */
     JCRON_ERR_OVERFLOW        = -4,  /* Time calculation overflow */
-    JCRON_ERR_NULL_POINTER    = -5   /* Null pointer argument */
+    JCRON_ERR_NULL_POINTER    = -5,  /* Null pointer argument */
+    JCRON_ERR_NO_MEMORY       = -6   /* Allocation failed (index/scheduler) */
 } jcron_error_t;
 
 /* ========================================================================
@@ -102,6 +104,23 @@ typedef struct {
     uint8_t  _reserved[128];
 } jcron_pattern_t;
 
+/**
+ * One field of a pattern: `len` bytes at `start`, not NUL-terminated
+ */
+typedef struct {
+    const char* start;
+    size_t len;
+} jcron_span_t;
+
+/**
+ * Field layouts accepted by jcron_parse_fields() (value = field count)
+ */
+typedef enum {
+    JCRON_FIELDS_5 = 5,   /* min hour day month weekday (Vixie crontab) */
+    JCRON_FIELDS_6 = 6,   /* sec min hour day month weekday (jcron_parse) */
+    JCRON_FIELDS_7 = 7    /* sec min hour day month weekday year */
+} jcron_layout_t;
+
 /**
  * Result structure for next/prev time calculations
  * 
@@ -139,6 +158,48 @@ typedef struct {
  */
 int jcron_parse(const char* pattern, jcron_pattern_t* out);
 
+/**
+ * Parse a cron pattern whose fields may use the hashed token "H"
+ * 
+ * "H" stands for one value of the field derived from `key`, so jobs that
+ * share a schedule such as "0 H H * * *" spread over the day instead of
+ * all firing at midnight. The same key always gives the same value.
+ * - "H"          one value in the field's range (day of month: 1-28)
+ * - "H(N-M)"     one value in N-M
+ * - "H/S"        every S, starting at a hashed offset below S
+ * - "H(N-M)/S"   every S within N-M, starting at a hashed offset
+ * jcron_parse() is this function with key 0.
+ * 
+ * @param pattern  Pattern string (e.g., "0 H H/4 * * *")
+ * @param key      Stable per-job value (e.g., a hash of the job's line)
+ * @param out      Output pattern structure
+ * @return         JCRON_OK or error code
+ */
+int jcron_parse_keyed(const char* pattern, uint64_t key, jcron_pattern_t* out);
+
+/**
+ * Parse fields that are already split, e.g. words of a crontab line
+ * 
+ * No string is built or copied: each span is parsed where it lies, so a
+ * loader can pass the fields it found in a mapped file. `fields` holds as
+ * many spans as the layout has fields. Field syntax is that of
+ * jcron_parse_keyed(), "H" included; modifiers and "|" are not accepted.
+ * Seconds are checked but not scheduled (minute resolution), and as
+ * patterns have no year mask, the 7th field must be "*" or "?".
+ * 
+ * @param fields   Field spans, in layout order
+ * @param layout   JCRON_FIELDS_5, JCRON_FIELDS_6 or JCRON_FIELDS_7
+ * @param key      Job key for "H" fields (0 if unused)
+ * @param out      Output pattern structure
+ * @return         JCRON_OK or error code
+ * 
+ * Example:
+ *   jcron_span_t f[5] = {{"30", 2}, {"9", 1}, {"*", 1}, {"*", 1}, {"1-5", 3}};
+ *   jcron_parse_fields(f, JCRON_FIELDS_5, 0, &pattern);
+ */
+int jcron_parse_fields(const jcron_span_t* fields, jcron_layout_t layout, uint64_t key,
+                       jcron_pattern_t* out);
+
 /**
  * Calculate next occurrence of pattern from given time
  * 
@@ -180,7 +241,9 @@ int jcron_next_n(int64_t from_timestamp, const jcron_pattern_t* pattern,
 /**
  * Calculate previous occurrence of pattern before given time
  * 
- * Equivalent to PostgreSQL's prev_time() function.
+ * Equivalent to PostgreSQL's prev_time() function. Returns the latest
+ * occurrence before the minute containing from_timestamp, using the same
+ * field jumps as jcron_next() run backwards.
  * 
  * @param from_timestamp Reference time
  * @param pattern        Parsed pattern
@@ -189,6 +252,47 @@ int jcron_next_n(int64_t from_timestamp, const jcron_pattern_t* pattern,
  */
 int jcron_prev(int64_t from_timestamp, const jcron_pattern_t* pattern, jcron_result_t* out);
 
+/**
+ * Count occurrences in a time range
+ * 
+ * Counts whole days from the field masks instead of enumerating
+ * occurrences: O(days in range), independent of how often the pattern
+ * fires. Useful for "how many runs were missed" questions.
+ * 
+ * Patterns with an SOD or EOD modifier (sod_type or eod_type >= 0) are
+ * rejected with JCRON_ERR_INVALID_PATTERN: the modifier moves each fire
+ * off its field-mask minute, so the masks cannot count them.
+ * 
+ * @param from_timestamp Range start (inclusive)
+ * @param to_timestamp   Range end (exclusive)
+ * @param pattern        Parsed pattern
+ * @param count          Output number of occurrences
+ * @return               JCRON_OK or error code
+ */
+int jcron_count(int64_t from_timestamp, int64_t to_timestamp,
+                const jcron_pattern_t* pattern, int64_t* count);
+
+/**
+ * List occurrences in a time range, oldest first
+ * 
+ * Rejects the same patterns as jcron_count(), so the two always agree.
+ * 
+ * @param from_timestamp Range start (inclusive)
+ * @param to_timestamp   Range end (exclusive)
+ * @param pattern        Parsed pattern
+ * @param times          Output timestamps (space for max_count)
+ * @param max_count      Maximum number of occurrences to return
+ * @param count          Output number of occurrences written
+ * @return               JCRON_OK or error code
+ * 
+ * Example:
+ *   int64_t missed[16];
+ *   int n;
+ *   jcron_range(last_run + 60, now, &pattern, missed, 16, &n);
+ */
+int jcron_range(int64_t from_timestamp, int64_t to_timestamp,
+                const jcron_pattern_t* pattern, int64_t* times, int max_count, int* count);
+
 /**
  * Check if given time matches pattern
  * 
@@ -200,6 +304,26 @@ int jcron_prev(int64_t from_timestamp, const jcron_pattern_t* pattern, jcron_res
  */
 int jcron_matches(int64_t timestamp, const jcron_pattern_t* pattern);
 
+/**
+ * Check many timestamps against one pattern
+ * 
+ * Batch form of jcron_matches() for analytics workloads (labelling event
+ * logs). Timestamps are decomposed in UTC lane-parallel (AVX2 when available)
+ * without calling gmtime_r(); the input is streamed once, front to back.
+ * 
+ * @param pattern    Parsed pattern
+ * @param timestamps Array of Unix timestamps
+ * @param count      Number of timestamps
+ * @param out        Output: out[i] = 1 if timestamps[i] matches, 0 otherwise
+ * @return           JCRON_OK or error code
+ * 
+ * Example:
+ *   uint8_t hit[4096];
+ *   jcron_matches_ts_batch(&pattern, events, 4096, hit);
+ */
+int jcron_matches_ts_batch(const jcron_pattern_t* pattern, const int64_t* timestamps,
+                           size_t count, uint8_t* out);
+
 /* ========================================================================
  * Helper Functions (PostgreSQL Compatibility)
  * ======================================================================== */
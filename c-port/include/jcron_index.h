@@ -0,0 +1,121 @@
+/**
+ * JCRON C Port - Inverted Field-Value Index
+ *
+ * Answers "which of N jobs fire at time T" without walking every pattern.
+ * The index keeps one job bitset per field value (60 minute, 24 hour,
+ * 31 day-of-month, 12 month and 7 day-of-week bitsets); the jobs due at T
+ * are the AND of the five bitsets selected by T. A second-level summary
+ * (one bit per non-zero 64-job word) lets the iterator skip empty regions,
+ * so a tick visits only words that can contain matches.
+ *
+ * Jobs are identified by caller-chosen slot numbers (dense small integers,
+ * e.g. positions in a job array). Unlike the pattern API, the index owns
+ * heap memory: call jcron_index_free() when done.
+ */
+
+#ifndef JCRON_INDEX_H
+#define JCRON_INDEX_H
+
+#include "jcron.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bitset rows: minutes(60) + hours(24) + days(31) + months(12) + weekdays(7) */
+#define JCRON_INDEX_ROWS 134
+
+/**
+ * Index structure
+ *
+ * Row r occupies bits[r * words .. r * words + words - 1]; bit s of a row
+ * is set when job slot s accepts that field value.
+ */
+typedef struct {
+    uint64_t* bits;           /* JCRON_INDEX_ROWS x words job bitsets */
+    uint64_t* summary;        /* JCRON_INDEX_ROWS x summary_words non-zero word maps */
+    uint64_t* live;           /* Slots currently indexed */
+    uint32_t  words;          /* 64-bit words per row (capacity / 64) */
+    uint32_t  summary_words;  /* Summary words per row (words / 64) */
+    uint32_t  count;          /* Number of indexed slots */
+} jcron_index_t;
+
+/**
+ * Iterator over the slots matching one timestamp
+ *
+ * Stack allocated; invalidated by any add/remove on the index.
+ */
+typedef struct {
+    const uint64_t* rows[5];       /* Selected bitsets (minute..weekday) */
+    const uint64_t* summaries[5];  /* Their summaries */
+    uint32_t summary_words;
+    uint32_t summary_pos;          /* Next summary word to load */
+    uint32_t word_base;            /* First word covered by `pending` */
+    uint32_t word;                 /* Word currently being drained */
+    uint64_t pending;              /* Candidate words left under summary_pos - 1 */
+    uint64_t bits;                 /* Matching slots left in `word` */
+} jcron_index_iter_t;
+
+/**
+ * Initialize an empty index
+ *
+ * @param index    Index to initialize
+ * @param capacity Initial slot capacity (grows on demand; 0 = minimum)
+ * @return         JCRON_OK or error code
+ */
+int jcron_index_init(jcron_index_t* index, uint32_t capacity);
+
+/**
+ * Release all memory held by the index
+ */
+void jcron_index_free(jcron_index_t* index);
+
+/**
+ * Add (or replace) the pattern stored under a slot
+ *
+ * O(set bits in the pattern); grows the index when slot >= capacity.
+ *
+ * @param index   Index
+ * @param slot    Caller-chosen job slot
+ * @param pattern Parsed pattern (must have a cron component)
+ * @return        JCRON_OK or error code
+ */
+int jcron_index_add(jcron_index_t* index, uint32_t slot, const jcron_pattern_t* pattern);
+
+/**
+ * Remove a slot from the index (no-op if absent)
+ *
+ * @return JCRON_OK or error code
+ */
+int jcron_index_remove(jcron_index_t* index, uint32_t slot);
+
+/**
+ * Start iterating the slots whose pattern matches a timestamp
+ *
+ * Same field semantics as jcron_matches() (UTC, minute resolution).
+ *
+ * @param index     Index
+ * @param timestamp Time to check
+ * @param iter      Output iterator
+ * @return          JCRON_OK or error code
+ *
+ * Example:
+ *   jcron_index_iter_t it;
+ *   jcron_index_match(&index, now, &it);
+ *   for (int slot; (slot = jcron_index_next(&it)) >= 0; )
+ *       run_job(jobs[slot]);
+ */
+int jcron_index_match(const jcron_index_t* index, int64_t timestamp, jcron_index_iter_t* iter);
+
+/**
+ * Next matching slot in ascending order
+ *
+ * @return Slot number, or -1 when exhausted
+ */
+int jcron_index_next(jcron_index_iter_t* iter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JCRON_INDEX_H */
@@ -0,0 +1,193 @@
+/**
+ * JCRON C Port - Next-Fire Scheduler
+ *
+ * Orders jobs by their next fire time so a daemon can sleep until the
+ * earliest one instead of polling every pattern. Each job is a caller-chosen
+ * slot (same convention as jcron_index) with one pending fire time.
+ *
+ * Two backends share one API:
+ * - JCRON_SCHED_HEAP: binary min-heap on (time, slot) with a slot -> position
+ *   map. Insert, reschedule, remove and pop are O(log n); peek is O(1).
+ *   Ties fire in ascending slot order, which keeps runs deterministic.
+ * - JCRON_SCHED_WHEEL: hierarchical timing wheel with second, minute, hour
+ *   and day tiers (60/60/24/64 buckets) and the heap as overflow beyond
+ *   64 days. Insert, remove and expiry are O(1); a tier's bucket is
+ *   re-placed in one batch when the clock crosses its boundary. Due fires
+ *   pop in second order (in bucket order within a second).
+ *
+ * Like jcron_index, the scheduler owns heap memory: call jcron_sched_free().
+ */
+
+#ifndef JCRON_SCHED_H
+#define JCRON_SCHED_H
+
+#include "jcron.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Position of a slot that is not scheduled */
+#define JCRON_SCHED_NONE UINT32_MAX
+
+/* Timing wheel tiers: seconds, minutes, hours, days */
+#define JCRON_WHEEL_TIERS 4
+#define JCRON_WHEEL_DAYS  64
+
+typedef enum {
+    JCRON_SCHED_HEAP  = 0,  /* Binary min-heap (default) */
+    JCRON_SCHED_WHEEL = 1   /* Hierarchical timing wheel + overflow heap */
+} jcron_sched_backend_t;
+
+/**
+ * Heap entry: one pending fire
+ */
+typedef struct {
+    int64_t  when;   /* Fire time (Unix timestamp) */
+    uint32_t slot;   /* Job slot */
+} jcron_sched_entry_t;
+
+/**
+ * Timing wheel node (one per slot)
+ */
+typedef struct {
+    int64_t  when;   /* Fire time */
+    uint32_t prev;   /* Bucket list links (slots) */
+    uint32_t next;
+    uint32_t loc;    /* Bucket id (tier * 64 + index), ready list, overflow or none */
+} jcron_wheel_node_t;
+
+/**
+ * Timing wheel state
+ *
+ * Tier t holds fires inside the current unit of tier t + 1 (e.g. the
+ * minute tier holds fires later in the current hour), bucketed by their
+ * own unit. Everything at or before `cur` has been moved to the ready list.
+ */
+typedef struct {
+    int64_t  cur;                                  /* Last processed second */
+    uint64_t occupied[JCRON_WHEEL_TIERS];          /* Non-empty bucket bitmaps */
+    uint32_t buckets[JCRON_WHEEL_TIERS][JCRON_WHEEL_DAYS];  /* List heads */
+    uint32_t ready_head;                           /* Due fires, FIFO */
+    uint32_t ready_tail;
+    jcron_wheel_node_t* nodes;                     /* Indexed by slot */
+} jcron_wheel_t;
+
+/**
+ * Scheduler structure
+ */
+typedef struct {
+    jcron_sched_entry_t* heap;   /* Min-heap on (when, slot); wheel overflow */
+    uint32_t* pos;               /* slot -> heap position, or JCRON_SCHED_NONE */
+    uint32_t  count;             /* Scheduled slots (all backends) */
+    uint32_t  heap_size;         /* Entries in `heap` */
+    uint32_t  heap_capacity;
+    uint32_t  pos_capacity;      /* Slots addressable by `pos` */
+    jcron_sched_backend_t backend;
+    jcron_wheel_t* wheel;        /* JCRON_SCHED_WHEEL only */
+} jcron_sched_t;
+
+/**
+ * Initialize an empty heap scheduler
+ *
+ * @param sched    Scheduler to initialize
+ * @param capacity Expected number of slots (grows on demand)
+ * @return         JCRON_OK or error code
+ */
+int jcron_sched_init(jcron_sched_t* sched, uint32_t capacity);
+
+/**
+ * Initialize an empty timing-wheel scheduler
+ *
+ * @param sched    Scheduler to initialize
+ * @param capacity Expected number of slots (grows on demand)
+ * @param start    Wheel clock; fires scheduled at or before it are due at once
+ * @return         JCRON_OK or error code
+ */
+int jcron_sched_init_wheel(jcron_sched_t* sched, uint32_t capacity, int64_t start);
+
+/**
+ * Release all memory held by the scheduler
+ */
+void jcron_sched_free(jcron_sched_t* sched);
+
+/**
+ * Schedule a slot at an absolute time, replacing any pending fire
+ *
+ * @param sched Scheduler
+ * @param slot  Job slot
+ * @param when  Fire time (Unix timestamp)
+ * @return      JCRON_OK or error code
+ */
+int jcron_sched_set(jcron_sched_t* sched, uint32_t slot, int64_t when);
+
+/**
+ * Schedule a slot at the first occurrence of a pattern at or after `from`
+ *
+ * Convenience wrapper over jcron_next() + jcron_sched_set(). When the
+ * pattern has no future match the slot is left unscheduled.
+ *
+ * @param sched   Scheduler
+ * @param slot    Job slot
+ * @param pattern Parsed pattern
+ * @param from    Earliest acceptable fire time (inclusive, minute resolution)
+ * @return        JCRON_OK, JCRON_ERR_NO_MATCH or other error code
+ */
+int jcron_sched_set_next(jcron_sched_t* sched, uint32_t slot,
+                         const jcron_pattern_t* pattern, int64_t from);
+
+/**
+ * Cancel a slot's pending fire (no-op if not scheduled)
+ *
+ * @return JCRON_OK or error code
+ */
+int jcron_sched_remove(jcron_sched_t* sched, uint32_t slot);
+
+/**
+ * Earliest pending fire
+ *
+ * O(1) for the heap; for the wheel, O(size of the earliest bucket).
+ *
+ * @param sched Scheduler
+ * @param when  Output fire time (may be NULL)
+ * @return      Slot, or -1 when empty
+ */
+int jcron_sched_peek(const jcron_sched_t* sched, int64_t* when);
+
+/**
+ * Time at which jcron_sched_pop() may next have work
+ *
+ * Exact for the heap. For the wheel it is a cheap lower bound: the start
+ * of the earliest non-empty bucket, where fires expire or cascade. Callers
+ * sleep until this time and pop; an empty pop just means "sleep again".
+ *
+ * @param sched Scheduler
+ * @param when  Output wake-up time
+ * @return      JCRON_OK, or JCRON_ERR_NO_MATCH when nothing is scheduled
+ */
+int jcron_sched_next_wakeup(const jcron_sched_t* sched, int64_t* when);
+
+/**
+ * Remove and return a due fire
+ *
+ * The heap returns the earliest (when, slot); the wheel returns due fires
+ * in second order.
+ *
+ * @param sched Scheduler
+ * @param now   Current time; fires with when <= now are due
+ * @param when  Output fire time of the popped slot (may be NULL)
+ * @return      Slot, or -1 when nothing is due
+ *
+ * Example:
+ *   for (int slot; (slot = jcron_sched_pop(&sched, now, &when)) >= 0; ) {
+ *       run_job(jobs[slot], now - when);
+ *       jcron_sched_set_next(&sched, slot, &jobs[slot].pattern, when + 60);
+ *   }
+ */
+int jcron_sched_pop(jcron_sched_t* sched, int64_t now, int64_t* when);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JCRON_SCHED_H */
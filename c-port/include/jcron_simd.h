@@ -8,6 +8,7 @@
 #define JCRON_SIMD_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 // SIMD detection macros
 #if defined(__AVX2__)
@@ -18,11 +19,29 @@
 #define JCRON_HAS_NEON 1
 #endif
 
+// Maximum number of fields the 64-bit-lane matcher checks in registers
+#define JCRON_SIMD_MAX_FIELDS 8
+
 // SIMD-accelerated functions
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// 64-bit-lane field matcher: every field i matches when bit values[i] is set
+// in masks[i]. Lanes are 64 bits wide, so 60-bit minute (and seconds) masks
+// are covered natively; values >= 64 never match.
+#if defined(JCRON_HAS_AVX2)
+int jcron_simd_bitmask_match64_avx2(const uint64_t* masks, const uint64_t* values, int num_fields);
+#endif
+#if defined(JCRON_HAS_NEON)
+int jcron_simd_bitmask_match64_neon(const uint64_t* masks, const uint64_t* values, int num_fields);
+#endif
+int jcron_simd_bitmask_match64(const uint64_t* masks, const uint64_t* values, int num_fields);
+
+// Legacy 32-bit-lane matcher. Field values must be < 32, so minute masks
+// cannot be represented (bits 32-59 are lost). Kept for benchmarking against
+// the 64-bit kernel; new code should call jcron_simd_bitmask_match64().
+
 // AVX2 implementations
 #if defined(JCRON_HAS_AVX2)
 int jcron_simd_bitmask_match_avx2(const uint32_t* pattern_masks, const uint32_t* time_values, int num_fields);
@@ -36,6 +55,18 @@ int jcron_simd_bitmask_match_neon(const uint32_t* pattern_masks, const uint32_t*
 // Generic SIMD dispatcher
 int jcron_simd_bitmask_match(const uint32_t* pattern_masks, const uint32_t* time_values, int num_fields);
 
+// Batch timestamp matcher: one pattern against many UTC timestamps.
+// field_masks = {minutes, hours, days_of_month, months, days_of_week}.
+// Processes whole vector blocks and returns how many timestamps were written
+// to out; it stops early at a block it cannot handle (|ts| >= 2^51) so the
+// caller can finish that block with scalar code. Returns 0 without SIMD.
+#if defined(JCRON_HAS_AVX2)
+size_t jcron_simd_match_ts_batch_avx2(const uint64_t* field_masks, const int64_t* timestamps,
+                                      size_t count, uint8_t* out);
+#endif
+size_t jcron_simd_match_ts_batch(const uint64_t* field_masks, const int64_t* timestamps,
+                                 size_t count, uint8_t* out);
+
 #ifdef __cplusplus
 }
 #endif
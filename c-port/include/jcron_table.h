@@ -0,0 +1,218 @@
+/**
+ * JCRON C Port - Job Table
+ *
+ * Structure-of-arrays storage for a scheduler's jobs, indexed by stable
+ * slot numbers. Every per-job field has its own dense array, so a tick
+ * that looks at all jobs reads consecutive cache lines instead of one
+ * list node (and its strings) per job:
+ * - next_fire (8 bytes per job) is what jcron_table_due() scans
+ * - the five field masks (19 bytes per job) are what jcron_table_match()
+ *   scans; same answer as jcron_matches() on the full pattern
+ * - flags, keys and a caller pointer sit alongside; full patterns, only
+ *   needed to compute the next fire, live in a separate cold array
+ *
+ * Slots come from a free list: insert and remove are O(1), and a removed
+ * slot is handed to the next insert, so the arrays stay dense under
+ * churn. Slot numbers are stable for the life of a job and can key a
+ * jcron_index or jcron_sched.
+ *
+ * Strings (command, user, ...) are stored in per-slot columns and
+ * interned in a side pool: each distinct string is kept once and shared
+ * by every slot using it, and its bytes are reclaimed when the last of
+ * them goes.
+ *
+ * Like jcron_index, the table owns heap memory: call jcron_table_free().
+ */
+
+#ifndef JCRON_TABLE_H
+#define JCRON_TABLE_H
+
+#include "jcron.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* next_fire of a slot without a pending fire (never due) */
+#define JCRON_TABLE_IDLE INT64_MAX
+
+/* String columns per slot, at most */
+#define JCRON_TABLE_MAX_COLUMNS 8
+
+/* Slot flags; bits 1-7 are free for the caller (paused, running, ...) */
+#define JCRON_TABLE_USED 0x01
+
+/**
+ * Interned string (pool entry)
+ */
+typedef struct {
+    uint32_t offset;   /* Bytes in the pool's buffer */
+    uint32_t len;
+    uint32_t hash;
+    uint32_t refs;     /* Slot columns using it; 0 = free entry */
+    uint32_t next;     /* Hash chain, or free list when refs is 0 */
+} jcron_table_string_t;
+
+/**
+ * String pool
+ *
+ * Entry 0 is reserved: string id 0 means "no string".
+ */
+typedef struct {
+    char*     bytes;             /* NUL-terminated strings */
+    uint32_t  used;              /* Bytes appended */
+    uint32_t  dead;              /* ...of which released, reclaimed by compaction */
+    uint32_t  capacity;
+    jcron_table_string_t* entries;
+    uint32_t  entry_count;       /* Entries ever used (including 0) */
+    uint32_t  entry_capacity;
+    uint32_t  free_entry;        /* Released entries, chained through `next` */
+    uint32_t* buckets;           /* Hash -> first entry */
+    uint32_t  bucket_mask;
+} jcron_table_pool_t;
+
+/**
+ * Table structure
+ *
+ * Columns are indexed by slot and valid below `high`. Read them directly
+ * (e.g. table.keys[slot]); change them through the functions below.
+ */
+typedef struct {
+    /* Hot: read by every scan */
+    int64_t*  next_fire;         /* Next fire (Unix timestamp), or JCRON_TABLE_IDLE */
+    uint8_t*  flags;             /* JCRON_TABLE_USED | caller bits */
+    uint64_t* minutes;           /* Field masks, as in jcron_pattern_t (0 if no cron part) */
+    uint32_t* hours;
+    uint32_t* days_of_month;
+    uint16_t* months;
+    uint8_t*  days_of_week;
+    uint64_t* keys;              /* Caller's job identity */
+    void**    data;              /* Caller's record */
+
+    /* Cold */
+    jcron_pattern_t* patterns;   /* For jcron_next() */
+    uint32_t* strings;           /* `columns` string ids per slot */
+
+    /* Slot allocation */
+    uint32_t* free_slots;        /* Stack of removed slots */
+    uint32_t  free_count;
+    uint32_t  high;              /* Slots ever handed out; scans stop here */
+    uint32_t  capacity;
+    uint32_t  count;             /* Slots in use */
+    uint32_t  columns;
+
+    jcron_table_pool_t pool;
+} jcron_table_t;
+
+/**
+ * Initialize an empty table
+ *
+ * @param table    Table to initialize
+ * @param capacity Expected number of jobs (grows on demand)
+ * @param columns  String columns per slot (0-JCRON_TABLE_MAX_COLUMNS)
+ * @return         JCRON_OK or error code
+ */
+int jcron_table_init(jcron_table_t* table, uint32_t capacity, uint32_t columns);
+
+/**
+ * Release all memory held by the table
+ */
+void jcron_table_free(jcron_table_t* table);
+
+/**
+ * Add a job in a free slot
+ *
+ * The slot starts with no pending fire, caller flags clear and no strings.
+ * O(1), amortized over growth.
+ *
+ * @param table   Table
+ * @param pattern Parsed pattern (copied)
+ * @param key     Caller's job identity
+ * @param data    Caller's record (may be NULL)
+ * @param slot    Output slot
+ * @return        JCRON_OK or error code
+ */
+int jcron_table_insert(jcron_table_t* table, const jcron_pattern_t* pattern,
+                       uint64_t key, void* data, uint32_t* slot);
+
+/**
+ * Remove a job and release its strings (no-op if the slot is free)
+ *
+ * The slot is reused by a later insert. O(1) plus its string columns.
+ *
+ * @return JCRON_OK or error code
+ */
+int jcron_table_remove(jcron_table_t* table, uint32_t slot);
+
+/**
+ * Set a string column of a slot, interning the string
+ *
+ * @param table  Table
+ * @param slot   Slot in use
+ * @param column Column (below the table's `columns`)
+ * @param s      String (`len` bytes, need not be NUL-terminated), or NULL to clear
+ * @param len    Length of `s`
+ * @return       JCRON_OK or error code
+ */
+int jcron_table_set_string(jcron_table_t* table, uint32_t slot, uint32_t column,
+                           const char* s, size_t len);
+
+/**
+ * String column of a slot
+ *
+ * @return NUL-terminated string, or NULL when unset. Valid until the next
+ *         set_string or remove on the table.
+ */
+const char* jcron_table_string(const jcron_table_t* table, uint32_t slot, uint32_t column);
+
+/**
+ * Set a slot's next fire to the first match of its pattern at or after
+ * `from` (inclusive, minute resolution)
+ *
+ * @return JCRON_OK, or JCRON_ERR_NO_MATCH (next_fire is then JCRON_TABLE_IDLE)
+ */
+int jcron_table_advance(jcron_table_t* table, uint32_t slot, int64_t from);
+
+/**
+ * Collect the slots whose next fire is at or before `now`
+ *
+ * One sequential pass over next_fire from *cursor; stops early when `out`
+ * is full. Due slots stay due until the caller advances them.
+ *
+ * @param table  Table
+ * @param now    Current time (Unix timestamp)
+ * @param cursor First slot to look at; updated to where the scan stopped
+ * @param out    Output slots, ascending
+ * @param max    Capacity of `out`
+ * @return       Number of slots written; the scan is complete once
+ *               *cursor reaches table->high
+ *
+ * Example:
+ *   uint32_t cursor = 0, due[256], n;
+ *   while (cursor < table.high) {
+ *       n = jcron_table_due(&table, now, &cursor, due, 256);
+ *       for (uint32_t i = 0; i < n; i++) {
+ *           run_job(table.data[due[i]]);
+ *           jcron_table_advance(&table, due[i], now / 60 * 60 + 60);
+ *       }
+ *   }
+ */
+uint32_t jcron_table_due(const jcron_table_t* table, int64_t now, uint32_t* cursor,
+                         uint32_t* out, uint32_t max);
+
+/**
+ * Collect the slots whose pattern matches a timestamp, as jcron_matches()
+ * would (UTC, minute resolution), from the dense mask columns
+ *
+ * Same cursor protocol as jcron_table_due().
+ *
+ * @return Number of slots written
+ */
+uint32_t jcron_table_match(const jcron_table_t* table, int64_t timestamp, uint32_t* cursor,
+                           uint32_t* out, uint32_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JCRON_TABLE_H */
@@ -0,0 +1,17 @@
+-- JCRON PostgreSQL Extension upgrade from 1.0 to 1.1
+
+-- Hand every change to jcron.jobs to the scheduler when it commits; the
+-- scheduler keeps active jobs in shared memory and does not re-read the table
+CREATE OR REPLACE FUNCTION jcron.jobs_changed()
+RETURNS TRIGGER
+AS '$libdir/jcron', 'jcron_jobs_changed'
+LANGUAGE C;
+
+CREATE TRIGGER jobs_changed
+    AFTER INSERT OR DELETE OR UPDATE OF job_id, schedule, database, username, active
+    ON jcron.jobs
+    FOR EACH ROW EXECUTE FUNCTION jcron.jobs_changed();
+
+CREATE TRIGGER jobs_truncated
+    AFTER TRUNCATE ON jcron.jobs
+    FOR EACH STATEMENT EXECUTE FUNCTION jcron.jobs_changed();
@@ -11,11 +11,17 @@
 #include "postmaster/bgworker.h"
 #include "storage/ipc.h"
 #include "storage/latch.h"
+#include "storage/lwlock.h"
 #include "storage/proc.h"
+#include "storage/shmem.h"
 #include "utils/builtins.h"
 #include "utils/guc.h"
+#include "utils/hsearch.h"
+#include "utils/snapmgr.h"
 #include "utils/timestamp.h"
+#include "access/htup_details.h"
 #include "access/xact.h"
+#include "commands/trigger.h"
 #include "executor/spi.h"
 #include "lib/stringinfo.h"
 #include "pgstat.h"
@@ -40,28 +46,70 @@ PG_FUNCTION_INFO_V1(jcron_list_jobs);
 PG_FUNCTION_INFO_V1(jcron_parse_eod);
 PG_FUNCTION_INFO_V1(jcron_parse_sod);
 PG_FUNCTION_INFO_V1(jcron_get_nth_weekday);
+PG_FUNCTION_INFO_V1(jcron_jobs_changed);
 
 /* Internal functions */
 static void jcron_sigterm(SIGNAL_ARGS);
 static void jcron_main(Datum main_arg);
-static void execute_pending_jobs(void);
+static int64 execute_pending_jobs(void);
 static void load_jobs_from_database(void);
+static void jcron_shmem_request(void);
+static void jcron_shmem_startup(void);
+static void jcron_scheduler_detach(int code, Datum arg);
 
-/* Job structure */
-typedef struct JcronJob {
+/*
+ * Shared job registry
+ *
+ * Active jobs live in a shared-memory hash keyed by job_id, sized by
+ * jcron.max_jobs, with their compiled pattern and next fire. A trigger on
+ * jcron.jobs queues each change in the backend making it; at commit the
+ * backend applies the queue to the hash under the registry lock and sets
+ * the scheduler's latch. The scheduler reads jcron.jobs once, when it
+ * starts, and from then on only looks at the hash.
+ *
+ * The command is not kept here: the job executor reads it by job_id.
+ */
+#define NEXT_FIRE_IDLE PG_INT64_MAX
+
+typedef struct {
+    int64 job_id;                    /* Hash key */
+    bool removed;                    /* Deleted before the first load finished */
+    int64 next_fire;                 /* Unix timestamp, or NEXT_FIRE_IDLE */
+    char database[NAMEDATALEN];
+    char username[NAMEDATALEN];
+    jcron_pattern_t pattern;
+} shared_job_t;
+
+typedef struct {
+    LWLock* lock;                    /* Guards the hash and this struct */
+    Latch* scheduler_latch;          /* NULL while the scheduler is not running */
+    bool loaded;                     /* The scheduler's first load is done */
+} shared_state_t;
+
+static shared_state_t* shared_state = NULL;
+static HTAB* shared_jobs = NULL;
+
+#if PG_VERSION_NUM >= 150000
+static shmem_request_hook_type prev_shmem_request_hook = NULL;
+#endif
+static shmem_startup_hook_type prev_shmem_startup_hook = NULL;
+
+/* A change to jcron.jobs, applied to the registry at commit */
+typedef enum { CHANGE_SET, CHANGE_REMOVE, CHANGE_CLEAR } change_kind_t;
+
+typedef struct {
+    change_kind_t kind;
+    SubTransactionId subxact;        /* Dropped if this subtransaction aborts */
     int64 job_id;
-    char* schedule;
-    char* command;
-    char* database;
-    char* username;
+    int64 from;                      /* First fire at or after this time */
+    char database[NAMEDATALEN];
+    char username[NAMEDATALEN];
     jcron_pattern_t pattern;
-    TimestampTz last_run;
-    bool active;
-    struct JcronJob* next;
-} JcronJob;
+} pending_change_t;
 
-static JcronJob* job_list = NULL;
-static int job_count = 0;
+/* This transaction's changes, in order (TopTransactionContext) */
+static List* pending_changes = NIL;
+static bool callbacks_registered = false;
 
 /*
  * SQL Function: jcron_schedule(schedule, command, database, username)
@@ -102,7 +150,7 @@ jcron_schedule(PG_FUNCTION_ARGS)
         quote_literal_cstr(database),
         quote_literal_cstr(username));
 
-    if (SPI_execute(query.data, true, 1) != SPI_OK_INSERT_RETURNING) {
+    if (SPI_execute(query.data, false, 1) != SPI_OK_INSERT_RETURNING) {
         SPI_finish();
         ereport(ERROR,
                 (errcode(ERRCODE_INTERNAL_ERROR),
@@ -111,12 +159,11 @@ jcron_schedule(PG_FUNCTION_ARGS)
 
     if (SPI_processed > 0) {
         HeapTuple tuple = SPI_tuptable->vals[0];
+        bool isnull;
         int64 job_id = DatumGetInt64(SPI_getbinval(tuple, SPI_tuptable->tupdesc, 1, &isnull));
         SPI_finish();
 
-        /* Reload jobs */
-        load_jobs_from_database();
-
+        /* The jobs_changed trigger hands the job to the scheduler at commit */
         PG_RETURN_INT64(job_id);
     }
 
@@ -150,9 +197,7 @@ jcron_unschedule(PG_FUNCTION_ARGS)
 
     SPI_finish();
 
-    /* Reload jobs */
-    load_jobs_from_database();
-
+    /* The jobs_changed trigger drops the job from the scheduler at commit */
     PG_RETURN_BOOL(true);
 }
 
@@ -177,8 +222,8 @@ jcron_next_time(PG_FUNCTION_ARGS)
 
     /* Calculate next time */
     jcron_result_t next_result;
-    time_t now = time(NULL);
-    result = jcron_next(&pattern, now, &next_result);
+    int64 now = (int64) timestamptz_to_time_t(GetCurrentTimestamp());
+    result = jcron_next(now, &pattern, &next_result);
     if (result != JCRON_OK) {
         ereport(ERROR,
                 (errcode(ERRCODE_INTERNAL_ERROR),
@@ -186,7 +231,7 @@ jcron_next_time(PG_FUNCTION_ARGS)
     }
 
     /* Convert to PostgreSQL timestamp */
-    TimestampTz next_time = (TimestampTz)next_result.timestamp * USECS_PER_SEC;
+    TimestampTz next_time = time_t_to_timestamptz((pg_time_t) next_result.next_time);
 
     PG_RETURN_TIMESTAMPTZ(next_time);
 }
@@ -234,7 +279,7 @@ jcron_list_jobs(PG_FUNCTION_ARGS)
     }
 
     /* Process results */
-    for (int i = 0; i < SPI_processed; i++) {
+    for (uint64 i = 0; i < SPI_processed; i++) {
         HeapTuple tuple = SPI_tuptable->vals[i];
         bool isnull;
 
@@ -248,9 +293,9 @@ jcron_list_jobs(PG_FUNCTION_ARGS)
         jcron_pattern_t pattern;
         if (jcron_parse(schedule, &pattern) == JCRON_OK) {
             jcron_result_t next_result;
-            time_t now = time(NULL);
-            if (jcron_next(&pattern, now, &next_result) == JCRON_OK) {
-                TimestampTz next_time = (TimestampTz)next_result.timestamp * USECS_PER_SEC;
+            int64 now = (int64) timestamptz_to_time_t(GetCurrentTimestamp());
+            if (jcron_next(now, &pattern, &next_result) == JCRON_OK) {
+                TimestampTz next_time = time_t_to_timestamptz((pg_time_t) next_result.next_time);
 
                 Datum values[6];
                 bool nulls[6] = {false, false, false, false, false, false};
@@ -387,117 +432,473 @@ jcron_get_nth_weekday(PG_FUNCTION_ARGS)
 }
 
 /*
- * Load jobs from database
+ * Shared memory for the job registry
  */
+static Size
+jcron_shmem_size(void)
+{
+    return add_size(MAXALIGN(sizeof(shared_state_t)),
+                    hash_estimate_size(jcron_max_jobs, sizeof(shared_job_t)));
+}
+
 static void
-load_jobs_from_database(void)
+jcron_shmem_request(void)
+{
+#if PG_VERSION_NUM >= 150000
+    if (prev_shmem_request_hook)
+        prev_shmem_request_hook();
+#endif
+    RequestAddinShmemSpace(jcron_shmem_size());
+    RequestNamedLWLockTranche("jcron", 1);
+}
+
+static void
+jcron_shmem_startup(void)
+{
+    bool found;
+    HASHCTL info;
+
+    if (prev_shmem_startup_hook)
+        prev_shmem_startup_hook();
+
+    LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+
+    shared_state = ShmemInitStruct("jcron registry", sizeof(shared_state_t), &found);
+    if (!found) {
+        shared_state->lock = &(GetNamedLWLockTranche("jcron"))->lock;
+        shared_state->scheduler_latch = NULL;
+        shared_state->loaded = false;
+    }
+
+    /* Fixed size: an insert past jcron.max_jobs fails instead of growing */
+    memset(&info, 0, sizeof(info));
+    info.keysize = sizeof(int64);
+    info.entrysize = sizeof(shared_job_t);
+    shared_jobs = ShmemInitHash("jcron jobs", jcron_max_jobs, jcron_max_jobs, &info,
+                                HASH_ELEM | HASH_BLOBS | HASH_FIXED_SIZE);
+
+    LWLockRelease(AddinShmemInitLock);
+}
+
+/*
+ * First fire of a pattern at or after `from`, or NEXT_FIRE_IDLE
+ */
+static int64
+first_fire(const jcron_pattern_t* pattern, int64 from)
+{
+    jcron_result_t result;
+    return jcron_next(from, pattern, &result) == JCRON_OK ? result.next_time : NEXT_FIRE_IDLE;
+}
+
+/*
+ * Where a job's fires start: the current minute, or the minute after its
+ * last recorded run if that is later
+ */
+static int64
+fires_from(HeapTuple tuple, TupleDesc tupdesc, int last_run_column)
+{
+    bool isnull;
+    int64 from = (int64) timestamptz_to_time_t(GetCurrentTimestamp()) / 60 * 60;
+    Datum last_run = heap_getattr(tuple, last_run_column, tupdesc, &isnull);
+
+    if (!isnull) {
+        int64 after = (int64) timestamptz_to_time_t(DatumGetTimestampTz(last_run)) / 60 * 60 + 60;
+        from = Max(from, after);
+    }
+    return from;
+}
+
+/*
+ * Drop a registry entry (registry lock held exclusively). Until the first
+ * load is done it stays as a tombstone, so the load cannot bring it back.
+ */
+static void
+remove_job(shared_job_t* job)
+{
+    if (shared_state->loaded) {
+        hash_search(shared_jobs, &job->job_id, HASH_REMOVE, NULL);
+        return;
+    }
+    job->removed = true;
+    job->next_fire = NEXT_FIRE_IDLE;
+}
+
+/*
+ * Apply this transaction's changes to the registry and wake the scheduler.
+ * Runs after commit, so it must not fail: jobs past jcron.max_jobs are
+ * reported and left out.
+ */
+static void
+apply_pending_changes(void)
+{
+    ListCell* cell;
+    Latch* latch;
+    int dropped = 0;
+
+    if (pending_changes == NIL || !shared_state)
+        return;
+
+    LWLockAcquire(shared_state->lock, LW_EXCLUSIVE);
+    foreach (cell, pending_changes) {
+        pending_change_t* change = (pending_change_t*) lfirst(cell);
+        shared_job_t* job;
+        bool found;
+
+        if (change->kind == CHANGE_CLEAR) {
+            HASH_SEQ_STATUS status;
+            hash_seq_init(&status, shared_jobs);
+            while ((job = (shared_job_t*) hash_seq_search(&status)) != NULL)
+                remove_job(job);
+            continue;
+        }
+
+        if (change->kind == CHANGE_REMOVE) {
+            job = (shared_job_t*) hash_search(shared_jobs, &change->job_id,
+                                              shared_state->loaded ? HASH_FIND : HASH_ENTER_NULL,
+                                              &found);
+            if (job)
+                remove_job(job);
+            continue;
+        }
+
+        job = (shared_job_t*) hash_search(shared_jobs, &change->job_id, HASH_ENTER_NULL, &found);
+        if (!job) {
+            dropped++;
+            continue;
+        }
+        job->removed = false;
+        job->pattern = change->pattern;
+        job->next_fire = first_fire(&job->pattern, change->from);
+        memcpy(job->database, change->database, NAMEDATALEN);
+        memcpy(job->username, change->username, NAMEDATALEN);
+    }
+    latch = shared_state->scheduler_latch;
+    LWLockRelease(shared_state->lock);
+
+    if (latch)
+        SetLatch(latch);
+
+    if (dropped > 0)
+        ereport(WARNING,
+                (errmsg("JCRON job registry is full: %d jobs not scheduled", dropped),
+                 errhint("Raise jcron.max_jobs (currently %d) and restart the server.",
+                         jcron_max_jobs)));
+}
+
+static void
+jcron_xact_callback(XactEvent event, void* arg)
+{
+    switch (event) {
+        case XACT_EVENT_PRE_PREPARE:
+            /* The changes would be applied at PREPARE, not at COMMIT PREPARED */
+            if (pending_changes != NIL)
+                ereport(ERROR,
+                        (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                         errmsg("cannot PREPARE a transaction that has changed jcron.jobs")));
+            break;
+        case XACT_EVENT_COMMIT:
+        case XACT_EVENT_PARALLEL_COMMIT:
+            apply_pending_changes();
+            pending_changes = NIL;
+            break;
+        case XACT_EVENT_ABORT:
+        case XACT_EVENT_PARALLEL_ABORT:
+        case XACT_EVENT_PREPARE:
+            pending_changes = NIL;
+            break;
+        default:
+            break;
+    }
+}
+
+static void
+jcron_subxact_callback(SubXactEvent event, SubTransactionId mySubid,
+                       SubTransactionId parentSubid, void* arg)
+{
+    ListCell* cell;
+    List* kept = NIL;
+    MemoryContext oldcontext;
+
+    if (pending_changes == NIL ||
+        (event != SUBXACT_EVENT_COMMIT_SUB && event != SUBXACT_EVENT_ABORT_SUB))
+        return;
+
+    /* A committed subtransaction's changes now belong to its parent; an
+     * aborted one's are dropped */
+    oldcontext = MemoryContextSwitchTo(TopTransactionContext);
+    foreach (cell, pending_changes) {
+        pending_change_t* change = (pending_change_t*) lfirst(cell);
+        if (change->subxact == mySubid) {
+            if (event == SUBXACT_EVENT_ABORT_SUB)
+                continue;
+            change->subxact = parentSubid;
+        }
+        kept = lappend(kept, change);
+    }
+    MemoryContextSwitchTo(oldcontext);
+
+    list_free(pending_changes);
+    pending_changes = kept;
+}
+
+/*
+ * Queue the change a row of jcron.jobs makes (NULL tuple: every row)
+ */
+static void
+queue_change(change_kind_t kind, HeapTuple tuple, TupleDesc tupdesc)
+{
+    pending_change_t* change;
+    MemoryContext oldcontext;
+    bool isnull;
+
+    if (!callbacks_registered) {
+        RegisterXactCallback(jcron_xact_callback, NULL);
+        RegisterSubXactCallback(jcron_subxact_callback, NULL);
+        callbacks_registered = true;
+    }
+
+    change = (pending_change_t*) MemoryContextAllocZero(TopTransactionContext,
+                                                        sizeof(pending_change_t));
+    change->kind = kind;
+    change->subxact = GetCurrentSubTransactionId();
+
+    if (tuple) {
+        change->job_id = DatumGetInt64(heap_getattr(tuple, SPI_fnumber(tupdesc, "job_id"),
+                                                    tupdesc, &isnull));
+
+        /* An inactive job leaves the registry */
+        Datum active = heap_getattr(tuple, SPI_fnumber(tupdesc, "active"), tupdesc, &isnull);
+        if (kind == CHANGE_SET && (isnull || !DatumGetBool(active)))
+            change->kind = CHANGE_REMOVE;
+    }
+
+    if (change->kind == CHANGE_SET) {
+        char* schedule = SPI_getvalue(tuple, tupdesc, SPI_fnumber(tupdesc, "schedule"));
+        char* database = SPI_getvalue(tuple, tupdesc, SPI_fnumber(tupdesc, "database"));
+        char* username = SPI_getvalue(tuple, tupdesc, SPI_fnumber(tupdesc, "username"));
+
+        /* Compiled here, so the scheduler never parses */
+        if (!schedule || jcron_parse(schedule, &change->pattern) != JCRON_OK) {
+            ereport(ERROR,
+                    (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                     errmsg("Invalid cron schedule for job %ld: %s", change->job_id,
+                            schedule ? schedule : "(null)")));
+        }
+        strlcpy(change->database, database ? database : "postgres", NAMEDATALEN);
+        strlcpy(change->username, username ? username : "", NAMEDATALEN);
+        change->from = fires_from(tuple, tupdesc, SPI_fnumber(tupdesc, "last_run"));
+    }
+
+    oldcontext = MemoryContextSwitchTo(TopTransactionContext);
+    pending_changes = lappend(pending_changes, change);
+    MemoryContextSwitchTo(oldcontext);
+}
+
+/*
+ * Trigger on jcron.jobs: hand the change to the scheduler at commit
+ */
+Datum
+jcron_jobs_changed(PG_FUNCTION_ARGS)
 {
-    /* Free existing jobs */
-    JcronJob* job = job_list;
-    while (job) {
-        JcronJob* next = job->next;
-        if (job->schedule) pfree(job->schedule);
-        if (job->command) pfree(job->command);
-        if (job->database) pfree(job->database);
-        if (job->username) pfree(job->username);
-        pfree(job);
-        job = next;
+    TriggerData* trigdata = (TriggerData*) fcinfo->context;
+
+    if (!CALLED_AS_TRIGGER(fcinfo) || !TRIGGER_FIRED_AFTER(trigdata->tg_event)) {
+        ereport(ERROR,
+                (errcode(ERRCODE_E_R_I_E_TRIGGER_PROTOCOL_VIOLATED),
+                 errmsg("jcron_jobs_changed: must be fired as an AFTER trigger")));
     }
-    job_list = NULL;
-    job_count = 0;
 
-    /* Load from database */
+    /* Not in shared_preload_libraries: there is no scheduler to tell */
+    if (!shared_state)
+        return PointerGetDatum(NULL);
+
+    TupleDesc tupdesc = RelationGetDescr(trigdata->tg_relation);
+
+    if (TRIGGER_FIRED_BY_TRUNCATE(trigdata->tg_event)) {
+        queue_change(CHANGE_CLEAR, NULL, tupdesc);
+    } else if (TRIGGER_FIRED_BY_DELETE(trigdata->tg_event)) {
+        queue_change(CHANGE_REMOVE, trigdata->tg_trigtuple, tupdesc);
+    } else if (TRIGGER_FIRED_BY_INSERT(trigdata->tg_event)) {
+        queue_change(CHANGE_SET, trigdata->tg_trigtuple, tupdesc);
+    } else {
+        /* A renumbered job leaves its old id behind */
+        bool isnull;
+        int job_id_column = SPI_fnumber(tupdesc, "job_id");
+        int64 old_id = DatumGetInt64(heap_getattr(trigdata->tg_trigtuple, job_id_column,
+                                                  tupdesc, &isnull));
+        int64 new_id = DatumGetInt64(heap_getattr(trigdata->tg_newtuple, job_id_column,
+                                                  tupdesc, &isnull));
+        if (old_id != new_id)
+            queue_change(CHANGE_REMOVE, trigdata->tg_trigtuple, tupdesc);
+        queue_change(CHANGE_SET, trigdata->tg_newtuple, tupdesc);
+    }
+
+    return PointerGetDatum(NULL);
+}
+
+/*
+ * Fill the registry from jcron.jobs, once, when the scheduler first starts
+ *
+ * A job a backend has put in the registry (or taken out of it) meanwhile
+ * is newer than this snapshot, and is left alone.
+ */
+static void
+load_jobs_from_database(void)
+{
+    uint32 loaded = 0;
+    bool done;
+
+    LWLockAcquire(shared_state->lock, LW_SHARED);
+    done = shared_state->loaded;
+    LWLockRelease(shared_state->lock);
+    if (done)
+        return;
+
+    SetCurrentStatementStartTimestamp();
+    StartTransactionCommand();
     SPI_connect();
-    if (SPI_execute("SELECT job_id, schedule, command, database, username, last_run FROM jcron.jobs WHERE active = true",
+    PushActiveSnapshot(GetTransactionSnapshot());
+
+    if (SPI_execute("SELECT job_id, schedule, database, username, last_run FROM jcron.jobs WHERE active = true",
                     true, 0) != SPI_OK_SELECT) {
+        elog(WARNING, "JCRON could not read jcron.jobs");
         SPI_finish();
+        PopActiveSnapshot();
+        CommitTransactionCommand();
         return;
     }
 
-    for (int i = 0; i < SPI_processed; i++) {
+    LWLockAcquire(shared_state->lock, LW_EXCLUSIVE);
+    for (uint64 i = 0; i < SPI_processed; i++) {
         HeapTuple tuple = SPI_tuptable->vals[i];
-        bool isnull;
-
-        JcronJob* job = (JcronJob*) palloc(sizeof(JcronJob));
-        memset(job, 0, sizeof(JcronJob));
-
-        job->job_id = DatumGetInt64(SPI_getbinval(tuple, SPI_tuptable->tupdesc, 1, &isnull));
-        job->schedule = pstrdup(SPI_getvalue(tuple, SPI_tuptable->tupdesc, 2));
-        job->command = pstrdup(SPI_getvalue(tuple, SPI_tuptable->tupdesc, 3));
-        job->database = pstrdup(SPI_getvalue(tuple, SPI_tuptable->tupdesc, 4));
-        job->username = pstrdup(SPI_getvalue(tuple, SPI_tuptable->tupdesc, 5));
+        TupleDesc tupdesc = SPI_tuptable->tupdesc;
+        bool isnull, found;
 
         /* Parse schedule */
-        if (jcron_parse(job->schedule, &job->pattern) != JCRON_OK) {
-            pfree(job->schedule);
-            pfree(job->command);
-            pfree(job->database);
-            pfree(job->username);
-            pfree(job);
+        char* schedule = SPI_getvalue(tuple, tupdesc, 2);
+        jcron_pattern_t pattern;
+        if (!schedule || jcron_parse(schedule, &pattern) != JCRON_OK)
             continue;
+
+        int64 job_id = DatumGetInt64(SPI_getbinval(tuple, tupdesc, 1, &isnull));
+        shared_job_t* job = (shared_job_t*) hash_search(shared_jobs, &job_id, HASH_ENTER_NULL,
+                                                        &found);
+        if (!job) {
+            elog(WARNING, "JCRON job registry is full at %d jobs", jcron_max_jobs);
+            break;
         }
+        if (found)
+            continue;
 
-        job->active = true;
-        job->next = job_list;
-        job_list = job;
-        job_count++;
+        char* database = SPI_getvalue(tuple, tupdesc, 3);
+        char* username = SPI_getvalue(tuple, tupdesc, 4);
+        job->removed = false;
+        job->pattern = pattern;
+        job->next_fire = first_fire(&pattern, fires_from(tuple, tupdesc, 5));
+        strlcpy(job->database, database ? database : "postgres", NAMEDATALEN);
+        strlcpy(job->username, username ? username : "", NAMEDATALEN);
+        loaded++;
     }
 
+    /* From here on, removals take effect at once */
+    HASH_SEQ_STATUS status;
+    shared_job_t* job;
+    hash_seq_init(&status, shared_jobs);
+    while ((job = (shared_job_t*) hash_seq_search(&status)) != NULL) {
+        if (job->removed)
+            hash_search(shared_jobs, &job->job_id, HASH_REMOVE, NULL);
+    }
+    shared_state->loaded = true;
+    LWLockRelease(shared_state->lock);
+
     SPI_finish();
+    PopActiveSnapshot();
+    CommitTransactionCommand();
 
-    elog(LOG, "JCRON loaded %d jobs from database", job_count);
+    elog(LOG, "JCRON loaded %u jobs from database", loaded);
 }
 
 /*
- * Execute pending jobs
+ * Execute pending jobs; returns the earliest fire still pending
  */
-static void
+static int64
 execute_pending_jobs(void)
 {
-    TimestampTz now = GetCurrentTimestamp();
-    time_t current_time = (time_t)(now / USECS_PER_SEC);
-
-    JcronJob* job = job_list;
-    while (job) {
-        /* Check if job should run */
-        if (jcron_matches(current_time, &job->pattern)) {
-            /* Avoid running the same job multiple times in the same minute */
-            if (job->last_run == 0 ||
-                (now - job->last_run) >= (60 * USECS_PER_SEC)) {
-
-                /* Execute job in separate process/database connection */
-                BackgroundWorker worker;
-                memset(&worker, 0, sizeof(BackgroundWorker));
-
-                snprintf(worker.bgw_name, BGW_MAXLEN, "jcron job %ld", job->job_id);
-                snprintf(worker.bgw_function_name, BGW_MAXLEN, "jcron_job_executor");
-                worker.bgw_flags = BGWORKER_SHMEM_ACCESS | BGWORKER_BACKEND_DATABASE_CONNECTION;
-                worker.bgw_start_time = BgWorkerStart_RecoveryFinished;
-                worker.bgw_restart_time = BGW_NEVER_RESTART;
-                worker.bgw_main_arg = Int64GetDatum(job->job_id);
-                strcpy(worker.bgw_library_name, "jcron");
-                strcpy(worker.bgw_extra, job->database);
-
-                RegisterDynamicBackgroundWorker(&worker, NULL);
-
-                job->last_run = now;
-
-                /* Update last_run in database */
-                SPI_connect();
-                StringInfoData query;
-                initStringInfo(&query);
-                appendStringInfo(&query,
-                    "UPDATE jcron.jobs SET last_run = now() WHERE job_id = %ld",
-                    job->job_id);
-                SPI_execute(query.data, false, 0);
-                SPI_finish();
-
-                elog(LOG, "JCRON scheduled job %ld for execution", job->job_id);
-            }
+    typedef struct {
+        int64 job_id;
+        char database[NAMEDATALEN];
+    } due_job_t;
+
+    static due_job_t* due = NULL;
+    int64 current_time = (int64) timestamptz_to_time_t(GetCurrentTimestamp());
+    int64 next_minute = current_time / 60 * 60 + 60;
+    int64 earliest = NEXT_FIRE_IDLE;
+    int n = 0;
+    HASH_SEQ_STATUS status;
+    shared_job_t* job;
+
+    if (!due)
+        due = MemoryContextAlloc(TopMemoryContext, sizeof(due_job_t) * jcron_max_jobs);
+
+    /* One pass over the registry; a fire missed by a late tick is still
+     * due, and runs once */
+    LWLockAcquire(shared_state->lock, LW_EXCLUSIVE);
+    hash_seq_init(&status, shared_jobs);
+    while ((job = (shared_job_t*) hash_seq_search(&status)) != NULL) {
+        if (job->next_fire <= current_time) {
+            due[n].job_id = job->job_id;
+            memcpy(due[n].database, job->database, NAMEDATALEN);
+            n++;
+
+            /* Next fire after the current minute */
+            job->next_fire = first_fire(&job->pattern, next_minute);
         }
+        earliest = Min(earliest, job->next_fire);
+    }
+    LWLockRelease(shared_state->lock);
+
+    if (n == 0)
+        return earliest;
 
-        job = job->next;
+    SetCurrentStatementStartTimestamp();
+    StartTransactionCommand();
+    SPI_connect();
+    PushActiveSnapshot(GetTransactionSnapshot());
+
+    for (int i = 0; i < n; i++) {
+        int64 job_id = due[i].job_id;
+
+        /* Execute job in separate process/database connection */
+        BackgroundWorker worker;
+        memset(&worker, 0, sizeof(BackgroundWorker));
+
+        snprintf(worker.bgw_name, BGW_MAXLEN, "jcron job %ld", job_id);
+        snprintf(worker.bgw_function_name, BGW_MAXLEN, "jcron_job_executor");
+        worker.bgw_flags = BGWORKER_SHMEM_ACCESS | BGWORKER_BACKEND_DATABASE_CONNECTION;
+        worker.bgw_start_time = BgWorkerStart_RecoveryFinished;
+        worker.bgw_restart_time = BGW_NEVER_RESTART;
+        worker.bgw_main_arg = Int64GetDatum(job_id);
+        strcpy(worker.bgw_library_name, "jcron");
+        strlcpy(worker.bgw_extra, due[i].database, BGW_EXTRALEN);
+
+        RegisterDynamicBackgroundWorker(&worker, NULL);
+
+        /* Update last_run in database (not a column the trigger watches) */
+        StringInfoData query;
+        initStringInfo(&query);
+        appendStringInfo(&query,
+            "UPDATE jcron.jobs SET last_run = now() WHERE job_id = %ld",
+            job_id);
+        SPI_execute(query.data, false, 0);
+
+        elog(LOG, "JCRON scheduled job %ld for execution", job_id);
     }
+
+    SPI_finish();
+    PopActiveSnapshot();
+    CommitTransactionCommand();
+
+    return earliest;
 }
 
 /*
@@ -513,6 +914,12 @@ jcron_main(Datum main_arg)
     /* Connect to database */
     BackgroundWorkerInitializeConnection("postgres", NULL, 0);
 
+    /* Backends set this latch when they change a job */
+    LWLockAcquire(shared_state->lock, LW_EXCLUSIVE);
+    shared_state->scheduler_latch = &MyProc->procLatch;
+    LWLockRelease(shared_state->lock);
+    before_shmem_exit(jcron_scheduler_detach, (Datum) 0);
+
     /* Load initial jobs */
     load_jobs_from_database();
 
@@ -520,9 +927,20 @@ jcron_main(Datum main_arg)
 
     /* Main loop */
     while (!got_sigterm) {
+        /* Check and execute jobs */
+        int64 earliest = execute_pending_jobs();
+
+        /* Sleep until the earliest fire, and no longer than check_interval;
+         * a changed job sets the latch, and the next pass sees it */
+        long timeout = jcron_check_interval * 1000L;
+        if (earliest != NEXT_FIRE_IDLE) {
+            TimestampTz fire = time_t_to_timestamptz((pg_time_t) earliest);
+            timeout = Min(timeout, TimestampDifferenceMilliseconds(GetCurrentTimestamp(), fire));
+        }
+
         int rc = WaitLatch(&MyProc->procLatch,
                           WL_LATCH_SET | WL_TIMEOUT | WL_POSTMASTER_DEATH,
-                          jcron_check_interval * 1000L,
+                          timeout,
                           PG_WAIT_EXTENSION);
 
         ResetLatch(&MyProc->procLatch);
@@ -530,19 +948,21 @@ jcron_main(Datum main_arg)
         if (rc & WL_POSTMASTER_DEATH) {
             break;
         }
-
-        if (rc & WL_LATCH_SET) {
-            /* Reload configuration if requested */
-            load_jobs_from_database();
-        }
-
-        /* Check and execute jobs */
-        execute_pending_jobs();
     }
 
     elog(LOG, "JCRON background worker shutting down");
 }
 
+/*
+ * Stop backends from setting the exiting scheduler's latch. A plain store:
+ * the registry lock may be held here if the scheduler exits on an error.
+ */
+static void
+jcron_scheduler_detach(int code, Datum arg)
+{
+    shared_state->scheduler_latch = NULL;
+}
+
 /*
  * Signal handler
  */
@@ -562,19 +982,19 @@ _PG_init(void)
     /* Register GUC variables */
     DefineCustomIntVariable("jcron.max_jobs",
                            "Maximum number of cron jobs",
-                           NULL,
+                           "Sizes the shared job registry; changing it needs a restart.",
                            &jcron_max_jobs,
                            1000,
                            1,
                            10000,
-                           PGC_SIGHUP,
+                           PGC_POSTMASTER,
                            GUC_UNIT,
                            NULL,
                            NULL,
                            NULL);
 
     DefineCustomIntVariable("jcron.check_interval",
-                           "Job check interval in seconds",
+                           "Longest the scheduler sleeps between job checks, in seconds",
                            NULL,
                            &jcron_check_interval,
                            60,
@@ -586,6 +1006,19 @@ _PG_init(void)
                            NULL,
                            NULL);
 
+    /* The job registry and the scheduler need shared_preload_libraries */
+    if (!process_shared_preload_libraries_in_progress)
+        return;
+
+#if PG_VERSION_NUM >= 150000
+    prev_shmem_request_hook = shmem_request_hook;
+    shmem_request_hook = jcron_shmem_request;
+#else
+    jcron_shmem_request();
+#endif
+    prev_shmem_startup_hook = shmem_startup_hook;
+    shmem_startup_hook = jcron_shmem_startup;
+
     /* Register background worker */
     BackgroundWorker worker;
     memset(&worker, 0, sizeof(BackgroundWorker));
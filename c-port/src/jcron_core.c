@@ -37,6 +37,8 @@ const char* jcron_strerror(int error_code) {
             return "Time calculation overflow";
         case JCRON_ERR_NULL_POINTER:
             return "Null pointer argument";
+        case JCRON_ERR_NO_MEMORY:
+            return "Out of memory";
         default:
             return "Unknown error";
     }
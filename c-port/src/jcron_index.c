@@ -0,0 +1,225 @@
+/**
+ * JCRON C Port - Inverted Field-Value Index Implementation
+ *
+ * One job bitset per field value; matching is the AND of five rows,
+ * driven by a per-row summary of non-zero words.
+ */
+
+#define _POSIX_C_SOURCE 200809L  /* gmtime_r */
+
+#include "jcron_index.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* ========================================================================
+ * Row Layout
+ * ======================================================================== */
+
+#define ROW_MINUTE  0    /* minute m      -> row m        */
+#define ROW_HOUR    60   /* hour h        -> row 60 + h   */
+#define ROW_DOM     84   /* day d (1-31)  -> row 83 + d   */
+#define ROW_MONTH   115  /* month m(1-12) -> row 114 + m  */
+#define ROW_DOW     127  /* weekday w     -> row 127 + w  */
+
+/* Growth granularity: one summary word covers 64 words = 4096 slots */
+#define BLOCK_WORDS 64
+
+static inline uint64_t* row_bits(const jcron_index_t* index, int row) {
+    return index->bits + (size_t)row * index->words;
+}
+
+static inline uint64_t* row_summary(const jcron_index_t* index, int row) {
+    return index->summary + (size_t)row * index->summary_words;
+}
+
+/* ========================================================================
+ * Allocation
+ * ======================================================================== */
+
+/**
+ * Grow rows to hold at least min_slots slots, preserving contents
+ */
+static int index_grow(jcron_index_t* index, uint64_t min_slots) {
+    uint64_t words = index->words ? index->words : BLOCK_WORDS;
+    while (words * 64 < min_slots) {
+        words *= 2;
+    }
+    if (words == index->words) return JCRON_OK;
+    if (words * 64 > UINT32_MAX) return JCRON_ERR_OVERFLOW;
+
+    uint32_t summary_words = (uint32_t)(words / BLOCK_WORDS);
+    uint64_t* bits = calloc((size_t)JCRON_INDEX_ROWS * words, sizeof(uint64_t));
+    uint64_t* summary = calloc((size_t)JCRON_INDEX_ROWS * summary_words, sizeof(uint64_t));
+    uint64_t* live = calloc((size_t)words, sizeof(uint64_t));
+    if (!bits || !summary || !live) {
+        free(bits);
+        free(summary);
+        free(live);
+        return JCRON_ERR_NO_MEMORY;
+    }
+
+    if (index->words) {
+        for (int row = 0; row < JCRON_INDEX_ROWS; row++) {
+            memcpy(bits + (size_t)row * words, row_bits(index, row),
+                   index->words * sizeof(uint64_t));
+            memcpy(summary + (size_t)row * summary_words, row_summary(index, row),
+                   index->summary_words * sizeof(uint64_t));
+        }
+        memcpy(live, index->live, index->words * sizeof(uint64_t));
+    }
+
+    free(index->bits);
+    free(index->summary);
+    free(index->live);
+
+    index->bits = bits;
+    index->summary = summary;
+    index->live = live;
+    index->words = (uint32_t)words;
+    index->summary_words = summary_words;
+    return JCRON_OK;
+}
+
+int jcron_index_init(jcron_index_t* index, uint32_t capacity) {
+    if (!index) return JCRON_ERR_NULL_POINTER;
+
+    memset(index, 0, sizeof(*index));
+    return index_grow(index, capacity);
+}
+
+void jcron_index_free(jcron_index_t* index) {
+    if (!index) return;
+
+    free(index->bits);
+    free(index->summary);
+    free(index->live);
+    memset(index, 0, sizeof(*index));
+}
+
+/* ========================================================================
+ * Add / Remove
+ * ======================================================================== */
+
+static inline void row_set(jcron_index_t* index, int row, uint32_t slot) {
+    uint32_t word = slot / 64;
+    row_bits(index, row)[word] |= 1ULL << (slot % 64);
+    row_summary(index, row)[word / 64] |= 1ULL << (word % 64);
+}
+
+static inline void row_clear(jcron_index_t* index, int row, uint32_t slot) {
+    uint32_t word = slot / 64;
+    uint64_t* bits = row_bits(index, row);
+
+    bits[word] &= ~(1ULL << (slot % 64));
+    if (bits[word] == 0) {
+        row_summary(index, row)[word / 64] &= ~(1ULL << (word % 64));
+    }
+}
+
+/**
+ * Set the slot bit in every row whose value is present in mask
+ */
+static void rows_set_mask(jcron_index_t* index, int first_row, uint64_t mask, uint32_t slot) {
+    while (mask) {
+        row_set(index, first_row + __builtin_ctzll(mask), slot);
+        mask &= mask - 1;
+    }
+}
+
+int jcron_index_remove(jcron_index_t* index, uint32_t slot) {
+    if (!index) return JCRON_ERR_NULL_POINTER;
+    if (slot / 64 >= index->words) return JCRON_OK;
+
+    uint64_t bit = 1ULL << (slot % 64);
+    if (!(index->live[slot / 64] & bit)) return JCRON_OK;
+
+    for (int row = 0; row < JCRON_INDEX_ROWS; row++) {
+        row_clear(index, row, slot);
+    }
+    index->live[slot / 64] &= ~bit;
+    index->count--;
+    return JCRON_OK;
+}
+
+int jcron_index_add(jcron_index_t* index, uint32_t slot, const jcron_pattern_t* pattern) {
+    if (!index || !pattern) return JCRON_ERR_NULL_POINTER;
+    if (!pattern->has_cron) return JCRON_ERR_INVALID_PATTERN;
+
+    if ((uint64_t)slot + 1 > (uint64_t)index->words * 64) {
+        int ret = index_grow(index, (uint64_t)slot + 1);
+        if (ret != JCRON_OK) return ret;
+    }
+
+    jcron_index_remove(index, slot);
+
+    // Day/month masks are 1-based; shift so bit 0 is the first value
+    rows_set_mask(index, ROW_MINUTE, pattern->minutes & ((1ULL << 60) - 1), slot);
+    rows_set_mask(index, ROW_HOUR, pattern->hours & ((1U << 24) - 1), slot);
+    rows_set_mask(index, ROW_DOM, (pattern->days_of_month >> 1) & 0x7FFFFFFFU, slot);
+    rows_set_mask(index, ROW_MONTH, (uint64_t)(pattern->months >> 1) & 0xFFFU, slot);
+    rows_set_mask(index, ROW_DOW, pattern->days_of_week & 0x7FU, slot);
+
+    index->live[slot / 64] |= 1ULL << (slot % 64);
+    index->count++;
+    return JCRON_OK;
+}
+
+/* ========================================================================
+ * Matching
+ * ======================================================================== */
+
+int jcron_index_match(const jcron_index_t* index, int64_t timestamp, jcron_index_iter_t* iter) {
+    if (!index || !iter) return JCRON_ERR_NULL_POINTER;
+
+    struct tm tm;
+    time_t t = (time_t)timestamp;
+    if (!gmtime_r(&t, &tm)) return JCRON_ERR_INVALID_TIME;
+
+    const int rows[5] = {
+        ROW_MINUTE + tm.tm_min,
+        ROW_HOUR + tm.tm_hour,
+        ROW_DOM + tm.tm_mday - 1,
+        ROW_MONTH + tm.tm_mon,
+        ROW_DOW + tm.tm_wday
+    };
+
+    memset(iter, 0, sizeof(*iter));
+    for (int i = 0; i < 5; i++) {
+        iter->rows[i] = row_bits(index, rows[i]);
+        iter->summaries[i] = row_summary(index, rows[i]);
+    }
+    iter->summary_words = index->words ? index->summary_words : 0;
+    return JCRON_OK;
+}
+
+int jcron_index_next(jcron_index_iter_t* iter) {
+    for (;;) {
+        // 1. Drain matching slots of the current word
+        if (iter->bits) {
+            int bit = __builtin_ctzll(iter->bits);
+            iter->bits &= iter->bits - 1;
+            return (int)(iter->word * 64 + (uint32_t)bit);
+        }
+
+        // 2. Next word that is non-zero in all five rows
+        if (iter->pending) {
+            uint32_t word = iter->word_base + (uint32_t)__builtin_ctzll(iter->pending);
+            iter->pending &= iter->pending - 1;
+            iter->word = word;
+            iter->bits = iter->rows[0][word] & iter->rows[1][word] & iter->rows[2][word] &
+                         iter->rows[3][word] & iter->rows[4][word];
+            continue;
+        }
+
+        // 3. Next summary word
+        if (iter->summary_pos >= iter->summary_words) {
+            return -1;
+        }
+        uint32_t pos = iter->summary_pos++;
+        iter->word_base = pos * 64;
+        iter->pending = iter->summaries[0][pos] & iter->summaries[1][pos] &
+                        iter->summaries[2][pos] & iter->summaries[3][pos] &
+                        iter->summaries[4][pos];
+    }
+}
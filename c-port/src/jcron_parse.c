@@ -16,27 +16,28 @@
  * ======================================================================== */
 
 /**
- * Skip whitespace in string
+ * Skip whitespace in [str, limit)
  */
-static const char* skip_whitespace(const char* str) {
-    while (*str && isspace(*str)) {
+static const char* skip_whitespace(const char* str, const char* limit) {
+    while (str < limit && isspace((unsigned char)*str)) {
         str++;
     }
     return str;
 }
 
 /**
- * Parse integer from string
+ * Parse integer from [*str, limit)
  */
-static int parse_int(const char** str, int* out) {
+static int parse_int(const char** str, const char* limit, int* out) {
     const char* p = *str;
     
-    if (!isdigit(*p)) {
+    if (p == limit || !isdigit((unsigned char)*p)) {
         return -1;  // Not a number
     }
     
     int value = 0;
-    while (isdigit(*p)) {
+    while (p < limit && isdigit((unsigned char)*p)) {
+        if (value > 100000) return -1;  // Far outside any field
         value = value * 10 + (*p - '0');
         p++;
     }
@@ -46,6 +47,18 @@ static int parse_int(const char** str, int* out) {
     return 0;
 }
 
+/**
+ * Mix a 64-bit value (splitmix64 finalizer)
+ *
+ * Spreads nearby job keys and field indexes over unrelated "H" values.
+ */
+static uint64_t hash_mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
 /**
  * Set all bits in range [start, end] for 64-bit mask
  */
@@ -95,32 +108,36 @@ static void set_range_8(uint8_t* mask, int start, int end) {
  * - "N-M" (range)
  * - "N,M,O" (list)
  * - "STAR/N" or "N-M/S" (step, STAR means asterisk)
+ * - "H", "H/N", "H(N-M)", "H(N-M)/S" (hashed: a value, or the phase of a
+ *   step, picked from the range by `hash`)
  * 
- * @param field     Field string (e.g., "5" or "1-10" or "1,5,10")
+ * @param field     Field text (e.g., "5" or "1-10" or "1,5,10")
+ * @param limit     End of the field text (not necessarily NUL-terminated)
  * @param min_val   Minimum allowed value
  * @param max_val   Maximum allowed value
  * @param mask_64   Output 64-bit mask (for minutes)
  * @param mask_32   Output 32-bit mask (for hours, days)
  * @param mask_16   Output 16-bit mask (for months)
  * @param mask_8    Output 8-bit mask (for weekdays)
+ * @param hash      Per-field hash of the job key, for "H"
  * @return          JCRON_OK or error code
  */
-static int parse_cron_field(const char* field, int min_val, int max_val,
+static int parse_cron_field(const char* field, const char* limit, int min_val, int max_val,
                             uint64_t* mask_64, uint32_t* mask_32, 
-                            uint16_t* mask_16, uint8_t* mask_8) {
+                            uint16_t* mask_16, uint8_t* mask_8, uint64_t hash) {
     if (!field) return JCRON_ERR_INVALID_PATTERN;
     
-    const char* p = skip_whitespace(field);
+    const char* p = skip_whitespace(field, limit);
     
     // Handle wildcard "*"
-    if (*p == '*') {
+    if (p < limit && *p == '*') {
         p++;
         
         // Check for step "*/N"
-        if (*p == '/') {
+        if (p < limit && *p == '/') {
             p++;
             int step = 0;
-            if (parse_int(&p, &step) != 0 || step <= 0) {
+            if (parse_int(&p, limit, &step) != 0 || step <= 0) {
                 return JCRON_ERR_INVALID_PATTERN;
             }
             
@@ -143,40 +160,79 @@ static int parse_cron_field(const char* field, int min_val, int max_val,
     }
     
     // Parse list/range
-    while (*p) {
-        p = skip_whitespace(p);
+    while (p < limit) {
+        p = skip_whitespace(p, limit);
         
-        // Parse start value
         int start = 0;
-        if (parse_int(&p, &start) != 0) {
-            return JCRON_ERR_INVALID_PATTERN;
-        }
-        
-        if (start < min_val || start > max_val) {
-            return JCRON_ERR_INVALID_PATTERN;
-        }
-        
-        int end = start;  // Default: single value
+        int end = 0;
         int step = 1;
         
-        // Check for range "N-M"
-        if (*p == '-') {
+        // Hashed value "H", optionally within "(N-M)" and with a step "/S"
+        if (p < limit && *p == 'H') {
             p++;
-            if (parse_int(&p, &end) != 0) {
-                return JCRON_ERR_INVALID_PATTERN;
+            int lo = min_val;
+            int hi = max_val;
+            if (min_val == 1 && max_val == 31) {
+                hi = 28;  // Day of month: a day every month has
+            }
+            if (p < limit && *p == '(') {
+                p++;
+                if (parse_int(&p, limit, &lo) != 0 || (p == limit || *p++ != '-') ||
+                    parse_int(&p, limit, &hi) != 0 || (p == limit || *p++ != ')')) {
+                    return JCRON_ERR_INVALID_PATTERN;
+                }
+                if (lo < min_val || hi > max_val || hi < lo) {
+                    return JCRON_ERR_INVALID_PATTERN;
+                }
+            }
+            
+            if (p < limit && *p == '/') {
+                p++;
+                if (parse_int(&p, limit, &step) != 0 || step <= 0) {
+                    return JCRON_ERR_INVALID_PATTERN;
+                }
+                // Same step, phase picked from the first step of the range
+                int span = hi - lo + 1 < step ? hi - lo + 1 : step;
+                start = lo + (int)(hash % (uint64_t)span);
+                end = hi;
+            } else {
+                start = lo + (int)(hash % (uint64_t)(hi - lo + 1));
+                end = start;
             }
             
-            if (end < min_val || end > max_val || end < start) {
+            // Several H in one list pick different values
+            hash = hash_mix(hash);
+        } else {
+            // Parse start value
+            if (parse_int(&p, limit, &start) != 0) {
                 return JCRON_ERR_INVALID_PATTERN;
             }
-        }
         
-        // Check for step "N-M/S" or "N/S"
-        if (*p == '/') {
-            p++;
-            if (parse_int(&p, &step) != 0 || step <= 0) {
+            if (start < min_val || start > max_val) {
                 return JCRON_ERR_INVALID_PATTERN;
             }
+        
+            end = start;  // Default: single value
+        
+            // Check for range "N-M"
+            if (p < limit && *p == '-') {
+                p++;
+                if (parse_int(&p, limit, &end) != 0) {
+                    return JCRON_ERR_INVALID_PATTERN;
+                }
+            
+                if (end < min_val || end > max_val || end < start) {
+                    return JCRON_ERR_INVALID_PATTERN;
+                }
+            }
+        
+            // Check for step "N-M/S" or "N/S"
+            if (p < limit && *p == '/') {
+                p++;
+                if (parse_int(&p, limit, &step) != 0 || step <= 0) {
+                    return JCRON_ERR_INVALID_PATTERN;
+                }
+            }
         }
         
         // Set bits in range with step
@@ -188,10 +244,10 @@ static int parse_cron_field(const char* field, int min_val, int max_val,
         }
         
         // Check for comma (list continuation)
-        p = skip_whitespace(p);
-        if (*p == ',') {
+        p = skip_whitespace(p, limit);
+        if (p < limit && *p == ',') {
             p++;
-        } else if (*p != '\0') {
+        } else if (p < limit) {
             // Unexpected character
             return JCRON_ERR_INVALID_PATTERN;
         }
@@ -200,10 +256,75 @@ static int parse_cron_field(const char* field, int min_val, int max_val,
     return JCRON_OK;
 }
 
+/**
+ * Parse the five schedule fields (minute hour day month weekday)
+ * 
+ * "H" hashes the key with the field's position in the 6-field layout, so
+ * a job resolves to the same times whichever layout it was written in.
+ */
+static int parse_schedule_fields(const jcron_span_t* fields, uint64_t key,
+                                 jcron_pattern_t* out) {
+    int result;
+    uint64_t key_hash = hash_mix(key);
+    
+    // Minutes: 0-59
+    result = parse_cron_field(fields[0].start, fields[0].start + fields[0].len,
+                              0, 59, &out->minutes, NULL, NULL, NULL,
+                              hash_mix(key_hash + 1));
+    if (result != JCRON_OK) return result;
+    
+    // Hours: 0-23
+    result = parse_cron_field(fields[1].start, fields[1].start + fields[1].len,
+                              0, 23, NULL, &out->hours, NULL, NULL,
+                              hash_mix(key_hash + 2));
+    if (result != JCRON_OK) return result;
+    
+    // Day of month: 1-31
+    result = parse_cron_field(fields[2].start, fields[2].start + fields[2].len,
+                              1, 31, NULL, &out->days_of_month, NULL, NULL,
+                              hash_mix(key_hash + 3));
+    if (result != JCRON_OK) return result;
+    
+    // Month: 1-12
+    result = parse_cron_field(fields[3].start, fields[3].start + fields[3].len,
+                              1, 12, NULL, NULL, &out->months, NULL,
+                              hash_mix(key_hash + 4));
+    if (result != JCRON_OK) return result;
+    
+    // Day of week: 0-6 (Sunday=0) or 1-53 for WOY
+    if (out->woy_modifier) {
+        result = parse_cron_field(fields[4].start, fields[4].start + fields[4].len,
+                                  1, 53, NULL, NULL, NULL, NULL,
+                                  hash_mix(key_hash + 5));
+        if (result != JCRON_OK) return result;
+        // For now, store in days_of_week (simplified)
+        out->days_of_week = 0x7F;  // All days
+        // TODO: Implement proper WOY logic
+    } else {
+        result = parse_cron_field(fields[4].start, fields[4].start + fields[4].len,
+                                  0, 6, NULL, NULL, NULL, &out->days_of_week,
+                                  hash_mix(key_hash + 5));
+        if (result != JCRON_OK) return result;
+    }
+    
+    return JCRON_OK;
+}
+
 /* ========================================================================
  * Main Parsing Function
  * ======================================================================== */
 
+/**
+ * Empty pattern: no fields, no modifiers
+ */
+static void pattern_init(jcron_pattern_t* out) {
+    memset(out, 0, sizeof(jcron_pattern_t));
+    out->eod_type = -1;
+    out->sod_type = -1;
+    out->eod_modifier = -1;
+    out->sod_modifier = -1;
+}
+
 /**
  * Parse full cron pattern
  * 
@@ -217,27 +338,32 @@ static int parse_cron_field(const char* field, int min_val, int max_val,
  * - "EOD:E0M" - End of this month
  */
 int jcron_parse(const char* pattern, jcron_pattern_t* out) {
+    return jcron_parse_keyed(pattern, 0, out);
+}
+
+/**
+ * Parse full cron pattern, resolving "H" fields from a job key
+ * 
+ * Each field hashes the key with its own index, so "H H * * * *" does
+ * not put every job on the diagonal minute == hour.
+ */
+int jcron_parse_keyed(const char* pattern, uint64_t key, jcron_pattern_t* out) {
     if (!pattern || !out) {
         return JCRON_ERR_NULL_POINTER;
     }
     
-    // Initialize structure
-    memset(out, 0, sizeof(jcron_pattern_t));
-    out->eod_type = -1;
-    out->sod_type = -1;
-    out->eod_modifier = -1;
-    out->sod_modifier = -1;
+    pattern_init(out);
     
     // Check for EOD-only pattern
     if (strncmp(pattern, "EOD:", 4) == 0) {
         out->is_eod_pattern = 1;
-        return jcron_parse_eod(pattern, &out->eod_type, &out->eod_modifier, &out->eod_unit);
+        return jcron_parse_eod(pattern + 4, &out->eod_type, &out->eod_modifier, &out->eod_unit);
     }
     
     // Check for SOD-only pattern
     if (strncmp(pattern, "SOD:", 4) == 0) {
         out->is_sod_pattern = 1;
-        return jcron_parse_sod(pattern, &out->sod_type, &out->sod_modifier, &out->sod_unit);
+        return jcron_parse_sod(pattern + 4, &out->sod_type, &out->sod_modifier, &out->sod_unit);
     }
     
     // Check for OR patterns separated by "|"
@@ -259,9 +385,9 @@ int jcron_parse(const char* pattern, jcron_pattern_t* out) {
         
         // Parse both patterns
         jcron_pattern_t pat1, pat2;
-        int ret1 = jcron_parse(pattern1, &pat1);
+        int ret1 = jcron_parse_keyed(pattern1, key, &pat1);
         if (ret1 != JCRON_OK) return ret1;
-        int ret2 = jcron_parse(pattern2, &pat2);
+        int ret2 = jcron_parse_keyed(pattern2, key, &pat2);
         if (ret2 != JCRON_OK) return ret2;
         
         // Combine with OR
@@ -307,40 +433,14 @@ int jcron_parse(const char* pattern, jcron_pattern_t* out) {
     
     out->has_cron = 1;
     
-    // Parse each field
-    int result;
-    
-    // Field 0: Seconds (0-59) - We don't have a seconds bitmask yet
-    // For now, we'll skip seconds and treat this as 5-field cron starting at minutes
-    // TODO: Add seconds support in Phase 2
-    
-    // Minutes (field 1): 0-59
-    result = parse_cron_field(fields[1], 0, 59, &out->minutes, NULL, NULL, NULL);
-    if (result != JCRON_OK) return result;
-    
-    // Hours (field 2: 0-23
-    result = parse_cron_field(fields[2], 0, 23, NULL, &out->hours, NULL, NULL);
-    if (result != JCRON_OK) return result;
-    
-    // Day of month (field 3): 1-31
-    result = parse_cron_field(fields[3], 1, 31, NULL, &out->days_of_month, NULL, NULL);
-    if (result != JCRON_OK) return result;
-    
-    // Month (field 4): 1-12
-    result = parse_cron_field(fields[4], 1, 12, NULL, NULL, &out->months, NULL);
-    if (result != JCRON_OK) return result;
-    
-    // Day of week (field 5): 0-6 (Sunday=0) or 1-53 for WOY
-    if (out->woy_modifier) {
-        result = parse_cron_field(fields[5], 1, 53, NULL, NULL, NULL, NULL);
-        if (result != JCRON_OK) return result;
-        // For now, store in days_of_week (simplified)
-        out->days_of_week = 0x7F;  // All days
-        // TODO: Implement proper WOY logic
-    } else {
-        result = parse_cron_field(fields[5], 0, 6, NULL, NULL, NULL, &out->days_of_week);
-        if (result != JCRON_OK) return result;
+    // Fields 1-5; field 0 (seconds) is not scheduled yet
+    jcron_span_t spans[5];
+    for (int i = 0; i < 5; i++) {
+        spans[i].start = fields[i + 1];
+        spans[i].len = strlen(fields[i + 1]);
     }
+    int result = parse_schedule_fields(spans, key, out);
+    if (result != JCRON_OK) return result;
     
     // Check for optional modifier (field 6)
     if (field_count >= 7) {
@@ -364,6 +464,51 @@ int jcron_parse(const char* pattern, jcron_pattern_t* out) {
     return JCRON_OK;
 }
 
+/**
+ * Parse pre-split cron fields
+ * 
+ * Layouts:
+ * - JCRON_FIELDS_5: "min hour day month weekday" (crontab)
+ * - JCRON_FIELDS_6: "sec min hour day month weekday"
+ * - JCRON_FIELDS_7: "sec min hour day month weekday year"
+ * 
+ * Seconds are checked but not scheduled (minute resolution, as with
+ * jcron_parse()). There is no year mask, so the year must be "*" or "?".
+ */
+int jcron_parse_fields(const jcron_span_t* fields, jcron_layout_t layout, uint64_t key,
+                       jcron_pattern_t* out) {
+    if (!fields || !out) {
+        return JCRON_ERR_NULL_POINTER;
+    }
+    if (layout != JCRON_FIELDS_5 && layout != JCRON_FIELDS_6 && layout != JCRON_FIELDS_7) {
+        return JCRON_ERR_INVALID_PATTERN;
+    }
+    for (int i = 0; i < (int)layout; i++) {
+        if (!fields[i].start || fields[i].len == 0) return JCRON_ERR_INVALID_PATTERN;
+    }
+    
+    pattern_init(out);
+    
+    const jcron_span_t* schedule = fields;
+    if (layout != JCRON_FIELDS_5) {
+        uint64_t seconds = 0;
+        int result = parse_cron_field(fields[0].start, fields[0].start + fields[0].len,
+                                      0, 59, &seconds, NULL, NULL, NULL, 0);
+        if (result != JCRON_OK) return result;
+        schedule = fields + 1;
+    }
+    
+    if (layout == JCRON_FIELDS_7) {
+        const jcron_span_t* year = &fields[6];
+        if (year->len != 1 || (year->start[0] != '*' && year->start[0] != '?')) {
+            return JCRON_ERR_INVALID_PATTERN;
+        }
+    }
+    
+    out->has_cron = 1;
+    return parse_schedule_fields(schedule, key, out);
+}
+
 /* ========================================================================
  * SOD/EOD Parsing Functions
  * ======================================================================== */
@@ -0,0 +1,589 @@
+/**
+ * JCRON C Port - Next-Fire Scheduler Implementation
+ *
+ * Heap backend: binary min-heap on (when, slot) with a slot -> position map.
+ * Wheel backend: four-tier hierarchical timing wheel (seconds, minutes,
+ * hours, days) with intrusive per-slot lists; the heap holds fires more than
+ * JCRON_WHEEL_DAYS days out.
+ */
+
+#include "jcron_sched.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Wheel node locations besides bucket ids (0 .. 4 * 64 - 1) */
+#define LOC_READY    (JCRON_WHEEL_TIERS * JCRON_WHEEL_DAYS)
+#define LOC_OVERFLOW (LOC_READY + 1)
+#define LOC_NONE     JCRON_SCHED_NONE
+
+#define SECS_PER_MIN  60
+#define SECS_PER_HOUR 3600
+#define SECS_PER_DAY  86400
+
+/* ========================================================================
+ * Heap Helpers
+ * ======================================================================== */
+
+static inline int entry_less(const jcron_sched_entry_t* a, const jcron_sched_entry_t* b) {
+    return a->when < b->when || (a->when == b->when && a->slot < b->slot);
+}
+
+static inline void heap_place(jcron_sched_t* sched, uint32_t i, jcron_sched_entry_t entry) {
+    sched->heap[i] = entry;
+    sched->pos[entry.slot] = i;
+}
+
+static void sift_up(jcron_sched_t* sched, uint32_t i) {
+    jcron_sched_entry_t entry = sched->heap[i];
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (!entry_less(&entry, &sched->heap[parent])) break;
+        heap_place(sched, i, sched->heap[parent]);
+        i = parent;
+    }
+    heap_place(sched, i, entry);
+}
+
+static void sift_down(jcron_sched_t* sched, uint32_t i) {
+    jcron_sched_entry_t entry = sched->heap[i];
+    for (;;) {
+        uint32_t child = 2 * i + 1;
+        if (child >= sched->heap_size) break;
+        if (child + 1 < sched->heap_size && entry_less(&sched->heap[child + 1], &sched->heap[child])) {
+            child++;
+        }
+        if (!entry_less(&sched->heap[child], &entry)) break;
+        heap_place(sched, i, sched->heap[child]);
+        i = child;
+    }
+    heap_place(sched, i, entry);
+}
+
+static int heap_reserve(jcron_sched_t* sched) {
+    if (sched->heap_size < sched->heap_capacity) return JCRON_OK;
+
+    uint64_t capacity = sched->heap_capacity ? (uint64_t)sched->heap_capacity * 2 : 64;
+    if (capacity > JCRON_SCHED_NONE) capacity = JCRON_SCHED_NONE;
+
+    jcron_sched_entry_t* heap = realloc(sched->heap, (size_t)capacity * sizeof(*heap));
+    if (!heap) return JCRON_ERR_NO_MEMORY;
+
+    sched->heap = heap;
+    sched->heap_capacity = (uint32_t)capacity;
+    return JCRON_OK;
+}
+
+static int heap_insert(jcron_sched_t* sched, uint32_t slot, int64_t when) {
+    int ret = heap_reserve(sched);
+    if (ret != JCRON_OK) return ret;
+
+    sched->heap[sched->heap_size] = (jcron_sched_entry_t){when, slot};
+    sift_up(sched, sched->heap_size++);
+    return JCRON_OK;
+}
+
+/**
+ * Remove the entry at heap position i
+ */
+static void heap_delete(jcron_sched_t* sched, uint32_t i) {
+    sched->pos[sched->heap[i].slot] = JCRON_SCHED_NONE;
+    sched->heap_size--;
+    if (i == sched->heap_size) return;
+
+    // Move the last entry into the hole and restore order in either direction
+    heap_place(sched, i, sched->heap[sched->heap_size]);
+    if (i > 0 && entry_less(&sched->heap[i], &sched->heap[(i - 1) / 2])) {
+        sift_up(sched, i);
+    } else {
+        sift_down(sched, i);
+    }
+}
+
+/**
+ * Make slot addressable by the position map (and wheel nodes)
+ */
+static int pos_reserve(jcron_sched_t* sched, uint32_t slot) {
+    if (slot < sched->pos_capacity) return JCRON_OK;
+    if (slot == JCRON_SCHED_NONE) return JCRON_ERR_OVERFLOW;
+
+    uint64_t capacity = sched->pos_capacity ? sched->pos_capacity : 64;
+    while (capacity <= slot) capacity *= 2;
+    if (capacity > JCRON_SCHED_NONE) capacity = JCRON_SCHED_NONE;
+
+    size_t added = (size_t)(capacity - sched->pos_capacity);
+
+    if (sched->wheel) {
+        jcron_wheel_node_t* nodes = realloc(sched->wheel->nodes,
+                                            (size_t)capacity * sizeof(jcron_wheel_node_t));
+        if (!nodes) return JCRON_ERR_NO_MEMORY;
+        for (size_t i = sched->pos_capacity; i < capacity; i++) {
+            nodes[i].loc = LOC_NONE;
+        }
+        sched->wheel->nodes = nodes;
+    }
+
+    uint32_t* pos = realloc(sched->pos, (size_t)capacity * sizeof(uint32_t));
+    if (!pos) return JCRON_ERR_NO_MEMORY;
+
+    memset(pos + sched->pos_capacity, 0xFF, added * sizeof(uint32_t));
+    sched->pos = pos;
+    sched->pos_capacity = (uint32_t)capacity;
+    return JCRON_OK;
+}
+
+/* ========================================================================
+ * Wheel Helpers
+ * ======================================================================== */
+
+static inline int64_t floor_div(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (a % b != 0 && a < 0) ? q - 1 : q;
+}
+
+static inline uint32_t floor_mod(int64_t a, int64_t b) {
+    return (uint32_t)(a - floor_div(a, b) * b);
+}
+
+static inline uint32_t* bucket_head(jcron_wheel_t* wheel, uint32_t bucket) {
+    return &wheel->buckets[bucket / JCRON_WHEEL_DAYS][bucket % JCRON_WHEEL_DAYS];
+}
+
+static void bucket_push(jcron_wheel_t* wheel, uint32_t tier, uint32_t index, uint32_t slot) {
+    jcron_wheel_node_t* node = &wheel->nodes[slot];
+    uint32_t* head = &wheel->buckets[tier][index];
+
+    node->loc = tier * JCRON_WHEEL_DAYS + index;
+    node->prev = LOC_NONE;
+    node->next = *head;
+    if (*head != LOC_NONE) wheel->nodes[*head].prev = slot;
+    *head = slot;
+    wheel->occupied[tier] |= 1ULL << index;
+}
+
+static void ready_append(jcron_wheel_t* wheel, uint32_t slot) {
+    jcron_wheel_node_t* node = &wheel->nodes[slot];
+
+    node->loc = LOC_READY;
+    node->next = LOC_NONE;
+    node->prev = wheel->ready_tail;
+    if (wheel->ready_tail != LOC_NONE) {
+        wheel->nodes[wheel->ready_tail].next = slot;
+    } else {
+        wheel->ready_head = slot;
+    }
+    wheel->ready_tail = slot;
+}
+
+/**
+ * Take a slot out of whatever list or heap holds it
+ */
+static void wheel_unlink(jcron_sched_t* sched, uint32_t slot) {
+    jcron_wheel_t* wheel = sched->wheel;
+    jcron_wheel_node_t* node = &wheel->nodes[slot];
+
+    if (node->loc == LOC_OVERFLOW) {
+        heap_delete(sched, sched->pos[slot]);
+    } else if (node->loc == LOC_READY) {
+        if (node->prev != LOC_NONE) wheel->nodes[node->prev].next = node->next;
+        else wheel->ready_head = node->next;
+        if (node->next != LOC_NONE) wheel->nodes[node->next].prev = node->prev;
+        else wheel->ready_tail = node->prev;
+    } else {
+        uint32_t* head = bucket_head(wheel, node->loc);
+        if (node->prev != LOC_NONE) wheel->nodes[node->prev].next = node->next;
+        else *head = node->next;
+        if (node->next != LOC_NONE) wheel->nodes[node->next].prev = node->prev;
+        if (*head == LOC_NONE) {
+            wheel->occupied[node->loc / JCRON_WHEEL_DAYS] &= ~(1ULL << (node->loc % JCRON_WHEEL_DAYS));
+        }
+    }
+    node->loc = LOC_NONE;
+}
+
+/**
+ * Put a slot in the finest tier whose unit around `ref` contains its fire
+ *
+ * `ref` is the first second of a unit being entered while its bucket
+ * cascades (or the wheel clock, for fires after it). Fires at or before
+ * `ref` go straight to the ready list, so minute-aligned cron fires skip
+ * the seconds tier entirely.
+ */
+static int wheel_place(jcron_sched_t* sched, uint32_t slot, int64_t ref) {
+    jcron_wheel_t* wheel = sched->wheel;
+    int64_t when = wheel->nodes[slot].when;
+
+    if (when <= ref) {
+        ready_append(wheel, slot);
+    } else if (floor_div(when, SECS_PER_MIN) == floor_div(ref, SECS_PER_MIN)) {
+        bucket_push(wheel, 0, floor_mod(when, SECS_PER_MIN), slot);
+    } else if (floor_div(when, SECS_PER_HOUR) == floor_div(ref, SECS_PER_HOUR)) {
+        bucket_push(wheel, 1, floor_mod(floor_div(when, SECS_PER_MIN), 60), slot);
+    } else if (floor_div(when, SECS_PER_DAY) == floor_div(ref, SECS_PER_DAY)) {
+        bucket_push(wheel, 2, floor_mod(floor_div(when, SECS_PER_HOUR), 24), slot);
+    } else if (floor_div(when, SECS_PER_DAY) - floor_div(ref, SECS_PER_DAY) < JCRON_WHEEL_DAYS) {
+        bucket_push(wheel, 3, floor_mod(floor_div(when, SECS_PER_DAY), JCRON_WHEEL_DAYS), slot);
+    } else {
+        int ret = heap_insert(sched, slot, when);
+        if (ret != JCRON_OK) return ret;
+        wheel->nodes[slot].loc = LOC_OVERFLOW;
+    }
+    return JCRON_OK;
+}
+
+/**
+ * Re-place a whole bucket as the clock enters its unit at `start`
+ */
+static void wheel_cascade(jcron_sched_t* sched, uint32_t tier, uint32_t index, int64_t start) {
+    jcron_wheel_t* wheel = sched->wheel;
+    uint32_t slot = wheel->buckets[tier][index];
+
+    wheel->buckets[tier][index] = LOC_NONE;
+    wheel->occupied[tier] &= ~(1ULL << index);
+
+    while (slot != LOC_NONE) {
+        uint32_t next = wheel->nodes[slot].next;
+        wheel_place(sched, slot, start);  // Lands in a finer tier: never allocates
+        slot = next;
+    }
+}
+
+/**
+ * Move second-tier buckets lo..hi of the current minute to the ready list
+ */
+static void wheel_expire(jcron_wheel_t* wheel, uint32_t lo, uint32_t hi) {
+    uint64_t range = (hi >= 63 ? ~0ULL : (1ULL << (hi + 1)) - 1) & ~((1ULL << lo) - 1);
+    uint64_t due = wheel->occupied[0] & range;
+
+    wheel->occupied[0] &= ~due;
+    while (due) {
+        uint32_t index = (uint32_t)__builtin_ctzll(due);
+        uint32_t slot = wheel->buckets[0][index];
+        wheel->buckets[0][index] = LOC_NONE;
+        while (slot != LOC_NONE) {
+            uint32_t next = wheel->nodes[slot].next;
+            ready_append(wheel, slot);
+            slot = next;
+        }
+        due &= due - 1;
+    }
+}
+
+/**
+ * First day after base_day with a non-empty day-tier bucket, or INT64_MAX
+ */
+static int64_t wheel_next_bucket_day(const jcron_wheel_t* wheel, int64_t base_day) {
+    uint64_t bits = wheel->occupied[3];
+    if (!bits) return INT64_MAX;
+
+    uint32_t shift = floor_mod(base_day + 1, JCRON_WHEEL_DAYS);
+    uint64_t rotated = shift ? (bits >> shift) | (bits << (64 - shift)) : bits;
+    return base_day + 1 + __builtin_ctzll(rotated);
+}
+
+/**
+ * First day after base_day that needs a day boundary processed: a day-tier
+ * bucket or overflow fires entering the window. INT64_MAX when none
+ */
+static int64_t wheel_next_day(const jcron_sched_t* sched, int64_t base_day) {
+    int64_t day = wheel_next_bucket_day(sched->wheel, base_day);
+
+    if (sched->heap_size) {
+        // Overflow fires enter the day tier JCRON_WHEEL_DAYS - 1 days ahead
+        int64_t enter = floor_div(sched->heap[0].when, SECS_PER_DAY) - (JCRON_WHEEL_DAYS - 1);
+        if (enter <= base_day) enter = base_day + 1;
+        if (enter < day) day = enter;
+    }
+    return day;
+}
+
+/**
+ * Advance the wheel clock to t, collecting fires at or before t as ready
+ *
+ * Empty minutes, hours and days are skipped using the occupancy bitmaps,
+ * so an idle stretch costs O(tiers), not O(seconds).
+ */
+static void wheel_advance(jcron_sched_t* sched, int64_t t) {
+    jcron_wheel_t* wheel = sched->wheel;
+
+    while (wheel->cur < t) {
+        int64_t cur = wheel->cur;
+        uint32_t sec = floor_mod(cur, SECS_PER_MIN);
+
+        if (sec != SECS_PER_MIN - 1) {
+            // Finish (part of) the current minute
+            int64_t limit = t < cur + (59 - sec) ? t : cur + (59 - sec);
+            if (wheel->occupied[0]) {
+                wheel_expire(wheel, sec + 1, sec + (uint32_t)(limit - cur));
+            }
+            wheel->cur = limit;
+            continue;
+        }
+
+        // Entering a new minute: batch-cascade the coarsest boundary crossed
+        int64_t next = cur + 1;
+        if (floor_mod(next, SECS_PER_DAY) == 0) {
+            int64_t day = floor_div(next, SECS_PER_DAY);
+            wheel_cascade(sched, 3, floor_mod(day, JCRON_WHEEL_DAYS), next);
+            while (sched->heap_size &&
+                   floor_div(sched->heap[0].when, SECS_PER_DAY) < day + JCRON_WHEEL_DAYS) {
+                uint32_t slot = sched->heap[0].slot;
+                heap_delete(sched, 0);
+                wheel_place(sched, slot, next);
+            }
+        } else if (floor_mod(next, SECS_PER_HOUR) == 0) {
+            wheel_cascade(sched, 2, floor_mod(floor_div(next, SECS_PER_HOUR), 24), next);
+        } else {
+            wheel_cascade(sched, 1, floor_mod(floor_div(next, SECS_PER_MIN), 60), next);
+        }
+
+        int64_t minute_end = next + SECS_PER_MIN - 1;
+        if (wheel->occupied[0]) {
+            int64_t limit = t < minute_end ? t : minute_end;
+            wheel_expire(wheel, 0, (uint32_t)(limit - next));
+            wheel->cur = limit;
+            continue;
+        }
+
+        // Nothing this minute: jump to just before the next non-empty unit
+        int64_t target;
+        if (wheel->occupied[1]) {
+            target = next - floor_mod(next, SECS_PER_HOUR) +
+                     (int64_t)__builtin_ctzll(wheel->occupied[1]) * SECS_PER_MIN;
+        } else if (wheel->occupied[2]) {
+            target = next - floor_mod(next, SECS_PER_DAY) +
+                     (int64_t)__builtin_ctzll(wheel->occupied[2]) * SECS_PER_HOUR;
+        } else {
+            int64_t day = wheel_next_day(sched, floor_div(next, SECS_PER_DAY));
+            target = day == INT64_MAX ? INT64_MAX : day * SECS_PER_DAY;
+        }
+
+        int64_t jump = target == INT64_MAX ? t : target - 1;
+        if (jump < minute_end) jump = minute_end;
+        wheel->cur = t < jump ? t : jump;
+    }
+}
+
+static int wheel_peek(const jcron_sched_t* sched, int64_t* when) {
+    const jcron_wheel_t* wheel = sched->wheel;
+    uint32_t slot = LOC_NONE;
+
+    if (wheel->ready_head != LOC_NONE) {
+        slot = wheel->ready_head;
+    } else {
+        for (uint32_t tier = 0; tier < 3 && slot == LOC_NONE; tier++) {
+            if (wheel->occupied[tier]) {
+                slot = wheel->buckets[tier][__builtin_ctzll(wheel->occupied[tier])];
+            }
+        }
+        if (slot == LOC_NONE && wheel->occupied[3]) {
+            // Day-tier fires always precede overflow fires
+            int64_t day = wheel_next_bucket_day(wheel, floor_div(wheel->cur, SECS_PER_DAY));
+            slot = wheel->buckets[3][floor_mod(day, JCRON_WHEEL_DAYS)];
+        }
+        if (slot == LOC_NONE) {
+            if (!sched->heap_size) return -1;
+            if (when) *when = sched->heap[0].when;
+            return (int)sched->heap[0].slot;
+        }
+    }
+
+    // Earliest (when, slot) of the chosen list
+    uint32_t best = slot;
+    for (; slot != LOC_NONE; slot = wheel->nodes[slot].next) {
+        const jcron_wheel_node_t* node = &wheel->nodes[slot];
+        const jcron_wheel_node_t* top = &wheel->nodes[best];
+        if (node->when < top->when || (node->when == top->when && slot < best)) best = slot;
+    }
+    if (when) *when = wheel->nodes[best].when;
+    return (int)best;
+}
+
+static int wheel_next_wakeup(const jcron_sched_t* sched, int64_t* when) {
+    const jcron_wheel_t* wheel = sched->wheel;
+    int64_t cur = wheel->cur;
+
+    if (wheel->ready_head != LOC_NONE) {
+        // Callers drain ready fires before sleeping, so this list is short
+        *when = cur;
+        for (uint32_t slot = wheel->ready_head; slot != LOC_NONE; slot = wheel->nodes[slot].next) {
+            if (wheel->nodes[slot].when < *when) *when = wheel->nodes[slot].when;
+        }
+    } else if (wheel->occupied[0]) {
+        *when = cur - floor_mod(cur, SECS_PER_MIN) + __builtin_ctzll(wheel->occupied[0]);
+    } else if (wheel->occupied[1]) {
+        *when = cur - floor_mod(cur, SECS_PER_HOUR) +
+                (int64_t)__builtin_ctzll(wheel->occupied[1]) * SECS_PER_MIN;
+    } else if (wheel->occupied[2]) {
+        *when = cur - floor_mod(cur, SECS_PER_DAY) +
+                (int64_t)__builtin_ctzll(wheel->occupied[2]) * SECS_PER_HOUR;
+    } else if (wheel->occupied[3] || sched->heap_size) {
+        *when = wheel_next_day(sched, floor_div(cur, SECS_PER_DAY)) * SECS_PER_DAY;
+    } else {
+        return JCRON_ERR_NO_MATCH;
+    }
+    return JCRON_OK;
+}
+
+/* ========================================================================
+ * Public API
+ * ======================================================================== */
+
+int jcron_sched_init(jcron_sched_t* sched, uint32_t capacity) {
+    if (!sched) return JCRON_ERR_NULL_POINTER;
+
+    memset(sched, 0, sizeof(*sched));
+    sched->backend = JCRON_SCHED_HEAP;
+    if (capacity == 0) return JCRON_OK;
+
+    sched->heap = malloc((size_t)capacity * sizeof(jcron_sched_entry_t));
+    if (!sched->heap) return JCRON_ERR_NO_MEMORY;
+    sched->heap_capacity = capacity;
+    return pos_reserve(sched, capacity - 1);
+}
+
+int jcron_sched_init_wheel(jcron_sched_t* sched, uint32_t capacity, int64_t start) {
+    if (!sched) return JCRON_ERR_NULL_POINTER;
+
+    // The wheel's overflow heap stays small; size only the per-slot arrays
+    memset(sched, 0, sizeof(*sched));
+    sched->backend = JCRON_SCHED_WHEEL;
+    sched->wheel = malloc(sizeof(jcron_wheel_t));
+    if (!sched->wheel) return JCRON_ERR_NO_MEMORY;
+
+    memset(sched->wheel, 0, sizeof(jcron_wheel_t));
+    memset(sched->wheel->buckets, 0xFF, sizeof(sched->wheel->buckets));
+    sched->wheel->cur = start;
+    sched->wheel->ready_head = LOC_NONE;
+    sched->wheel->ready_tail = LOC_NONE;
+
+    return capacity ? pos_reserve(sched, capacity - 1) : JCRON_OK;
+}
+
+void jcron_sched_free(jcron_sched_t* sched) {
+    if (!sched) return;
+
+    if (sched->wheel) {
+        free(sched->wheel->nodes);
+        free(sched->wheel);
+    }
+    free(sched->heap);
+    free(sched->pos);
+    memset(sched, 0, sizeof(*sched));
+}
+
+int jcron_sched_set(jcron_sched_t* sched, uint32_t slot, int64_t when) {
+    if (!sched) return JCRON_ERR_NULL_POINTER;
+
+    int ret = pos_reserve(sched, slot);
+    if (ret != JCRON_OK) return ret;
+
+    if (sched->backend == JCRON_SCHED_WHEEL) {
+        jcron_wheel_node_t* node = &sched->wheel->nodes[slot];
+        if (node->loc != LOC_NONE) {
+            wheel_unlink(sched, slot);
+            sched->count--;
+        }
+        node->when = when;
+        if (when <= sched->wheel->cur) {
+            ready_append(sched->wheel, slot);
+        } else {
+            ret = wheel_place(sched, slot, sched->wheel->cur);
+        }
+        if (ret == JCRON_OK) sched->count++;
+        return ret;
+    }
+
+    jcron_sched_entry_t entry = {when, slot};
+    uint32_t i = sched->pos[slot];
+
+    if (i != JCRON_SCHED_NONE) {
+        // Reschedule in place
+        int earlier = entry_less(&entry, &sched->heap[i]);
+        sched->heap[i] = entry;
+        if (earlier) {
+            sift_up(sched, i);
+        } else {
+            sift_down(sched, i);
+        }
+        return JCRON_OK;
+    }
+
+    ret = heap_insert(sched, slot, when);
+    if (ret == JCRON_OK) sched->count++;
+    return ret;
+}
+
+int jcron_sched_set_next(jcron_sched_t* sched, uint32_t slot,
+                         const jcron_pattern_t* pattern, int64_t from) {
+    if (!sched || !pattern) return JCRON_ERR_NULL_POINTER;
+
+    jcron_result_t next;
+    int ret = jcron_next(from, pattern, &next);
+    if (ret != JCRON_OK) {
+        jcron_sched_remove(sched, slot);
+        return ret;
+    }
+    return jcron_sched_set(sched, slot, next.next_time);
+}
+
+int jcron_sched_remove(jcron_sched_t* sched, uint32_t slot) {
+    if (!sched) return JCRON_ERR_NULL_POINTER;
+    if (slot >= sched->pos_capacity) return JCRON_OK;
+
+    if (sched->backend == JCRON_SCHED_WHEEL) {
+        if (sched->wheel->nodes[slot].loc == LOC_NONE) return JCRON_OK;
+        wheel_unlink(sched, slot);
+    } else {
+        if (sched->pos[slot] == JCRON_SCHED_NONE) return JCRON_OK;
+        heap_delete(sched, sched->pos[slot]);
+    }
+    sched->count--;
+    return JCRON_OK;
+}
+
+int jcron_sched_peek(const jcron_sched_t* sched, int64_t* when) {
+    if (!sched || sched->count == 0) return -1;
+    if (sched->backend == JCRON_SCHED_WHEEL) return wheel_peek(sched, when);
+
+    if (when) *when = sched->heap[0].when;
+    return (int)sched->heap[0].slot;
+}
+
+int jcron_sched_next_wakeup(const jcron_sched_t* sched, int64_t* when) {
+    if (!sched || !when) return JCRON_ERR_NULL_POINTER;
+    if (sched->count == 0) return JCRON_ERR_NO_MATCH;
+    if (sched->backend == JCRON_SCHED_WHEEL) return wheel_next_wakeup(sched, when);
+
+    *when = sched->heap[0].when;
+    return JCRON_OK;
+}
+
+int jcron_sched_pop(jcron_sched_t* sched, int64_t now, int64_t* when) {
+    if (!sched || sched->count == 0) return -1;
+
+    if (sched->backend == JCRON_SCHED_WHEEL) {
+        jcron_wheel_t* wheel = sched->wheel;
+        if (now > wheel->cur) wheel_advance(sched, now);
+
+        // Ready fires are all due unless the caller's clock went backwards
+        uint32_t slot = wheel->ready_head;
+        while (slot != LOC_NONE && wheel->nodes[slot].when > now) {
+            slot = wheel->nodes[slot].next;
+        }
+        if (slot == LOC_NONE) return -1;
+
+        if (when) *when = wheel->nodes[slot].when;
+        wheel_unlink(sched, slot);
+        sched->count--;
+        return (int)slot;
+    }
+
+    if (sched->heap[0].when > now) return -1;
+
+    jcron_sched_entry_t top = sched->heap[0];
+    heap_delete(sched, 0);
+    sched->count--;
+
+    if (when) *when = top.when;
+    return (int)top.slot;
+}
@@ -7,9 +7,61 @@
 #include "jcron_simd.h"
 #include <string.h>
 
+/**
+ * Copy up to JCRON_SIMD_MAX_FIELDS fields into register-sized buffers
+ *
+ * Unused lanes get an all-ones mask and value 0 so they always match.
+ */
+static inline void pad_fields64(const uint64_t* masks, const uint64_t* values, int num_fields,
+                                uint64_t* padded_masks, uint64_t* padded_values) {
+    for (int i = 0; i < JCRON_SIMD_MAX_FIELDS; i++) {
+        padded_masks[i] = i < num_fields ? masks[i] : ~0ULL;
+        padded_values[i] = i < num_fields ? values[i] : 0;
+    }
+}
+
+/**
+ * Scalar 64-bit field matcher (reference semantics for the SIMD kernels)
+ */
+static inline int bitmask_match64_scalar(const uint64_t* masks, const uint64_t* values, int num_fields) {
+    for (int i = 0; i < num_fields; i++) {
+        if (values[i] >= 64 || ((masks[i] >> values[i]) & 1) == 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
 // AVX2 implementations
 #if defined(JCRON_HAS_AVX2)
 
+/**
+ * AVX2 64-bit-lane bitmask matching
+ *
+ * Two 256-bit registers hold up to 8 fields; 1 << value is built per lane
+ * with _mm256_sllv_epi64 (counts >= 64 yield 0, i.e. no match).
+ */
+int jcron_simd_bitmask_match64_avx2(const uint64_t* masks, const uint64_t* values, int num_fields) {
+    if (num_fields > JCRON_SIMD_MAX_FIELDS) {
+        return bitmask_match64_scalar(masks, values, num_fields);
+    }
+
+    uint64_t m[JCRON_SIMD_MAX_FIELDS], v[JCRON_SIMD_MAX_FIELDS];
+    pad_fields64(masks, values, num_fields, m, v);
+
+    const __m256i ones = _mm256_set1_epi64x(1);
+    const __m256i zero = _mm256_setzero_si256();
+
+    __m256i hit_lo = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)m),
+                                      _mm256_sllv_epi64(ones, _mm256_loadu_si256((const __m256i*)v)));
+    __m256i hit_hi = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(m + 4)),
+                                      _mm256_sllv_epi64(ones, _mm256_loadu_si256((const __m256i*)(v + 4))));
+
+    // A lane that ANDs to zero is a field that failed
+    __m256i miss = _mm256_or_si256(_mm256_cmpeq_epi64(hit_lo, zero), _mm256_cmpeq_epi64(hit_hi, zero));
+    return _mm256_testz_si256(miss, miss);
+}
+
 /**
  * AVX2-accelerated bitmask matching for cron patterns
  * Uses SIMD to check multiple fields in parallel with real AVX2 operations
@@ -63,11 +115,199 @@ int jcron_simd_bitmask_match_avx2(const uint32_t* pattern_masks, const uint32_t*
     return 1;
 }
 
+/**
+ * Exact floor division of integral doubles by a positive constant
+ *
+ * Estimates with the reciprocal and corrects by one step in either direction,
+ * so q = floor(a / b) and *rem = a - q * b hold exactly for |a| < 2^51.
+ */
+static inline __m256d floordiv_pd(__m256d a, double b, __m256d* rem) {
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d vb = _mm256_set1_pd(b);
+    __m256d q = _mm256_floor_pd(_mm256_mul_pd(a, _mm256_set1_pd(1.0 / b)));
+    __m256d r = _mm256_sub_pd(a, _mm256_mul_pd(q, vb));
+
+    q = _mm256_add_pd(q, _mm256_and_pd(_mm256_cmp_pd(r, vb, _CMP_GE_OQ), one));
+    q = _mm256_sub_pd(q, _mm256_and_pd(_mm256_cmp_pd(r, _mm256_setzero_pd(), _CMP_LT_OQ), one));
+
+    if (rem) *rem = _mm256_sub_pd(a, _mm256_mul_pd(q, vb));
+    return q;
+}
+
+/**
+ * Same as floordiv_pd() on 8 float lanes; exact for 0 <= a < 2^20, which
+ * covers everything below the day number (time of day, day of era, ...)
+ */
+static inline __m256 floordiv_ps(__m256 a, float b, __m256* rem) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 vb = _mm256_set1_ps(b);
+    __m256 q = _mm256_floor_ps(_mm256_mul_ps(a, _mm256_set1_ps(1.0f / b)));
+    __m256 r = _mm256_sub_ps(a, _mm256_mul_ps(q, vb));
+
+    q = _mm256_add_ps(q, _mm256_and_ps(_mm256_cmp_ps(r, vb, _CMP_GE_OQ), one));
+    q = _mm256_sub_ps(q, _mm256_and_ps(_mm256_cmp_ps(r, _mm256_setzero_ps(), _CMP_LT_OQ), one));
+
+    if (rem) *rem = _mm256_sub_ps(a, _mm256_mul_ps(q, vb));
+    return q;
+}
+
+// int64 -> double via the 2^52 + 2^51 magic constant (exact for |x| < 2^51)
+static inline __m256d epi64_to_pd(__m256i v) {
+    const __m256i magic_i = _mm256_set1_epi64x(0x4338000000000000LL);
+    const __m256d magic_d = _mm256_set1_pd(6755399441055744.0);
+    return _mm256_sub_pd(_mm256_castsi256_pd(_mm256_add_epi64(v, magic_i)), magic_d);
+}
+
+// Two blocks of 4 doubles -> one block of 8 floats (values must be exact in float)
+static inline __m256 pack_pd_ps(__m256d lo, __m256d hi) {
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(lo)), _mm256_cvtpd_ps(hi), 1);
+}
+
+/**
+ * Match 8 timestamps (two blocks of 4 already converted to doubles)
+ *
+ * The civil decomposition (seconds -> days/time-of-day -> y/m/d and weekday)
+ * runs lane-parallel using Hinnant's days-to-civil algorithm. Only the steps
+ * that see the full day number (day split, era, weekday) need doubles; the
+ * rest is bounded by one era and runs on 8 float lanes. All lanes share one
+ * pattern, so the field masks are broadcast once and probed with variable
+ * shifts instead of gathers.
+ *
+ * @return 8-bit match mask (bit k = timestamp k matched)
+ */
+static inline int match_block_avx2(__m256d t_lo, __m256d t_hi, const __m256i* masks) {
+    __m256d sod_lo, sod_hi, doe_lo, doe_hi, dow_lo, dow_hi;
+
+    // Seconds -> day number and time of day
+    __m256d days_lo = floordiv_pd(t_lo, 86400.0, &sod_lo);
+    __m256d days_hi = floordiv_pd(t_hi, 86400.0, &sod_hi);
+
+    // Day number -> day of 400-year era; 1970-01-01 was a Thursday (4)
+    floordiv_pd(_mm256_add_pd(days_lo, _mm256_set1_pd(719468.0)), 146097.0, &doe_lo);
+    floordiv_pd(_mm256_add_pd(days_hi, _mm256_set1_pd(719468.0)), 146097.0, &doe_hi);
+    floordiv_pd(_mm256_add_pd(days_lo, _mm256_set1_pd(4.0)), 7.0, &dow_lo);
+    floordiv_pd(_mm256_add_pd(days_hi, _mm256_set1_pd(4.0)), 7.0, &dow_hi);
+
+    __m256 sod = pack_pd_ps(sod_lo, sod_hi);
+    __m256 doe = pack_pd_ps(doe_lo, doe_hi);
+    __m256 dow = pack_pd_ps(dow_lo, dow_hi);
+
+    __m256 hour = floordiv_ps(sod, 3600.0f, &sod);
+    __m256 minute = floordiv_ps(sod, 60.0f, NULL);
+
+    // Day of era -> year of era -> day of year (March-based)
+    __m256 yoe = _mm256_sub_ps(doe, floordiv_ps(doe, 1460.0f, NULL));
+    yoe = _mm256_add_ps(yoe, floordiv_ps(doe, 36524.0f, NULL));
+    yoe = _mm256_sub_ps(yoe, floordiv_ps(doe, 146096.0f, NULL));
+    yoe = floordiv_ps(yoe, 365.0f, NULL);
+
+    __m256 doy = _mm256_mul_ps(yoe, _mm256_set1_ps(365.0f));
+    doy = _mm256_add_ps(doy, floordiv_ps(yoe, 4.0f, NULL));
+    doy = _mm256_sub_ps(doy, floordiv_ps(yoe, 100.0f, NULL));
+    doy = _mm256_sub_ps(doe, doy);
+
+    __m256 mp = floordiv_ps(_mm256_add_ps(_mm256_mul_ps(doy, _mm256_set1_ps(5.0f)),
+                                          _mm256_set1_ps(2.0f)), 153.0f, NULL);
+    __m256 dom = floordiv_ps(_mm256_add_ps(_mm256_mul_ps(mp, _mm256_set1_ps(153.0f)),
+                                           _mm256_set1_ps(2.0f)), 5.0f, NULL);
+    dom = _mm256_add_ps(_mm256_sub_ps(doy, dom), _mm256_set1_ps(1.0f));
+
+    // March-based month index -> 1..12
+    __m256 wrap = _mm256_and_ps(_mm256_cmp_ps(mp, _mm256_set1_ps(10.0f), _CMP_GE_OQ),
+                                _mm256_set1_ps(12.0f));
+    __m256 month = _mm256_sub_ps(_mm256_add_ps(mp, _mm256_set1_ps(3.0f)), wrap);
+
+    // Field probes. Counts >= 32 shift everything out, so the 64-bit minute
+    // mask is probed as two 32-bit halves.
+    __m256i min_i = _mm256_cvttps_epi32(minute);
+    __m256i ok = _mm256_or_si256(
+        _mm256_srlv_epi32(masks[0], min_i),
+        _mm256_srlv_epi32(masks[1], _mm256_sub_epi32(min_i, _mm256_set1_epi32(32))));
+    ok = _mm256_and_si256(ok, _mm256_srlv_epi32(masks[2], _mm256_cvttps_epi32(hour)));
+    ok = _mm256_and_si256(ok, _mm256_srlv_epi32(masks[3], _mm256_cvttps_epi32(dom)));
+    ok = _mm256_and_si256(ok, _mm256_srlv_epi32(masks[4], _mm256_cvttps_epi32(month)));
+    ok = _mm256_and_si256(ok, _mm256_srlv_epi32(masks[5], _mm256_cvttps_epi32(dow)));
+
+    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_slli_epi32(ok, 31)));
+}
+
+/**
+ * AVX2 batch matcher: 8 timestamps per iteration
+ */
+size_t jcron_simd_match_ts_batch_avx2(const uint64_t* field_masks, const int64_t* timestamps,
+                                      size_t count, uint8_t* out) {
+    // Little-endian byte patterns for every 4-bit half of the match mask
+    static const uint32_t expand[16] = {
+        0x00000000, 0x00000001, 0x00000100, 0x00000101,
+        0x00010000, 0x00010001, 0x00010100, 0x00010101,
+        0x01000000, 0x01000001, 0x01000100, 0x01000101,
+        0x01010000, 0x01010001, 0x01010100, 0x01010101
+    };
+
+    const __m256i masks[6] = {
+        _mm256_set1_epi32((int)(uint32_t)field_masks[0]),          // minutes 0-31
+        _mm256_set1_epi32((int)(uint32_t)(field_masks[0] >> 32)),  // minutes 32-59
+        _mm256_set1_epi32((int)(uint32_t)field_masks[1]),
+        _mm256_set1_epi32((int)(uint32_t)field_masks[2]),
+        _mm256_set1_epi32((int)(uint32_t)field_masks[3]),
+        _mm256_set1_epi32((int)(uint32_t)field_masks[4])
+    };
+    const __m256i range_bias = _mm256_set1_epi64x(1LL << 51);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(timestamps + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(timestamps + i + 4));
+
+        // Bail out on blocks the magic conversion cannot represent exactly
+        __m256i hi = _mm256_or_si256(_mm256_add_epi64(a, range_bias), _mm256_add_epi64(b, range_bias));
+        hi = _mm256_srli_epi64(hi, 52);
+        if (!_mm256_testz_si256(hi, hi)) break;
+
+        int bits = match_block_avx2(epi64_to_pd(a), epi64_to_pd(b), masks);
+        memcpy(out + i, &expand[bits & 0xF], 4);
+        memcpy(out + i + 4, &expand[bits >> 4], 4);
+    }
+
+    return i;
+}
+
 #endif // JCRON_HAS_AVX2
 
 // ARM64 NEON implementations
 #if defined(JCRON_HAS_NEON)
 
+/**
+ * NEON 64-bit-lane bitmask matching
+ *
+ * Four 128-bit registers hold up to 8 fields. vshlq_u64 with a negative
+ * count shifts each mask right by its value, leaving the tested bit in bit 0;
+ * the per-lane results are ANDed. vshlq_u64 only reads the low byte of the
+ * count (256 shifts by 0), so values >= 64 are masked out beforehand.
+ */
+int jcron_simd_bitmask_match64_neon(const uint64_t* masks, const uint64_t* values, int num_fields) {
+    if (num_fields > JCRON_SIMD_MAX_FIELDS) {
+        return bitmask_match64_scalar(masks, values, num_fields);
+    }
+
+    uint64_t m[JCRON_SIMD_MAX_FIELDS], v[JCRON_SIMD_MAX_FIELDS];
+    pad_fields64(masks, values, num_fields, m, v);
+
+    const uint64x2_t one = vdupq_n_u64(1);
+    const uint64x2_t limit = vdupq_n_u64(64);
+    const int64x2_t zero = vdupq_n_s64(0);
+    uint64x2_t acc = one;
+
+    for (int i = 0; i < JCRON_SIMD_MAX_FIELDS; i += 2) {
+        uint64x2_t value = vld1q_u64(v + i);
+        int64x2_t shift = vsubq_s64(zero, vreinterpretq_s64_u64(value));
+        uint64x2_t bit = vandq_u64(vshlq_u64(vld1q_u64(m + i), shift), one);
+        acc = vandq_u64(acc, vandq_u64(bit, vcltq_u64(value, limit)));
+    }
+
+    return (int)(vgetq_lane_u64(acc, 0) & vgetq_lane_u64(acc, 1));
+}
+
 /**
  * NEON-accelerated bitmask matching for cron patterns
  * Uses SIMD to check multiple fields in parallel with real NEON operations
@@ -144,4 +384,30 @@ int jcron_simd_bitmask_match(const uint32_t* pattern_masks, const uint32_t* time
     }
     return 1;
 #endif
-}
\ No newline at end of file
+}
+
+/**
+ * 64-bit-lane dispatcher - chooses best available implementation
+ */
+int jcron_simd_bitmask_match64(const uint64_t* masks, const uint64_t* values, int num_fields) {
+#if defined(JCRON_HAS_AVX2)
+    return jcron_simd_bitmask_match64_avx2(masks, values, num_fields);
+#elif defined(JCRON_HAS_NEON)
+    return jcron_simd_bitmask_match64_neon(masks, values, num_fields);
+#else
+    return bitmask_match64_scalar(masks, values, num_fields);
+#endif
+}
+
+/**
+ * Batch timestamp matcher dispatcher
+ */
+size_t jcron_simd_match_ts_batch(const uint64_t* field_masks, const int64_t* timestamps,
+                                 size_t count, uint8_t* out) {
+#if defined(JCRON_HAS_AVX2)
+    return jcron_simd_match_ts_batch_avx2(field_masks, timestamps, count, out);
+#else
+    (void)field_masks; (void)timestamps; (void)count; (void)out;
+    return 0;
+#endif
+}
@@ -0,0 +1,481 @@
+/**
+ * JCRON C Port - Job Table Implementation
+ *
+ * One array per column, grown together; a stack of removed slots; and a
+ * string pool with a chained hash table over reference-counted entries.
+ */
+
+#define _POSIX_C_SOURCE 200809L  /* gmtime_r */
+
+#include "jcron_table.h"
+#include "jcron_simd.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Pool compaction: when released bytes exceed this and half the buffer */
+#define POOL_COMPACT_MIN 4096
+
+/* ========================================================================
+ * String Pool
+ * ======================================================================== */
+
+static uint32_t string_hash(const char* s, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)s[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int pool_init(jcron_table_pool_t* pool) {
+    memset(pool, 0, sizeof(*pool));
+    pool->capacity = 1024;
+    pool->entry_capacity = 64;
+    pool->bucket_mask = 63;
+    pool->bytes = malloc(pool->capacity);
+    pool->entries = calloc(pool->entry_capacity, sizeof(jcron_table_string_t));
+    pool->buckets = calloc(pool->bucket_mask + 1, sizeof(uint32_t));
+    if (!pool->bytes || !pool->entries || !pool->buckets) return JCRON_ERR_NO_MEMORY;
+    pool->entry_count = 1;  /* Id 0: no string */
+    return JCRON_OK;
+}
+
+static void pool_free(jcron_table_pool_t* pool) {
+    free(pool->bytes);
+    free(pool->entries);
+    free(pool->buckets);
+    memset(pool, 0, sizeof(*pool));
+}
+
+/**
+ * Double the bucket array and rechain every live entry
+ */
+static int pool_rehash(jcron_table_pool_t* pool) {
+    uint32_t mask = pool->bucket_mask * 2 + 1;
+    uint32_t* buckets = calloc((size_t)mask + 1, sizeof(uint32_t));
+    if (!buckets) return JCRON_ERR_NO_MEMORY;
+
+    for (uint32_t id = 1; id < pool->entry_count; id++) {
+        jcron_table_string_t* entry = &pool->entries[id];
+        if (!entry->refs) continue;
+        entry->next = buckets[entry->hash & mask];
+        buckets[entry->hash & mask] = id;
+    }
+    free(pool->buckets);
+    pool->buckets = buckets;
+    pool->bucket_mask = mask;
+    return JCRON_OK;
+}
+
+/**
+ * Copy live strings to a fresh buffer, dropping released bytes; ids keep
+ * their meaning. Skipped (not an error) when out of memory.
+ */
+static void pool_compact(jcron_table_pool_t* pool) {
+    uint32_t capacity = 1024;
+    while (capacity < pool->used - pool->dead) capacity *= 2;
+    char* bytes = malloc(capacity);
+    if (!bytes) return;
+
+    uint32_t used = 0;
+    for (uint32_t id = 1; id < pool->entry_count; id++) {
+        jcron_table_string_t* entry = &pool->entries[id];
+        if (!entry->refs) continue;
+        memcpy(bytes + used, pool->bytes + entry->offset, entry->len + 1);
+        entry->offset = used;
+        used += entry->len + 1;
+    }
+    free(pool->bytes);
+    pool->bytes = bytes;
+    pool->capacity = capacity;
+    pool->used = used;
+    pool->dead = 0;
+}
+
+/**
+ * Take a reference to the string, adding it if it is new
+ */
+static int pool_intern(jcron_table_pool_t* pool, const char* s, size_t len, uint32_t* id) {
+    if (len >= UINT32_MAX - pool->used) return JCRON_ERR_OVERFLOW;
+
+    uint32_t hash = string_hash(s, len);
+    for (uint32_t i = pool->buckets[hash & pool->bucket_mask]; i; i = pool->entries[i].next) {
+        jcron_table_string_t* entry = &pool->entries[i];
+        if (entry->hash == hash && entry->len == len &&
+            memcmp(pool->bytes + entry->offset, s, len) == 0) {
+            entry->refs++;
+            *id = i;
+            return JCRON_OK;
+        }
+    }
+
+    /* Room for the bytes and an entry */
+    uint64_t need = (uint64_t)pool->used + len + 1;
+    if (need > pool->capacity) {
+        uint64_t capacity = pool->capacity;
+        while (capacity < need) capacity *= 2;
+        if (capacity > UINT32_MAX) capacity = UINT32_MAX;
+        char* bytes = realloc(pool->bytes, (size_t)capacity);
+        if (!bytes) return JCRON_ERR_NO_MEMORY;
+        pool->bytes = bytes;
+        pool->capacity = (uint32_t)capacity;
+    }
+    if (!pool->free_entry && pool->entry_count == pool->entry_capacity) {
+        if (pool->entry_capacity > UINT32_MAX / 2) return JCRON_ERR_OVERFLOW;
+        uint32_t capacity = pool->entry_capacity * 2;
+        jcron_table_string_t* entries = realloc(pool->entries,
+                                                capacity * sizeof(jcron_table_string_t));
+        if (!entries) return JCRON_ERR_NO_MEMORY;
+        pool->entries = entries;
+        pool->entry_capacity = capacity;
+    }
+
+    uint32_t i = pool->free_entry;
+    if (i) {
+        pool->free_entry = pool->entries[i].next;
+    } else {
+        i = pool->entry_count++;
+    }
+    jcron_table_string_t* entry = &pool->entries[i];
+    entry->offset = pool->used;
+    entry->len = (uint32_t)len;
+    entry->hash = hash;
+    entry->refs = 1;
+    memcpy(pool->bytes + pool->used, s, len);
+    pool->bytes[pool->used + len] = '\0';
+    pool->used += (uint32_t)len + 1;
+
+    entry->next = pool->buckets[hash & pool->bucket_mask];
+    pool->buckets[hash & pool->bucket_mask] = i;
+
+    /* Keep chains short; a failed rehash only costs lookup time */
+    if (pool->entry_count > pool->bucket_mask + 1) pool_rehash(pool);
+
+    *id = i;
+    return JCRON_OK;
+}
+
+/**
+ * Drop a reference; the last one frees the entry and its bytes
+ */
+static void pool_release(jcron_table_pool_t* pool, uint32_t id) {
+    if (!id) return;
+    jcron_table_string_t* entry = &pool->entries[id];
+    if (--entry->refs) return;
+
+    uint32_t* link = &pool->buckets[entry->hash & pool->bucket_mask];
+    while (*link != id) link = &pool->entries[*link].next;
+    *link = entry->next;
+
+    entry->next = pool->free_entry;
+    pool->free_entry = id;
+    pool->dead += entry->len + 1;
+
+    if (pool->dead > POOL_COMPACT_MIN && pool->dead > pool->used / 2) pool_compact(pool);
+}
+
+/* ========================================================================
+ * Allocation
+ * ======================================================================== */
+
+/**
+ * Grow every column to `capacity` slots, preserving contents
+ *
+ * Columns that were grown before a failure keep their larger buffer; the
+ * table's capacity only moves once all of them fit.
+ */
+static int table_grow(jcron_table_t* table, uint32_t capacity) {
+    int ok = 1;
+
+#define GROW(column, size)                                          \
+    do {                                                            \
+        void* grown = realloc(table->column, (size_t)capacity * (size)); \
+        if (grown) table->column = grown;                           \
+        else ok = 0;                                                \
+    } while (0)
+
+    GROW(next_fire, sizeof(int64_t));
+    GROW(flags, sizeof(uint8_t));
+    GROW(minutes, sizeof(uint64_t));
+    GROW(hours, sizeof(uint32_t));
+    GROW(days_of_month, sizeof(uint32_t));
+    GROW(months, sizeof(uint16_t));
+    GROW(days_of_week, sizeof(uint8_t));
+    GROW(keys, sizeof(uint64_t));
+    GROW(data, sizeof(void*));
+    GROW(patterns, sizeof(jcron_pattern_t));
+    GROW(free_slots, sizeof(uint32_t));
+    if (table->columns) GROW(strings, table->columns * sizeof(uint32_t));
+
+#undef GROW
+
+    if (!ok) return JCRON_ERR_NO_MEMORY;
+    table->capacity = capacity;
+    return JCRON_OK;
+}
+
+int jcron_table_init(jcron_table_t* table, uint32_t capacity, uint32_t columns) {
+    if (!table) return JCRON_ERR_NULL_POINTER;
+    memset(table, 0, sizeof(*table));
+    if (columns > JCRON_TABLE_MAX_COLUMNS) return JCRON_ERR_INVALID_PATTERN;
+    table->columns = columns;
+
+    if (capacity < 64) capacity = 64;
+    if (table_grow(table, capacity) != JCRON_OK || pool_init(&table->pool) != JCRON_OK) {
+        jcron_table_free(table);
+        return JCRON_ERR_NO_MEMORY;
+    }
+    return JCRON_OK;
+}
+
+void jcron_table_free(jcron_table_t* table) {
+    if (!table) return;
+    free(table->next_fire);
+    free(table->flags);
+    free(table->minutes);
+    free(table->hours);
+    free(table->days_of_month);
+    free(table->months);
+    free(table->days_of_week);
+    free(table->keys);
+    free(table->data);
+    free(table->patterns);
+    free(table->strings);
+    free(table->free_slots);
+    pool_free(&table->pool);
+    memset(table, 0, sizeof(*table));
+}
+
+/* ========================================================================
+ * Slots
+ * ======================================================================== */
+
+int jcron_table_insert(jcron_table_t* table, const jcron_pattern_t* pattern,
+                       uint64_t key, void* data, uint32_t* slot) {
+    if (!table || !pattern || !slot) return JCRON_ERR_NULL_POINTER;
+
+    uint32_t s;
+    if (table->free_count) {
+        s = table->free_slots[--table->free_count];
+    } else {
+        if (table->high == table->capacity) {
+            if (table->capacity > UINT32_MAX / 2) return JCRON_ERR_OVERFLOW;
+            int ret = table_grow(table, table->capacity * 2);
+            if (ret != JCRON_OK) return ret;
+        }
+        s = table->high++;
+    }
+
+    int cron = pattern->has_cron;
+    table->next_fire[s] = JCRON_TABLE_IDLE;
+    table->flags[s] = JCRON_TABLE_USED;
+    table->minutes[s] = cron ? pattern->minutes : 0;
+    table->hours[s] = cron ? pattern->hours : 0;
+    table->days_of_month[s] = cron ? pattern->days_of_month : 0;
+    table->months[s] = cron ? pattern->months : 0;
+    table->days_of_week[s] = cron ? pattern->days_of_week : 0;
+    table->keys[s] = key;
+    table->data[s] = data;
+    table->patterns[s] = *pattern;
+    if (table->columns) {
+        memset(&table->strings[(size_t)s * table->columns], 0,
+               table->columns * sizeof(uint32_t));
+    }
+    table->count++;
+
+    *slot = s;
+    return JCRON_OK;
+}
+
+int jcron_table_remove(jcron_table_t* table, uint32_t slot) {
+    if (!table) return JCRON_ERR_NULL_POINTER;
+    if (slot >= table->high || !(table->flags[slot] & JCRON_TABLE_USED)) return JCRON_OK;
+
+    for (uint32_t column = 0; column < table->columns; column++) {
+        pool_release(&table->pool, table->strings[(size_t)slot * table->columns + column]);
+    }
+
+    /* Free slots never match or come due, so scans need not test flags */
+    table->next_fire[slot] = JCRON_TABLE_IDLE;
+    table->flags[slot] = 0;
+    table->minutes[slot] = 0;
+    table->hours[slot] = 0;
+    table->days_of_month[slot] = 0;
+    table->months[slot] = 0;
+    table->days_of_week[slot] = 0;
+    table->data[slot] = NULL;
+
+    table->free_slots[table->free_count++] = slot;
+    table->count--;
+    return JCRON_OK;
+}
+
+int jcron_table_set_string(jcron_table_t* table, uint32_t slot, uint32_t column,
+                           const char* s, size_t len) {
+    if (!table) return JCRON_ERR_NULL_POINTER;
+    if (slot >= table->high || !(table->flags[slot] & JCRON_TABLE_USED) ||
+        column >= table->columns) {
+        return JCRON_ERR_INVALID_PATTERN;
+    }
+
+    uint32_t id = 0;
+    if (s) {
+        int ret = pool_intern(&table->pool, s, len, &id);
+        if (ret != JCRON_OK) return ret;
+    }
+    uint32_t* cell = &table->strings[(size_t)slot * table->columns + column];
+    pool_release(&table->pool, *cell);
+    *cell = id;
+    return JCRON_OK;
+}
+
+const char* jcron_table_string(const jcron_table_t* table, uint32_t slot, uint32_t column) {
+    if (!table || slot >= table->high || column >= table->columns) return NULL;
+    uint32_t id = table->strings[(size_t)slot * table->columns + column];
+    return id ? table->pool.bytes + table->pool.entries[id].offset : NULL;
+}
+
+int jcron_table_advance(jcron_table_t* table, uint32_t slot, int64_t from) {
+    if (!table) return JCRON_ERR_NULL_POINTER;
+    if (slot >= table->high || !(table->flags[slot] & JCRON_TABLE_USED)) {
+        return JCRON_ERR_INVALID_PATTERN;
+    }
+
+    jcron_result_t result;
+    int ret = jcron_next(from, &table->patterns[slot], &result);
+    table->next_fire[slot] = ret == JCRON_OK ? result.next_time : JCRON_TABLE_IDLE;
+    return ret;
+}
+
+/* ========================================================================
+ * Scans
+ * ======================================================================== */
+
+/*
+ * Both scans test 8 slots per step into a bitmask (one AVX2 compare per
+ * column with JCRON_HAS_AVX2, branch-free scalar otherwise) and only
+ * branch to emit hits. Steps run while `out` can take all 8; the rest goes
+ * one slot at a time.
+ */
+
+/* Field bits of one timestamp */
+typedef struct {
+    uint64_t minute;
+    uint32_t hour, day, month, weekday;
+} match_bits_t;
+
+static inline int slot_matches(const jcron_table_t* table, uint32_t s, const match_bits_t* b) {
+    return (table->minutes[s] & b->minute) && (table->hours[s] & b->hour) &&
+           (table->days_of_month[s] & b->day) && (table->months[s] & b->month) &&
+           (table->days_of_week[s] & b->weekday);
+}
+
+#if defined(JCRON_HAS_AVX2)
+
+static inline unsigned due8(const int64_t* next_fire, int64_t now) {
+    const __m256i limit = _mm256_set1_epi64x(now);
+    __m256i lo = _mm256_cmpgt_epi64(_mm256_loadu_si256((const __m256i*)next_fire), limit);
+    __m256i hi = _mm256_cmpgt_epi64(_mm256_loadu_si256((const __m256i*)(next_fire + 4)), limit);
+    unsigned later = (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(lo)) |
+                     (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(hi)) << 4;
+    return ~later & 0xFF;
+}
+
+/* Lanes of `column & bits` that are zero, as a bitmask */
+static inline unsigned miss32(__m256i column, __m256i bits) {
+    __m256i zero = _mm256_cmpeq_epi32(_mm256_and_si256(column, bits), _mm256_setzero_si256());
+    return (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(zero));
+}
+
+static inline unsigned match8(const jcron_table_t* table, uint32_t s, const match_bits_t* b) {
+    const __m256i minute = _mm256_set1_epi64x((long long)b->minute);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i lo = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(table->minutes + s)), minute);
+    __m256i hi = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(table->minutes + s + 4)), minute);
+    unsigned miss =
+        (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(lo, zero))) |
+        (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(hi, zero))) << 4;
+
+    /* Narrower columns are widened to 32-bit lanes */
+    miss |= miss32(_mm256_loadu_si256((const __m256i*)(table->hours + s)),
+                   _mm256_set1_epi32((int)b->hour));
+    miss |= miss32(_mm256_loadu_si256((const __m256i*)(table->days_of_month + s)),
+                   _mm256_set1_epi32((int)b->day));
+    miss |= miss32(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(table->months + s))),
+                   _mm256_set1_epi32((int)b->month));
+    miss |= miss32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(table->days_of_week + s))),
+                   _mm256_set1_epi32((int)b->weekday));
+    return ~miss & 0xFF;
+}
+
+#else
+
+static inline unsigned due8(const int64_t* next_fire, int64_t now) {
+    unsigned hits = 0;
+    for (unsigned i = 0; i < 8; i++) hits |= (unsigned)(next_fire[i] <= now) << i;
+    return hits;
+}
+
+static inline unsigned match8(const jcron_table_t* table, uint32_t s, const match_bits_t* b) {
+    unsigned hits = 0;
+    for (unsigned i = 0; i < 8; i++) hits |= (unsigned)slot_matches(table, s + i, b) << i;
+    return hits;
+}
+
+#endif
+
+static inline uint32_t emit8(unsigned hits, uint32_t s, uint32_t* out, uint32_t n) {
+    while (hits) {
+        out[n++] = s + (uint32_t)__builtin_ctz(hits);
+        hits &= hits - 1;
+    }
+    return n;
+}
+
+uint32_t jcron_table_due(const jcron_table_t* table, int64_t now, uint32_t* cursor,
+                         uint32_t* out, uint32_t max) {
+    if (!table || !cursor || !out) return 0;
+
+    const int64_t* next_fire = table->next_fire;
+    uint32_t s = *cursor, n = 0;
+    while (s + 8 <= table->high && max - n >= 8) {
+        n = emit8(due8(next_fire + s, now), s, out, n);
+        s += 8;
+    }
+    for (; s < table->high && n < max; s++) {
+        if (next_fire[s] <= now) out[n++] = s;
+    }
+
+    *cursor = s;
+    return n;
+}
+
+uint32_t jcron_table_match(const jcron_table_t* table, int64_t timestamp, uint32_t* cursor,
+                           uint32_t* out, uint32_t max) {
+    if (!table || !cursor || !out) return 0;
+
+    struct tm tm;
+    time_t t = (time_t)timestamp;
+    if (!gmtime_r(&t, &tm)) {
+        *cursor = table->high;
+        return 0;
+    }
+    const match_bits_t bits = {
+        1ULL << tm.tm_min, 1u << tm.tm_hour, 1u << tm.tm_mday,
+        1u << (tm.tm_mon + 1), 1u << tm.tm_wday
+    };
+
+    uint32_t s = *cursor, n = 0;
+    while (s + 8 <= table->high && max - n >= 8) {
+        n = emit8(match8(table, s, &bits), s, out, n);
+        s += 8;
+    }
+    for (; s < table->high && n < max; s++) {
+        if (slot_matches(table, s, &bits)) out[n++] = s;
+    }
+
+    *cursor = s;
+    return n;
+}
@@ -12,6 +12,8 @@
  * This ensures O(fields) iterations instead of O(days)!
  */
 
+#define _POSIX_C_SOURCE 200809L  /* gmtime_r */
+
 #include "jcron.h"
 #include <string.h>
 #include <time.h>
@@ -388,6 +390,22 @@ int jcron_next(int64_t from_timestamp, const jcron_pattern_t* pattern,
  * jcron_prev() - Top-Down Jump Algorithm (Backwards)
  * ======================================================================== */
 
+// Step back to 23:59 of the previous day
+static inline void prev_day(struct tm* tm) {
+    tm->tm_mday--;
+    if (tm->tm_mday < 1) {
+        tm->tm_mon--;
+        if (tm->tm_mon < 0) {
+            tm->tm_mon = 11;
+            tm->tm_year--;
+        }
+        tm->tm_mday = jcron_days_in_month(tm->tm_year + 1900, tm->tm_mon + 1);
+    }
+    tm->tm_hour = 23;
+    tm->tm_min = 59;
+    tm->tm_wday = calc_day_of_week_fast(tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday);
+}
+
 int jcron_prev(int64_t from_timestamp, const jcron_pattern_t* pattern, 
                jcron_result_t* out) {
     if (!pattern || !out) {
@@ -400,50 +418,84 @@ int jcron_prev(int64_t from_timestamp, const jcron_pattern_t* pattern,
         return JCRON_ERR_INVALID_PATTERN;
     }
     
+    // Latest candidate: the minute before the one containing `from`
     struct tm tm;
-    timestamp_to_tm(from_timestamp, &tm);
+    timestamp_to_tm(from_timestamp - 60, &tm);
     tm.tm_sec = 0;
     
-    int max_iterations = 10000;
+    int max_iterations = 10000;  // Safety limit
     
     for (int iter = 0; iter < max_iterations; iter++) {
-        // Jump backwards first
-        tm.tm_min--;
-        if (tm.tm_min < 0) {
+        // 1. Check MONTH
+        if (!(pattern->months & (1 << (tm.tm_mon + 1)))) {
+            // Month doesn't match - jump to the end of the previous valid month
+            int prev_month = jcron_prev_bit_32(pattern->months, tm.tm_mon + 1);
+            
+            if (prev_month < 1) {
+                // Wrap to previous year
+                prev_month = jcron_last_bit_32(pattern->months);
+                if (prev_month < 1) return JCRON_ERR_NO_MATCH;
+                tm.tm_year--;
+            }
+            
+            tm.tm_mon = prev_month - 1;
+            tm.tm_mday = jcron_days_in_month(tm.tm_year + 1900, tm.tm_mon + 1);
+            tm.tm_hour = 23;
             tm.tm_min = 59;
-            tm.tm_hour--;
-            if (tm.tm_hour < 0) {
-                tm.tm_hour = 23;
-                tm.tm_mday--;
-                if (tm.tm_mday < 1) {
-                    tm.tm_mon--;
-                    if (tm.tm_mon < 0) {
-                        tm.tm_mon = 11;
-                        tm.tm_year--;
-                    }
-                    tm.tm_mday = jcron_days_in_month(tm.tm_year + 1900, tm.tm_mon + 1);
-                }
-                tm.tm_wday = calc_day_of_week(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday);
+            tm.tm_wday = calc_day_of_week_fast(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday);
+            continue;
+        }
+        
+        // 2. Check DAY (day_of_month AND day_of_week must both match)
+        if (!jcron_test_bit_32(pattern->days_of_month, tm.tm_mday) ||
+            !(pattern->days_of_week & (1 << tm.tm_wday))) {
+            prev_day(&tm);
+            continue;
+        }
+        
+        // 3. Check HOUR
+        if (!jcron_test_bit_32(pattern->hours, tm.tm_hour)) {
+            int prev_hour = jcron_prev_bit_32(pattern->hours, tm.tm_hour);
+            
+            if (prev_hour < 0) {
+                // Wrap to previous day
+                prev_hour = jcron_last_bit_32(pattern->hours);
+                if (prev_hour < 0) return JCRON_ERR_NO_MATCH;
+                prev_day(&tm);
             }
+            
+            tm.tm_hour = prev_hour;
+            tm.tm_min = 59;
+            continue;
         }
         
-        // Now check if this time matches
-        if ((pattern->months & (1 << (tm.tm_mon + 1))) &&
-            jcron_test_bit_32(pattern->days_of_month, tm.tm_mday) &&
-            (pattern->days_of_week & (1 << tm.tm_wday)) &&
-            jcron_test_bit_32(pattern->hours, tm.tm_hour) &&
-            jcron_test_bit_64(pattern->minutes, tm.tm_min)) {
-            // Found previous occurrence
-            int64_t match_time = tm_to_timestamp_select(&tm);
+        // 4. Check MINUTE
+        if (!jcron_test_bit_64(pattern->minutes, tm.tm_min)) {
+            int prev_min = jcron_prev_bit_64(pattern->minutes, tm.tm_min);
             
-            // Apply SOD/EOD modifiers
-            match_time = apply_sod_eod_modifiers(match_time, pattern);
+            if (prev_min < 0) {
+                // Wrap to previous hour
+                prev_min = jcron_last_bit_64(pattern->minutes);
+                if (prev_min < 0) return JCRON_ERR_NO_MATCH;
+                
+                tm.tm_hour--;
+                if (tm.tm_hour < 0) {
+                    prev_day(&tm);
+                }
+            }
             
-            out->prev_time = match_time;
-            return JCRON_OK;
+            tm.tm_min = prev_min;
+            continue;
         }
         
-        // If not match, continue jumping backwards (already did at top)
+        // ALL FIELDS MATCH! Found previous occurrence
+        int64_t match_time = tm_to_timestamp_select(&tm);
+        
+        // Apply SOD/EOD modifiers
+        match_time = apply_sod_eod_modifiers(match_time, pattern);
+        
+        out->prev_time = match_time;
+        return JCRON_OK;
     }
     
     return JCRON_ERR_NO_MATCH;
@@ -459,8 +511,8 @@ int jcron_matches(int64_t timestamp, const jcron_pattern_t* pattern) {
     struct tm tm;
     timestamp_to_tm(timestamp, &tm);
 
-    // Prepare arrays for SIMD matching
-    const uint32_t pattern_masks[5] = {
+    // Prepare arrays for SIMD matching (64-bit lanes: minutes need 60 bits)
+    const uint64_t pattern_masks[5] = {
         pattern->minutes,
         pattern->hours,
         pattern->days_of_month,
@@ -468,16 +520,81 @@ int jcron_matches(int64_t timestamp, const jcron_pattern_t* pattern) {
         pattern->days_of_week
     };
 
-    const uint32_t time_values[5] = {
-        tm.tm_min,
-        tm.tm_hour,
-        tm.tm_mday,
-        tm.tm_mon + 1,  // months are 1-based in cron
-        tm.tm_wday
+    const uint64_t time_values[5] = {
+        (uint64_t)tm.tm_min,
+        (uint64_t)tm.tm_hour,
+        (uint64_t)tm.tm_mday,
+        (uint64_t)tm.tm_mon + 1,  // months are 1-based in cron
+        (uint64_t)tm.tm_wday
     };
 
     // Use SIMD-accelerated matching
-    return jcron_simd_bitmask_match(pattern_masks, time_values, 5);
+    return jcron_simd_bitmask_match64(pattern_masks, time_values, 5);
+}
+
+/**
+ * Scalar twin of the SIMD batch kernel (tails and out-of-range blocks)
+ *
+ * Same days-to-civil arithmetic as the vector path, so both agree bit for bit
+ * without going through gmtime_r().
+ */
+static inline uint8_t match_ts_scalar(const uint64_t* masks, int64_t ts) {
+    int64_t days = ts / 86400;
+    int64_t sod = ts % 86400;
+    if (sod < 0) {
+        sod += 86400;
+        days--;
+    }
+
+    int64_t z = days + 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    int64_t doe = z - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    int dom = (int)(doy - (153 * mp + 2) / 5 + 1);
+    int month = (int)(mp < 10 ? mp + 3 : mp - 9);
+    int dow = (int)((days + 4) % 7);
+    if (dow < 0) dow += 7;
+
+    return ((masks[0] >> (sod / 60 % 60)) &
+            (masks[1] >> (sod / 3600)) &
+            (masks[2] >> dom) &
+            (masks[3] >> month) &
+            (masks[4] >> dow) & 1) != 0;
+}
+
+int jcron_matches_ts_batch(const jcron_pattern_t* pattern, const int64_t* timestamps,
+                           size_t count, uint8_t* out) {
+    if (!pattern || (count && (!timestamps || !out))) {
+        return JCRON_ERR_NULL_POINTER;
+    }
+
+    if (!pattern->has_cron) {
+        if (count) memset(out, 0, count);
+        return JCRON_OK;
+    }
+
+    const uint64_t masks[5] = {
+        pattern->minutes,
+        pattern->hours,
+        pattern->days_of_month,
+        pattern->months,
+        pattern->days_of_week
+    };
+
+    size_t i = 0;
+    while (i < count) {
+        i += jcron_simd_match_ts_batch(masks, timestamps + i, count - i, out + i);
+
+        // Finish the block the kernel stopped at (tail or out-of-range input)
+        size_t stop = (count - i < 8) ? count : i + 8;
+        for (; i < stop; i++) {
+            out[i] = match_ts_scalar(masks, timestamps[i]);
+        }
+    }
+
+    return JCRON_OK;
 }
 
 int jcron_next_n(int64_t from_timestamp, const jcron_pattern_t* pattern,
@@ -493,7 +610,120 @@ int jcron_next_n(int64_t from_timestamp, const jcron_pattern_t* pattern,
         if (ret != JCRON_OK) {
             return ret;
         }
-        current = results[i].next_time;
+        // jcron_next() is inclusive of the starting minute
+        current = results[i].next_time + 60;
+    }
+    
+    return JCRON_OK;
+}
+
+/* ========================================================================
+ * Ranges
+ * ======================================================================== */
+
+static inline int64_t floor_div(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+/**
+ * Occurrences on a matching day whose minute-of-day is below `limit`
+ */
+static inline int64_t fires_before_minute(uint64_t minutes, uint32_t hours, int limit) {
+    int hour = limit / 60;
+    int minute = limit % 60;
+    int64_t per_hour = __builtin_popcountll(minutes);
+
+    int64_t fires = (int64_t)__builtin_popcount(hours & ((1U << hour) - 1)) * per_hour;
+    if (hour < 24 && (hours & (1U << hour))) {
+        fires += __builtin_popcountll(minutes & ((1ULL << minute) - 1));
+    }
+    return fires;
+}
+
+int jcron_count(int64_t from_timestamp, int64_t to_timestamp,
+                const jcron_pattern_t* pattern, int64_t* count) {
+    if (!pattern || !count) {
+        return JCRON_ERR_NULL_POINTER;
+    }
+    
+    *count = 0;
+    
+    // SOD/EOD move each fire away from its mask minute: not countable per day
+    if (!pattern->has_cron || pattern->sod_type >= 0 || pattern->eod_type >= 0) {
+        return JCRON_ERR_INVALID_PATTERN;
+    }
+    
+    // Occurrences are minute starts in [from, to)
+    int64_t first = floor_div(from_timestamp + 59, 60);   // First minute
+    int64_t end = floor_div(to_timestamp + 59, 60);       // One past the last
+    if (end <= first) return JCRON_OK;
+    
+    uint64_t minutes = pattern->minutes & ((1ULL << 60) - 1);
+    uint32_t hours = pattern->hours & ((1U << 24) - 1);
+    int64_t per_day = (int64_t)__builtin_popcount(hours) * __builtin_popcountll(minutes);
+    
+    int64_t total = 0;
+    for (int64_t day = floor_div(first, 1440); day <= floor_div(end - 1, 1440); day++) {
+        // Days to civil date (same arithmetic as the batch matcher)
+        int64_t z = day + 719468;
+        int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+        int64_t doe = z - era * 146097;
+        int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        int64_t mp = (5 * doy + 2) / 153;
+        int dom = (int)(doy - (153 * mp + 2) / 5 + 1);
+        int month = (int)(mp < 10 ? mp + 3 : mp - 9);
+        int dow = (int)((day + 4) % 7);
+        if (dow < 0) dow += 7;
+        
+        if (!(pattern->months & (1U << month)) ||
+            !jcron_test_bit_32(pattern->days_of_month, dom) ||
+            !(pattern->days_of_week & (1U << dow))) {
+            continue;
+        }
+        
+        int64_t day_start = day * 1440;
+        int lo = first > day_start ? (int)(first - day_start) : 0;
+        int hi = end - day_start < 1440 ? (int)(end - day_start) : 1440;
+        
+        if (lo == 0 && hi == 1440) {
+            total += per_day;
+        } else {
+            total += fires_before_minute(minutes, hours, hi) -
+                     fires_before_minute(minutes, hours, lo);
+        }
+    }
+    
+    *count = total;
+    return JCRON_OK;
+}
+
+int jcron_range(int64_t from_timestamp, int64_t to_timestamp,
+                const jcron_pattern_t* pattern, int64_t* times, int max_count, int* count) {
+    if (!pattern || !count || (max_count > 0 && !times)) {
+        return JCRON_ERR_NULL_POINTER;
+    }
+    
+    *count = 0;
+    
+    // Same patterns as jcron_count(), so the two always agree
+    if (!pattern->has_cron || pattern->sod_type >= 0 || pattern->eod_type >= 0) {
+        return JCRON_ERR_INVALID_PATTERN;
+    }
+    
+    // jcron_next() truncates to the minute: start at the first whole minute
+    int64_t current = floor_div(from_timestamp + 59, 60) * 60;
+    jcron_result_t result;
+    
+    while (*count < max_count && current < to_timestamp) {
+        int ret = jcron_next(current, pattern, &result);
+        if (ret == JCRON_ERR_NO_MATCH) break;
+        if (ret != JCRON_OK) return ret;
+        if (result.next_time >= to_timestamp) break;
+        
+        times[(*count)++] = result.next_time;
+        current = result.next_time + 60;
     }
     
     return JCRON_OK;
@@ -0,0 +1,218 @@
+/**
+ * JCRON C Port - Inverted Index Tests
+ *
+ * Checks jcron_index_match() against per-pattern jcron_matches() for random
+ * job sets, plus add/remove/replace bookkeeping and capacity growth
+ */
+
+#define _DEFAULT_SOURCE  /* timegm */
+
+#include "jcron.h"
+#include "jcron_index.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* ========================================================================
+ * Test Framework
+ * ======================================================================== */
+
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) static void test_##name(void)
+
+#define ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("    ✗ FAILED: %s\n", message); \
+            tests_failed++; \
+            return; \
+        } \
+    } while (0)
+
+#define RUN_TEST(name) \
+    do { \
+        int failed_before = tests_failed; \
+        printf("  Running: " #name " ... "); \
+        fflush(stdout); \
+        tests_run++; \
+        test_##name(); \
+        if (tests_failed == failed_before) { \
+            printf("✓\n"); \
+            tests_passed++; \
+        } \
+    } while (0)
+
+/* ========================================================================
+ * Helpers
+ * ======================================================================== */
+
+#define NUM_JOBS 5000
+
+static jcron_pattern_t jobs[NUM_JOBS];
+
+/**
+ * Compare one index query with a linear jcron_matches() scan
+ */
+static int index_agrees(const jcron_index_t* index, const uint8_t* live, int64_t ts) {
+    jcron_index_iter_t it;
+    if (jcron_index_match(index, ts, &it) != JCRON_OK) return 0;
+
+    for (int slot = 0; slot < NUM_JOBS; slot++) {
+        /* Next matching slot from the index must be the next expected one */
+        if (!live[slot] || !jcron_matches(ts, &jobs[slot])) continue;
+        if (jcron_index_next(&it) != slot) return 0;
+    }
+    return jcron_index_next(&it) == -1;
+}
+
+/* ========================================================================
+ * Matching Tests
+ * ======================================================================== */
+
+TEST(matches_linear_scan) {
+    uint64_t state = 7;
+    uint8_t live[NUM_JOBS];
+    jcron_index_t index;
+    ASSERT(jcron_index_init(&index, NUM_JOBS) == JCRON_OK, "init should succeed");
+
+    for (int slot = 0; slot < NUM_JOBS; slot++) {
+        ASSERT(random_pattern(&state, &jobs[slot]) == JCRON_OK, "pattern should parse");
+        ASSERT(jcron_index_add(&index, (uint32_t)slot, &jobs[slot]) == JCRON_OK, "add should succeed");
+        live[slot] = 1;
+    }
+    ASSERT(index.count == NUM_JOBS, "count should track adds");
+
+    int64_t base = make_timestamp(2025, 1, 1, 0, 0);
+    for (int i = 0; i < 2000; i++) {
+        /* Random minute within ~4 years, so every field value is visited */
+        int64_t ts = base + (int64_t)(next_random(&state) % (4 * 366 * 1440)) * 60;
+        if (!index_agrees(&index, live, ts)) {
+            printf("\n    timestamp %lld\n", (long long)ts);
+            jcron_index_free(&index);
+            ASSERT(0, "index should agree with jcron_matches");
+        }
+    }
+
+    jcron_index_free(&index);
+}
+
+TEST(empty_index) {
+    jcron_index_t index;
+    jcron_index_iter_t it;
+    ASSERT(jcron_index_init(&index, 0) == JCRON_OK, "init should succeed");
+    ASSERT(jcron_index_match(&index, make_timestamp(2025, 3, 1, 12, 0), &it) == JCRON_OK,
+           "match should succeed");
+    ASSERT(jcron_index_next(&it) == -1, "empty index should yield nothing");
+    jcron_index_free(&index);
+}
+
+/* ========================================================================
+ * Bookkeeping Tests
+ * ======================================================================== */
+
+TEST(remove_and_replace) {
+    jcron_index_t index;
+    jcron_pattern_t every, noon;
+    jcron_index_iter_t it;
+    int64_t ts = make_timestamp(2025, 3, 1, 8, 30);
+
+    ASSERT(jcron_parse("0 * * * * *", &every) == JCRON_OK, "pattern should parse");
+    ASSERT(jcron_parse("0 0 12 * * *", &noon) == JCRON_OK, "pattern should parse");
+    ASSERT(jcron_index_init(&index, 0) == JCRON_OK, "init should succeed");
+
+    jcron_index_add(&index, 3, &every);
+    jcron_index_add(&index, 70, &every);
+    jcron_index_add(&index, 70, &every);
+    ASSERT(index.count == 2, "re-adding a slot should not double count");
+
+    jcron_index_match(&index, ts, &it);
+    ASSERT(jcron_index_next(&it) == 3, "slot 3 should match");
+    ASSERT(jcron_index_next(&it) == 70, "slot 70 should match");
+    ASSERT(jcron_index_next(&it) == -1, "no other slot should match");
+
+    /* Replacing slot 3 with a noon job drops it from 08:30 */
+    jcron_index_add(&index, 3, &noon);
+    jcron_index_remove(&index, 70);
+    jcron_index_remove(&index, 70);
+    jcron_index_remove(&index, 100000);
+    ASSERT(index.count == 1, "remove should be idempotent");
+
+    jcron_index_match(&index, ts, &it);
+    ASSERT(jcron_index_next(&it) == -1, "replaced and removed slots should not match");
+
+    jcron_index_match(&index, make_timestamp(2025, 3, 1, 12, 0), &it);
+    ASSERT(jcron_index_next(&it) == 3, "replaced slot should match its new pattern");
+    ASSERT(jcron_index_next(&it) == -1, "no other slot should match");
+
+    jcron_index_free(&index);
+}
+
+TEST(grows_past_capacity) {
+    jcron_index_t index;
+    jcron_pattern_t every;
+    jcron_index_iter_t it;
+    const uint32_t slots[] = {0, 4095, 4096, 70000, 300000};
+
+    ASSERT(jcron_parse("0 * * * * *", &every) == JCRON_OK, "pattern should parse");
+    ASSERT(jcron_index_init(&index, 0) == JCRON_OK, "init should succeed");
+
+    for (int i = 0; i < 5; i++) {
+        ASSERT(jcron_index_add(&index, slots[i], &every) == JCRON_OK, "add should grow the index");
+    }
+    ASSERT((uint64_t)index.words * 64 > 300000, "capacity should cover the largest slot");
+
+    jcron_index_match(&index, make_timestamp(2025, 3, 1, 8, 30), &it);
+    for (int i = 0; i < 5; i++) {
+        ASSERT(jcron_index_next(&it) == (int)slots[i], "slots should survive growth in order");
+    }
+    ASSERT(jcron_index_next(&it) == -1, "no other slot should match");
+
+    jcron_index_free(&index);
+}
+
+TEST(rejects_invalid_input) {
+    jcron_index_t index;
+    jcron_pattern_t eod;
+
+    ASSERT(jcron_index_init(NULL, 0) == JCRON_ERR_NULL_POINTER, "NULL index should fail");
+    ASSERT(jcron_index_init(&index, 0) == JCRON_OK, "init should succeed");
+    ASSERT(jcron_parse("EOD:E0D", &eod) == JCRON_OK, "EOD pattern should parse");
+    ASSERT(jcron_index_add(&index, 0, &eod) == JCRON_ERR_INVALID_PATTERN,
+           "pattern without cron part should be rejected");
+    ASSERT(jcron_index_add(&index, 0, NULL) == JCRON_ERR_NULL_POINTER, "NULL pattern should fail");
+    ASSERT(index.count == 0, "failed adds should not count");
+    jcron_index_free(&index);
+}
+
+/* ========================================================================
+ * Main Test Runner
+ * ======================================================================== */
+
+int main(void) {
+    printf("JCRON C Port - Index Tests\n");
+    printf("==========================\n\n");
+
+    printf("Matching Tests:\n");
+    RUN_TEST(matches_linear_scan);
+    RUN_TEST(empty_index);
+
+    printf("\nBookkeeping Tests:\n");
+    RUN_TEST(remove_and_replace);
+    RUN_TEST(grows_past_capacity);
+    RUN_TEST(rejects_invalid_input);
+
+    printf("\n==========================\n");
+    printf("Results: %d/%d tests passed ", tests_passed, tests_run);
+
+    if (tests_failed == 0) {
+        printf("✓\n");
+        return 0;
+    } else {
+        printf("✗ (%d failed)\n", tests_failed);
+        return 1;
+    }
+}
@@ -4,6 +4,8 @@
  * Tests for jcron_next(), jcron_prev(), jcron_matches()
  */
 
+#define _DEFAULT_SOURCE  /* timegm, localtime_r */
+
 #include "jcron.h"
 #include <stdio.h>
 #include <string.h>
@@ -353,6 +355,80 @@ TEST(matches_weekday) {
     ASSERT(jcron_matches(time2, &pattern) == 0, "Should not match Tuesday");
 }
 
+/* ========================================================================
+ * jcron_matches_ts_batch() Tests
+ * ======================================================================== */
+
+/**
+ * Reference matcher via gmtime_r (checks all 60 minute bits)
+ */
+static int reference_match(int64_t timestamp, const jcron_pattern_t* p) {
+    struct tm tm;
+    time_t t = (time_t)timestamp;
+    gmtime_r(&t, &tm);
+    return jcron_test_bit_64(p->minutes, tm.tm_min) &&
+           jcron_test_bit_32(p->hours, tm.tm_hour) &&
+           jcron_test_bit_32(p->days_of_month, tm.tm_mday) &&
+           ((p->months >> (tm.tm_mon + 1)) & 1) &&
+           ((p->days_of_week >> tm.tm_wday) & 1);
+}
+
+TEST(batch_matches_reference) {
+    static const char* patterns[] = {
+        "* * * * * *",
+        "* 45 * * * *",
+        "* 0,15,30,45,59 9-17 * * 1-5",
+        "* */7 */5 29 2 *",
+        "* 31 23 31 12 *",
+        "* 0 0 1 1,4,7,10 0,6",
+    };
+    enum { N = 4099 };  /* not a multiple of the vector width */
+    static int64_t ts[N];
+    static uint8_t out[N];
+
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < N; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        /* Years ~1600..2400, including pre-epoch timestamps */
+        ts[i] = (int64_t)(seed >> 20) % 25000000000LL - 11500000000LL;
+        if (i % 3 == 0) ts[i] -= ts[i] % 60;  /* land exactly on minutes */
+    }
+
+    for (size_t p = 0; p < sizeof(patterns) / sizeof(patterns[0]); p++) {
+        jcron_pattern_t pattern;
+        ASSERT_EQ(jcron_parse(patterns[p], &pattern), JCRON_OK, "pattern should parse");
+        ASSERT_EQ(jcron_matches_ts_batch(&pattern, ts, N, out), JCRON_OK, "batch should succeed");
+        for (int i = 0; i < N; i++) {
+            if (out[i] != reference_match(ts[i], &pattern)) {
+                printf("\n    pattern \"%s\" ts %" PRId64 ": got %d\n", patterns[p], ts[i], out[i]);
+                ASSERT(0, "batch result should match gmtime_r reference");
+            }
+        }
+    }
+}
+
+TEST(batch_matches_edges) {
+    jcron_pattern_t pattern;
+    jcron_parse("* 30 14 * * *", &pattern);
+
+    int64_t ts[21];
+    for (int i = 0; i < 21; i++) {
+        ts[i] = make_timestamp(2025, 10, 23, 14, 29 + i % 3, i);
+    }
+    ts[3] = make_timestamp(1969, 12, 31, 14, 30, 0);
+    ts[10] = (int64_t)1 << 52;      /* outside the exact vector range */
+    ts[19] = -((int64_t)1 << 52);
+    uint8_t out[21];
+
+    ASSERT_EQ(jcron_matches_ts_batch(&pattern, ts, 21, out), JCRON_OK, "batch should succeed");
+    for (int i = 0; i < 21; i++) {
+        ASSERT_EQ(out[i], reference_match(ts[i], &pattern), "edge timestamp should match reference");
+    }
+
+    ASSERT_EQ(jcron_matches_ts_batch(&pattern, NULL, 0, NULL), JCRON_OK, "empty batch is a no-op");
+    ASSERT_EQ(jcron_matches_ts_batch(NULL, ts, 21, out), JCRON_ERR_NULL_POINTER, "NULL pattern rejected");
+}
+
 /* ========================================================================
  * jcron_prev() Tests
  * ======================================================================== */
@@ -391,6 +467,135 @@ TEST(prev_day_rollback) {
     ASSERT_TIME_EQ(result.prev_time, expected, "Previous time should be today's midnight");
 }
 
+TEST(prev_monthly_beyond_a_week) {
+    // Pattern: "0 0 0 1 * *" - First of the month (more than 10000 minutes back)
+    jcron_pattern_t pattern;
+    jcron_parse("0 0 0 1 * *", &pattern);
+    
+    int64_t from = make_timestamp(2025, 10, 23, 10, 5, 0);
+    jcron_result_t result;
+    
+    int ret = jcron_prev(from, &pattern, &result);
+    ASSERT_EQ(ret, JCRON_OK, "jcron_prev should succeed");
+    
+    int64_t expected = make_timestamp(2025, 10, 1, 0, 0, 0);
+    ASSERT_TIME_EQ(result.prev_time, expected, "Previous time should be the 1st of the month");
+    
+    // Leap day: four years back across year boundaries
+    jcron_parse("0 30 12 29 2 *", &pattern);
+    ret = jcron_prev(make_timestamp(2028, 2, 29, 12, 30, 0), &pattern, &result);
+    ASSERT_EQ(ret, JCRON_OK, "jcron_prev should succeed");
+    ASSERT_TIME_EQ(result.prev_time, make_timestamp(2024, 2, 29, 12, 30, 0),
+                   "Previous leap day should be 2024-02-29");
+}
+
+static const char* range_patterns[] = {
+    "0 * * * * *",
+    "0 45 * * * *",
+    "0 0,15,30,45,59 9-17 * * 1-5",
+    "0 */7 */5 * * *",
+    "0 0 0 1 1,4,7,10 0,6",
+    "0 31 23 31 12 *",
+};
+
+TEST(prev_agrees_with_next) {
+    uint64_t seed = 0x2545F4914F6CDD1DULL;
+    
+    for (size_t p = 0; p < sizeof(range_patterns) / sizeof(range_patterns[0]); p++) {
+        jcron_pattern_t pattern;
+        ASSERT_EQ(jcron_parse(range_patterns[p], &pattern), JCRON_OK, "pattern should parse");
+        
+        for (int i = 0; i < 200; i++) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            int64_t from = 946684800 + (int64_t)(seed >> 33) % 2000000000LL;  // 2000..2063
+            
+            jcron_result_t prev, next;
+            ASSERT_EQ(jcron_prev(from, &pattern, &prev), JCRON_OK, "prev should succeed");
+            ASSERT(prev.prev_time < from - from % 60, "prev must be before the minute of from");
+            
+            // prev is an occurrence, and the next one after it is not before from's minute
+            ASSERT_EQ(jcron_next(prev.prev_time, &pattern, &next), JCRON_OK, "next should succeed");
+            ASSERT_TIME_EQ(next.next_time, prev.prev_time, "prev must be an occurrence");
+            ASSERT_EQ(jcron_next(prev.prev_time + 60, &pattern, &next), JCRON_OK, "next should succeed");
+            ASSERT(next.next_time >= from - from % 60, "no occurrence between prev and from");
+        }
+    }
+}
+
+TEST(next_n_distinct) {
+    jcron_pattern_t pattern;
+    jcron_parse("0 */15 * * * *", &pattern);
+    
+    jcron_result_t results[5];
+    int64_t from = make_timestamp(2025, 10, 23, 10, 0, 0);
+    ASSERT_EQ(jcron_next_n(from, &pattern, 5, results), JCRON_OK, "jcron_next_n should succeed");
+    
+    for (int i = 0; i < 5; i++) {
+        ASSERT_TIME_EQ(results[i].next_time, from + i * 900, "Occurrences every 15 minutes");
+    }
+}
+
+TEST(count_and_range_agree_with_next) {
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    
+    for (size_t p = 0; p < sizeof(range_patterns) / sizeof(range_patterns[0]); p++) {
+        jcron_pattern_t pattern;
+        ASSERT_EQ(jcron_parse(range_patterns[p], &pattern), JCRON_OK, "pattern should parse");
+        
+        for (int i = 0; i < 40; i++) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            int64_t from = 946684800 + (int64_t)(seed >> 33) % 2000000000LL;
+            int64_t to = from + (int64_t)(seed % (3 * 86400));
+            if (i % 10 == 0) to = from + 400 * 86400LL;  // Spans a year boundary
+            
+            // Reference: step jcron_next() through the range
+            int64_t times[64];
+            int64_t expected = 0;
+            jcron_result_t next;
+            int64_t current = from + 59 - (from + 59) % 60;
+            while (jcron_next(current, &pattern, &next) == JCRON_OK && next.next_time < to) {
+                if (expected < 64) times[expected] = next.next_time;
+                expected++;
+                current = next.next_time + 60;
+            }
+            
+            int64_t count;
+            ASSERT_EQ(jcron_count(from, to, &pattern, &count), JCRON_OK, "count should succeed");
+            ASSERT_EQ(count, expected, "count must match stepping jcron_next");
+            
+            int64_t listed[64];
+            int n;
+            ASSERT_EQ(jcron_range(from, to, &pattern, listed, 64, &n), JCRON_OK, "range should succeed");
+            ASSERT_EQ(n, expected < 64 ? expected : 64, "range must stop at max_count");
+            for (int k = 0; k < n; k++) {
+                ASSERT_TIME_EQ(listed[k], times[k], "range must list the same occurrences");
+            }
+        }
+    }
+}
+
+TEST(count_and_range_reject_sod_eod) {
+    const char* modified[] = {"0 0 12 * * * E1D", "0 0 12 * * * S1D"};
+    
+    for (size_t p = 0; p < sizeof(modified) / sizeof(modified[0]); p++) {
+        jcron_pattern_t pattern;
+        ASSERT_EQ(jcron_parse(modified[p], &pattern), JCRON_OK, "pattern should parse");
+        ASSERT(pattern.sod_type >= 0 || pattern.eod_type >= 0, "modifier should be set");
+        
+        int64_t from = make_timestamp(2025, 1, 1, 0, 0, 0);
+        int64_t count = -1;
+        ASSERT_EQ(jcron_count(from, from + 7 * 86400, &pattern, &count),
+                  JCRON_ERR_INVALID_PATTERN, "count should reject SOD/EOD");
+        ASSERT_EQ(count, 0, "count should be zeroed");
+        
+        int64_t listed[8];
+        int n = -1;
+        ASSERT_EQ(jcron_range(from, from + 7 * 86400, &pattern, listed, 8, &n),
+                  JCRON_ERR_INVALID_PATTERN, "range should reject SOD/EOD");
+        ASSERT_EQ(n, 0, "range should list nothing");
+    }
+}
+
 /* ========================================================================
  * Main Test Runner
  * ======================================================================== */
@@ -420,9 +625,20 @@ int main(void) {
     RUN_TEST(matches_exact_time);
     RUN_TEST(matches_weekday);
     
+    printf("\njcron_matches_ts_batch() Tests:\n");
+    RUN_TEST(batch_matches_reference);
+    RUN_TEST(batch_matches_edges);
+    
     printf("\njcron_prev() Tests:\n");
     RUN_TEST(prev_every_minute);
     RUN_TEST(prev_day_rollback);
+    RUN_TEST(prev_monthly_beyond_a_week);
+    RUN_TEST(prev_agrees_with_next);
+    
+    printf("\njcron_next_n() / jcron_count() / jcron_range() Tests:\n");
+    RUN_TEST(next_n_distinct);
+    RUN_TEST(count_and_range_agree_with_next);
+    RUN_TEST(count_and_range_reject_sod_eod);
     
     printf("\n=====================================\n");
     printf("Results: %d/%d tests passed ", tests_passed, tests_run);
@@ -279,6 +279,176 @@ TEST(parse_cron_with_sod_modifier) {
     ASSERT_BIT_SET(pattern.hours, 10, "Hour 10 should be set");
 }
 
+/* ========================================================================
+ * Test Cases: Hashed Fields
+ * ======================================================================== */
+
+static int count_bits_64(uint64_t mask) {
+    int n = 0;
+    for (; mask; mask &= mask - 1) n++;
+    return n;
+}
+
+TEST(parse_hash_stable_per_key) {
+    // Pattern: "0 H H * * *" - One time a day, chosen by the key
+    jcron_pattern_t a, b;
+    ASSERT_EQ(jcron_parse_keyed("0 H H * * *", 42, &a), JCRON_OK, "Parse should succeed");
+    ASSERT_EQ(jcron_parse_keyed("0 H H * * *", 42, &b), JCRON_OK, "Parse should succeed");
+
+    ASSERT_EQ(count_bits_64(a.minutes), 1, "H should pick one minute");
+    ASSERT_EQ(count_bits_64(a.hours), 1, "H should pick one hour");
+    ASSERT_EQ(a.minutes, b.minutes, "Same key should give the same minute");
+    ASSERT_EQ(a.hours, b.hours, "Same key should give the same hour");
+    ASSERT_EQ(a.days_of_month, 0xFFFFFFFEu, "Other fields should parse as usual");
+}
+
+TEST(parse_hash_spreads_keys) {
+    // 1000 keys over 60 minutes: every minute used, none heavily
+    int per_minute[60] = {0};
+    for (uint64_t key = 1; key <= 1000; key++) {
+        jcron_pattern_t pattern;
+        ASSERT_EQ(jcron_parse_keyed("0 H * * * *", key, &pattern), JCRON_OK,
+                  "Parse should succeed");
+        for (int m = 0; m < 60; m++) {
+            if (jcron_test_bit_64(pattern.minutes, m)) per_minute[m]++;
+        }
+    }
+    for (int m = 0; m < 60; m++) {
+        ASSERT(per_minute[m] > 0 && per_minute[m] < 50, "Keys should spread over the hour");
+    }
+}
+
+TEST(parse_hash_range_and_step) {
+    for (uint64_t key = 0; key < 200; key++) {
+        jcron_pattern_t pattern;
+        // Every 15 minutes at a hashed offset, hour within 2-5
+        ASSERT_EQ(jcron_parse_keyed("0 H/15 H(2-5) * * *", key, &pattern), JCRON_OK,
+                  "Parse should succeed");
+        ASSERT_EQ(count_bits_64(pattern.minutes), 4, "H/15 should fire 4 times an hour");
+        int first = __builtin_ctzll(pattern.minutes);
+        ASSERT(first < 15, "H/15 should start within the first step");
+        ASSERT_BIT_SET(pattern.minutes, first + 45, "H/15 should step by 15");
+        ASSERT(pattern.hours && (pattern.hours & ~0x3Cu) == 0, "H(2-5) should stay in 2-5");
+
+        // Day of month: every month has the day
+        ASSERT_EQ(jcron_parse_keyed("0 0 0 H * *", key, &pattern), JCRON_OK,
+                  "Parse should succeed");
+        ASSERT(pattern.days_of_month >= 2 && pattern.days_of_month < (1u << 29),
+               "H day of month should be within 1-28");
+    }
+}
+
+TEST(parse_hash_invalid) {
+    jcron_pattern_t pattern;
+    ASSERT_EQ(jcron_parse_keyed("0 H(5-70) * * * *", 1, &pattern), JCRON_ERR_INVALID_PATTERN,
+              "Should reject a range outside the field");
+    ASSERT_EQ(jcron_parse_keyed("0 H(9-3) * * * *", 1, &pattern), JCRON_ERR_INVALID_PATTERN,
+              "Should reject a reversed range");
+    ASSERT_EQ(jcron_parse_keyed("0 H/0 * * * *", 1, &pattern), JCRON_ERR_INVALID_PATTERN,
+              "Should reject a zero step");
+    ASSERT_EQ(jcron_parse_keyed("0 H(1-5 * * * *", 1, &pattern), JCRON_ERR_INVALID_PATTERN,
+              "Should reject an unclosed range");
+}
+
+/* ========================================================================
+ * Test Cases: Pre-split Fields
+ * ======================================================================== */
+
+// Split `line` at whitespace into at most `max` spans (no copies)
+static int split_spans(const char* line, jcron_span_t* spans, int max) {
+    int n = 0;
+    const char* p = line;
+    while (*p && n < max) {
+        while (*p == ' ') p++;
+        if (!*p) break;
+        spans[n].start = p;
+        while (*p && *p != ' ') p++;
+        spans[n].len = (size_t)(p - spans[n].start);
+        n++;
+    }
+    return n;
+}
+
+static int same_schedule(const jcron_pattern_t* a, const jcron_pattern_t* b) {
+    return a->minutes == b->minutes && a->hours == b->hours &&
+           a->days_of_month == b->days_of_month && a->months == b->months &&
+           a->days_of_week == b->days_of_week;
+}
+
+TEST(parse_fields_five_field_crontab) {
+    // Crontab line: the fields are followed by the command, not a NUL
+    const char* line = "30 9 * * 1-5 /usr/bin/backup --full";
+    jcron_span_t spans[5];
+    ASSERT_EQ(split_spans(line, spans, 5), 5, "Should split five fields");
+
+    jcron_pattern_t fields, string;
+    ASSERT_EQ(jcron_parse_fields(spans, JCRON_FIELDS_5, 0, &fields), JCRON_OK,
+              "Parse should succeed");
+    ASSERT_EQ(jcron_parse("0 30 9 * * 1-5", &string), JCRON_OK, "Parse should succeed");
+    ASSERT(same_schedule(&fields, &string), "Should match the 6-field string form");
+    ASSERT_EQ(fields.has_cron, 1, "Should have cron component");
+    ASSERT_EQ(fields.eod_type, -1, "Should have no EOD modifier");
+}
+
+TEST(parse_fields_six_and_seven_fields) {
+    jcron_span_t spans[7];
+    jcron_pattern_t six, seven, string;
+    ASSERT_EQ(jcron_parse("0 */15 8-18 * * *", &string), JCRON_OK, "Parse should succeed");
+
+    split_spans("0 */15 8-18 * * *", spans, 7);
+    ASSERT_EQ(jcron_parse_fields(spans, JCRON_FIELDS_6, 0, &six), JCRON_OK,
+              "Parse should succeed");
+    ASSERT(same_schedule(&six, &string), "6 fields should match jcron_parse()");
+
+    split_spans("0 */15 8-18 * * * *", spans, 7);
+    ASSERT_EQ(jcron_parse_fields(spans, JCRON_FIELDS_7, 0, &seven), JCRON_OK,
+              "Parse should succeed");
+    ASSERT(same_schedule(&seven, &string), "7 fields should match jcron_parse()");
+
+    split_spans("0 */15 8-18 * * * 2030", spans, 7);
+    ASSERT_EQ(jcron_parse_fields(spans, JCRON_FIELDS_7, 0, &seven), JCRON_ERR_INVALID_PATTERN,
+              "Should reject a year it cannot schedule");
+    split_spans("75 */15 8-18 * * *", spans, 7);
+    ASSERT_EQ(jcron_parse_fields(spans, JCRON_FIELDS_6, 0, &six), JCRON_ERR_INVALID_PATTERN,
+              "Should reject seconds out of range");
+}
+
+TEST(parse_fields_hash_matches_string_form) {
+    // "H" resolves the same whichever entry point and layout is used
+    jcron_span_t spans[5];
+    split_spans("H H(2-5) * * *", spans, 5);
+    for (uint64_t key = 1; key < 100; key++) {
+        jcron_pattern_t fields, string;
+        ASSERT_EQ(jcron_parse_fields(spans, JCRON_FIELDS_5, key, &fields), JCRON_OK,
+                  "Parse should succeed");
+        ASSERT_EQ(jcron_parse_keyed("0 H H(2-5) * * *", key, &string), JCRON_OK,
+                  "Parse should succeed");
+        ASSERT(same_schedule(&fields, &string), "Same key should give the same schedule");
+    }
+}
+
+TEST(parse_fields_invalid) {
+    jcron_span_t spans[5];
+    jcron_pattern_t pattern;
+    split_spans("* * * * *", spans, 5);
+    ASSERT_EQ(jcron_parse_fields(NULL, JCRON_FIELDS_5, 0, &pattern), JCRON_ERR_NULL_POINTER,
+              "Should reject NULL fields");
+    ASSERT_EQ(jcron_parse_fields(spans, (jcron_layout_t)4, 0, &pattern),
+              JCRON_ERR_INVALID_PATTERN, "Should reject an unknown layout");
+
+    // A span ends where its length says, even if digits follow
+    const char* text = "59";
+    jcron_span_t one = {text, 1};
+    spans[0] = one;
+    ASSERT_EQ(jcron_parse_fields(spans, JCRON_FIELDS_5, 0, &pattern), JCRON_OK,
+              "Parse should succeed");
+    ASSERT_EQ(pattern.minutes, 1ULL << 5, "Only the span's digit should be read");
+
+    spans[0].len = 0;
+    ASSERT_EQ(jcron_parse_fields(spans, JCRON_FIELDS_5, 0, &pattern), JCRON_ERR_INVALID_PATTERN,
+              "Should reject an empty field");
+}
+
 /* ========================================================================
  * Test Cases: Error Handling
  * ======================================================================== */
@@ -329,6 +499,18 @@ int main(void) {
     run_test_parse_sod_start_of_week();
     run_test_parse_cron_with_sod_modifier();
     
+    printf("\nHashed Fields:\n");
+    run_test_parse_hash_stable_per_key();
+    run_test_parse_hash_spreads_keys();
+    run_test_parse_hash_range_and_step();
+    run_test_parse_hash_invalid();
+    
+    printf("\nPre-split Fields:\n");
+    run_test_parse_fields_five_field_crontab();
+    run_test_parse_fields_six_and_seven_fields();
+    run_test_parse_fields_hash_matches_string_form();
+    run_test_parse_fields_invalid();
+    
     printf("\nError Handling:\n");
     run_test_parse_null_pointer();
     run_test_parse_invalid_field_count();
@@ -0,0 +1,306 @@
+/**
+ * JCRON C Port - Scheduler Tests
+ *
+ * Random set/remove/pop sequences checked against a brute-force reference
+ * (heap) and against the heap (timing wheel), plus jcron_next()-driven
+ * rescheduling
+ */
+
+#define _DEFAULT_SOURCE  /* timegm */
+
+#include "jcron.h"
+#include "jcron_sched.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* ========================================================================
+ * Test Framework
+ * ======================================================================== */
+
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) static void test_##name(void)
+
+#define ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("    ✗ FAILED: %s\n", message); \
+            tests_failed++; \
+            return; \
+        } \
+    } while (0)
+
+#define RUN_TEST(name) \
+    do { \
+        int failed_before = tests_failed; \
+        printf("  Running: " #name " ... "); \
+        fflush(stdout); \
+        tests_run++; \
+        test_##name(); \
+        if (tests_failed == failed_before) { \
+            printf("✓\n"); \
+            tests_passed++; \
+        } \
+    } while (0)
+
+/* ========================================================================
+ * Helpers
+ * ======================================================================== */
+
+#define NUM_SLOTS 300
+#define UNSCHEDULED INT64_MIN
+
+/**
+ * Earliest (when, slot) of the reference table, or -1 when empty
+ */
+static int reference_min(const int64_t* ref, int64_t* when) {
+    int best = -1;
+    for (int slot = 0; slot < NUM_SLOTS; slot++) {
+        if (ref[slot] == UNSCHEDULED) continue;
+        if (best < 0 || ref[slot] < ref[best]) best = slot;
+    }
+    if (best >= 0) *when = ref[best];
+    return best;
+}
+
+/* ========================================================================
+ * Heap Tests
+ * ======================================================================== */
+
+TEST(random_operations_match_reference) {
+    jcron_sched_t sched;
+    int64_t ref[NUM_SLOTS];
+    uint64_t state = 99;
+
+    ASSERT(jcron_sched_init(&sched, 16) == JCRON_OK, "init should succeed");
+    for (int i = 0; i < NUM_SLOTS; i++) ref[i] = UNSCHEDULED;
+
+    for (int iter = 0; iter < 100000; iter++) {
+        uint32_t slot = (uint32_t)(next_random(&state) % NUM_SLOTS);
+        int op = (int)(next_random(&state) % 4);
+
+        if (op <= 1) {
+            /* Small time range so ties between slots are frequent */
+            int64_t when = (int64_t)(next_random(&state) % 1000);
+            ASSERT(jcron_sched_set(&sched, slot, when) == JCRON_OK, "set should succeed");
+            ref[slot] = when;
+        } else if (op == 2) {
+            jcron_sched_remove(&sched, slot);
+            ref[slot] = UNSCHEDULED;
+        } else {
+            int64_t now = (int64_t)(next_random(&state) % 1000);
+            int64_t want_when = 0, got_when = 0;
+            int want = reference_min(ref, &want_when);
+            if (want >= 0 && want_when > now) want = -1;
+
+            int got = jcron_sched_pop(&sched, now, &got_when);
+            ASSERT(got == want, "pop should return the earliest due slot");
+            if (got >= 0) {
+                ASSERT(got_when == want_when, "pop should report the fire time");
+                ref[got] = UNSCHEDULED;
+            }
+        }
+
+        uint32_t expected = 0;
+        for (int i = 0; i < NUM_SLOTS; i++) expected += ref[i] != UNSCHEDULED;
+        ASSERT(sched.count == expected, "count should track the reference");
+    }
+
+    jcron_sched_free(&sched);
+}
+
+TEST(ties_pop_in_slot_order) {
+    jcron_sched_t sched;
+    const uint32_t slots[] = {9, 2, 7, 0, 5};
+
+    ASSERT(jcron_sched_init(&sched, 0) == JCRON_OK, "init should succeed");
+    for (int i = 0; i < 5; i++) jcron_sched_set(&sched, slots[i], 100);
+
+    ASSERT(jcron_sched_pop(&sched, 99, NULL) == -1, "nothing should be due early");
+    ASSERT(jcron_sched_pop(&sched, 100, NULL) == 0, "lowest slot first");
+    ASSERT(jcron_sched_pop(&sched, 100, NULL) == 2, "then slot 2");
+    ASSERT(jcron_sched_pop(&sched, 100, NULL) == 5, "then slot 5");
+    ASSERT(jcron_sched_pop(&sched, 100, NULL) == 7, "then slot 7");
+    ASSERT(jcron_sched_pop(&sched, 100, NULL) == 9, "then slot 9");
+    ASSERT(jcron_sched_peek(&sched, NULL) == -1, "scheduler should be empty");
+
+    jcron_sched_free(&sched);
+}
+
+/* ========================================================================
+ * Timing Wheel Tests
+ * ======================================================================== */
+
+/**
+ * Drain every due fire from both schedulers and compare as (when, slot) sets
+ */
+static int drain_agrees(jcron_sched_t* wheel, jcron_sched_t* heap, int64_t now) {
+    static int64_t due[NUM_SLOTS];
+    int64_t when;
+    int n = 0;
+
+    for (int i = 0; i < NUM_SLOTS; i++) due[i] = UNSCHEDULED;
+    for (int slot; (slot = jcron_sched_pop(heap, now, &when)) >= 0; n++) {
+        due[slot] = when;
+    }
+    for (int slot; (slot = jcron_sched_pop(wheel, now, &when)) >= 0; n--) {
+        if (due[slot] != when) return 0;
+        due[slot] = UNSCHEDULED;
+    }
+    return n == 0;
+}
+
+TEST(wheel_matches_heap) {
+    jcron_sched_t wheel, heap;
+    uint64_t state = 2024;
+    int64_t now = make_timestamp(2025, 12, 31, 23, 58);
+
+    /* Horizons exercising each tier and the overflow heap */
+    static const int64_t horizons[] = {30, 600, 7200, 3 * 86400, 200 * 86400};
+
+    ASSERT(jcron_sched_init_wheel(&wheel, 8, now) == JCRON_OK, "wheel init should succeed");
+    ASSERT(jcron_sched_init(&heap, 0) == JCRON_OK, "heap init should succeed");
+
+    for (int iter = 0; iter < 200000; iter++) {
+        uint32_t slot = (uint32_t)(next_random(&state) % NUM_SLOTS);
+        int op = (int)(next_random(&state) % 8);
+
+        if (op <= 3) {
+            int64_t horizon = horizons[next_random(&state) % 5];
+            int64_t when = now - 5 + (int64_t)(next_random(&state) % (uint64_t)horizon);
+            ASSERT(jcron_sched_set(&wheel, slot, when) == JCRON_OK, "wheel set should succeed");
+            jcron_sched_set(&heap, slot, when);
+        } else if (op == 4) {
+            jcron_sched_remove(&wheel, slot);
+            jcron_sched_remove(&heap, slot);
+        } else {
+            /* Mostly small steps, sometimes long idle jumps */
+            int64_t step = (op == 7) ? (int64_t)(next_random(&state) % (90 * 86400))
+                                     : (int64_t)(next_random(&state) % 200);
+            now += step;
+            if (!drain_agrees(&wheel, &heap, now)) {
+                printf("\n    iteration %d, now %lld\n", iter, (long long)now);
+                ASSERT(0, "wheel and heap should fire the same slots");
+            }
+        }
+
+        ASSERT(wheel.count == heap.count, "counts should agree");
+
+        int64_t wheel_when = 0, heap_when = 0, wakeup = 0;
+        int wheel_top = jcron_sched_peek(&wheel, &wheel_when);
+        int heap_top = jcron_sched_peek(&heap, &heap_when);
+        ASSERT(wheel_top == heap_top && wheel_when == heap_when, "peek should agree");
+        if (heap_top >= 0) {
+            ASSERT(jcron_sched_next_wakeup(&wheel, &wakeup) == JCRON_OK, "wakeup should exist");
+            ASSERT(wakeup <= heap_when, "wakeup should not be after the earliest fire");
+        } else {
+            ASSERT(jcron_sched_next_wakeup(&wheel, &wakeup) == JCRON_ERR_NO_MATCH,
+                   "empty wheel has no wakeup");
+        }
+    }
+
+    jcron_sched_free(&wheel);
+    jcron_sched_free(&heap);
+}
+
+TEST(wheel_wakeups_reach_far_fires) {
+    /* Following next_wakeup() must eventually pop a fire 100 days out */
+    jcron_sched_t wheel;
+    int64_t start = make_timestamp(2025, 1, 1, 0, 0);
+    int64_t target = start + 100 * 86400 + 3600 + 17;
+    int64_t now = start, when = 0;
+    int wakeups = 0;
+
+    ASSERT(jcron_sched_init_wheel(&wheel, 0, start) == JCRON_OK, "init should succeed");
+    ASSERT(jcron_sched_set(&wheel, 42, target) == JCRON_OK, "set should succeed");
+
+    int slot = -1;
+    while (slot < 0 && wakeups < 100) {
+        ASSERT(jcron_sched_next_wakeup(&wheel, &now) == JCRON_OK, "wakeup should exist");
+        ASSERT(now <= target, "wakeup should not overshoot");
+        slot = jcron_sched_pop(&wheel, now, &when);
+        wakeups++;
+    }
+    ASSERT(slot == 42 && when == target, "far fire should pop at its time");
+    ASSERT(wakeups <= 8, "tier cascades should need only a few wakeups");
+
+    jcron_sched_free(&wheel);
+}
+
+/* ========================================================================
+ * Pattern Scheduling Tests
+ * ======================================================================== */
+
+TEST(set_next_follows_pattern) {
+    jcron_sched_t sched;
+    jcron_pattern_t quarter, daily;
+    int64_t when = 0;
+    int64_t start = make_timestamp(2025, 3, 1, 8, 7);
+
+    ASSERT(jcron_parse("0 */15 * * * *", &quarter) == JCRON_OK, "pattern should parse");
+    ASSERT(jcron_parse("0 30 9 * * *", &daily) == JCRON_OK, "pattern should parse");
+    ASSERT(jcron_sched_init(&sched, 0) == JCRON_OK, "init should succeed");
+
+    ASSERT(jcron_sched_set_next(&sched, 0, &quarter, start) == JCRON_OK, "schedule should succeed");
+    ASSERT(jcron_sched_set_next(&sched, 1, &daily, start) == JCRON_OK, "schedule should succeed");
+
+    /* Drive the clock to 09:30 and record the quarter-hour fires */
+    int fires = 0;
+    int64_t now = make_timestamp(2025, 3, 1, 9, 30);
+    for (int slot; (slot = jcron_sched_pop(&sched, now, &when)) >= 0; ) {
+        if (slot == 0) {
+            ASSERT(when == make_timestamp(2025, 3, 1, 8, 15) + fires * 15 * 60,
+                   "quarter-hour fires should be consecutive");
+            fires++;
+            jcron_sched_set_next(&sched, 0, &quarter, when + 60);
+        } else {
+            ASSERT(when == now, "daily job should fire at 09:30");
+            jcron_sched_set_next(&sched, 1, &daily, when + 60);
+        }
+    }
+    ASSERT(fires == 6, "08:15 through 09:30 is six quarter-hour fires");
+
+    ASSERT(jcron_sched_peek(&sched, &when) == 0, "quarter job should be next");
+    ASSERT(when == make_timestamp(2025, 3, 1, 9, 45), "next quarter fire at 09:45");
+
+    jcron_sched_remove(&sched, 0);
+    ASSERT(jcron_sched_peek(&sched, &when) == 1, "daily job should remain");
+    ASSERT(when == make_timestamp(2025, 3, 2, 9, 30), "daily job rescheduled to tomorrow");
+
+    jcron_sched_free(&sched);
+}
+
+/* ========================================================================
+ * Main Test Runner
+ * ======================================================================== */
+
+int main(void) {
+    printf("JCRON C Port - Scheduler Tests\n");
+    printf("==============================\n\n");
+
+    printf("Heap Tests:\n");
+    RUN_TEST(random_operations_match_reference);
+    RUN_TEST(ties_pop_in_slot_order);
+
+    printf("\nTiming Wheel Tests:\n");
+    RUN_TEST(wheel_matches_heap);
+    RUN_TEST(wheel_wakeups_reach_far_fires);
+
+    printf("\nPattern Scheduling Tests:\n");
+    RUN_TEST(set_next_follows_pattern);
+
+    printf("\n==============================\n");
+    printf("Results: %d/%d tests passed ", tests_passed, tests_run);
+
+    if (tests_failed == 0) {
+        printf("✓\n");
+        return 0;
+    } else {
+        printf("✗ (%d failed)\n", tests_failed);
+        return 1;
+    }
+}
@@ -0,0 +1,175 @@
+/**
+ * JCRON C Port - SIMD Kernel Tests
+ *
+ * Exhaustive checks of the 64-bit-lane field matcher against a scalar
+ * reference, plus end-to-end jcron_matches() coverage of every minute value
+ */
+
+#define _DEFAULT_SOURCE  /* timegm */
+
+#include "jcron.h"
+#include "jcron_simd.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* ========================================================================
+ * Test Framework
+ * ======================================================================== */
+
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) static void test_##name(void)
+
+#define ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("    ✗ FAILED: %s\n", message); \
+            tests_failed++; \
+            return; \
+        } \
+    } while (0)
+
+#define RUN_TEST(name) \
+    do { \
+        int failed_before = tests_failed; \
+        printf("  Running: " #name " ... "); \
+        fflush(stdout); \
+        tests_run++; \
+        test_##name(); \
+        if (tests_failed == failed_before) { \
+            printf("✓\n"); \
+            tests_passed++; \
+        } \
+    } while (0)
+
+/* ========================================================================
+ * Helpers
+ * ======================================================================== */
+
+/* Value ranges of the five cron fields: minute, hour, day, month, weekday */
+static const int field_min[5] = {0, 0, 1, 1, 0};
+static const int field_max[5] = {59, 23, 31, 12, 6};
+
+static int reference_match(const uint64_t* masks, const uint64_t* values, int num_fields) {
+    for (int i = 0; i < num_fields; i++) {
+        if (values[i] >= 64 || !((masks[i] >> values[i]) & 1)) return 0;
+    }
+    return 1;
+}
+
+/* ========================================================================
+ * 64-bit Kernel Tests
+ * ======================================================================== */
+
+TEST(kernel_single_bit_exhaustive) {
+    /* Every (mask bit, value) pair of every field, other fields matching */
+    for (int f = 0; f < 5; f++) {
+        for (int bit = field_min[f]; bit <= field_max[f]; bit++) {
+            for (int value = field_min[f]; value <= field_max[f]; value++) {
+                uint64_t masks[5], values[5];
+                for (int i = 0; i < 5; i++) {
+                    masks[i] = ~0ULL;
+                    values[i] = (uint64_t)field_min[i];
+                }
+                masks[f] = 1ULL << bit;
+                values[f] = (uint64_t)value;
+
+                int got = jcron_simd_bitmask_match64(masks, values, 5);
+                if (got != (bit == value)) {
+                    printf("\n    field %d bit %d value %d: got %d\n", f, bit, value, got);
+                    ASSERT(0, "kernel should agree with single-bit reference");
+                }
+            }
+        }
+    }
+}
+
+TEST(kernel_random_masks) {
+    uint64_t state = 42;
+    for (int iter = 0; iter < 200000; iter++) {
+        int num_fields = 1 + (int)(next_random(&state) % JCRON_SIMD_MAX_FIELDS);
+        uint64_t masks[JCRON_SIMD_MAX_FIELDS], values[JCRON_SIMD_MAX_FIELDS];
+        for (int i = 0; i < num_fields; i++) {
+            /* Dense masks so that full matches are common */
+            masks[i] = next_random(&state) | next_random(&state) | next_random(&state);
+            values[i] = next_random(&state) % 60;
+        }
+        ASSERT(jcron_simd_bitmask_match64(masks, values, num_fields) ==
+               reference_match(masks, values, num_fields),
+               "kernel should agree with scalar reference");
+    }
+}
+
+TEST(kernel_out_of_range_values) {
+    uint64_t masks[5] = {~0ULL, ~0ULL, ~0ULL, ~0ULL, ~0ULL};
+    uint64_t values[5] = {63, 0, 1, 1, 0};
+    ASSERT(jcron_simd_bitmask_match64(masks, values, 5) == 1, "bit 63 should be addressable");
+
+    values[0] = 64;
+    ASSERT(jcron_simd_bitmask_match64(masks, values, 5) == 0, "value 64 should never match");
+
+    /* NEON shift counts only use the low byte: 256 and 320 alias 0 and 64 */
+    values[0] = 256;
+    ASSERT(jcron_simd_bitmask_match64(masks, values, 5) == 0, "value 256 should never match");
+    values[0] = 320;
+    ASSERT(jcron_simd_bitmask_match64(masks, values, 5) == 0, "value 320 should never match");
+
+    values[0] = 0;
+    values[4] = 1000;
+    ASSERT(jcron_simd_bitmask_match64(masks, values, 5) == 0, "huge value should never match");
+}
+
+/* ========================================================================
+ * jcron_matches() Coverage
+ * ======================================================================== */
+
+TEST(matches_every_minute_value) {
+    /* "* M * * * *" must fire at minute M only, including M >= 32 */
+    for (int minute = 0; minute < 60; minute++) {
+        char expr[32];
+        snprintf(expr, sizeof(expr), "* %d * * * *", minute);
+
+        jcron_pattern_t pattern;
+        ASSERT(jcron_parse(expr, &pattern) == JCRON_OK, "pattern should parse");
+
+        for (int m = 0; m < 60; m++) {
+            int64_t ts = make_timestamp(2025, 10, 23, 10, m);
+            if (jcron_matches(ts, &pattern) != (m == minute)) {
+                printf("\n    pattern \"%s\" at minute %d\n", expr, m);
+                ASSERT(0, "jcron_matches should fire exactly at the pattern minute");
+            }
+        }
+    }
+}
+
+/* ========================================================================
+ * Main Test Runner
+ * ======================================================================== */
+
+int main(void) {
+    printf("JCRON C Port - SIMD Kernel Tests\n");
+    printf("================================\n\n");
+
+    printf("64-bit Kernel Tests:\n");
+    RUN_TEST(kernel_single_bit_exhaustive);
+    RUN_TEST(kernel_random_masks);
+    RUN_TEST(kernel_out_of_range_values);
+
+    printf("\njcron_matches() Coverage:\n");
+    RUN_TEST(matches_every_minute_value);
+
+    printf("\n================================\n");
+    printf("Results: %d/%d tests passed ", tests_passed, tests_run);
+
+    if (tests_failed == 0) {
+        printf("✓\n");
+        return 0;
+    } else {
+        printf("✗ (%d failed)\n", tests_failed);
+        return 1;
+    }
+}
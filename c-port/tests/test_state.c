@@ -0,0 +1,472 @@
+/**
+ * JCRON C Port - Daemon State Tests
+ *
+ * The run-state journal (state.c) across a crash: a child records and
+ * commits, then exits without a checkpoint; the snapshot is put back as of
+ * its last checkpoint (what a power loss leaves) and the journal is cut
+ * where the test needs it before reloading. Also the crontab side of the
+ * daemon (crontab.c): commands split for direct exec, and the line diff
+ * applied when a file is re-read.
+ */
+
+#include "jcrond.h"
+#include "test_util.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/* ========================================================================
+ * Test Framework
+ * ======================================================================== */
+
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) static void test_##name(void)
+
+#define ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("    ✗ FAILED: %s\n", message); \
+            tests_failed++; \
+            return; \
+        } \
+    } while (0)
+
+#define RUN_TEST(name) \
+    do { \
+        int failed_before = tests_failed; \
+        printf("  Running: " #name " ... "); \
+        fflush(stdout); \
+        tests_run++; \
+        test_##name(); \
+        if (tests_failed == failed_before) { \
+            printf("✓\n"); \
+            tests_passed++; \
+        } \
+    } while (0)
+
+/* ========================================================================
+ * Helpers
+ * ======================================================================== */
+
+#define T1 1700000040
+#define T2 (T1 + 60)
+
+static char root[] = "/tmp/jcron-test-state-XXXXXX";
+static char path_state[128], path_journal[128];
+
+// Control jobs whose state the journal tests record
+static cron_job_t* job_a;
+static cron_job_t* job_b;
+static cron_job_t* job_c;
+
+// The snapshot as of its last checkpoint
+static char* snapshot = NULL;
+static size_t snapshot_size = 0;
+
+static char* read_file(const char* path, size_t* size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long len = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* data = malloc(len > 0 ? (size_t)len : 1);
+    if (data && fread(data, 1, (size_t)len, file) != (size_t)len) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    *size = (size_t)len;
+    return data;
+}
+
+static int write_file(const char* path, const char* data, size_t size) {
+    FILE* file = fopen(path, "wb");
+    if (!file) return -1;
+    int ok = fwrite(data, 1, size, file) == size;
+    return fclose(file) == 0 && ok ? 0 : -1;
+}
+
+static off_t file_size(const char* path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? st.st_size : -1;
+}
+
+static void forget_job_state(void) {
+    cron_job_t* jobs[] = {job_a, job_b, job_c};
+    for (int i = 0; i < 3; i++) {
+        jobs[i]->last_run = 0;
+        jobs[i]->last_status = 0;
+        jobs[i]->last_duration_ms = 0;
+    }
+}
+
+// Empty state files, checkpointed; keeps a copy of the snapshot
+static int fresh_state(void) {
+    unlink(path_state);
+    unlink(path_journal);
+    if (state_load() < 0) return -1;
+    state_close();
+    free(snapshot);
+    snapshot = read_file(path_state, &snapshot_size);
+    return snapshot ? 0 : -1;
+}
+
+// Run `steps` in a child that loads the state and dies without closing it
+static int crash_after(void (*steps)(void)) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (state_load() < 0) _exit(1);
+        steps();
+        _exit(0);
+    }
+    int status;
+    return pid > 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status) &&
+           WEXITSTATUS(status) == 0 ? 0 : -1;
+}
+
+// Writes to the mapping that were never msync()ed are lost
+static int power_loss(void) {
+    return write_file(path_state, snapshot, snapshot_size);
+}
+
+static void fire(cron_job_t* job, int64_t when) {
+    job->last_run = (time_t)when;
+    state_record_fire(job);
+}
+
+static cron_job_t* file_job(const char* command) {
+    for (uint32_t slot = 0; slot < crontab_slot_limit(); slot++) {
+        cron_job_t* job = crontab_job(slot);
+        if (job && !job->control && strcmp(job->command, command) == 0) return job;
+    }
+    return NULL;
+}
+
+/* ========================================================================
+ * Journal Tests
+ * ======================================================================== */
+
+// Six entries; the last one (B at T2) is the one tests damage
+static void record_history(void) {
+    fire(job_a, T1);
+    state_commit();
+    fire(job_b, T1);
+    state_commit();
+    job_a->last_status = 3 << 8;
+    job_a->last_duration_ms = 42;
+    state_record_exit(job_a);
+    state_commit();
+    fire(job_c, T1);
+    state_commit();
+    state_forget(job_c);
+    state_commit();
+    fire(job_b, T2);
+    state_commit();
+}
+
+TEST(torn_tail_is_cut_off) {
+    ASSERT(fresh_state() == 0, "state files should be created");
+    ASSERT(crash_after(record_history) == 0, "child should record its history");
+    ASSERT(power_loss() == 0, "snapshot should be put back");
+
+    off_t size = file_size(path_journal);
+    ASSERT(size > 0 && size % 6 == 0, "journal should hold six whole entries");
+    ASSERT(truncate(path_journal, size - size / 6 / 2) == 0, "journal should be torn");
+
+    forget_job_state();
+    ASSERT(state_load() == 2, "A and B should be restored");
+    ASSERT(job_a->last_run == T1, "A keeps its fire");
+    ASSERT(job_a->last_status == 3 << 8, "A keeps its exit status");
+    ASSERT(job_a->last_duration_ms == 42, "A keeps its duration");
+    ASSERT(job_b->last_run == T1, "B's torn fire must be ignored");
+    ASSERT(job_c->last_run == 0, "C's tombstone frees its record");
+    state_close();
+    ASSERT(file_size(path_journal) == 0, "reload should checkpoint the journal");
+}
+
+TEST(bad_checksum_stops_replay) {
+    ASSERT(fresh_state() == 0, "state files should be created");
+    ASSERT(crash_after(record_history) == 0, "child should record its history");
+    ASSERT(power_loss() == 0, "snapshot should be put back");
+
+    // Whole-sized but half-written: the length alone cannot tell
+    off_t size = file_size(path_journal);
+    ASSERT(size > 0 && size % 6 == 0, "journal should hold six whole entries");
+    off_t half = size / 6 / 2;
+    char zeros[64] = {0};
+    int fd = open(path_journal, O_WRONLY);
+    ssize_t written = fd >= 0 ? pwrite(fd, zeros, (size_t)half, size - half) : -1;
+    if (fd >= 0) close(fd);
+    ASSERT(written == half, "last entry should be damaged");
+
+    forget_job_state();
+    ASSERT(state_load() == 2, "A and B should be restored");
+    ASSERT(job_b->last_run == T1, "B's damaged fire must be ignored");
+    ASSERT(job_c->last_run == 0, "entries before it still apply");
+    state_close();
+}
+
+TEST(replay_is_idempotent) {
+    ASSERT(fresh_state() == 0, "state files should be created");
+    ASSERT(crash_after(record_history) == 0, "child should record its history");
+    ASSERT(power_loss() == 0, "snapshot should be put back");
+    size_t journal_size;
+    char* journal = read_file(path_journal, &journal_size);
+    ASSERT(journal, "journal should be readable");
+
+    // The same journal over a snapshot that already has every entry, as
+    // after a crash during the checkpoint that followed recovery
+    forget_job_state();
+    state_load();
+    state_close();
+    int written = write_file(path_journal, journal, journal_size);
+    ASSERT(written == 0, "journal should be put back");
+
+    forget_job_state();
+    ASSERT(state_load() == 2, "replaying again restores the same jobs");
+    ASSERT(job_a->last_run == T1 && job_a->last_status == 3 << 8 &&
+           job_a->last_duration_ms == 42, "A unchanged by the second replay");
+    ASSERT(job_b->last_run == T2, "B keeps its last fire");
+    ASSERT(job_c->last_run == 0, "C stays forgotten");
+    state_close();
+
+    // Only the first two entries, over a snapshot that has B's later fire
+    written = write_file(path_journal, journal, journal_size / 6 * 2);
+    free(journal);
+    ASSERT(written == 0, "journal prefix should be put back");
+    forget_job_state();
+    ASSERT(state_load() == 2, "replaying a prefix restores the same jobs");
+    ASSERT(job_b->last_run == T2, "B's last fire never moves back");
+    state_close();
+}
+
+static void forget_then_fire(void) {
+    fire(job_c, T1);
+    state_commit();
+    state_forget(job_c);
+    state_commit();
+    fire(job_c, T2);
+    state_commit();
+}
+
+TEST(tombstone_then_new_record) {
+    ASSERT(fresh_state() == 0, "state files should be created");
+    ASSERT(crash_after(forget_then_fire) == 0, "child should record its history");
+    ASSERT(power_loss() == 0, "snapshot should be put back");
+
+    forget_job_state();
+    ASSERT(state_load() == 1, "only C should be restored");
+    ASSERT(job_c->last_run == T2, "a fire after the tombstone gets a new record");
+    state_close();
+}
+
+// A fires and commits; B's fire is recorded but the child dies before
+// the commit that would precede its launch
+static void die_before_commit(void) {
+    fire(job_a, T1);
+    state_commit();
+    fire(job_b, T1);
+}
+
+TEST(fire_is_committed_before_launch) {
+    ASSERT(fresh_state() == 0, "state files should be created");
+    ASSERT(crash_after(die_before_commit) == 0, "child should record its fires");
+    ASSERT(power_loss() == 0, "snapshot should be put back");
+
+    forget_job_state();
+    ASSERT(state_load() == 1, "only the committed fire survives");
+    ASSERT(job_a->last_run == T1, "A's committed fire is on disk");
+    ASSERT(job_b->last_run == 0, "B's uncommitted fire is not");
+
+    // Fires are synced at commit; exits ride along without a sync
+    uint64_t syncs = counters.state_syncs;
+    fire(job_a, T2);
+    ASSERT(state_commit() == 0, "commit should succeed");
+    ASSERT(counters.state_syncs == syncs + 1, "a fire commit syncs the journal");
+    state_record_exit(job_a);
+    ASSERT(state_commit() == 0, "commit should succeed");
+    ASSERT(counters.state_syncs == syncs + 1, "an exit-only commit does not sync");
+    state_close();
+}
+
+/* ========================================================================
+ * Command Splitting Tests
+ * ======================================================================== */
+
+// argv of a control job defined with `command`, or NULL if it goes
+// through the shell
+static int split_matches(const char* command, const char* const* expected) {
+    cron_job_t* job;
+    if (crontab_job_define("split", "* * * * *", NULL, command, NULL, &job) != JCRON_OK) {
+        return 0;
+    }
+    int same = 1;
+    if (!expected || !job->argv) {
+        same = !expected && !job->argv;
+    } else {
+        int i = 0;
+        for (; expected[i] && job->argv[i]; i++) {
+            if (strcmp(expected[i], job->argv[i]) != 0) same = 0;
+        }
+        if (expected[i] || job->argv[i]) same = 0;
+    }
+    crontab_job_remove(job);
+    return same;
+}
+
+TEST(split_plain_words) {
+    const char* const echo[] = {"/bin/echo", "hello", "world", NULL};
+    ASSERT(split_matches("/bin/echo hello \t world", echo), "blanks separate words");
+    const char* const relative[] = {"backup", "--full", NULL};
+    ASSERT(split_matches("  backup --full  ", relative), "outer blanks are dropped");
+}
+
+TEST(split_leaves_shell_syntax_to_the_shell) {
+    const char* shell[] = {"echo $HOME", "a | b", "a && b", "a > out", "echo 'x'",
+                           "echo \"x\"", "ls *.log", "echo ~", "date +%s", "run\r",
+                           "a # note", "echo `id`", "a\\ b"};
+    for (size_t i = 0; i < sizeof(shell) / sizeof(shell[0]); i++) {
+        ASSERT(split_matches(shell[i], NULL), "shell syntax goes through the shell");
+    }
+    ASSERT(split_matches("cd /tmp", NULL), "builtins go through the shell");
+    ASSERT(split_matches("exec true", NULL), "keywords go through the shell");
+    ASSERT(split_matches("FOO=1 env", NULL), "assignments go through the shell");
+    const char* const cdrom[] = {"cdrom", NULL};
+    ASSERT(split_matches("cdrom", cdrom), "only whole words are builtins");
+}
+
+TEST(split_word_limit) {
+    char command[JOB_ARGV_MAX * 2 + 4] = "";
+    const char* expected[JOB_ARGV_MAX + 2];
+    for (int i = 0; i < JOB_ARGV_MAX; i++) {
+        strcat(command, i ? " x" : "x");
+        expected[i] = "x";
+    }
+    expected[JOB_ARGV_MAX] = NULL;
+    ASSERT(split_matches(command, expected), "JOB_ARGV_MAX words are split");
+    strcat(command, " x");
+    ASSERT(split_matches(command, NULL), "one more goes through the shell");
+}
+
+/* ========================================================================
+ * Crontab Reload Tests
+ * ======================================================================== */
+
+TEST(reload_applies_line_diff) {
+    char dir[128];
+    snprintf(dir, sizeof(dir), "%s/cron.d", root);
+    mkdir(dir, 0700);
+    snprintf(dir, sizeof(dir), "%s/spool", root);
+    mkdir(dir, 0700);
+    int base = crontab_job_count();
+
+    const char* before =
+        "0 * * * * root /bin/true a\n"
+        "5 * * * * root /bin/true b\n"
+        "10 * * * * root /bin/true c\n"
+        "20 * * * * root /bin/true e\n"
+        "20 * * * * root /bin/true e\n";
+    ASSERT(write_file(crontab_paths.crontab, before, strlen(before)) == 0, "crontab written");
+    crontab_load_all(1);
+    ASSERT(crontab_job_count() == base + 5, "every line is a job");
+
+    cron_job_t* a = file_job("/bin/true a");
+    cron_job_t* b = file_job("/bin/true b");
+    cron_job_t* c = file_job("/bin/true c");
+    ASSERT(a && b && c, "jobs should be found");
+    uint32_t slot_a = a->slot, slot_b = b->slot, slot_c = c->slot;
+    b->last_run = 4242;
+
+    // b moves up, c changes schedule, one e goes, d is new
+    const char* after =
+        "5 * * * * root /bin/true b\n"
+        "0 * * * * root /bin/true a\n"
+        "15 * * * * root /bin/true c\n"
+        "20 * * * * root /bin/true e\n"
+        "30 * * * * root /bin/true d\n";
+    ASSERT(write_file(crontab_paths.crontab, after, strlen(after)) == 0, "crontab rewritten");
+    crontab_load_all(1);
+    ASSERT(crontab_job_count() == base + 5, "one e removed, d added");
+
+    a = file_job("/bin/true a");
+    b = file_job("/bin/true b");
+    c = file_job("/bin/true c");
+    ASSERT(a && a->slot == slot_a, "unchanged line keeps its slot");
+    ASSERT(b && b->slot == slot_b, "moved line keeps its slot");
+    ASSERT(b->last_run == 4242, "kept job keeps its run state");
+    ASSERT(c && c->slot != slot_c && strcmp(c->schedule, "15 * * * *") == 0,
+           "changed line is a new job");
+    ASSERT(crontab_job(slot_c) == NULL, "changed line's old slot is freed");
+    ASSERT(file_job("/bin/true d") != NULL, "new line is added");
+    ASSERT(file_job("/bin/true e") != NULL, "duplicate lines pair up one by one");
+
+    unlink(crontab_paths.crontab);
+    crontab_load_all(1);
+    ASSERT(crontab_job_count() == base, "removed file drops its jobs");
+}
+
+/* ========================================================================
+ * Main Test Runner
+ * ======================================================================== */
+
+int main(void) {
+    printf("JCRON C Port - Daemon State Tests\n");
+    printf("=================================\n\n");
+
+    setlogmask(LOG_UPTO(LOG_ERR));
+    if (!mkdtemp(root) || metrics_init() != 0 || crontab_init(JCRON_SCHED_HEAP) != JCRON_OK ||
+        crontab_job_define("a", "* * * * *", NULL, "/bin/true", NULL, &job_a) != JCRON_OK ||
+        crontab_job_define("b", "* * * * *", NULL, "/bin/true", NULL, &job_b) != JCRON_OK ||
+        crontab_job_define("c", "* * * * *", NULL, "/bin/true", NULL, &job_c) != JCRON_OK) {
+        printf("Cannot set up the daemon state\n");
+        return 1;
+    }
+    snprintf(path_state, sizeof(path_state), "%s/state", root);
+    snprintf(path_journal, sizeof(path_journal), "%s/state.journal", root);
+    state_path = path_state;
+    static char crontab[128], cron_d[128], spool[128];
+    snprintf(crontab, sizeof(crontab), "%s/crontab", root);
+    snprintf(cron_d, sizeof(cron_d), "%s/cron.d", root);
+    snprintf(spool, sizeof(spool), "%s/spool", root);
+    crontab_paths = (jcrond_paths_t){crontab, cron_d, spool};
+
+    printf("Journal Tests:\n");
+    RUN_TEST(torn_tail_is_cut_off);
+    RUN_TEST(bad_checksum_stops_replay);
+    RUN_TEST(replay_is_idempotent);
+    RUN_TEST(tombstone_then_new_record);
+    RUN_TEST(fire_is_committed_before_launch);
+
+    printf("\nCommand Splitting Tests:\n");
+    RUN_TEST(split_plain_words);
+    RUN_TEST(split_leaves_shell_syntax_to_the_shell);
+    RUN_TEST(split_word_limit);
+
+    printf("\nCrontab Reload Tests:\n");
+    RUN_TEST(reload_applies_line_diff);
+
+    crontab_free();
+    free(snapshot);
+    char command[160];
+    snprintf(command, sizeof(command), "rm -rf %s", root);
+    if (system(command) != 0) printf("Cannot remove %s\n", root);
+
+    printf("\n=================================\n");
+    printf("Results: %d/%d tests passed ", tests_passed, tests_run);
+
+    if (tests_failed == 0) {
+        printf("✓\n");
+        return 0;
+    } else {
+        printf("✗ (%d failed)\n", tests_failed);
+        return 1;
+    }
+}
@@ -0,0 +1,301 @@
+/**
+ * JCRON C Port - Job Table Tests
+ *
+ * Checks jcron_table_match() and jcron_table_due() against per-pattern
+ * jcron_matches() / jcron_next() under insert/remove churn, plus slot
+ * reuse and string interning
+ */
+
+#define _DEFAULT_SOURCE  /* timegm */
+
+#include "jcron.h"
+#include "jcron_table.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* ========================================================================
+ * Test Framework
+ * ======================================================================== */
+
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) static void test_##name(void)
+
+#define ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("    ✗ FAILED: %s\n", message); \
+            tests_failed++; \
+            return; \
+        } \
+    } while (0)
+
+#define RUN_TEST(name) \
+    do { \
+        int failed_before = tests_failed; \
+        printf("  Running: " #name " ... "); \
+        fflush(stdout); \
+        tests_run++; \
+        test_##name(); \
+        if (tests_failed == failed_before) { \
+            printf("✓\n"); \
+            tests_passed++; \
+        } \
+    } while (0)
+
+/* ========================================================================
+ * Helpers
+ * ======================================================================== */
+
+#define NUM_JOBS 3000
+
+/**
+ * Fill a table with random jobs, then remove about a third and insert
+ * replacements, so the scans see reused slots
+ */
+static int build_churned(jcron_table_t* table, uint64_t* state) {
+    jcron_pattern_t pattern;
+    uint32_t slot;
+    for (int i = 0; i < NUM_JOBS; i++) {
+        if (random_pattern(state, &pattern) != JCRON_OK) return 0;
+        if (jcron_table_insert(table, &pattern, (uint64_t)i, NULL, &slot) != JCRON_OK) return 0;
+    }
+    for (uint32_t s = 0; s < NUM_JOBS; s++) {
+        if (next_random(state) % 3 == 0) jcron_table_remove(table, s);
+    }
+    for (int i = 0; i < NUM_JOBS / 6; i++) {
+        if (random_pattern(state, &pattern) != JCRON_OK) return 0;
+        if (jcron_table_insert(table, &pattern, 0, NULL, &slot) != JCRON_OK) return 0;
+    }
+    return 1;
+}
+
+/* ========================================================================
+ * Scan Tests
+ * ======================================================================== */
+
+TEST(match_agrees_with_jcron_matches) {
+    uint64_t state = 11;
+    jcron_table_t table;
+    ASSERT(jcron_table_init(&table, 0, 0) == JCRON_OK, "init should succeed");
+    ASSERT(build_churned(&table, &state), "table should fill");
+
+    int64_t base = make_timestamp(2025, 1, 1, 0, 0);
+    for (int i = 0; i < 500; i++) {
+        int64_t ts = base + (int64_t)(next_random(&state) % (4 * 366 * 1440)) * 60;
+
+        /* Small output buffer, so the cursor resumes mid-table */
+        uint32_t cursor = 0, out[13], expect = 0;
+        while (cursor < table.high) {
+            uint32_t n = jcron_table_match(&table, ts, &cursor, out, 13);
+            for (uint32_t k = 0; k < n; k++) {
+                while (expect < out[k]) {
+                    if ((table.flags[expect] & JCRON_TABLE_USED) &&
+                        jcron_matches(ts, &table.patterns[expect])) {
+                        jcron_table_free(&table);
+                        ASSERT(0, "match should not skip a matching slot");
+                    }
+                    expect++;
+                }
+                if (!(table.flags[out[k]] & JCRON_TABLE_USED) ||
+                    !jcron_matches(ts, &table.patterns[out[k]])) {
+                    jcron_table_free(&table);
+                    ASSERT(0, "match should only return matching live slots");
+                }
+                expect = out[k] + 1;
+            }
+        }
+        for (; expect < table.high; expect++) {
+            if ((table.flags[expect] & JCRON_TABLE_USED) &&
+                jcron_matches(ts, &table.patterns[expect])) {
+                jcron_table_free(&table);
+                ASSERT(0, "match should reach the end of the table");
+            }
+        }
+    }
+
+    jcron_table_free(&table);
+}
+
+TEST(due_follows_next_fire) {
+    uint64_t state = 5;
+    jcron_table_t table;
+    ASSERT(jcron_table_init(&table, 0, 0) == JCRON_OK, "init should succeed");
+    ASSERT(build_churned(&table, &state), "table should fill");
+
+    int64_t start = make_timestamp(2025, 6, 1, 8, 0);
+    for (uint32_t s = 0; s < table.high; s++) {
+        if (table.flags[s] & JCRON_TABLE_USED) jcron_table_advance(&table, s, start);
+    }
+
+    /* Walk two days minute by minute; every fire must come due exactly once,
+       at its minute */
+    uint32_t due[64];
+    long fires = 0, expected = 0;
+    for (int64_t now = start; now < start + 2 * 86400; now += 60) {
+        for (uint32_t s = 0; s < table.high; s++) {
+            if ((table.flags[s] & JCRON_TABLE_USED) && jcron_matches(now, &table.patterns[s])) {
+                expected++;
+            }
+        }
+        uint32_t cursor = 0;
+        while (cursor < table.high) {
+            uint32_t n = jcron_table_due(&table, now, &cursor, due, 64);
+            for (uint32_t k = 0; k < n; k++) {
+                if (table.next_fire[due[k]] != now) {
+                    jcron_table_free(&table);
+                    ASSERT(0, "due slot should fire at the current minute");
+                }
+                jcron_table_advance(&table, due[k], now + 60);
+                fires++;
+            }
+        }
+    }
+    ASSERT(fires == expected, "due fires should equal jcron_matches() hits");
+    ASSERT(fires > 0, "some jobs should fire");
+
+    jcron_table_free(&table);
+}
+
+/* ========================================================================
+ * Bookkeeping Tests
+ * ======================================================================== */
+
+TEST(slots_are_reused) {
+    jcron_table_t table;
+    jcron_pattern_t pattern;
+    uint32_t a, b, c;
+    ASSERT(jcron_table_init(&table, 0, 0) == JCRON_OK, "init should succeed");
+    ASSERT(jcron_parse("0 */5 * * * *", &pattern) == JCRON_OK, "pattern should parse");
+
+    ASSERT(jcron_table_insert(&table, &pattern, 1, NULL, &a) == JCRON_OK, "insert should succeed");
+    ASSERT(jcron_table_insert(&table, &pattern, 2, &table, &b) == JCRON_OK, "insert should succeed");
+    ASSERT(a == 0 && b == 1, "slots should be dense");
+    ASSERT(table.keys[b] == 2 && table.data[b] == &table, "key and data should be stored");
+    ASSERT(table.next_fire[a] == JCRON_TABLE_IDLE, "new slot should have no fire");
+
+    ASSERT(jcron_table_remove(&table, a) == JCRON_OK, "remove should succeed");
+    ASSERT(jcron_table_remove(&table, a) == JCRON_OK, "second remove should be a no-op");
+    ASSERT(table.count == 1, "count should track removes");
+    ASSERT(jcron_table_insert(&table, &pattern, 3, NULL, &c) == JCRON_OK, "insert should succeed");
+    ASSERT(c == a && table.high == 2, "freed slot should be reused");
+    ASSERT(table.keys[c] == 3, "reused slot should take the new key");
+
+    /* Growth past the initial capacity keeps earlier slots intact */
+    for (uint32_t i = 0; i < 1000; i++) {
+        ASSERT(jcron_table_insert(&table, &pattern, 100 + i, NULL, &c) == JCRON_OK,
+               "insert should grow the table");
+    }
+    ASSERT(table.keys[b] == 2 && table.keys[c] == 1099, "keys should survive growth");
+    ASSERT(table.minutes[c] == pattern.minutes, "masks should be copied");
+
+    jcron_pattern_t eod;
+    ASSERT(jcron_parse("EOD:E0D", &eod) == JCRON_OK, "EOD pattern should parse");
+    ASSERT(jcron_table_insert(&table, &eod, 0, NULL, &c) == JCRON_OK, "EOD insert should succeed");
+    uint32_t cursor = 0, out[8];
+    uint32_t hits = 0;
+    while (cursor < table.high) {
+        uint32_t n = jcron_table_match(&table, make_timestamp(2025, 1, 1, 0, 0), &cursor, out, 8);
+        for (uint32_t k = 0; k < n; k++) hits += out[k] == c;
+    }
+    ASSERT(hits == 0, "pattern without cron part should never match");
+
+    jcron_table_free(&table);
+}
+
+TEST(strings_are_interned) {
+    jcron_table_t table;
+    jcron_pattern_t pattern;
+    uint32_t a, b;
+    ASSERT(jcron_table_init(&table, 0, 2) == JCRON_OK, "init should succeed");
+    ASSERT(jcron_parse("0 0 * * * *", &pattern) == JCRON_OK, "pattern should parse");
+    ASSERT(jcron_table_insert(&table, &pattern, 1, NULL, &a) == JCRON_OK, "insert should succeed");
+    ASSERT(jcron_table_insert(&table, &pattern, 2, NULL, &b) == JCRON_OK, "insert should succeed");
+
+    ASSERT(jcron_table_set_string(&table, a, 0, "backup.sh --full", 9) == JCRON_OK,
+           "set should succeed");
+    ASSERT(jcron_table_set_string(&table, b, 0, "backup.sh", 9) == JCRON_OK, "set should succeed");
+    ASSERT(jcron_table_set_string(&table, a, 1, "root", 4) == JCRON_OK, "set should succeed");
+    ASSERT(strcmp(jcron_table_string(&table, a, 0), "backup.sh") == 0,
+           "string should be cut at len and terminated");
+    ASSERT(jcron_table_string(&table, a, 0) == jcron_table_string(&table, b, 0),
+           "equal strings should be stored once");
+    ASSERT(jcron_table_string(&table, b, 1) == NULL, "unset column should be NULL");
+    ASSERT(jcron_table_set_string(&table, a, 2, "x", 1) == JCRON_ERR_INVALID_PATTERN,
+           "column out of range should fail");
+
+    /* Releasing one user keeps the string for the other */
+    ASSERT(jcron_table_remove(&table, a) == JCRON_OK, "remove should succeed");
+    ASSERT(strcmp(jcron_table_string(&table, b, 0), "backup.sh") == 0,
+           "shared string should outlive one user");
+    ASSERT(jcron_table_set_string(&table, b, 0, NULL, 0) == JCRON_OK, "clear should succeed");
+    ASSERT(jcron_table_string(&table, b, 0) == NULL, "cleared column should be NULL");
+
+    /* Churn through distinct strings: released bytes are reclaimed */
+    char text[64];
+    for (int i = 0; i < 20000; i++) {
+        int len = snprintf(text, sizeof(text), "/usr/local/bin/job-%d --verbose", i);
+        ASSERT(jcron_table_set_string(&table, b, 0, text, (size_t)len) == JCRON_OK,
+               "set should succeed");
+        ASSERT(strcmp(jcron_table_string(&table, b, 0), text) == 0, "string should round-trip");
+    }
+    ASSERT(table.pool.used - table.pool.dead < 256, "only the live string should remain");
+    ASSERT(table.pool.capacity <= 16384, "pool should not grow with dead strings");
+
+    jcron_table_free(&table);
+}
+
+TEST(rejects_invalid_input) {
+    jcron_table_t table;
+    jcron_pattern_t pattern;
+    uint32_t slot;
+    ASSERT(jcron_table_init(NULL, 0, 0) == JCRON_ERR_NULL_POINTER, "NULL table should fail");
+    ASSERT(jcron_table_init(&table, 0, JCRON_TABLE_MAX_COLUMNS + 1) == JCRON_ERR_INVALID_PATTERN,
+           "too many columns should fail");
+    ASSERT(jcron_table_init(&table, 0, 1) == JCRON_OK, "init should succeed");
+    ASSERT(jcron_table_insert(&table, NULL, 0, NULL, &slot) == JCRON_ERR_NULL_POINTER,
+           "NULL pattern should fail");
+    ASSERT(jcron_parse("0 0 0 30 2 *", &pattern) == JCRON_OK, "Feb 30 should parse");
+    ASSERT(jcron_table_insert(&table, &pattern, 0, NULL, &slot) == JCRON_OK, "insert should succeed");
+    ASSERT(jcron_table_advance(&table, slot, make_timestamp(2025, 1, 1, 0, 0)) != JCRON_OK,
+           "pattern that never fires should not advance");
+    ASSERT(table.next_fire[slot] == JCRON_TABLE_IDLE, "slot should be left idle");
+    ASSERT(jcron_table_advance(&table, slot + 1, 0) == JCRON_ERR_INVALID_PATTERN,
+           "free slot should not advance");
+    ASSERT(jcron_table_set_string(&table, slot + 1, 0, "x", 1) == JCRON_ERR_INVALID_PATTERN,
+           "free slot should take no strings");
+    jcron_table_free(&table);
+}
+
+/* ========================================================================
+ * Main Test Runner
+ * ======================================================================== */
+
+int main(void) {
+    printf("JCRON C Port - Job Table Tests\n");
+    printf("==============================\n\n");
+
+    printf("Scan Tests:\n");
+    RUN_TEST(match_agrees_with_jcron_matches);
+    RUN_TEST(due_follows_next_fire);
+
+    printf("\nBookkeeping Tests:\n");
+    RUN_TEST(slots_are_reused);
+    RUN_TEST(strings_are_interned);
+    RUN_TEST(rejects_invalid_input);
+
+    printf("\n==============================\n");
+    printf("Results: %d/%d tests passed ", tests_passed, tests_run);
+
+    if (tests_failed == 0) {
+        printf("✓\n");
+        return 0;
+    } else {
+        printf("✗ (%d failed)\n", tests_failed);
+        return 1;
+    }
+}
@@ -0,0 +1,54 @@
+/**
+ * JCRON C Port - Test Fixtures
+ *
+ * Deterministic random numbers, UTC timestamps and random patterns shared
+ * by the randomized tests (index, job table, scheduler, SIMD)
+ */
+
+#ifndef JCRON_TEST_UTIL_H
+#define JCRON_TEST_UTIL_H
+
+#include "jcron.h"
+#include <stdio.h>
+#include <time.h>
+
+/**
+ * 64-bit LCG with an xorshift output step
+ */
+static inline uint64_t next_random(uint64_t* state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return *state ^ (*state >> 29);
+}
+
+/**
+ * UTC timestamp of a calendar minute (needs _DEFAULT_SOURCE for timegm)
+ */
+static inline int64_t make_timestamp(int year, int month, int day, int hour, int min) {
+    struct tm tm = {0};
+    tm.tm_year = year - 1900;
+    tm.tm_mon = month - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = hour;
+    tm.tm_min = min;
+    return (int64_t)timegm(&tm);
+}
+
+/**
+ * Random pattern mixing wildcards, lists and steps in every field
+ */
+static inline int random_pattern(uint64_t* state, jcron_pattern_t* out) {
+    static const char* minutes[] = {"*", "0", "*/5", "15,45", "59", "30-35"};
+    static const char* hours[] = {"*", "0", "*/2", "9-17", "23"};
+    static const char* days[] = {"*", "*", "1", "15", "31", "1-7"};
+    static const char* months[] = {"*", "*", "*", "1", "6-8", "12"};
+    static const char* weekdays[] = {"*", "*", "*", "0", "1-5", "6"};
+
+    char expr[64];
+    snprintf(expr, sizeof(expr), "0 %s %s %s %s %s",
+             minutes[next_random(state) % 6], hours[next_random(state) % 5],
+             days[next_random(state) % 6], months[next_random(state) % 6],
+             weekdays[next_random(state) % 6]);
+    return jcron_parse(expr, out);
+}
+
+#endif // JCRON_TEST_UTIL_H